@@ -176,7 +176,6 @@ R_API RAnal *r_anal_new() {
 	r_event_hook (anal->zign_spaces.event, R_SPACE_EVENT_RENAME, zign_rename_for, NULL);
 	anal->sdb_fcns = sdb_ns (anal->sdb, "fcns", 1);
 	anal->sdb_meta = sdb_ns (anal->sdb, "meta", 1);
-	anal->sdb_hints = sdb_ns (anal->sdb, "hints", 1);
 	anal->hint_cbs.on_bits = __anal_hint_on_bits;
 	anal->sdb_types = sdb_ns (anal->sdb, "types", 1);
 	anal->sdb_fmts = sdb_ns (anal->sdb, "spec", 1);
@@ -190,6 +189,7 @@ R_API RAnal *r_anal_new() {
 	(void)r_anal_xrefs_init (anal);
 	anal->diff_thbb = R_ANAL_THRESHOLDBB;
 	anal->diff_thfcn = R_ANAL_THRESHOLDFCN;
+	anal->diff_jobs = 1;
 	anal->syscall = r_syscall_new ();
 	r_io_bind_init (anal->iob);
 	r_flag_bind_init (anal->flb);
@@ -230,13 +230,16 @@ R_API RAnal *r_anal_free(RAnal *a) {
 	r_list_free (a->plugins);
 	a->fcns->free = r_anal_fcn_free;
 	r_list_free (a->fcns);
+	r_meta_free (a);
 	r_spaces_fini (&a->meta_spaces);
+	r_sign_index_invalidate (a);
 	r_spaces_fini (&a->zign_spaces);
 	r_anal_pin_fini (a);
 	r_list_free (a->refs);
 	r_syscall_free (a->syscall);
 	r_reg_free (a->reg);
 	r_anal_op_free (a->queued);
+	r_anal_hint_clear (a);
 	r_rbtree_free (a->rb_hints_ranges, __anal_hint_range_tree_free);
 	ht_up_free (a->dict_refs);
 	ht_up_free (a->dict_xrefs);
@@ -506,9 +509,11 @@ R_API bool r_anal_op_is_eob (RAnalOp *op) {
 R_API int r_anal_purge (RAnal *anal) {
 	sdb_reset (anal->sdb_fcns);
 	sdb_reset (anal->sdb_meta);
-	sdb_reset (anal->sdb_hints);
+	r_meta_free (anal);
+	r_anal_hint_clear (anal);
 	sdb_reset (anal->sdb_types);
 	sdb_reset (anal->sdb_zigns);
+	r_sign_index_invalidate (anal);
 	sdb_reset (anal->sdb_classes);
 	sdb_reset (anal->sdb_classes_attrs);
 	r_list_free (anal->fcns);
@@ -794,27 +799,48 @@ R_API int r_anal_range_tree_find_bits_at(RBNode *root, ut64 addr) {
 	return bits;
 }
 
+typedef struct {
+	RAnal *anal;
+	int range_bits;
+	RList *redundant;
+} HintRangesState;
+
+static bool merge_hint_range_cb(const RAnalHint *hint, void *user) {
+	HintRangesState *st = user;
+	if (!hint->bits) {
+		return true;
+	}
+	if (st->range_bits == hint->bits) {
+		// the same bits are already in effect from a previous hint
+		ut64 *addr = R_NEW (ut64);
+		if (addr) {
+			*addr = hint->addr;
+			r_list_append (st->redundant, addr);
+		}
+	} else {
+		RAnalRange *range = R_NEW0 (RAnalRange);
+		if (range) {
+			range->bits = hint->bits;
+			range->from = hint->addr;
+			__anal_range_hint_tree_insert (&st->anal->rb_hints_ranges, range);
+		}
+	}
+	st->range_bits = hint->bits;
+	return true;
+}
+
 R_API void r_anal_merge_hint_ranges(RAnal *a) {
 	if (a->merge_hints) {
-		SdbListIter *iter;
-		SdbKv *kv;
-		SdbList *sdb_range = sdb_foreach_list (a->sdb_hints, true);
-		int range_bits = 0;
+		RListIter *iter;
+		ut64 *addr;
+		HintRangesState st = { a, 0, r_list_newf (free) };
 		r_rbtree_free (a->rb_hints_ranges, __anal_hint_range_tree_free);
 		a->rb_hints_ranges = NULL;
-		ls_foreach (sdb_range, iter, kv) {
-			ut64 addr = sdb_atoi (sdbkv_key (kv) + 5);
-			int bits = r_anal_hint_get_bits_at (a, addr,  sdbkv_value (kv));
-			if (bits && range_bits == bits) {
-				r_anal_hint_unset_bits (a, addr);
-			} else {
-				RAnalRange *range = R_NEW0 (RAnalRange);
-				range->bits = bits;
-				range->from = addr;
-				__anal_range_hint_tree_insert (&a->rb_hints_ranges, range);
-			}
-			range_bits = bits;
+		r_anal_hint_foreach (a, merge_hint_range_cb, &st);
+		r_list_foreach (st.redundant, iter, addr) {
+			r_anal_hint_unset_bits (a, *addr);
 		}
+		r_list_free (st.redundant);
 		a->merge_hints = false;
 	}
 }
@@ -54,18 +54,19 @@ R_API int r_anal_diff_fingerprint_bb(RAnal *anal, RAnalBlock *bb) {
 	if (anal->cur && anal->cur->fingerprint_bb) {
 		return (anal->cur->fingerprint_bb (anal, bb));
 	}
+	free (bb->fingerprint);
 	if (!(bb->fingerprint = malloc (1 + bb->size))) {
 		return false;
 	}
 	if (!(buf = malloc (bb->size + 1))) {
-		free (bb->fingerprint);
+		R_FREE (bb->fingerprint);
 		return false;
 	}
 	if (anal->iob.read_at (anal->iob.io, bb->addr, buf, bb->size)) {
 		memcpy (bb->fingerprint, buf, bb->size);
 		if (anal->diff_ops) { // diff using only the opcode
 			if (!(op = r_anal_op_new ())) {
-				free (bb->fingerprint);
+				R_FREE (bb->fingerprint);
 				free (buf);
 				return false;
 			}
@@ -85,24 +86,39 @@ R_API int r_anal_diff_fingerprint_bb(RAnal *anal, RAnalBlock *bb) {
 	return bb->size;
 }
 
+// Fingerprint the basic blocks of a function and concatenate them. The
+// result is kept in the function until its blocks or bytes change.
 R_API int r_anal_diff_fingerprint_fcn(RAnal *anal, RAnalFunction *fcn) {
 	RAnalBlock *bb;
 	RListIter *iter;
 	int len = 0;
 
-	if (anal && anal->cur && anal->cur->fingerprint_fcn) {
+	r_return_val_if_fail (anal && fcn, 0);
+	if (anal->cur && anal->cur->fingerprint_fcn) {
 		return (anal->cur->fingerprint_fcn (anal, fcn));
 	}
-
-	fcn->fingerprint = NULL;
+	if (fcn->fingerprint && fcn->features.fpops == anal->diff_ops
+			&& r_anal_fcn_features_valid (anal, fcn, R_ANAL_FCN_FEAT_FINGERPRINT)) {
+		return fcn->features.fplen;
+	}
+	R_FREE (fcn->fingerprint);
 	r_list_foreach (fcn->bbs, iter, bb) {
+		r_anal_diff_fingerprint_bb (anal, bb);
+		if (!bb->fingerprint) {
+			continue;
+		}
 		len += bb->size;
-		fcn->fingerprint = realloc (fcn->fingerprint, len + 1);
-		if (!fcn->fingerprint) {
+		ut8 *fp = realloc (fcn->fingerprint, len + 1);
+		if (!fp) {
+			R_FREE (fcn->fingerprint);
 			return 0;
 		}
+		fcn->fingerprint = fp;
 		memcpy (fcn->fingerprint+len-bb->size, bb->fingerprint, bb->size);
 	}
+	fcn->features.fplen = len;
+	fcn->features.fpops = anal->diff_ops;
+	r_anal_fcn_features_set (anal, fcn, R_ANAL_FCN_FEAT_FINGERPRINT);
 	return len;
 }
 
@@ -155,8 +171,6 @@ R_API bool r_anal_diff_bb(RAnal *anal, RAnalFunction *fcn, RAnalFunction *fcn2)
 				fcn->diff->type = fcn2->diff->type = \
 					R_ANAL_DIFF_TYPE_UNMATCH;
 			}
-			R_FREE (mbb->fingerprint);
-			R_FREE (mbb2->fingerprint);
 			mbb->diff->addr = mbb2->addr;
 			mbb2->diff->addr = mbb->addr;
 			mbb->diff->size = mbb2->size;
@@ -170,11 +184,330 @@ R_API bool r_anal_diff_bb(RAnal *anal, RAnalFunction *fcn, RAnalFunction *fcn2)
 	return true;
 }
 
+/* Matching of the functions that do not share a name. Pairs are only
+ * compared with the exact (and quadratic) buffer distance when they could
+ * beat the best candidate found so far:
+ *  - the size threshold limits the candidates to a window of fcns2 sorted
+ *    by size
+ *  - minhash buckets over the basic block fingerprints propose the likely
+ *    matches first, so a good candidate is known early
+ *  - a byte histogram bounds the similarity of any other pair
+ * The result is the same as comparing every pair, the first best candidate
+ * in fcns2 order wins. */
+
+#define DIFF_MINHASH 16
+#define DIFF_BAND 2     // minhash values per lsh band
+
+typedef struct {
+	RAnalFunction *fcn;
+	int size;
+	bool ready;     // not matched yet and fingerprinted
+	bool hashed;    // has fingerprinted basic blocks
+	ut16 hist[256]; // byte counts, saturated counts keep the bound valid
+	ut32 minhash[DIFF_MINHASH];
+} DiffFcn;
+
+typedef struct diff_ctx_t {
+	RAnal *anal;
+	DiffFcn *a;
+	DiffFcn *b;     // fcns2, in list order
+	int nb;
+	ut64 *bysize;   // size << 32 | index of b, sorted
+	HtUP *lsh;      // minhash band -> RVector of indices of b
+	RThreadLock *lock;
+	int next;
+	int njobs;
+	int *todo;      // index in a of each job
+	int *best;      // index in b matched by each job, -1 if none
+	double *dist;
+	ut32 *seen;     // candidates already tried by the calling thread
+	void (*run)(struct diff_ctx_t *ctx, ut32 *seen, int job);
+} DiffCtx;
+
+typedef struct {
+	DiffCtx *ctx;
+	ut32 *seen;
+} DiffWorker;
+
+static inline ut32 diff_mix(ut32 h) {
+	h ^= h >> 16;
+	h *= 0x85ebca6b;
+	h ^= h >> 13;
+	h *= 0xc2b2ae35;
+	h ^= h >> 16;
+	return h;
+}
+
+static ut32 diff_hash(const ut8 *buf, int len) {
+	ut32 h = 0x811c9dc5;
+	int i;
+	for (i = 0; i < len; i++) {
+		h = (h ^ buf[i]) * 0x01000193;
+	}
+	return h;
+}
+
+static void diff_fcn_init(DiffFcn *df, RAnalFunction *fcn) {
+	RAnalBlock *bb;
+	RListIter *iter;
+	int i, k;
+	memset (df, 0, sizeof (DiffFcn));
+	df->fcn = fcn;
+	df->size = r_anal_fcn_size (fcn);
+	if (fcn->features.valid & R_ANAL_FCN_FEAT_FINGERPRINT) {
+		df->size = R_MIN (df->size, fcn->features.fplen);
+	}
+	df->ready = fcn->fingerprint && fcn->diff->type == R_ANAL_DIFF_TYPE_NULL;
+	if (!df->ready) {
+		return;
+	}
+	for (i = 0; i < df->size; i++) {
+		ut16 *h = &df->hist[fcn->fingerprint[i]];
+		if (*h < UT16_MAX) {
+			(*h)++;
+		}
+	}
+	memset (df->minhash, 0xff, sizeof (df->minhash));
+	r_list_foreach (fcn->bbs, iter, bb) {
+		if (!bb->fingerprint || bb->size < 1) {
+			continue;
+		}
+		ut32 h = diff_hash (bb->fingerprint, bb->size);
+		for (k = 0; k < DIFF_MINHASH; k++) {
+			ut32 v = diff_mix (h ^ (k * 0x9e3779b9));
+			if (v < df->minhash[k]) {
+				df->minhash[k] = v;
+			}
+		}
+		df->hashed = true;
+	}
+}
+
+static inline ut64 diff_band_key(const DiffFcn *df, int band) {
+	const ut32 *mh = df->minhash + band * DIFF_BAND;
+	return ((ut64)band << 32) | diff_mix (mh[0] ^ diff_mix (mh[1]));
+}
+
+static void diff_bucket_free(HtUPKv *kv) {
+	r_vector_free (kv->value);
+}
+
+static bool diff_lsh_add(HtUP *ht, ut64 key, int j) {
+	RVector *v = ht_up_find (ht, key, NULL);
+	if (!v) {
+		v = r_vector_new (sizeof (int), NULL, NULL);
+		if (!v || !ht_up_insert (ht, key, v)) {
+			r_vector_free (v);
+			return false;
+		}
+	}
+	return r_vector_push (v, &j);
+}
+
+static int diff_size_cmp(const void *x, const void *y) {
+	ut64 a = *(const ut64 *)x, b = *(const ut64 *)y;
+	return a < b? -1: a > b;
+}
+
+static inline bool diff_size_ok(RAnal *anal, int size, int size2) {
+	ut64 maxsize = R_MAX (size, size2);
+	ut64 minsize = R_MIN (size, size2);
+	return !(maxsize * anal->diff_thfcn > minsize);
+}
+
+static inline bool diff_free(const DiffFcn *df) {
+	RAnalFunction *fcn = df->fcn;
+	return df->ready && fcn->diff->type == R_ANAL_DIFF_TYPE_NULL
+		&& (fcn->type == R_ANAL_FCN_TYPE_FCN || fcn->type == R_ANAL_FCN_TYPE_SYM);
+}
+
+// highest similarity the buffer distance can report for this pair
+static double diff_bound(const DiffFcn *a, const DiffFcn *b) {
+	ut32 more = 0, less = 0;
+	int i;
+	for (i = 0; i < 256; i++) {
+		if (a->hist[i] > b->hist[i]) {
+			more += a->hist[i] - b->hist[i];
+		} else {
+			less += b->hist[i] - a->hist[i];
+		}
+	}
+	// each edit fixes at most one missing and one extra byte
+	ut32 length = R_MAX (a->size, b->size);
+	return length? 1.0 - (double)R_MAX (more, less) / length: 1.0;
+}
+
+typedef struct {
+	int j;
+	double t;
+} DiffBest;
+
+static void diff_try(DiffCtx *ctx, const DiffFcn *a, int j, DiffBest *best) {
+	const DiffFcn *b = &ctx->b[j];
+	double t = 0;
+	if (!r_diff_buffers_distance (NULL, a->fcn->fingerprint, a->size,
+			b->fcn->fingerprint, b->size, NULL, &t)) {
+		return;
+	}
+	if (t > best->t || (best->j >= 0 && t == best->t && j < best->j)) {
+		best->t = t;
+		best->j = j;
+	}
+}
+
+static void diff_consider(DiffCtx *ctx, const DiffFcn *a, int j, DiffBest *best) {
+	const DiffFcn *b = &ctx->b[j];
+	if (!diff_free (b) || !diff_size_ok (ctx->anal, a->size, b->size)) {
+		return;
+	}
+	double ub = diff_bound (a, b);
+	if (ub < best->t || (ub == best->t && (best->j < 0 || j > best->j))) {
+		return;
+	}
+	diff_try (ctx, a, j, best);
+}
+
+static int diff_best(DiffCtx *ctx, ut32 *seen, ut32 stamp, const DiffFcn *a, double *dist) {
+	RAnal *anal = ctx->anal;
+	DiffBest best = { -1, anal->diff_thfcn };
+	int k, band;
+	if (a->hashed) {
+		for (band = 0; band < DIFF_MINHASH / DIFF_BAND; band++) {
+			RVector *v = ht_up_find (ctx->lsh, diff_band_key (a, band), NULL);
+			int *j;
+			if (!v) {
+				continue;
+			}
+			r_vector_foreach (v, j) {
+				if (seen[*j] != stamp) {
+					seen[*j] = stamp;
+					diff_consider (ctx, a, *j, &best);
+				}
+			}
+		}
+	}
+	// the window of fcns2 that passes the size threshold
+	ut64 from = (ut64)(a->size * anal->diff_thfcn);
+	int lo = 0, hi = ctx->nb;
+	while (lo < hi) {
+		int mid = (lo + hi) / 2;
+		if ((ctx->bysize[mid] >> 32) + 1 < from) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+	for (k = lo; k < ctx->nb; k++) {
+		int j = (int)(ctx->bysize[k] & UT32_MAX);
+		const DiffFcn *b = &ctx->b[j];
+		if (b->size > a->size && !diff_size_ok (anal, a->size, b->size)) {
+			break;
+		}
+		if (seen[j] != stamp) {
+			diff_consider (ctx, a, j, &best);
+		}
+	}
+	*dist = best.t;
+	return best.j;
+}
+
+static void diff_name_job(DiffCtx *ctx, ut32 *seen, int job) {
+	const DiffFcn *a = &ctx->a[ctx->todo[job]];
+	const DiffFcn *b = &ctx->b[ctx->best[job]];
+	double t = 0;
+	r_diff_buffers_distance (NULL, a->fcn->fingerprint, a->size,
+		b->fcn->fingerprint, b->size, NULL, &t);
+	ctx->dist[job] = t;
+}
+
+static void diff_best_job(DiffCtx *ctx, ut32 *seen, int job) {
+	ctx->best[job] = diff_best (ctx, seen, job + 1, &ctx->a[ctx->todo[job]], &ctx->dist[job]);
+}
+
+static RThreadFunctionRet diff_worker_th(RThread *th) {
+	DiffWorker *w = th->user;
+	DiffCtx *ctx = w->ctx;
+	for (;;) {
+		r_th_lock_enter (ctx->lock);
+		int job = ctx->next++;
+		r_th_lock_leave (ctx->lock);
+		if (job >= ctx->njobs) {
+			break;
+		}
+		ctx->run (ctx, w->seen, job);
+	}
+	return R_TH_STOP;
+}
+
+// run the jobs on anal->diff_jobs threads
+static void diff_run(DiffCtx *ctx, int njobs, void (*run)(DiffCtx *, ut32 *, int)) {
+	int i, nth = R_MIN (ctx->anal->diff_jobs, njobs);
+	ctx->next = 0;
+	ctx->njobs = njobs;
+	ctx->run = run;
+	DiffWorker *ws = nth > 1? R_NEWS0 (DiffWorker, nth): NULL;
+	RThread **ths = ws? R_NEWS0 (RThread *, nth): NULL;
+	if (ths && (ctx->lock || (ctx->lock = r_th_lock_new (false)))) {
+		for (i = 0; i < nth; i++) {
+			ws[i].ctx = ctx;
+			ws[i].seen = i? R_NEWS0 (ut32, ctx->nb + 1): ctx->seen;
+			if (ws[i].seen) {
+				ths[i] = r_th_new (diff_worker_th, &ws[i], 0);
+			}
+		}
+		for (i = 0; i < nth; i++) {
+			if (ths[i]) {
+				r_th_wait (ths[i]);
+				r_th_free (ths[i]);
+			}
+			if (i) {
+				free (ws[i].seen);
+			}
+		}
+	}
+	free (ths);
+	free (ws);
+	// whatever the threads could not take
+	for (i = ctx->next; i < njobs; i++) {
+		run (ctx, ctx->seen, i);
+	}
+}
+
+static void diff_set_match(RAnal *anal, RAnalFunction *fcn, RAnalFunction *fcn2, int type, double dist) {
+	fcn->diff->type = fcn2->diff->type = type;
+	fcn->diff->dist = fcn2->diff->dist = dist;
+	fcn->diff->addr = fcn2->addr;
+	fcn2->diff->addr = fcn->addr;
+	fcn->diff->size = r_anal_fcn_size (fcn2);
+	fcn2->diff->size = r_anal_fcn_size (fcn);
+	R_FREE (fcn->diff->name);
+	if (fcn2->name) {
+		fcn->diff->name = strdup (fcn2->name);
+	}
+	R_FREE (fcn2->diff->name);
+	if (fcn->name) {
+		fcn2->diff->name = strdup (fcn->name);
+	}
+	r_anal_diff_bb (anal, fcn, fcn2);
+}
+
+static void diff_ctx_fini(DiffCtx *ctx) {
+	free (ctx->a);
+	free (ctx->b);
+	free (ctx->bysize);
+	ht_up_free (ctx->lsh);
+	r_th_lock_free (ctx->lock);
+	free (ctx->todo);
+	free (ctx->best);
+	free (ctx->dist);
+	free (ctx->seen);
+}
+
 R_API int r_anal_diff_fcn(RAnal *anal, RList *fcns, RList *fcns2) {
-	RAnalFunction *fcn, *fcn2, *mfcn, *mfcn2;
-	RListIter *iter, *iter2;
-	ut64 maxsize, minsize;
-	double t, ot;
+	RAnalFunction *fcn;
+	RListIter *iter;
+	DiffCtx ctx = { anal };
+	int i, j, na, n;
 
 	if (!anal) {
 		return false;
@@ -182,109 +515,114 @@ R_API int r_anal_diff_fcn(RAnal *anal, RList *fcns, RList *fcns2) {
 	if (anal->cur && anal->cur->diff_fcn) {
 		return (anal->cur->diff_fcn (anal, fcns, fcns2));
 	}
-	/* Compare functions with the same name */
-	if (fcns) {
-		r_list_foreach (fcns, iter, fcn) {
-			r_list_foreach (fcns2, iter2, fcn2) {
-				if (fcn->name && fcn2->name && strcmp (fcn->name, fcn2->name)) {
-					continue;
-				}
-				r_diff_buffers_distance (NULL, fcn->fingerprint, r_anal_fcn_size (fcn),
-						fcn2->fingerprint, r_anal_fcn_size (fcn2),
-						NULL, &t);
-				/* Set flag in matched functions */
-				fcn->diff->type = fcn2->diff->type = (t >= 1)
-					? R_ANAL_DIFF_TYPE_MATCH
-					: R_ANAL_DIFF_TYPE_UNMATCH;
-				fcn->diff->dist = fcn2->diff->dist = t;
-				R_FREE (fcn->fingerprint);
-				R_FREE (fcn2->fingerprint);
-				fcn->diff->addr = fcn2->addr;
-				fcn2->diff->addr = fcn->addr;
-				fcn->diff->size = r_anal_fcn_size (fcn2);
-				fcn2->diff->size = r_anal_fcn_size (fcn);
-				R_FREE (fcn->diff->name);
-				if (fcn2->name) {
-					fcn->diff->name = strdup (fcn2->name);
-				}
-				R_FREE (fcn2->diff->name);
-				if (fcn->name) {
-					fcn2->diff->name = strdup (fcn->name);
-				}
-				r_anal_diff_bb (anal, fcn, fcn2);
-				break;
+	// nothing to match against
+	if (!fcns || r_list_empty (fcns2)) {
+		return true;
+	}
+	na = r_list_length (fcns);
+	ctx.nb = r_list_length (fcns2);
+	ctx.a = R_NEWS0 (DiffFcn, na + 1);
+	ctx.b = R_NEWS0 (DiffFcn, ctx.nb + 1);
+	ctx.bysize = R_NEWS0 (ut64, ctx.nb + 1);
+	ctx.todo = R_NEWS0 (int, na + 1);
+	ctx.best = R_NEWS0 (int, na + 1);
+	ctx.dist = R_NEWS0 (double, na + 1);
+	ctx.seen = R_NEWS0 (ut32, ctx.nb + 1);
+	ctx.lsh = ht_up_new (NULL, diff_bucket_free, NULL);
+	HtPP *names = ht_pp_new0 ();
+	if (!ctx.a || !ctx.b || !ctx.bysize || !ctx.todo || !ctx.best
+			|| !ctx.dist || !ctx.seen || !ctx.lsh || !names) {
+		ht_pp_free (names);
+		diff_ctx_fini (&ctx);
+		return false;
+	}
+
+	/* Compare functions with the same name, or the first one if any of
+	 * both names is missing */
+	int first_noname = -1;
+	j = 0;
+	r_list_foreach (fcns2, iter, fcn) {
+		ctx.b[j].fcn = fcn;
+		if (!fcn->name) {
+			if (first_noname < 0) {
+				first_noname = j;
 			}
+		} else if (!ht_pp_find (names, fcn->name, NULL)) {
+			ht_pp_insert (names, fcn->name, (void *)(size_t)(j + 1));
 		}
+		j++;
 	}
-	/* Compare remaining functions */
+	n = 0;
+	i = 0;
 	r_list_foreach (fcns, iter, fcn) {
-/*
-		if ((fcn->type != R_ANAL_FCN_TYPE_FCN &&
-			fcn->type != R_ANAL_FCN_TYPE_SYM) ||
-			fcn->diff->type != R_ANAL_DIFF_TYPE_NULL) {
-			continue;
+		int k = -1;
+		if (!fcn->name) {
+			k = 0;
+		} else {
+			k = (int)(size_t)ht_pp_find (names, fcn->name, NULL) - 1;
+			if (first_noname >= 0 && (k < 0 || first_noname < k)) {
+				k = first_noname;
+			}
 		}
-*/
-		if (fcn->diff->type != R_ANAL_DIFF_TYPE_NULL) {
-			continue;
+		ctx.a[i].fcn = fcn;
+		ctx.a[i].size = r_anal_fcn_size (fcn);
+		if (k >= 0) {
+			ctx.b[k].size = r_anal_fcn_size (ctx.b[k].fcn);
+			ctx.todo[n] = i;
+			ctx.best[n] = k;
+			n++;
 		}
-		ot = 0;
-		mfcn = mfcn2 = NULL;
-		r_list_foreach (fcns2, iter2, fcn2) {
-			int fcn_size = r_anal_fcn_size (fcn);
-			int fcn2_size = r_anal_fcn_size (fcn2);
-			if (fcn_size > fcn2_size) {
-				maxsize = fcn_size;
-				minsize = fcn2_size;
-			} else {
-				maxsize = fcn2_size;
-				minsize = fcn_size;
-			}
-			if (maxsize * anal->diff_thfcn > minsize) {
-				eprintf ("Exceeded anal threshold while diffing %s and %s\n", fcn->name, fcn2->name);
-				continue;
-			}
-			if (fcn2->diff->type != R_ANAL_DIFF_TYPE_NULL) {
-				eprintf ("Function %s already diffed\n", fcn2->name);
-				continue;
-			}
-			if ((fcn2->type != R_ANAL_FCN_TYPE_FCN && fcn2->type != R_ANAL_FCN_TYPE_SYM)) {
-				eprintf ("Function %s type not supported\n", fcn2->name);
-				continue;
-			}
-			r_diff_buffers_distance (NULL, fcn->fingerprint, fcn_size, fcn2->fingerprint, fcn2_size, NULL, &t);
-			fcn->diff->dist = fcn2->diff->dist = t;
-			if (t > anal->diff_thfcn && t > ot) {
-				ot = t;
-				mfcn = fcn;
-				mfcn2 = fcn2;
-				if (t == 1) {
-					break;
-				}
+		i++;
+	}
+	ht_pp_free (names);
+	diff_run (&ctx, n, diff_name_job);
+	for (i = 0; i < n; i++) {
+		RAnalFunction *fcn2 = ctx.b[ctx.best[i]].fcn;
+		double t = ctx.dist[i];
+		/* Set flag in matched functions */
+		diff_set_match (anal, ctx.a[ctx.todo[i]].fcn, fcn2,
+			(t >= 1)? R_ANAL_DIFF_TYPE_MATCH: R_ANAL_DIFF_TYPE_UNMATCH, t);
+	}
+
+	/* Compare remaining functions */
+	for (j = 0; j < ctx.nb; j++) {
+		DiffFcn *b = &ctx.b[j];
+		diff_fcn_init (b, b->fcn);
+		ctx.bysize[j] = ((ut64)R_MAX (b->size, 0) << 32) | j;
+		if (b->hashed && diff_free (b)) {
+			int band;
+			for (band = 0; band < DIFF_MINHASH / DIFF_BAND; band++) {
+				diff_lsh_add (ctx.lsh, diff_band_key (b, band), j);
 			}
 		}
-		if (mfcn && mfcn2) {
+	}
+	qsort (ctx.bysize, ctx.nb, sizeof (ut64), diff_size_cmp);
+	n = 0;
+	for (i = 0; i < na; i++) {
+		diff_fcn_init (&ctx.a[i], ctx.a[i].fcn);
+		if (ctx.a[i].ready) {
+			ctx.todo[n++] = i;
+		}
+	}
+	diff_run (&ctx, n, diff_best_job);
+	for (i = 0; i < n; i++) {
+		const DiffFcn *a = &ctx.a[ctx.todo[i]];
+		double t = ctx.dist[i];
+		if (a->fcn->diff->type != R_ANAL_DIFF_TYPE_NULL) {
+			continue;
+		}
+		j = ctx.best[i];
+		if (j >= 0 && !diff_free (&ctx.b[j])) {
+			// taken by a previous function, look again among the rest
+			j = diff_best (&ctx, ctx.seen, n + 1 + i, a, &t);
+		}
+		if (j >= 0) {
 			/* Set flag in matched functions */
-			mfcn->diff->type = mfcn2->diff->type = (ot == 1)
-				? R_ANAL_DIFF_TYPE_MATCH
-				: R_ANAL_DIFF_TYPE_UNMATCH;
-			R_FREE (mfcn->fingerprint);
-			R_FREE (mfcn2->fingerprint);
-			mfcn->diff->addr = mfcn2->addr;
-			mfcn2->diff->addr = mfcn->addr;
-			mfcn->diff->size = r_anal_fcn_size (mfcn2);
-			mfcn2->diff->size = r_anal_fcn_size (mfcn);
-			R_FREE (mfcn->diff->name);
-			if (mfcn2->name) {
-				mfcn->diff->name = strdup (mfcn2->name);
-			}
-			R_FREE (mfcn2->diff->name);
-			if (mfcn->name) {
-				mfcn2->diff->name = strdup (mfcn->name);
-			}
-			r_anal_diff_bb (anal, mfcn, mfcn2);
+			diff_set_match (anal, a->fcn, ctx.b[j].fcn,
+				(t == 1)? R_ANAL_DIFF_TYPE_MATCH: R_ANAL_DIFF_TYPE_UNMATCH, t);
 		}
 	}
+	diff_ctx_fini (&ctx);
 	return true;
 }
 
@@ -67,15 +67,54 @@ static bool isregornum(RAnalEsil *esil, const char *str, ut64 *num) {
 	return true;
 }
 
-/* pop Register or Number */
-static bool popRN(RAnalEsil *esil, ut64 *n) {
-	char *str = r_anal_esil_pop (esil);
-	if (str) {
-		bool ret = isregornum (esil, str, n);
-		free (str);
-		return ret;
+/* expressions cached by esil.compile */
+#define ESIL_COMPILED_MAX 4096
+
+enum {
+	ESIL_WORD_PUSH,
+	ESIL_WORD_OP,
+	ESIL_WORD_IF,
+	ESIL_WORD_ELSE,
+	ESIL_WORD_ENDIF,
+};
+
+typedef struct {
+	int kind;
+	RAnalEsilOp op;
+	const char *str; // word text, NUL-terminated inside EsilProgram.text
+	const char *rest; // expression text after this word, for TODO traces
+	RAnalEsilValue value; // prebuilt stack slot for ESIL_WORD_PUSH
+} EsilWord;
+
+typedef struct {
+	char *src;
+	char *text;
+	EsilWord *words;
+	int count; // 0 when the expression must go through the interpreter
+	int refs; // the cache may be flushed by a nested parse while running
+} EsilProgram;
+
+static void esil_program_unref(EsilProgram *p) {
+	int i;
+	if (p && --p->refs < 1) {
+		for (i = 0; i < p->count; i++) {
+			free (p->words[i].value.str);
+		}
+		free (p->words);
+		free (p->text);
+		free (p->src);
+		free (p);
 	}
-	return false;
+}
+
+static void esil_program_kv_free(HtPPKv *kv) {
+	free (kv->key);
+	esil_program_unref (kv->value);
+}
+
+static void esil_compiled_flush(RAnalEsil *esil) {
+	ht_pp_free (esil->compiled);
+	esil->compiled = NULL;
 }
 
 /* R_ANAL_ESIL API */
@@ -89,7 +128,7 @@ R_API RAnalEsil *r_anal_esil_new(int stacksize, int iotrap, unsigned int addrsiz
 		free (esil);
 		return NULL;
 	}
-	if (!(esil->stack = calloc (sizeof (char *), stacksize))) {
+	if (!(esil->stack = calloc (sizeof (RAnalEsilValue), stacksize))) {
 		free (esil);
 		return NULL;
 	}
@@ -112,6 +151,8 @@ R_API int r_anal_esil_set_op(RAnalEsil *esil, const char *op, RAnalEsilOp code)
 	}
 	char *h = sdb_itoa (sdb_hash (op), t, 16);
 	sdb_num_set (esil->ops, h, (ut64)(size_t)code, 0);
+	// compiled words hold resolved op pointers
+	esil_compiled_flush (esil);
 	if (!sdb_num_exists (esil->ops, h)) {
 		eprintf ("can't set esil-op %s\n", op);
 		return false;
@@ -151,6 +192,7 @@ R_API bool r_anal_esil_set_pc(RAnalEsil *esil, ut64 addr) {
 }
 
 R_API void r_anal_esil_free(RAnalEsil *esil) {
+	int i;
 	if (!esil) {
 		return;
 	}
@@ -159,6 +201,7 @@ R_API void r_anal_esil_free(RAnalEsil *esil) {
 	}
 	sdb_free (esil->ops);
 	esil->ops = NULL;
+	esil_compiled_flush (esil);
 	r_anal_esil_interrupts_fini (esil);
 	r_anal_esil_sources_fini (esil);
 	sdb_free (esil->stats);
@@ -166,6 +209,9 @@ R_API void r_anal_esil_free(RAnalEsil *esil) {
 	sdb_free (esil->db_trace);
 	esil->db_trace = NULL;
 	r_anal_esil_stack_free (esil);
+	for (i = 0; i < esil->stacksize; i++) {
+		free (esil->stack[i].str);
+	}
 	free (esil->stack);
 	if (esil->anal && esil->anal->cur && esil->anal->cur->esil_fini) {
 		esil->anal->cur->esil_fini (esil);
@@ -432,54 +478,180 @@ static bool esil_internal_overflow_check(RAnalEsil *esil) {
 	return (esil_internal_carry_check (esil, esil->lastsz - 1) ^ esil_internal_carry_check (esil, esil->lastsz - 2));
 }
 
+/* classify a token without looking at the register profile */
+static int esil_token_type(const char *str) {
+	int i;
+	if (str[0] == ESIL_INTERNAL_PREFIX && str[1]) {
+		return R_ANAL_ESIL_PARM_INTERNAL;
+	}
+	if (!strncmp (str, "0x", 2)) {
+		return R_ANAL_ESIL_PARM_NUM;
+	}
+	if (!((IS_DIGIT (str[0])) || str[0] == '-')) {
+		return R_ANAL_ESIL_PARM_INVALID;
+	}
+	for (i = 1; str[i]; i++) {
+		if (!(IS_DIGIT (str[i]))) {
+			return R_ANAL_ESIL_PARM_INVALID;
+		}
+	}
+	return R_ANAL_ESIL_PARM_NUM;
+}
+
+static bool esil_value_set(RAnalEsilValue *v, const char *str) {
+	size_t len = strlen (str);
+	if (len < sizeof (v->buf)) {
+		R_FREE (v->str);
+		memcpy (v->buf, str, len + 1);
+		return true;
+	}
+	char *s = strdup (str);
+	if (!s) {
+		return false;
+	}
+	free (v->str);
+	v->str = s;
+	*v->buf = 0;
+	return true;
+}
+
+static bool esil_value_parse(RAnalEsilValue *v, const char *str) {
+	if (!esil_value_set (v, str)) {
+		return false;
+	}
+	// registers are resolved lazily by esil_value_type, most names are only written to
+	v->type = esil_token_type (str);
+	v->num = (v->type == R_ANAL_ESIL_PARM_NUM)? r_num_get (NULL, str): 0;
+	return true;
+}
+
+/* numbers pushed with pushnum are only formatted when someone asks for the text */
+static const char *esil_value_str(RAnalEsilValue *v) {
+	if (v->str) {
+		return v->str;
+	}
+	if (!*v->buf && v->type == R_ANAL_ESIL_PARM_NUM) {
+		snprintf (v->buf, sizeof (v->buf), "0x%" PFMT64x, v->num);
+	}
+	return v->buf;
+}
+
+static bool esil_push_value(RAnalEsil *esil, RAnalEsilValue *v) {
+	if (esil->stackptr > (esil->stacksize - 1)) {
+		return false;
+	}
+	RAnalEsilValue *slot = &esil->stack[esil->stackptr];
+	if (slot != v) {
+		if (v->str) {
+			if (!esil_value_set (slot, v->str)) {
+				return false;
+			}
+		} else {
+			R_FREE (slot->str);
+			memcpy (slot->buf, v->buf, sizeof (slot->buf));
+		}
+		slot->type = v->type;
+		slot->num = v->num;
+	}
+	esil->stackptr++;
+	return true;
+}
+
+/* the returned slot is owned by the stack and stays valid until the next push */
+static RAnalEsilValue *esil_pop_value(RAnalEsil *esil) {
+	if (esil->stackptr < 1) {
+		return NULL;
+	}
+	return &esil->stack[--esil->stackptr];
+}
+
+static int esil_value_type(RAnalEsil *esil, RAnalEsilValue *v) {
+	if (v->type == R_ANAL_ESIL_PARM_INVALID) {
+		v->type = r_anal_esil_get_parm_type (esil, esil_value_str (v));
+	}
+	return v->type;
+}
+
+static bool esil_value_get_size(RAnalEsil *esil, RAnalEsilValue *v, ut64 *num, int *size) {
+	switch (esil_value_type (esil, v)) {
+	case R_ANAL_ESIL_PARM_NUM:
+		*num = v->num;
+		if (size) {
+			*size = esil->anal->bits;
+		}
+		return true;
+	case R_ANAL_ESIL_PARM_REG:
+		return r_anal_esil_reg_read (esil, esil_value_str (v), num, size);
+	default:
+		break;
+	}
+	return r_anal_esil_get_parm_size (esil, esil_value_str (v), num, size);
+}
+
+static bool esil_value_get(RAnalEsil *esil, RAnalEsilValue *v, ut64 *num) {
+	return esil_value_get_size (esil, v, num, NULL);
+}
+
+static bool esil_value_isregornum(RAnalEsil *esil, RAnalEsilValue *v, ut64 *num) {
+	if (v->type == R_ANAL_ESIL_PARM_NUM) {
+		*num = v->num;
+		return true;
+	}
+	return isregornum (esil, esil_value_str (v), num);
+}
+
+/* pop Register or Number */
+static bool popRN(RAnalEsil *esil, ut64 *n) {
+	RAnalEsilValue *v = esil_pop_value (esil);
+	return v && esil_value_isregornum (esil, v, n);
+}
+
 R_API int r_anal_esil_pushnum(RAnalEsil *esil, ut64 num) {
-	char str[64];
-	snprintf (str, sizeof (str) - 1, "0x%" PFMT64x, num);
-	return r_anal_esil_push (esil, str);
+	if (!esil || esil->stackptr > (esil->stacksize - 1)) {
+		return false;
+	}
+	RAnalEsilValue *v = &esil->stack[esil->stackptr++];
+	R_FREE (v->str);
+	*v->buf = 0;
+	v->type = R_ANAL_ESIL_PARM_NUM;
+	v->num = num;
+	return true;
 }
 
 R_API bool r_anal_esil_push(RAnalEsil *esil, const char *str) {
 	if (!str || !esil || !*str || esil->stackptr > (esil->stacksize - 1)) {
 		return false;
 	}
-	esil->stack[esil->stackptr++] = strdup (str);
+	if (!esil_value_parse (&esil->stack[esil->stackptr], str)) {
+		return false;
+	}
+	esil->stackptr++;
 	return true;
 }
 
 R_API char *r_anal_esil_pop(RAnalEsil *esil) {
 	r_return_val_if_fail (esil, NULL);
-	if (esil->stackptr < 1) {
+	RAnalEsilValue *v = esil_pop_value (esil);
+	if (!v) {
 		return NULL;
 	}
-	return esil->stack[--esil->stackptr];
+	if (v->str) {
+		char *str = v->str;
+		v->str = NULL;
+		return str;
+	}
+	return strdup (esil_value_str (v));
 }
 
 R_API int r_anal_esil_get_parm_type(RAnalEsil *esil, const char *str) {
-	int len, i;
-
-	if (!str || !(len = strlen (str))) {
+	if (!str || !*str) {
 		return R_ANAL_ESIL_PARM_INVALID;
 	}
-	if (str[0] == ESIL_INTERNAL_PREFIX && str[1]) {
-		return R_ANAL_ESIL_PARM_INTERNAL;
-	}
-	if (!strncmp (str, "0x", 2)) {
-		return R_ANAL_ESIL_PARM_NUM;
-	}
-	if (!((IS_DIGIT(str[0])) || str[0] == '-')) {
-		goto not_a_number;
-	}
-	for (i = 1; i < len; i++) {
-		if (!(IS_DIGIT (str[i]))) {
-			goto not_a_number;
-		}
-	}
-	return R_ANAL_ESIL_PARM_NUM;
-not_a_number:
-	if (r_reg_get (esil->anal->reg, str, -1)) {
+	int type = esil_token_type (str);
+	if (type == R_ANAL_ESIL_PARM_INVALID && r_reg_get (esil->anal->reg, str, -1)) {
 		return R_ANAL_ESIL_PARM_REG;
 	}
-	return R_ANAL_ESIL_PARM_INVALID;
+	return type;
 }
 
 static int esil_internal_read(RAnalEsil *esil, const char *str, ut64 *num) {
@@ -684,25 +856,24 @@ R_API int r_anal_esil_reg_read(RAnalEsil *esil, const char *regname, ut64 *num,
 static int esil_eq(RAnalEsil *esil) {
 	int ret = 0;
 	ut64 num, num2;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if (ispackedreg (esil, dst)) {
-		char *src2 = r_anal_esil_pop (esil);
-		char *newreg = r_str_newf ("%sl", dst);
-		if (r_anal_esil_get_parm (esil, src2, &num2)) {
+	RAnalEsilValue *dst = esil_pop_value (esil);
+	RAnalEsilValue *src = esil_pop_value (esil);
+	if (dst && ispackedreg (esil, esil_value_str (dst))) {
+		RAnalEsilValue *src2 = esil_pop_value (esil);
+		char *newreg = r_str_newf ("%sl", esil_value_str (dst));
+		if (src2 && esil_value_get (esil, src2, &num2)) {
 			ret = r_anal_esil_reg_write (esil, newreg, num2);
 		}
 		free (newreg);
-		free (src2);
 	}
 
-	if (src && dst && r_anal_esil_reg_read_nocallback (esil, dst, &num, NULL)) {
-		if (r_anal_esil_get_parm (esil, src, &num2)) {
-			ret = r_anal_esil_reg_write (esil, dst, num2);
-			if (ret && r_anal_esil_get_parm_type (esil, src) != R_ANAL_ESIL_PARM_INTERNAL) { //necessary for some flag-things
+	if (src && dst && r_anal_esil_reg_read_nocallback (esil, esil_value_str (dst), &num, NULL)) {
+		if (esil_value_get (esil, src, &num2)) {
+			ret = r_anal_esil_reg_write (esil, esil_value_str (dst), num2);
+			if (ret && src->type != R_ANAL_ESIL_PARM_INTERNAL) { //necessary for some flag-things
 				esil->cur = num2;
 				esil->old = num;
-				esil->lastsz = esil_internal_sizeof_reg (esil, dst);
+				esil->lastsz = esil_internal_sizeof_reg (esil, esil_value_str (dst));
 			}
 		} else {
 			ERR ("esil_eq: invalid src");
@@ -710,46 +881,42 @@ static int esil_eq(RAnalEsil *esil) {
 	} else {
 		ERR ("esil_eq: invalid parameters");
 	}
-	free (src);
-	free (dst);
 	return ret;
 }
 
 static int esil_neg(RAnalEsil *esil) {
 	int ret = 0;
 	ut64 num;
-	char *src = r_anal_esil_pop (esil);
+	RAnalEsilValue *src = esil_pop_value (esil);
 	if (src) {
-		if (r_anal_esil_get_parm (esil, src, &num)) {
+		if (esil_value_get (esil, src, &num)) {
 			r_anal_esil_pushnum (esil, !num);
 			ret = 1;
 		} else {
-			if (isregornum (esil, src, &num)) {
+			if (esil_value_isregornum (esil, src, &num)) {
 				ret = 1;
 				r_anal_esil_pushnum (esil, !num);
 			} else {
-				eprintf ("0x%08"PFMT64x" esil_neg: unknown reg %s\n", esil->address, src);
+				eprintf ("0x%08"PFMT64x" esil_neg: unknown reg %s\n", esil->address, esil_value_str (src));
 			}
 		}
 	} else {
 		ERR ("esil_neg: empty stack");
 	}
-	free (src);
 	return ret;
 }
 
 static int esil_negeq(RAnalEsil *esil) {
 	int ret = 0;
 	ut64 num;
-	char *src = r_anal_esil_pop (esil);
-	if (src && r_anal_esil_reg_read (esil, src, &num, NULL)) {
+	RAnalEsilValue *src = esil_pop_value (esil);
+	if (src && r_anal_esil_reg_read (esil, esil_value_str (src), &num, NULL)) {
 		num = !num;
-		r_anal_esil_reg_write (esil, src, num);
+		r_anal_esil_reg_write (esil, esil_value_str (src), num);
 		ret = 1;
 	} else {
 		ERR ("esil_negeq: empty stack");
 	}
-	free (src);
 	//r_anal_esil_pushnum (esil, ret);
 	return ret;
 }
@@ -761,69 +928,63 @@ static int esil_nop(RAnalEsil *esil) {
 static int esil_andeq(RAnalEsil *esil) {
 	int ret = 0;
 	ut64 num, num2;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if (dst && r_anal_esil_reg_read (esil, dst, &num, NULL)) {
-		if (src && r_anal_esil_get_parm (esil, src, &num2)) {
-			if (r_anal_esil_get_parm_type (esil, src) != R_ANAL_ESIL_PARM_INTERNAL) {
+	RAnalEsilValue *dst = esil_pop_value (esil);
+	RAnalEsilValue *src = esil_pop_value (esil);
+	if (dst && r_anal_esil_reg_read (esil, esil_value_str (dst), &num, NULL)) {
+		if (src && esil_value_get (esil, src, &num2)) {
+			if (src->type != R_ANAL_ESIL_PARM_INTERNAL) {
 				esil->old = num;
 				esil->cur = num & num2;
-				esil->lastsz = esil_internal_sizeof_reg (esil, dst);
+				esil->lastsz = esil_internal_sizeof_reg (esil, esil_value_str (dst));
 			}
-			r_anal_esil_reg_write (esil, dst, num & num2);
+			r_anal_esil_reg_write (esil, esil_value_str (dst), num & num2);
 			ret = 1;
 		} else {
 			ERR ("esil_andeq: empty stack");
 		}
 	}
-	free (src);
-	free (dst);
 	return ret;
 }
 
 static int esil_oreq(RAnalEsil *esil) {
 	int ret = 0;
 	ut64 num, num2;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if (dst && r_anal_esil_reg_read (esil, dst, &num, NULL)) {
-		if (src && r_anal_esil_get_parm (esil, src, &num2)) {
-			if (r_anal_esil_get_parm_type (esil, src) != R_ANAL_ESIL_PARM_INTERNAL) {
+	RAnalEsilValue *dst = esil_pop_value (esil);
+	RAnalEsilValue *src = esil_pop_value (esil);
+	if (dst && r_anal_esil_reg_read (esil, esil_value_str (dst), &num, NULL)) {
+		if (src && esil_value_get (esil, src, &num2)) {
+			if (src->type != R_ANAL_ESIL_PARM_INTERNAL) {
 				esil->old = num;
 				esil->cur = num | num2;
-				esil->lastsz = esil_internal_sizeof_reg (esil, dst);
+				esil->lastsz = esil_internal_sizeof_reg (esil, esil_value_str (dst));
 			}
-			r_anal_esil_reg_write (esil, dst, num | num2);
+			r_anal_esil_reg_write (esil, esil_value_str (dst), num | num2);
 			ret = 1;
 		} else {
 			ERR ("esil_ordeq: empty stack");
 		}
 	}
-	free (src);
-	free (dst);
 	return ret;
 }
 
 static int esil_xoreq(RAnalEsil *esil) {
 	int ret = 0;
 	ut64 num, num2;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if (dst && r_anal_esil_reg_read (esil, dst, &num, NULL)) {
-		if (src && r_anal_esil_get_parm (esil, src, &num2)) {
-			if (r_anal_esil_get_parm_type (esil, src) != R_ANAL_ESIL_PARM_INTERNAL) {
+	RAnalEsilValue *dst = esil_pop_value (esil);
+	RAnalEsilValue *src = esil_pop_value (esil);
+	if (dst && r_anal_esil_reg_read (esil, esil_value_str (dst), &num, NULL)) {
+		if (src && esil_value_get (esil, src, &num2)) {
+			if (src->type != R_ANAL_ESIL_PARM_INTERNAL) {
 				esil->old = num;
 				esil->cur = num ^ num2;
-				esil->lastsz = esil_internal_sizeof_reg (esil, dst);
+				esil->lastsz = esil_internal_sizeof_reg (esil, esil_value_str (dst));
 			}
-			r_anal_esil_reg_write (esil, dst, num ^ num2);
+			r_anal_esil_reg_write (esil, esil_value_str (dst), num ^ num2);
 			ret = 1;
 		} else {
 			ERR ("esil_xoreq: empty stack");
 		}
 	}
-	free (src);
-	free (dst);
 	return ret;
 }
 
@@ -918,25 +1079,23 @@ static int esil_interrupt(RAnalEsil *esil) {
 static int esil_cmp(RAnalEsil *esil) {
 	ut64 num, num2;
 	int ret = 0;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if (dst && r_anal_esil_get_parm (esil, dst, &num)) {
-		if (src && r_anal_esil_get_parm (esil, src, &num2)) {
+	RAnalEsilValue *dst = esil_pop_value (esil);
+	RAnalEsilValue *src = esil_pop_value (esil);
+	if (dst && esil_value_get (esil, dst, &num)) {
+		if (src && esil_value_get (esil, src, &num2)) {
 			esil->old = num;
 			esil->cur = num - num2;
 			ret = 1;
-			if (r_reg_get (esil->anal->reg, dst, -1)) {
-				esil->lastsz = esil_internal_sizeof_reg (esil, dst);
-			} else if (r_reg_get (esil->anal->reg, src, -1)) {
-				esil->lastsz = esil_internal_sizeof_reg (esil, src);
+			if (esil_value_type (esil, dst) == R_ANAL_ESIL_PARM_REG) {
+				esil->lastsz = esil_internal_sizeof_reg (esil, esil_value_str (dst));
+			} else if (esil_value_type (esil, src) == R_ANAL_ESIL_PARM_REG) {
+				esil->lastsz = esil_internal_sizeof_reg (esil, esil_value_str (src));
 			} else {
 				// default size is set to 64 as internally operands are ut64
 				esil->lastsz = 64;
 			}
 		}
 	}
-	free (dst);
-	free (src);
 	return ret;
 }
 
@@ -1005,15 +1164,14 @@ static int esil_if(RAnalEsil *esil) {
 		esil->skip++;
 		return true;
 	}
-	char *src = r_anal_esil_pop (esil);
+	RAnalEsilValue *src = esil_pop_value (esil);
 	if (src) {
 		// TODO: check return value
-		(void)r_anal_esil_get_parm (esil, src, &num);
+		(void)esil_value_get (esil, src, &num);
 		// condition not matching, skipping until }
 		if (!num) {
 			esil->skip++;
 		}
-		free (src);
 		return true;
 	}
 	return false;
@@ -1022,10 +1180,10 @@ static int esil_if(RAnalEsil *esil) {
 static int esil_lsl(RAnalEsil *esil) {
 	int ret = 0;
 	ut64 num, num2;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if (dst && r_anal_esil_get_parm (esil, dst, &num)) {
-		if (src && r_anal_esil_get_parm (esil, src, &num2)) {
+	RAnalEsilValue *dst = esil_pop_value (esil);
+	RAnalEsilValue *src = esil_pop_value (esil);
+	if (dst && esil_value_get (esil, dst, &num)) {
+		if (src && esil_value_get (esil, src, &num2)) {
 			if (num2 > sizeof (ut64) * 8) {
 				ERR ("esil_lsl: shift is too big");
 			} else {
@@ -1040,18 +1198,16 @@ static int esil_lsl(RAnalEsil *esil) {
 			ERR ("esil_lsl: empty stack");
 		}
 	}
-	free (src);
-	free (dst);
 	return ret;
 }
 
 static int esil_lsleq(RAnalEsil *esil) {
 	int ret = 0;
 	ut64 num, num2;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if (dst && r_anal_esil_reg_read (esil, dst, &num, NULL)) {
-		if (src && r_anal_esil_get_parm (esil, src, &num2)) {
+	RAnalEsilValue *dst = esil_pop_value (esil);
+	RAnalEsilValue *src = esil_pop_value (esil);
+	if (dst && r_anal_esil_reg_read (esil, esil_value_str (dst), &num, NULL)) {
+		if (src && esil_value_get (esil, src, &num2)) {
 			if (num2 > sizeof (ut64) * 8) {
 				ERR ("esil_lsleq: shift is too big");
 			} else {
@@ -1062,26 +1218,24 @@ static int esil_lsleq(RAnalEsil *esil) {
 					num <<= num2;
 				}
 				esil->cur = num;
-				esil->lastsz = esil_internal_sizeof_reg (esil, dst);
-				r_anal_esil_reg_write (esil, dst, num);
+				esil->lastsz = esil_internal_sizeof_reg (esil, esil_value_str (dst));
+				r_anal_esil_reg_write (esil, esil_value_str (dst), num);
 				ret = 1;
 			}
 		} else {
 			ERR ("esil_lsleq: empty stack");
 		}
 	}
-	free (src);
-	free (dst);
 	return ret;
 }
 
 static int esil_lsr(RAnalEsil *esil) {
 	int ret = 0;
 	ut64 num, num2;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if (dst && r_anal_esil_get_parm (esil, dst, &num)) {
-		if (src && r_anal_esil_get_parm (esil, src, &num2)) {
+	RAnalEsilValue *dst = esil_pop_value (esil);
+	RAnalEsilValue *src = esil_pop_value (esil);
+	if (dst && esil_value_get (esil, dst, &num)) {
+		if (src && esil_value_get (esil, src, &num2)) {
 			ut64 res = num >> R_MIN (num2, 63);
 			r_anal_esil_pushnum (esil, res);
 			ret = 1;
@@ -1089,18 +1243,16 @@ static int esil_lsr(RAnalEsil *esil) {
 			ERR ("esil_lsr: empty stack");
 		}
 	}
-	free (src);
-	free (dst);
 	return ret;
 }
 
 static int esil_lsreq(RAnalEsil *esil) {
 	int ret = 0;
 	ut64 num, num2;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if (dst && r_anal_esil_reg_read (esil, dst, &num, NULL)) {
-		if (src && r_anal_esil_get_parm (esil, src, &num2)) {
+	RAnalEsilValue *dst = esil_pop_value (esil);
+	RAnalEsilValue *src = esil_pop_value (esil);
+	if (dst && r_anal_esil_reg_read (esil, esil_value_str (dst), &num, NULL)) {
+		if (src && esil_value_get (esil, src, &num2)) {
 			if (num2 > 63) {
 				eprintf ("Invalid shift at 0x%08"PFMT64x"\n", esil->address);
 				num2 = 63;
@@ -1108,25 +1260,23 @@ static int esil_lsreq(RAnalEsil *esil) {
 			esil->old = num;
 			num >>= num2;
 			esil->cur = num;
-			esil->lastsz = esil_internal_sizeof_reg (esil, dst);
-			r_anal_esil_reg_write (esil, dst, num);
+			esil->lastsz = esil_internal_sizeof_reg (esil, esil_value_str (dst));
+			r_anal_esil_reg_write (esil, esil_value_str (dst), num);
 			ret = 1;
 		} else {
 			ERR ("esil_lsreq: empty stack");
 		}
 	}
-	free (src);
-	free (dst);
 	return ret;
 }
 
 static int esil_asreq(RAnalEsil *esil) {
 	int regsize = 0, ret = 0;
 	ut64 op_num, param_num;
-	char *op = r_anal_esil_pop (esil);
-	char *param = r_anal_esil_pop (esil);
-	if (op && r_anal_esil_get_parm_size (esil, op, &op_num, &regsize)) {
-		if (param && r_anal_esil_get_parm (esil, param, &param_num)) {
+	RAnalEsilValue *op = esil_pop_value (esil);
+	RAnalEsilValue *param = esil_pop_value (esil);
+	if (op && esil_value_get_size (esil, op, &op_num, &regsize)) {
+		if (param && esil_value_get (esil, param, &param_num)) {
 			ut64 mask = (regsize - 1);
 			param_num &= mask;
 			bool isNegative;
@@ -1174,26 +1324,24 @@ static int esil_asreq(RAnalEsil *esil) {
 			}
 			ut64 res = op_num;
 			esil->cur = res;
-			esil->lastsz = esil_internal_sizeof_reg (esil, op);
-			r_anal_esil_reg_write (esil, op, res);
+			esil->lastsz = esil_internal_sizeof_reg (esil, esil_value_str (op));
+			r_anal_esil_reg_write (esil, esil_value_str (op), res);
 			// r_anal_esil_pushnum (esil, res);
 			ret = 1;
 		} else {
 			ERR ("esil_asr: empty stack");
 		}
 	}
-	free (param);
-	free (op);
 	return ret;
 }
 
 static int esil_asr(RAnalEsil *esil) {
 	int regsize = 0, ret = 0;
 	ut64 op_num = 0, param_num = 0;
-	char *op = r_anal_esil_pop (esil);
-	char *param = r_anal_esil_pop (esil);
-	if (op && r_anal_esil_get_parm_size (esil, op, &op_num, &regsize)) {
-		if (param && r_anal_esil_get_parm (esil, param, &param_num)) {
+	RAnalEsilValue *op = esil_pop_value (esil);
+	RAnalEsilValue *param = esil_pop_value (esil);
+	if (op && esil_value_get_size (esil, op, &op_num, &regsize)) {
+		if (param && esil_value_get (esil, param, &param_num)) {
 			if (param_num > regsize - 1) {
 				// capstone bug?
 				eprintf ("Invalid asr shift of %"PFMT64d" at 0x%"PFMT64x"\n", param_num, esil->address);
@@ -1226,18 +1374,16 @@ static int esil_asr(RAnalEsil *esil) {
 			ERR ("esil_asr: empty stack");
 		}
 	}
-	free (param);
-	free (op);
 	return ret;
 }
 
 static int esil_ror(RAnalEsil *esil) {
 	int regsize, ret = 0;
 	ut64 num, num2;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if (dst && r_anal_esil_get_parm_size (esil, dst, &num, &regsize)) {
-		if (src && r_anal_esil_get_parm (esil, src, &num2)) {
+	RAnalEsilValue *dst = esil_pop_value (esil);
+	RAnalEsilValue *src = esil_pop_value (esil);
+	if (dst && esil_value_get_size (esil, dst, &num, &regsize)) {
+		if (src && esil_value_get (esil, src, &num2)) {
 			ut64 mask = (regsize - 1);
 			num2 &= mask;
 			ut64 res = (num >> num2) | (num << ((-(st64)num2) & mask));
@@ -1247,18 +1393,16 @@ static int esil_ror(RAnalEsil *esil) {
 			ERR ("esil_ror: empty stack");
 		}
 	}
-	free (src);
-	free (dst);
 	return ret;
 }
 
 static int esil_rol(RAnalEsil *esil) {
 	int regsize, ret = 0;
 	ut64 num, num2;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if (dst && r_anal_esil_get_parm_size (esil, dst, &num, &regsize)) {
-		if (src && r_anal_esil_get_parm (esil, src, &num2)) {
+	RAnalEsilValue *dst = esil_pop_value (esil);
+	RAnalEsilValue *src = esil_pop_value (esil);
+	if (dst && esil_value_get_size (esil, dst, &num, &regsize)) {
+		if (src && esil_value_get (esil, src, &num2)) {
 			ut64 mask = (regsize - 1);
 			num2 &= mask;
 			ut64 res = (num << num2) | (num >> ((-(st64)num2) & mask));
@@ -1268,18 +1412,16 @@ static int esil_rol(RAnalEsil *esil) {
 			ERR ("esil_rol: empty stack");
 		}
 	}
-	free (src);
-	free (dst);
 	return ret;
 }
 
 static int esil_and(RAnalEsil *esil) {
 	int ret = 0;
 	ut64 num, num2;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if (dst && r_anal_esil_get_parm (esil, dst, &num)) {
-		if (src && r_anal_esil_get_parm (esil, src, &num2)) {
+	RAnalEsilValue *dst = esil_pop_value (esil);
+	RAnalEsilValue *src = esil_pop_value (esil);
+	if (dst && esil_value_get (esil, dst, &num)) {
+		if (src && esil_value_get (esil, src, &num2)) {
 			num &= num2;
 			r_anal_esil_pushnum (esil, num);
 			ret = 1;
@@ -1287,18 +1429,16 @@ static int esil_and(RAnalEsil *esil) {
 			ERR ("esil_and: empty stack");
 		}
 	}
-	free (src);
-	free (dst);
 	return ret;
 }
 
 static int esil_xor(RAnalEsil *esil) {
 	int ret = 0;
 	ut64 num, num2;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if (dst && r_anal_esil_get_parm (esil, dst, &num)) {
-		if (src && r_anal_esil_get_parm (esil, src, &num2)) {
+	RAnalEsilValue *dst = esil_pop_value (esil);
+	RAnalEsilValue *src = esil_pop_value (esil);
+	if (dst && esil_value_get (esil, dst, &num)) {
+		if (src && esil_value_get (esil, src, &num2)) {
 			num ^= num2;
 			r_anal_esil_pushnum (esil, num);
 			ret = 1;
@@ -1306,18 +1446,16 @@ static int esil_xor(RAnalEsil *esil) {
 			ERR ("esil_xor: empty stack");
 		}
 	}
-	free (src);
-	free (dst);
 	return ret;
 }
 
 static int esil_or(RAnalEsil *esil) {
 	int ret = 0;
 	ut64 num, num2;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if (dst && r_anal_esil_get_parm (esil, dst, &num)) {
-		if (src && r_anal_esil_get_parm (esil, src, &num2)) {
+	RAnalEsilValue *dst = esil_pop_value (esil);
+	RAnalEsilValue *src = esil_pop_value (esil);
+	if (dst && esil_value_get (esil, dst, &num)) {
+		if (src && esil_value_get (esil, src, &num2)) {
 			num |= num2;
 			r_anal_esil_pushnum (esil, num);
 			ret = 1;
@@ -1325,8 +1463,6 @@ static int esil_or(RAnalEsil *esil) {
 			ERR ("esil_xor: empty stack");
 		}
 	}
-	free (src);
-	free (dst);
 	return ret;
 }
 
@@ -1367,7 +1503,7 @@ R_API int r_anal_esil_dumpstack(RAnalEsil *esil) {
 		return 0;
 	}
 	for (i = esil->stackptr - 1; i >= 0; i--) {
-		esil->anal->cb_printf ("%s\n", esil->stack[i]);
+		esil->anal->cb_printf ("%s\n", esil_value_str (&esil->stack[i]));
 	}
 	return 1;
 }
@@ -1378,10 +1514,7 @@ static int esil_break(RAnalEsil *esil) {
 }
 
 static int esil_clear(RAnalEsil *esil) {
-	char *r;
-	while ((r = r_anal_esil_pop (esil))) {
-		free (r);
-	}
+	r_anal_esil_stack_free (esil);
 	return 1;
 }
 
@@ -1392,42 +1525,38 @@ static int esil_todo(RAnalEsil *esil) {
 
 static int esil_goto(RAnalEsil *esil) {
 	ut64 num = 0;
-	char *src = r_anal_esil_pop (esil);
-	if (src && *src && r_anal_esil_get_parm (esil, src, &num)) {
+	RAnalEsilValue *src = esil_pop_value (esil);
+	if (src && esil_value_get (esil, src, &num)) {
 		esil->parse_goto = num;
 	}
-	free (src);
 	return 1;
 }
 
 static int esil_repeat(RAnalEsil *esil) {
-	char *dst = r_anal_esil_pop (esil); // destaintion of the goto
-	char *src = r_anal_esil_pop (esil); // value of the counter
+	RAnalEsilValue *dst = esil_pop_value (esil); // destaintion of the goto
+	RAnalEsilValue *src = esil_pop_value (esil); // value of the counter
 	ut64 n, num = 0;
-	if (r_anal_esil_get_parm (esil, src, &n) && r_anal_esil_get_parm (esil, dst, &num)) {
+	if (src && dst && esil_value_get (esil, src, &n) && esil_value_get (esil, dst, &num)) {
 		if (n > 1) {
 			esil->parse_goto = num;
 			r_anal_esil_pushnum (esil, n - 1);
 		}
 	}
-	free (dst);
-	free (src);
 	return 1;
 }
 
 static int esil_pop(RAnalEsil *esil) {
-	char *dst = r_anal_esil_pop (esil);
-	free (dst);
+	(void)esil_pop_value (esil);
 	return 1;
 }
 
 static int esil_mod(RAnalEsil *esil) {
 	int ret = 0;
 	ut64 s, d;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if (src && r_anal_esil_get_parm (esil, src, &s)) {
-		if (dst && r_anal_esil_get_parm (esil, dst, &d)) {
+	RAnalEsilValue *dst = esil_pop_value (esil);
+	RAnalEsilValue *src = esil_pop_value (esil);
+	if (src && esil_value_get (esil, src, &s)) {
+		if (dst && esil_value_get (esil, dst, &d)) {
 			if (s == 0) {
 				if (esil->verbose > 0) {
 					eprintf ("0x%08"PFMT64x" esil_mod: Division by zero!\n", esil->address);
@@ -1442,25 +1571,23 @@ static int esil_mod(RAnalEsil *esil) {
 	} else {
 		ERR ("esil_mod: invalid parameters");
 	}
-	free (dst);
-	free (src);
 	return ret;
 }
 
 static int esil_modeq(RAnalEsil *esil) {
 	int ret = 0;
 	ut64 s, d;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if (src && r_anal_esil_get_parm (esil, src, &s)) {
-		if (dst && r_anal_esil_reg_read (esil, dst, &d, NULL)) {
+	RAnalEsilValue *dst = esil_pop_value (esil);
+	RAnalEsilValue *src = esil_pop_value (esil);
+	if (src && esil_value_get (esil, src, &s)) {
+		if (dst && r_anal_esil_reg_read (esil, esil_value_str (dst), &d, NULL)) {
 			if (s) {
-				if (r_anal_esil_get_parm_type (esil, src) != R_ANAL_ESIL_PARM_INTERNAL) {
+				if (src->type != R_ANAL_ESIL_PARM_INTERNAL) {
 					esil->old = d;
 					esil->cur = d % s;
-					esil->lastsz = esil_internal_sizeof_reg (esil, dst);
+					esil->lastsz = esil_internal_sizeof_reg (esil, esil_value_str (dst));
 				}
-				r_anal_esil_reg_write (esil, dst, d % s);
+				r_anal_esil_reg_write (esil, esil_value_str (dst), d % s);
 			} else {
 				ERR ("esil_modeq: Division by zero!");
 				esil->trap = R_ANAL_TRAP_DIVBYZERO;
@@ -1473,18 +1600,16 @@ static int esil_modeq(RAnalEsil *esil) {
 	} else {
 		ERR ("esil_modeq: invalid parameters");
 	}
-	free (src);
-	free (dst);
 	return ret;
 }
 
 static int esil_div(RAnalEsil *esil) {
 	int ret = 0;
 	ut64 s, d;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if (src && r_anal_esil_get_parm (esil, src, &s)) {
-		if (dst && r_anal_esil_get_parm (esil, dst, &d)) {
+	RAnalEsilValue *dst = esil_pop_value (esil);
+	RAnalEsilValue *src = esil_pop_value (esil);
+	if (src && esil_value_get (esil, src, &s)) {
+		if (dst && esil_value_get (esil, dst, &d)) {
 			if (s == 0) {
 				ERR ("esil_div: Division by zero!");
 				esil->trap = R_ANAL_TRAP_DIVBYZERO;
@@ -1497,25 +1622,23 @@ static int esil_div(RAnalEsil *esil) {
 	} else {
 		ERR ("esil_div: invalid parameters");
 	}
-	free (src);
-	free (dst);
 	return ret;
 }
 
 static int esil_diveq(RAnalEsil *esil) {
 	int ret = 0;
 	ut64 s, d;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if (src && r_anal_esil_get_parm (esil, src, &s)) {
-		if (dst && r_anal_esil_reg_read (esil, dst, &d, NULL)) {
+	RAnalEsilValue *dst = esil_pop_value (esil);
+	RAnalEsilValue *src = esil_pop_value (esil);
+	if (src && esil_value_get (esil, src, &s)) {
+		if (dst && r_anal_esil_reg_read (esil, esil_value_str (dst), &d, NULL)) {
 			if (s) {
-				if (r_anal_esil_get_parm_type (esil, src) != R_ANAL_ESIL_PARM_INTERNAL) {
+				if (src->type != R_ANAL_ESIL_PARM_INTERNAL) {
 					esil->old = d;
 					esil->cur = d / s;
-					esil->lastsz = esil_internal_sizeof_reg (esil, dst);
+					esil->lastsz = esil_internal_sizeof_reg (esil, esil_value_str (dst));
 				}
-				r_anal_esil_reg_write (esil, dst, d / s);
+				r_anal_esil_reg_write (esil, esil_value_str (dst), d / s);
 			} else {
 				// eprintf ("0x%08"PFMT64x" esil_diveq: Division by zero!\n", esil->address);
 				esil->trap = R_ANAL_TRAP_DIVBYZERO;
@@ -1528,18 +1651,16 @@ static int esil_diveq(RAnalEsil *esil) {
 	} else {
 		ERR ("esil_diveq: invalid parameters");
 	}
-	free (src);
-	free (dst);
 	return ret;
 }
 
 static int esil_mul(RAnalEsil *esil) {
 	int ret = 0;
 	ut64 s, d;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if (src && r_anal_esil_get_parm (esil, src, &s)) {
-		if (dst && r_anal_esil_get_parm (esil, dst, &d)) {
+	RAnalEsilValue *dst = esil_pop_value (esil);
+	RAnalEsilValue *src = esil_pop_value (esil);
+	if (src && esil_value_get (esil, src, &s)) {
+		if (dst && esil_value_get (esil, dst, &d)) {
 			r_anal_esil_pushnum (esil, d * s);
 			ret = 1;
 		} else {
@@ -1548,24 +1669,22 @@ static int esil_mul(RAnalEsil *esil) {
 	} else {
 		ERR ("esil_mul: invalid parameters");
 	}
-	free (src);
-	free (dst);
 	return ret;
 }
 
 static int esil_muleq(RAnalEsil *esil) {
 	int ret = 0;
 	ut64 s, d;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if (src && r_anal_esil_get_parm (esil, src, &s)) {
-		if (dst && r_anal_esil_reg_read (esil, dst, &d, NULL)) {
-			if (r_anal_esil_get_parm_type (esil, src) != R_ANAL_ESIL_PARM_INTERNAL) {
+	RAnalEsilValue *dst = esil_pop_value (esil);
+	RAnalEsilValue *src = esil_pop_value (esil);
+	if (src && esil_value_get (esil, src, &s)) {
+		if (dst && r_anal_esil_reg_read (esil, esil_value_str (dst), &d, NULL)) {
+			if (src->type != R_ANAL_ESIL_PARM_INTERNAL) {
 				esil->old = d;
 				esil->cur = d * s;
-				esil->lastsz = esil_internal_sizeof_reg (esil, dst);
+				esil->lastsz = esil_internal_sizeof_reg (esil, esil_value_str (dst));
 			}
-			r_anal_esil_reg_write (esil, dst, s * d);
+			r_anal_esil_reg_write (esil, esil_value_str (dst), s * d);
 			ret = true;
 		} else {
 			ERR ("esil_muleq: empty stack");
@@ -1573,157 +1692,143 @@ static int esil_muleq(RAnalEsil *esil) {
 	} else {
 		ERR ("esil_muleq: invalid parameters");
 	}
-	free (dst);
-	free (src);
 	return ret;
 }
 
 static int esil_add(RAnalEsil *esil) {
 	int ret = 0;
 	ut64 s, d;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if ((src && r_anal_esil_get_parm (esil, src, &s)) && (dst && r_anal_esil_get_parm (esil, dst, &d))) {
+	RAnalEsilValue *dst = esil_pop_value (esil);
+	RAnalEsilValue *src = esil_pop_value (esil);
+	if ((src && esil_value_get (esil, src, &s)) && (dst && esil_value_get (esil, dst, &d))) {
 		r_anal_esil_pushnum (esil, s + d);
 		ret = true;
 	} else {
 		ERR ("esil_add: invalid parameters");
 	}
-	free (src);
-	free (dst);
 	return ret;
 }
 
 static int esil_addeq(RAnalEsil *esil) {
 	int ret = 0;
 	ut64 s, d;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if (src && r_anal_esil_get_parm (esil, src, &s)) {
-		if (dst && r_anal_esil_reg_read (esil, dst, &d, NULL)) {
-			if (r_anal_esil_get_parm_type (esil, src) != R_ANAL_ESIL_PARM_INTERNAL) {
+	RAnalEsilValue *dst = esil_pop_value (esil);
+	RAnalEsilValue *src = esil_pop_value (esil);
+	if (src && esil_value_get (esil, src, &s)) {
+		if (dst && r_anal_esil_reg_read (esil, esil_value_str (dst), &d, NULL)) {
+			if (src->type != R_ANAL_ESIL_PARM_INTERNAL) {
 				esil->old = d;
 				esil->cur = d + s;
-				esil->lastsz = esil_internal_sizeof_reg (esil, dst);
+				esil->lastsz = esil_internal_sizeof_reg (esil, esil_value_str (dst));
 			}
-			r_anal_esil_reg_write (esil, dst, s + d);
+			r_anal_esil_reg_write (esil, esil_value_str (dst), s + d);
 			ret = true;
 		}
 	} else {
 		ERR ("esil_addeq: invalid parameters");
 	}
-	free (src);
-	free (dst);
 	return ret;
 }
 
 static int esil_inc(RAnalEsil *esil) {
 	int ret = 0;
 	ut64 s;
-	char *src = r_anal_esil_pop (esil);
-	if (src && r_anal_esil_get_parm (esil, src, &s)) {
+	RAnalEsilValue *src = esil_pop_value (esil);
+	if (src && esil_value_get (esil, src, &s)) {
 		s++;
 		r_anal_esil_pushnum (esil, s);
 		ret = true;
 	} else {
 		ERR ("esil_inc: invalid parameters");
 	}
-	free (src);
 	return ret;
 }
 
 static int esil_inceq(RAnalEsil *esil) {
 	int ret = 0;
 	ut64 sd;
-	char *src_dst = r_anal_esil_pop (esil);
-	if (src_dst && (r_anal_esil_get_parm_type (esil, src_dst) == R_ANAL_ESIL_PARM_REG) && r_anal_esil_get_parm (esil, src_dst, &sd)) {
+	RAnalEsilValue *src_dst = esil_pop_value (esil);
+	if (src_dst && (esil_value_type (esil, src_dst) == R_ANAL_ESIL_PARM_REG) && esil_value_get (esil, src_dst, &sd)) {
 		// inc rax
 		esil->old = sd++;
 		esil->cur = sd;
-		r_anal_esil_reg_write (esil, src_dst, sd);
-		esil->lastsz = esil_internal_sizeof_reg (esil, src_dst);
+		r_anal_esil_reg_write (esil, esil_value_str (src_dst), sd);
+		esil->lastsz = esil_internal_sizeof_reg (esil, esil_value_str (src_dst));
 		ret = true;
 	} else {
 		ERR ("esil_inceq: invalid parameters");
 	}
-	free (src_dst);
 	return ret;
 }
 
 static int esil_sub(RAnalEsil *esil) {
 	int ret = 0;
 	ut64 s, d;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if ((src && r_anal_esil_get_parm (esil, src, &s)) && (dst && r_anal_esil_get_parm (esil, dst, &d))) {
-		if (r_anal_esil_get_parm_type (esil, src) != R_ANAL_ESIL_PARM_INTERNAL) {
+	RAnalEsilValue *dst = esil_pop_value (esil);
+	RAnalEsilValue *src = esil_pop_value (esil);
+	if ((src && esil_value_get (esil, src, &s)) && (dst && esil_value_get (esil, dst, &d))) {
+		if (src->type != R_ANAL_ESIL_PARM_INTERNAL) {
 			esil->old = d;
 			esil->cur = d - s;
-			esil->lastsz = esil_internal_sizeof_reg (esil, dst);
+			esil->lastsz = esil_internal_sizeof_reg (esil, esil_value_str (dst));
 		}
 		r_anal_esil_pushnum (esil, d - s);
 		ret = true;
 	} else {
 		ERR ("esil_sub: invalid parameters");
 	}
-	free (src);
-	free (dst);
 	return ret;
 }
 
 static int esil_subeq(RAnalEsil *esil) {
 	int ret = 0;
 	ut64 s, d;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if (src && r_anal_esil_get_parm (esil, src, &s)) {
-		if (dst && r_anal_esil_reg_read (esil, dst, &d, NULL)) {
-			if (r_anal_esil_get_parm_type (esil, src) != R_ANAL_ESIL_PARM_INTERNAL) {
+	RAnalEsilValue *dst = esil_pop_value (esil);
+	RAnalEsilValue *src = esil_pop_value (esil);
+	if (src && esil_value_get (esil, src, &s)) {
+		if (dst && r_anal_esil_reg_read (esil, esil_value_str (dst), &d, NULL)) {
+			if (src->type != R_ANAL_ESIL_PARM_INTERNAL) {
 				esil->old = d;
 				esil->cur = d - s;
-				esil->lastsz = esil_internal_sizeof_reg (esil, dst);
+				esil->lastsz = esil_internal_sizeof_reg (esil, esil_value_str (dst));
 			}
-			r_anal_esil_reg_write (esil, dst, d - s);
+			r_anal_esil_reg_write (esil, esil_value_str (dst), d - s);
 			ret = true;
 		}
 	} else {
 		ERR ("esil_subeq: invalid parameters");
 	}
-	free (src);
-	free (dst);
 	return ret;
 }
 
 static int esil_dec(RAnalEsil *esil) {
 	int ret = 0;
 	ut64 s;
-	char *src = r_anal_esil_pop (esil);
-	if (src && r_anal_esil_get_parm (esil, src, &s)) {
+	RAnalEsilValue *src = esil_pop_value (esil);
+	if (src && esil_value_get (esil, src, &s)) {
 		s--;
 		r_anal_esil_pushnum (esil, s);
 		ret = true;
 	} else {
 		ERR ("esil_dec: invalid parameters");
 	}
-	free (src);
 	return ret;
 }
 
 static int esil_deceq(RAnalEsil *esil) {
 	int ret = 0;
 	ut64 sd;
-	char *src_dst = r_anal_esil_pop (esil);
-	if (src_dst && (r_anal_esil_get_parm_type (esil, src_dst) == R_ANAL_ESIL_PARM_REG) && r_anal_esil_get_parm (esil, src_dst, &sd)) {
+	RAnalEsilValue *src_dst = esil_pop_value (esil);
+	if (src_dst && (esil_value_type (esil, src_dst) == R_ANAL_ESIL_PARM_REG) && esil_value_get (esil, src_dst, &sd)) {
 		esil->old = sd;
 		sd--;
 		esil->cur = sd;
-		r_anal_esil_reg_write (esil, src_dst, sd);
-		esil->lastsz = esil_internal_sizeof_reg (esil, src_dst);
+		r_anal_esil_reg_write (esil, esil_value_str (src_dst), sd);
+		esil->lastsz = esil_internal_sizeof_reg (esil, esil_value_str (src_dst));
 		ret = true;
 	} else {
 		ERR ("esil_deceq: invalid parameters");
 	}
-	free (src_dst);
 	return ret;
 }
 
@@ -1733,21 +1838,19 @@ static int esil_poke_n(RAnalEsil *esil, int bits) {
 	ut64 num, num2, addr;
 	ut8 b[8] = {0};
 	ut64 n;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
+	RAnalEsilValue *dst = esil_pop_value (esil);
+	RAnalEsilValue *src = esil_pop_value (esil);
 	int bytes = R_MIN (sizeof (b), bits / 8), ret = 0;
 	if (bits % 8) {
-		free (src);
-		free (dst);
 		return 0;
 	}
 	//eprintf ("GONA POKE %d src:%s dst:%s\n", bits, src, dst);
-	char *src2 = NULL;
-	if (src && r_anal_esil_get_parm (esil, src, &num)) {
-		if (dst && r_anal_esil_get_parm (esil, dst, &addr)) {
+	RAnalEsilValue *src2 = NULL;
+	if (src && esil_value_get (esil, src, &num)) {
+		if (dst && esil_value_get (esil, dst, &addr)) {
 			if (bits == 128) {
-				src2 = r_anal_esil_pop (esil);
-				if (src2 && r_anal_esil_get_parm (esil, src2, &num2)) {
+				src2 = esil_pop_value (esil);
+				if (src2 && esil_value_get (esil, src2, &num2)) {
 					r_write_ble (b, num, esil->anal->big_endian, 64);
 					ret = r_anal_esil_mem_write (esil, addr, b, bytes);
 					if (ret == 0) {
@@ -1759,8 +1862,7 @@ static int esil_poke_n(RAnalEsil *esil, int bits) {
 				ret = -1;
 				goto out;
 			}
-			int type = r_anal_esil_get_parm_type (esil, src);
-			if (type != R_ANAL_ESIL_PARM_INTERNAL) {
+			if (src->type != R_ANAL_ESIL_PARM_INTERNAL) {
 				// this is a internal peek performed before a poke
 				// we disable hooks to avoid run hooks on internal peeks
 				void * oldhook = (void*)esil->cb.hook_mem_read;
@@ -1778,9 +1880,6 @@ static int esil_poke_n(RAnalEsil *esil, int bits) {
 		}
 	}
 out:
-	free (src2);
-	free (src);
-	free (dst);
 	return ret;
 }
 
@@ -1863,26 +1962,22 @@ static int esil_peek_n(RAnalEsil *esil, int bits) {
 	if (bits & 7) {
 		return 0;
 	}
-	char res[32];
 	ut64 addr;
 	int ret = 0, bytes = bits / 8;
-	char *dst = r_anal_esil_pop (esil);
+	RAnalEsilValue *dst = esil_pop_value (esil);
 	if (!dst) {
 		eprintf ("ESIL-ERROR at 0x%08"PFMT64x": Cannot peek memory without specifying an address\n", esil->address);
 		return 0;
 	}
 	//eprintf ("GONA PEEK %d dst:%s\n", bits, dst);
-	if (dst && isregornum (esil, dst, &addr)) {
+	if (esil_value_isregornum (esil, dst, &addr)) {
 		if (bits == 128) {
 			ut8 a[sizeof(ut64) * 2] = {0};
 			ret = r_anal_esil_mem_read (esil, addr, a, bytes);
 			ut64 b = r_read_ble64 (&a, 0); //esil->anal->big_endian);
 			ut64 c = r_read_ble64 (&a[8], 0); //esil->anal->big_endian);
-			snprintf (res, sizeof (res), "0x%" PFMT64x, b);
-			r_anal_esil_push (esil, res);
-			snprintf (res, sizeof (res), "0x%" PFMT64x, c);
-			r_anal_esil_push (esil, res);
-			free (dst);
+			r_anal_esil_pushnum (esil, b);
+			r_anal_esil_pushnum (esil, c);
 			return ret;
 		}
 		ut64 bitmask = genmask (bits - 1);
@@ -1892,11 +1987,9 @@ static int esil_peek_n(RAnalEsil *esil, int bits) {
 		if (esil->anal->big_endian) {
 			r_mem_swapendian ((ut8*)&b, (const ut8*)&b, bytes);
 		}
-		snprintf (res, sizeof (res), "0x%" PFMT64x, b & bitmask);
-		r_anal_esil_push (esil, res);
+		r_anal_esil_pushnum (esil, b & bitmask);
 		esil->lastsz = bits;
 	}
-	free (dst);
 	return ret;
 }
 
@@ -2570,17 +2663,14 @@ static int esil_dup(RAnalEsil *esil) {
 	if (!esil || !esil->stack || esil->stackptr < 1 || esil->stackptr > (esil->stacksize - 1)) {
 		return false;
 	}
-	return r_anal_esil_push (esil, esil->stack[esil->stackptr-1]);
+	return esil_push_value (esil, &esil->stack[esil->stackptr-1]);
 }
 
 static int esil_swap(RAnalEsil *esil) {
-	char *tmp;
+	RAnalEsilValue tmp;
 	if (!esil || !esil->stack || esil->stackptr < 2) {
 		return false;
 	}
-	if (!esil->stack[esil->stackptr-1] || !esil->stack[esil->stackptr-2]) {
-		return false;
-	}
 	tmp = esil->stack[esil->stackptr-1];
 	esil->stack[esil->stackptr-1] = esil->stack[esil->stackptr-2];
 	esil->stack[esil->stackptr-2] = tmp;
@@ -2588,10 +2678,10 @@ static int esil_swap(RAnalEsil *esil) {
 }
 
 static int __esil_generic_pick(RAnalEsil *esil, int rev) {
-	char *idx = r_anal_esil_pop (esil);
+	RAnalEsilValue *idx = esil_pop_value (esil);
 	ut64 i;
 	int ret = false;
-	if (!idx || !r_anal_esil_get_parm (esil, idx, &i)) {
+	if (!idx || !esil_value_get (esil, idx, &i)) {
 		ERR ("esil_pick: invalid index number");
 		goto end;
 	}
@@ -2606,11 +2696,7 @@ static int __esil_generic_pick(RAnalEsil *esil, int rev) {
 		ERR ("esil_pick: index out of stack bounds");
 		goto end;
 	}
-	if (!esil->stack[esil->stackptr-i]) {
-		ERR ("esil_pick: undefined element");
-		goto end;
-	}
-	if (!r_anal_esil_push (esil, esil->stack[esil->stackptr-i])) {
+	if (!esil_push_value (esil, &esil->stack[esil->stackptr-i])) {
 		ERR ("ESIL stack is full");
 		esil->trap = 1;
 		esil->trap_code = 1;
@@ -2618,7 +2704,6 @@ static int __esil_generic_pick(RAnalEsil *esil, int rev) {
 	}
 	ret = true;
 end:
-	free (idx);
 	return ret;
 }
 
@@ -2658,17 +2743,17 @@ static int signed_compare_gt(ut64 a, ut64 b, ut64 size) {
 static int esil_smaller(RAnalEsil *esil) { // 'dst < src' => 'src,dst,<'
 	ut64 num, num2;
 	int ret = 0;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if (dst && r_anal_esil_get_parm (esil, dst, &num)) {
-		if (src && r_anal_esil_get_parm (esil, src, &num2)) {
+	RAnalEsilValue *dst = esil_pop_value (esil);
+	RAnalEsilValue *src = esil_pop_value (esil);
+	if (dst && esil_value_get (esil, dst, &num)) {
+		if (src && esil_value_get (esil, src, &num2)) {
 			esil->old = num;
 			esil->cur = num - num2;
 			ret = 1;
-			if (r_reg_get (esil->anal->reg, dst, -1)) {
-				esil->lastsz = esil_internal_sizeof_reg (esil, dst);
-			} else if (r_reg_get (esil->anal->reg, src, -1)) {
-				esil->lastsz = esil_internal_sizeof_reg (esil, src);
+			if (esil_value_type (esil, dst) == R_ANAL_ESIL_PARM_REG) {
+				esil->lastsz = esil_internal_sizeof_reg (esil, esil_value_str (dst));
+			} else if (esil_value_type (esil, src) == R_ANAL_ESIL_PARM_REG) {
+				esil->lastsz = esil_internal_sizeof_reg (esil, esil_value_str (src));
 			} else {
 				// default size is set to 64 as internally operands are ut64
 				esil->lastsz = 64;
@@ -2677,25 +2762,23 @@ static int esil_smaller(RAnalEsil *esil) { // 'dst < src' => 'src,dst,<'
 			                           !signed_compare_gt (num, num2, esil->lastsz));
 		}
 	}
-	free (dst);
-	free (src);
 	return ret;
 }
 
 static int esil_bigger(RAnalEsil *esil) { // 'dst > src' => 'src,dst,>'
 	ut64 num, num2;
 	int ret = 0;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if (dst && r_anal_esil_get_parm (esil, dst, &num)) {
-		if (src && r_anal_esil_get_parm (esil, src, &num2)) {
+	RAnalEsilValue *dst = esil_pop_value (esil);
+	RAnalEsilValue *src = esil_pop_value (esil);
+	if (dst && esil_value_get (esil, dst, &num)) {
+		if (src && esil_value_get (esil, src, &num2)) {
 			esil->old = num;
 			esil->cur = num - num2;
 			ret = 1;
-			if (r_reg_get (esil->anal->reg, dst, -1)) {
-				esil->lastsz = esil_internal_sizeof_reg (esil, dst);
-			} else if (r_reg_get (esil->anal->reg, src, -1)) {
-				esil->lastsz = esil_internal_sizeof_reg (esil, src);
+			if (esil_value_type (esil, dst) == R_ANAL_ESIL_PARM_REG) {
+				esil->lastsz = esil_internal_sizeof_reg (esil, esil_value_str (dst));
+			} else if (esil_value_type (esil, src) == R_ANAL_ESIL_PARM_REG) {
+				esil->lastsz = esil_internal_sizeof_reg (esil, esil_value_str (src));
 			} else {
 				// default size is set to 64 as internally operands are ut64
 				esil->lastsz = 64;
@@ -2703,25 +2786,23 @@ static int esil_bigger(RAnalEsil *esil) { // 'dst > src' => 'src,dst,>'
 			r_anal_esil_pushnum (esil, signed_compare_gt (num, num2, esil->lastsz));
 		}
 	}
-	free (dst);
-	free (src);
 	return ret;
 }
 
 static int esil_smaller_equal(RAnalEsil *esil) { // 'dst <= src' => 'src,dst,<='
 	ut64 num, num2;
 	int ret = 0;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if (dst && r_anal_esil_get_parm (esil, dst, &num)) {
-		if (src && r_anal_esil_get_parm (esil, src, &num2)) {
+	RAnalEsilValue *dst = esil_pop_value (esil);
+	RAnalEsilValue *src = esil_pop_value (esil);
+	if (dst && esil_value_get (esil, dst, &num)) {
+		if (src && esil_value_get (esil, src, &num2)) {
 			esil->old = num;
 			esil->cur = num - num2;
 			ret = 1;
-			if (r_reg_get (esil->anal->reg, dst, -1)) {
-				esil->lastsz = esil_internal_sizeof_reg (esil, dst);
-			} else if (r_reg_get (esil->anal->reg, src, -1)) {
-				esil->lastsz = esil_internal_sizeof_reg (esil, src);
+			if (esil_value_type (esil, dst) == R_ANAL_ESIL_PARM_REG) {
+				esil->lastsz = esil_internal_sizeof_reg (esil, esil_value_str (dst));
+			} else if (esil_value_type (esil, src) == R_ANAL_ESIL_PARM_REG) {
+				esil->lastsz = esil_internal_sizeof_reg (esil, esil_value_str (src));
 			} else {
 				// default size is set to 64 as internally operands are ut64
 				esil->lastsz = 64;
@@ -2729,25 +2810,23 @@ static int esil_smaller_equal(RAnalEsil *esil) { // 'dst <= src' => 'src,dst,<='
 			r_anal_esil_pushnum (esil, !signed_compare_gt (num, num2, esil->lastsz));
 		}
 	}
-	free (dst);
-	free (src);
 	return ret;
 }
 
 static int esil_bigger_equal(RAnalEsil *esil) { // 'dst >= src' => 'src,dst,>='
 	ut64 num, num2;
 	int ret = 0;
-	char *dst = r_anal_esil_pop (esil);
-	char *src = r_anal_esil_pop (esil);
-	if (dst && r_anal_esil_get_parm (esil, dst, &num)) {
-		if (src && r_anal_esil_get_parm (esil, src, &num2)) {
+	RAnalEsilValue *dst = esil_pop_value (esil);
+	RAnalEsilValue *src = esil_pop_value (esil);
+	if (dst && esil_value_get (esil, dst, &num)) {
+		if (src && esil_value_get (esil, src, &num2)) {
 			esil->old = num;
 			esil->cur = num - num2;
 			ret = 1;
-			if (r_reg_get (esil->anal->reg, dst, -1)) {
-				esil->lastsz = esil_internal_sizeof_reg (esil, dst);
-			} else if (r_reg_get (esil->anal->reg, src, -1)) {
-				esil->lastsz = esil_internal_sizeof_reg (esil, src);
+			if (esil_value_type (esil, dst) == R_ANAL_ESIL_PARM_REG) {
+				esil->lastsz = esil_internal_sizeof_reg (esil, esil_value_str (dst));
+			} else if (esil_value_type (esil, src) == R_ANAL_ESIL_PARM_REG) {
+				esil->lastsz = esil_internal_sizeof_reg (esil, esil_value_str (src));
 			} else {
 				// default size is set to 64 as internally operands are ut64
 				esil->lastsz = 64;
@@ -2756,8 +2835,6 @@ static int esil_bigger_equal(RAnalEsil *esil) { // 'dst >= src' => 'src,dst,>='
 			                           signed_compare_gt (num, num2, esil->lastsz));
 		}
 	}
-	free (dst);
-	free (src);
 	return ret;
 }
 
@@ -2905,6 +2982,169 @@ static int evalWord(RAnalEsil *esil, const char *ostr, const char **str) {
 	return 3;
 }
 
+/* split the expression once and resolve the ops, returns a program with no
+ * words for expressions that need the interpreter (';', '#!', empty words) */
+static EsilProgram *esil_compile(RAnalEsil *esil, const char *str) {
+	EsilProgram *p = R_NEW0 (EsilProgram);
+	if (!p) {
+		return NULL;
+	}
+	p->refs = 1;
+	if (strchr (str, ';') || strstr (str, "#!")) {
+		return p;
+	}
+	int i, n = 1;
+	for (i = 0; str[i]; i++) {
+		if (str[i] == ',') {
+			n++;
+		}
+	}
+	p->src = strdup (str);
+	p->text = strdup (str);
+	p->words = R_NEWS0 (EsilWord, n);
+	if (!p->src || !p->text || !p->words) {
+		esil_program_unref (p);
+		return NULL;
+	}
+	char *word = p->text;
+	for (i = 0; i < n; i++) {
+		EsilWord *w = &p->words[i];
+		char *next = strchr (word, ',');
+		if (next) {
+			*next++ = 0;
+		}
+		size_t len = strlen (word);
+		if (!len || len > 62) {
+			break;
+		}
+		w->str = word;
+		w->rest = next? p->src + (next - p->text): "";
+		if (!strcmp (word, "}{")) {
+			w->kind = ESIL_WORD_ELSE;
+		} else if (!strcmp (word, "}")) {
+			w->kind = ESIL_WORD_ENDIF;
+		} else if (iscommand (esil, word, &w->op) && w->op) {
+			w->kind = strcmp (word, "?{")? ESIL_WORD_OP: ESIL_WORD_IF;
+		} else if (esil_value_parse (&w->value, word)) {
+			w->kind = ESIL_WORD_PUSH;
+		} else {
+			break;
+		}
+		p->count++;
+		word = next;
+	}
+	if (p->count != n) {
+		// fall back to the interpreter for this one
+		for (i = 0; i < p->count; i++) {
+			R_FREE (p->words[i].value.str);
+		}
+		p->count = 0;
+	}
+	return p;
+}
+
+static EsilProgram *esil_program_get(RAnalEsil *esil, const char *str) {
+	if (!esil->compiled || esil->compiled->count >= ESIL_COMPILED_MAX) {
+		esil_compiled_flush (esil);
+		esil->compiled = ht_pp_new (NULL, esil_program_kv_free, NULL);
+		if (!esil->compiled) {
+			return NULL;
+		}
+	}
+	EsilProgram *p = ht_pp_find (esil->compiled, str, NULL);
+	if (!p) {
+		p = esil_compile (esil, str);
+		if (p) {
+			ht_pp_insert (esil->compiled, str, p);
+		}
+	}
+	return p;
+}
+
+/* same semantics as runword, minus the REIL and word parsing bits */
+static int esil_word_run(RAnalEsil *esil, EsilWord *w) {
+	esil->parse_goto_count--;
+	if (esil->parse_goto_count < 1) {
+		ERR ("ESIL infinite loop detected\n");
+		esil->trap = 1;       // INTERNAL ERROR
+		esil->parse_stop = 1; // INTERNAL ERROR
+		return 0;
+	}
+	switch (w->kind) {
+	case ESIL_WORD_ELSE:
+		if (esil->skip == 1) {
+			esil->skip = 0;
+		} else if (esil->skip == 0) {
+			esil->skip = 1;
+		}
+		return 1;
+	case ESIL_WORD_ENDIF:
+		if (esil->skip) {
+			esil->skip--;
+		}
+		return 1;
+	case ESIL_WORD_IF:
+		break;
+	default:
+		if (esil->skip) {
+			return 1;
+		}
+		break;
+	}
+	if (w->kind == ESIL_WORD_PUSH) {
+		if (!esil_push_value (esil, &w->value)) {
+			ERR ("ESIL stack is full");
+			esil->trap = 1;
+			esil->trap_code = 1;
+		}
+		return 1;
+	}
+	if (esil->cb.hook_command && esil->cb.hook_command (esil, w->str)) {
+		return 1; // XXX cannot return != 1
+	}
+	return w->op (esil);
+}
+
+/* same control flow as the r_anal_esil_parse loop, word indexes are goto targets */
+static int esil_program_run(RAnalEsil *esil, EsilProgram *p) {
+	int i;
+loop:
+	esil->repeat = 0;
+	esil->skip = 0;
+	esil->parse_goto = -1;
+	esil->parse_stop = 0;
+	esil->parse_goto_count = esil->anal? esil->anal->esil_goto_limit: R_ANAL_ESIL_GOTO_LIMIT;
+	i = 0;
+	while (i < p->count) {
+		EsilWord *w = &p->words[i];
+		if (!esil_word_run (esil, w)) {
+			return 0;
+		}
+		if (esil->repeat) {
+			goto loop;
+		}
+		if (esil->parse_goto != -1) {
+			if (esil->parse_goto < 0 || esil->parse_goto >= p->count) {
+				if (esil->verbose) {
+					eprintf ("Cannot find word %d\n", esil->parse_goto);
+				}
+				return 0;
+			}
+			i = esil->parse_goto;
+			esil->parse_goto = -1;
+			continue;
+		}
+		if (esil->parse_stop) {
+			if (esil->parse_stop == 2) {
+				eprintf ("[esil at 0x%08"PFMT64x"] TODO: %s\n", esil->address, w->rest);
+			}
+			return 0;
+		}
+		i++;
+	}
+	return 1;
+}
+
 R_API int r_anal_esil_parse(RAnalEsil *esil, const char *str) {
 	int wordi = 0;
 	int dorunword;
@@ -2925,6 +3165,15 @@ R_API int r_anal_esil_parse(RAnalEsil *esil, const char *str) {
 			esil->cmd (esil, esil->cmd_todo, esil->address, 0);
 		}
 	}
+	if (esil->anal && esil->anal->esil_compile && !esil->Reil) {
+		EsilProgram *p = esil_program_get (esil, str);
+		if (p && p->count > 0) {
+			p->refs++;
+			int ret = esil_program_run (esil, p);
+			esil_program_unref (p);
+			return ret;
+		}
+	}
 loop:
 	esil->repeat = 0;
 	esil->skip = 0;
@@ -3015,7 +3264,7 @@ R_API void r_anal_esil_stack_free(RAnalEsil *esil) {
 	int i;
 	if (esil) {
 		for (i = 0; i < esil->stackptr; i++) {
-			R_FREE (esil->stack[i]);
+			R_FREE (esil->stack[i].str);
 		}
 		esil->stackptr = 0;
 	}
@@ -299,6 +299,7 @@ R_API int r_anal_fcn_resize(RAnal *anal, RAnalFunction *fcn, int newsize) {
 		return false;
 	}
 	r_anal_fcn_set_size (anal, fcn, newsize);
+	r_anal_fcn_invalidate (fcn);
 	eof = fcn->addr + r_anal_fcn_size (fcn);
 	r_list_foreach_safe (fcn->bbs, iter, iter2, bb) {
 		if (bb->addr >= eof) {
@@ -364,6 +365,7 @@ R_API void r_anal_fcn_free(void *_fcn) {
 		fcn->bbs = NULL;
 	}
 	free (fcn->fingerprint);
+	free (fcn->features.bbhash);
 	r_anal_diff_free (fcn->diff);
 	free (fcn->args);
 	free (fcn);
@@ -958,6 +960,7 @@ static int fcn_recurse(RAnal *anal, RAnalFunction *fcn, ut64 addr, ut8 *buf, ut6
 		0
 	};
 	bool is_arm = anal->cur->arch && !strncmp (anal->cur->arch, "arm", 3);
+	r_anal_fcn_invalidate (fcn);
 	char tmp_buf[MAX_FLG_NAME_SIZE + 5] = "skip";
 	bool is_x86 = anal->cur->arch && !strncmp (anal->cur->arch, "x86", 3);
 
@@ -1937,6 +1940,7 @@ R_API bool r_anal_fcn_add_bb(RAnal *anal, RAnalFunction *fcn, ut64 addr, ut64 si
 	}
 	const bool is_x86 = anal->cur->arch && !strcmp (anal->cur->arch, "x86");
 
+	r_anal_fcn_invalidate (fcn);
 	r_list_foreach (fcn->bbs, iter, bbi) {
 		if (addr == bbi->addr) {
 			bb = bbi;
@@ -2025,6 +2029,7 @@ R_API int r_anal_fcn_split_bb(RAnal *anal, RAnalFunction *fcn, RAnalBlock *bbi,
 	if (addr == bbi->addr) {
 		return R_ANAL_RET_DUP;
 	}
+	r_anal_fcn_invalidate (fcn);
 	bb = appendBasicBlock (anal, fcn, addr);
 	bb->size = bbi->addr + bbi->size - addr;
 	bb->jump = bbi->jump;
@@ -2081,6 +2086,7 @@ R_API int r_anal_fcn_bb_overlaps(RAnalFunction *fcn, RAnalBlock *bb) {
 				bb->type = R_ANAL_BB_TYPE_BODY;
 			}
 			r_list_append (fcn->bbs, bb);
+			r_anal_fcn_invalidate (fcn);
 			return R_ANAL_RET_END;
 		}
 	}
@@ -2113,6 +2119,9 @@ R_API int r_anal_fcn_cc(RAnal *anal, RAnalFunction *fcn) {
 	RListIter *iter;
 	RAnalBlock *bb;
 
+	if (fcn->features.valid & R_ANAL_FCN_FEAT_CC) {
+		return fcn->features.cc;
+	}
 	r_list_foreach (fcn->bbs, iter, bb) {
 		N++; // nodes
 		if ((anal && anal->verbose) && bb->jump == UT64_MAX && bb->fail != UT64_MAX) {
@@ -2139,6 +2148,8 @@ R_API int r_anal_fcn_cc(RAnal *anal, RAnalFunction *fcn) {
 		eprintf ("Warning: CC = E(%d) - N(%d) + (2 * P(%d)) < 1 at 0x%08"PFMT64x"\n", E, N, P, fcn->addr);
 	}
 	// r_return_val_if_fail (result > 0, 0);
+	fcn->features.cc = result;
+	fcn->features.valid |= R_ANAL_FCN_FEAT_CC;
 	return result;
 }
 
@@ -2296,6 +2307,7 @@ R_API bool r_anal_fcn_bbadd(RAnalFunction *fcn, RAnalBlock *bb) {
 	return sdb_ptr_set (HB, sdb_fmt (SDB_KEY_BB, fcn->addr, bb->addr), bb, NULL);
 #endif
 	r_list_append (fcn->bbs, bb);
+	r_anal_fcn_invalidate (fcn);
 	return true;
 }
 
@@ -2389,23 +2401,67 @@ R_API ut32 r_anal_fcn_cost(RAnal *anal, RAnalFunction *fcn) {
 R_API int r_anal_fcn_count_edges(RAnalFunction *fcn, int *ebbs) {
 	RListIter *iter;
 	RAnalBlock *bb;
-	int edges = 0;
-	if (ebbs) {
-		*ebbs = 0;
-	}
-	r_list_foreach (fcn->bbs, iter, bb) {
-		if (ebbs && bb->jump == UT64_MAX && bb->fail == UT64_MAX) {
-			*ebbs = *ebbs + 1;
-		} else {
+	RAnalFcnFeatures *ft = &fcn->features;
+	if (!(ft->valid & R_ANAL_FCN_FEAT_EDGES)) {
+		ft->edges = ft->ebbs = 0;
+		r_list_foreach (fcn->bbs, iter, bb) {
+			if (bb->jump == UT64_MAX && bb->fail == UT64_MAX) {
+				ft->ebbs++;
+			}
 			if (bb->jump != UT64_MAX) {
-				edges ++;
+				ft->edges++;
 			}
 			if (bb->fail != UT64_MAX) {
-				edges ++;
+				ft->edges++;
 			}
 		}
+		ft->valid |= R_ANAL_FCN_FEAT_EDGES;
+	}
+	if (ebbs) {
+		*ebbs = ft->ebbs;
+	}
+	return ft->edges;
+}
+
+/* Drop the cached features of fcn. Must be called whenever its basic
+ * blocks are added, removed, split or resized. */
+R_API void r_anal_fcn_invalidate(RAnalFunction *fcn) {
+	r_return_if_fail (fcn);
+	fcn->features.valid = 0;
+	R_FREE (fcn->features.bbhash);
+}
+
+#define FEAT_BYTES (R_ANAL_FCN_FEAT_BBHASH | R_ANAL_FCN_FEAT_FINGERPRINT)
+
+static ut32 io_wgen(RAnal *anal) {
+	return (anal && anal->iob.io)? anal->iob.io->wgen: 0;
+}
+
+/* Check if the features in feat are cached. The ones computed from the
+ * function bytes are also dropped when anything was written since. */
+R_API bool r_anal_fcn_features_valid(RAnal *anal, RAnalFunction *fcn, ut32 feat) {
+	r_return_val_if_fail (fcn, false);
+	RAnalFcnFeatures *ft = &fcn->features;
+	if ((ft->valid & FEAT_BYTES) && ft->iogen != io_wgen (anal)) {
+		ft->valid &= ~FEAT_BYTES;
+		R_FREE (ft->bbhash);
+	}
+	return (ft->valid & feat) == feat;
+}
+
+/* Mark feat as computed, with the bytes as they are now */
+R_API void r_anal_fcn_features_set(RAnal *anal, RAnalFunction *fcn, ut32 feat) {
+	r_return_if_fail (fcn);
+	RAnalFcnFeatures *ft = &fcn->features;
+	if (feat & FEAT_BYTES) {
+		ut32 gen = io_wgen (anal);
+		if (ft->iogen != gen) {
+			// the other byte based values were computed before a write
+			ft->valid &= ~FEAT_BYTES;
+			ft->iogen = gen;
+		}
 	}
-	return edges;
+	ft->valid |= feat;
 }
 
 R_API bool r_anal_fcn_get_purity(RAnal *anal, RAnalFunction *fcn) {
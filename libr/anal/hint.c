@@ -2,120 +2,212 @@
 
 #include <r_anal.h>
 
-#define DB a->sdb_hints
-#define setf(x,...) snprintf(x,sizeof(x)-1,##__VA_ARGS__)
+// Hints are kept as native records in a red-black tree sorted by address,
+// so looking them up does not need to format keys nor parse sdb strings.
 
-R_API void r_anal_hint_clear(RAnal *a) {
-	sdb_reset (a->sdb_hints);
+typedef struct r_anal_hint_record_t {
+	RAnalHint hint;
+	RBNode rb;
+} RAnalHintRecord;
+
+#define HINT_CONTAINER(x) container_of ((RBNode*)(x), RAnalHintRecord, rb)
+
+static void hint_fini(RAnalHint *h) {
+	free (h->arch);
+	free (h->esil);
+	free (h->opcode);
+	free (h->syntax);
+	free (h->offset);
 }
 
-R_API void r_anal_hint_del(RAnal *a, ut64 addr, int size) {
-	char key[128];
-	if (size > 1) {
-		eprintf ("TODO: r_anal_hint_del: in range\n");
-	} else {
-		setf (key, "hint.0x%08"PFMT64x, addr);
-		sdb_unset (a->sdb_hints, key, 0);
+static void _hint_tree_free(RBNode *node) {
+	RAnalHintRecord *r = HINT_CONTAINER (node);
+	hint_fini (&r->hint);
+	free (r);
+}
+
+static int _hint_tree_cmp(const void *a_, const RBNode *b_) {
+	const ut64 addr = *(const ut64 *)a_;
+	const RAnalHintRecord *b = HINT_CONTAINER (b_);
+	if (addr != b->hint.addr) {
+		return addr < b->hint.addr ? -1 : 1;
 	}
+	return 0;
 }
 
-static void unsetHint(RAnal *a, const char *type, ut64 addr) {
-	char key[128];
-	setf (key, "hint.0x%08"PFMT64x, addr);
-	int idx = sdb_array_indexof (DB, key, type, 0);
-	if (idx != -1) {
-		sdb_array_delete (DB, key, idx, 0);
-		sdb_array_delete (DB, key, idx, 0);
+static RAnalHintRecord *hint_find(RAnal *a, ut64 addr) {
+	RBNode *n = a->hints;
+	while (n) {
+		RAnalHintRecord *r = HINT_CONTAINER (n);
+		if (r->hint.addr == addr) {
+			return r;
+		}
+		n = n->child[r->hint.addr < addr];
 	}
+	return NULL;
 }
 
-static void setHint(RAnal *a, const char *type, ut64 addr, const char *s, ut64 ptr) {
-	char key[128], val[128], *nval = NULL;
-	setf (key, "hint.0x%08"PFMT64x, addr);
-	int idx = sdb_array_indexof (DB, key, type, 0);
-	if (s) {
-		nval = sdb_encode ((const ut8*)s, -1);
-	} else {
-		nval = sdb_itoa (ptr, val, 16);
+static RAnalHint *hint_ensure(RAnal *a, ut64 addr) {
+	RAnalHintRecord *r = hint_find (a, addr);
+	a->hints_gen++;
+	if (r) {
+		return &r->hint;
 	}
-	if (idx != -1) {
-		if (!s) {
-			nval = sdb_itoa (ptr, val, 16);
-		}
-		sdb_array_set (DB, key, idx + 1, nval, 0);
-	} else {
-		sdb_array_push (DB, key, nval, 0);
-		sdb_array_push (DB, key, type, 0);
+	r = R_NEW0 (RAnalHintRecord);
+	if (!r) {
+		return NULL;
+	}
+	r->hint.addr = addr;
+	r->hint.jump = UT64_MAX;
+	r->hint.fail = UT64_MAX;
+	r->hint.ret = UT64_MAX;
+	r_rbtree_insert (&a->hints, &addr, &r->rb, _hint_tree_cmp);
+	return &r->hint;
+}
+
+static bool hint_empty(RAnalHint *h) {
+	return !h->ptr && h->jump == UT64_MAX && h->fail == UT64_MAX
+		&& h->ret == UT64_MAX && !h->arch && !h->opcode && !h->syntax
+		&& !h->esil && !h->offset && !h->type && !h->size && !h->bits
+		&& !h->new_bits && !h->immbase && !h->high && !h->nword;
+}
+
+// drop the record once its last hint has been unset
+static void hint_gc(RAnal *a, RAnalHint *h) {
+	if (hint_empty (h)) {
+		ut64 addr = h->addr;
+		r_rbtree_delete (&a->hints, &addr, _hint_tree_cmp, _hint_tree_free);
+	}
+}
+
+#define SET_HINT_NUM(a, addr, field, val) do { \
+		RAnalHint *h = hint_ensure (a, addr); \
+		if (h) { \
+			h->field = val; \
+			hint_gc (a, h); \
+		} \
+	} while (0)
+
+#define SET_HINT_STR(a, addr, field, val) do { \
+		RAnalHint *h = hint_ensure (a, addr); \
+		char *v = strdup (val); \
+		if (h && v) { \
+			free (h->field); \
+			h->field = v; \
+		} else { \
+			free (v); \
+			if (h) { \
+				hint_gc (a, h); \
+			} \
+		} \
+	} while (0)
+
+#define UNSET_HINT(a, addr, field, val) do { \
+		RAnalHintRecord *r = hint_find (a, addr); \
+		if (r) { \
+			a->hints_gen++; \
+			r->hint.field = val; \
+			hint_gc (a, &r->hint); \
+		} \
+	} while (0)
+
+#define UNSET_HINT_STR(a, addr, field) do { \
+		RAnalHintRecord *r = hint_find (a, addr); \
+		if (r) { \
+			a->hints_gen++; \
+			R_FREE (r->hint.field); \
+			hint_gc (a, &r->hint); \
+		} \
+	} while (0)
+
+R_API void r_anal_hint_clear(RAnal *a) {
+	r_rbtree_free (a->hints, _hint_tree_free);
+	a->hints = NULL;
+	a->hints_gen++;
+	a->merge_hints = true;
+}
+
+R_API void r_anal_hint_del(RAnal *a, ut64 addr, int size) {
+	RBNode *n;
+	if (size < 1) {
+		size = 1;
 	}
-	if (s) {
-		free (nval);
+	const ut64 end = (addr + size < addr)? UT64_MAX: addr + size;
+	while ((n = r_rbtree_lower_bound (a->hints, &addr, _hint_tree_cmp))) {
+		ut64 at = HINT_CONTAINER (n)->hint.addr;
+		if (at >= end) {
+			break;
+		}
+		r_rbtree_delete (&a->hints, &at, _hint_tree_cmp, _hint_tree_free);
 	}
+	a->hints_gen++;
+	a->merge_hints = true;
 }
 
 R_API void r_anal_hint_set_offset(RAnal *a, ut64 addr, const char* typeoff) {
-	setHint (a, "Offset:", addr, r_str_trim_ro (typeoff), 0);
+	SET_HINT_STR (a, addr, offset, r_str_trim_ro (typeoff));
 }
 
 R_API void r_anal_hint_set_nword(RAnal *a, ut64 addr, int nword) {
-	setHint (a, "nword:", addr, NULL, nword);
+	SET_HINT_NUM (a, addr, nword, nword);
 }
 
 R_API void r_anal_hint_set_jump(RAnal *a, ut64 addr, ut64 ptr) {
-	setHint (a, "jump:", addr, NULL, ptr);
+	SET_HINT_NUM (a, addr, jump, ptr);
 }
 
 R_API void r_anal_hint_set_newbits(RAnal *a, ut64 addr, int bits) {
-	setHint (a, "Bits:", addr, NULL, bits);
+	SET_HINT_NUM (a, addr, new_bits, bits);
 }
 
 // TOOD: add helpers for newendian and newbank
 
 R_API void r_anal_hint_set_fail(RAnal *a, ut64 addr, ut64 ptr) {
-	setHint (a, "fail:", addr, NULL, ptr);
+	SET_HINT_NUM (a, addr, fail, ptr);
 }
 
 R_API void r_anal_hint_set_high(RAnal *a, ut64 addr) {
-	setHint (a, "high:", addr, NULL, 1);
+	SET_HINT_NUM (a, addr, high, true);
 }
 
 R_API void r_anal_hint_set_immbase(RAnal *a, ut64 addr, int base) {
 	if (base) {
-		setHint (a, "immbase:", addr, NULL, (ut64)base);
+		SET_HINT_NUM (a, addr, immbase, base);
 	} else {
-		unsetHint (a, "immbase:", addr);
+		UNSET_HINT (a, addr, immbase, 0);
 	}
 }
 
 R_API void r_anal_hint_set_pointer(RAnal *a, ut64 addr, ut64 ptr) {
-	setHint (a, "ptr:", addr, NULL, ptr);
+	SET_HINT_NUM (a, addr, ptr, ptr);
 }
 
 R_API void r_anal_hint_set_ret(RAnal *a, ut64 addr, ut64 val) {
-	setHint (a, "ret:", addr, NULL, val);
+	SET_HINT_NUM (a, addr, ret, val);
 }
 
 R_API void r_anal_hint_set_arch(RAnal *a, ut64 addr, const char *arch) {
-	setHint (a, "arch:", addr, r_str_trim_ro (arch), 0);
+	SET_HINT_STR (a, addr, arch, r_str_trim_ro (arch));
 }
 
 R_API void r_anal_hint_set_syntax(RAnal *a, ut64 addr, const char *syn) {
-	setHint (a, "Syntax:", addr, syn, 0);
+	SET_HINT_STR (a, addr, syntax, syn);
 }
 
 R_API void r_anal_hint_set_opcode(RAnal *a, ut64 addr, const char *opcode) {
-	setHint (a, "opcode:", addr, r_str_trim_ro (opcode), 0);
+	SET_HINT_STR (a, addr, opcode, r_str_trim_ro (opcode));
 }
 
 R_API void r_anal_hint_set_esil(RAnal *a, ut64 addr, const char *esil) {
-	setHint (a, "esil:", addr, r_str_trim_ro (esil), 0);
+	SET_HINT_STR (a, addr, esil, r_str_trim_ro (esil));
 }
 
 R_API void r_anal_hint_set_type (RAnal *a, ut64 addr, int type) {
-	setHint (a, "type:", addr, NULL, (ut64)type);
+	SET_HINT_NUM (a, addr, type, type);
 }
 
 R_API void r_anal_hint_set_bits(RAnal *a, ut64 addr, int bits) {
-	setHint (a, "bits:", addr, NULL, bits);
+	SET_HINT_NUM (a, addr, bits, bits);
 	if (a && a->hint_cbs.on_bits) {
 		a->hint_cbs.on_bits (a, addr, bits, true);
 	}
@@ -123,15 +215,15 @@ R_API void r_anal_hint_set_bits(RAnal *a, ut64 addr, int bits) {
 }
 
 R_API void r_anal_hint_set_size(RAnal *a, ut64 addr, int size) {
-	setHint (a, "size:", addr, NULL, size);
+	SET_HINT_NUM (a, addr, size, size);
 }
 
 R_API void r_anal_hint_unset_size(RAnal *a, ut64 addr) {
-	unsetHint(a, "size:", addr);
+	UNSET_HINT (a, addr, size, 0);
 }
 
 R_API void r_anal_hint_unset_bits(RAnal *a, ut64 addr) {
-	unsetHint(a, "bits:", addr);
+	UNSET_HINT (a, addr, bits, 0);
 	if (a && a->hint_cbs.on_bits) {
 		a->hint_cbs.on_bits (a, addr, 0, false);
 	}
@@ -139,60 +231,56 @@ R_API void r_anal_hint_unset_bits(RAnal *a, ut64 addr) {
 }
 
 R_API void r_anal_hint_unset_esil(RAnal *a, ut64 addr) {
-	unsetHint(a, "esil:", addr);
+	UNSET_HINT_STR (a, addr, esil);
 }
 
 R_API void r_anal_hint_unset_opcode(RAnal *a, ut64 addr) {
-	unsetHint(a, "opcode:", addr);
+	UNSET_HINT_STR (a, addr, opcode);
 }
 
 R_API void r_anal_hint_unset_high(RAnal *a, ut64 addr) {
-	unsetHint(a, "high:", addr);
+	UNSET_HINT (a, addr, high, false);
 }
 
 R_API void r_anal_hint_unset_arch(RAnal *a, ut64 addr) {
-	unsetHint(a, "arch:", addr);
+	UNSET_HINT_STR (a, addr, arch);
 }
 
 R_API void r_anal_hint_unset_nword(RAnal *a, ut64 addr) {
-	unsetHint(a, "nword:", addr);
+	UNSET_HINT (a, addr, nword, 0);
 }
 
 R_API void r_anal_hint_unset_syntax(RAnal *a, ut64 addr) {
-	unsetHint(a, "Syntax:", addr);
+	UNSET_HINT_STR (a, addr, syntax);
 }
 
 R_API void r_anal_hint_unset_pointer(RAnal *a, ut64 addr) {
-	unsetHint(a, "ptr:", addr);
+	UNSET_HINT (a, addr, ptr, 0);
 }
 
 R_API void r_anal_hint_unset_ret(RAnal *a, ut64 addr) {
-	unsetHint(a, "ret:", addr);
+	UNSET_HINT (a, addr, ret, UT64_MAX);
 }
 
 R_API void r_anal_hint_unset_offset(RAnal *a, ut64 addr) {
-	unsetHint (a, "Offset:", addr);
+	UNSET_HINT_STR (a, addr, offset);
 }
 
 R_API void r_anal_hint_unset_jump(RAnal *a, ut64 addr) {
-	unsetHint (a, "jump:", addr);
+	UNSET_HINT (a, addr, jump, UT64_MAX);
 }
 
 R_API void r_anal_hint_unset_fail(RAnal *a, ut64 addr) {
-	unsetHint (a, "fail:", addr);
+	UNSET_HINT (a, addr, fail, UT64_MAX);
 }
 
 R_API void r_anal_hint_unset_type (RAnal *a, ut64 addr) {
-	unsetHint (a, "type:", addr);
+	UNSET_HINT (a, addr, type, 0);
 }
 
 R_API void r_anal_hint_free(RAnalHint *h) {
 	if (h) {
-		free (h->arch);
-		free (h->esil);
-		free (h->opcode);
-		free (h->syntax);
-		free (h->offset);
+		hint_fini (h);
 		free (h);
 	}
 }
@@ -227,7 +315,7 @@ R_API int r_anal_hint_get_bits_at(RAnal *a, ut64 addr, const char *str) {
 	return bits;
 }
 
-// TODO: missing to_string ()
+// parses the legacy "type:,value,..." sdb array format used by old dumps
 R_API RAnalHint *r_anal_hint_from_string(RAnal *a, ut64 addr, const char *str) {
 	char *r, *nxt, *nxt2;
 	int token = 0;
@@ -280,9 +368,40 @@ R_API RAnalHint *r_anal_hint_from_string(RAnal *a, ut64 addr, const char *str) {
 	return hint;
 }
 
+// Returns the hint stored at addr without copying it. The pointer is owned
+// by the anal and is only valid until the hints at that address change.
+R_API const RAnalHint *r_anal_hint_at(RAnal *a, ut64 addr) {
+	r_return_val_if_fail (a, NULL);
+	RAnalHintRecord *r = a->hints? hint_find (a, addr): NULL;
+	return r? &r->hint: NULL;
+}
+
 R_API RAnalHint *r_anal_hint_get(RAnal *a, ut64 addr) {
-	char key[64];
-	setf (key, "hint.0x%08"PFMT64x, addr);
-	const char *s = sdb_const_get (DB, key, 0);
-	return s? r_anal_hint_from_string (a, addr, s): NULL;
+	const RAnalHint *h = r_anal_hint_at (a, addr);
+	if (!h) {
+		return NULL;
+	}
+	RAnalHint *hint = R_NEW (RAnalHint);
+	if (!hint) {
+		return NULL;
+	}
+	*hint = *h;
+	hint->arch = h->arch? strdup (h->arch): NULL;
+	hint->opcode = h->opcode? strdup (h->opcode): NULL;
+	hint->syntax = h->syntax? strdup (h->syntax): NULL;
+	hint->esil = h->esil? strdup (h->esil): NULL;
+	hint->offset = h->offset? strdup (h->offset): NULL;
+	return hint;
+}
+
+// Iterates all hints sorted by address, stopping when cb returns false.
+// The hints must not be modified from the callback.
+R_API void r_anal_hint_foreach(RAnal *a, RAnalHintCb cb, void *user) {
+	RBIter it;
+	RAnalHintRecord *r;
+	r_rbtree_foreach (a->hints, it, r, RAnalHintRecord, rb) {
+		if (!cb (&r->hint, user)) {
+			break;
+		}
+	}
 }
@@ -19,71 +19,248 @@ Keys:
   'meta.<type>.count=<int>'     number of added metas where 'type' is a single char
   'meta.<type>.<last>=<array>'  splitted array, each block contains K elements
   'meta.<type>.<addr>=<string>' string representing extra information of the meta type at given address
-  'range.<baddr>=<array>'       store valid addresses in a base range array
 #endif
 
 #include <r_anal.h>
 #include <r_core.h>
 #include <r_util.h>
 
-#define META_RANGE_BASE(x) ((x)>>5)
 #undef DB
 #define DB a->sdb_meta
 
-static char *meta_inrange_get (RAnal *a, ut64 addr, int size) {
-	if (size <= 0) {
+// ranges covered by the metas, one interval tree keyed on from per meta type,
+// the items themselves are still serialized in sdb
+typedef struct {
+	RBNode rb;
+	ut64 from;
+	ut64 to;
+	ut64 max_to; // maximum of to in the subtree, insertion order while pending
+} RMetaRange;
+
+typedef struct {
+	RBNode *root;
+	RPVector pending; // RMetaRange added by r_meta_add_batch, see meta_ranges_flush
+} RMetaRanges;
+
+#define META_RANGE_CONTAINER(x) container_of ((RBNode*)(x), RMetaRange, rb)
+
+static int meta_range_cmp(const void *a_, const RBNode *b_) {
+	const ut64 from = *(const ut64 *)a_;
+	const RMetaRange *b = META_RANGE_CONTAINER (b_);
+	if (from != b->from) {
+		return from < b->from ? -1 : 1;
+	}
+	return 0;
+}
+
+static void meta_range_calc_max_to(RBNode *node) {
+	int i;
+	RMetaRange *r = META_RANGE_CONTAINER (node);
+	r->max_to = r->to;
+	for (i = 0; i < 2; i++) {
+		if (node->child[i]) {
+			RMetaRange *r1 = META_RANGE_CONTAINER (node->child[i]);
+			if (r1->max_to > r->max_to) {
+				r->max_to = r1->max_to;
+			}
+		}
+	}
+}
+
+static void meta_range_free(RBNode *node) {
+	free (META_RANGE_CONTAINER (node));
+}
+
+static void meta_ranges_free(HtUPKv *kv) {
+	RMetaRanges *mr = kv->value;
+	r_rbtree_free (mr->root, meta_range_free);
+	r_pvector_clear (&mr->pending);
+	free (mr);
+}
+
+static RMetaRanges *meta_ranges_get(RAnal *a, int type, bool create) {
+	RMetaRanges *mr = NULL;
+	if (a->meta_ranges) {
+		mr = ht_up_find (a->meta_ranges, type, NULL);
+	} else if (create) {
+		a->meta_ranges = ht_up_new (NULL, meta_ranges_free, NULL);
+	}
+	if (mr || !create || !a->meta_ranges) {
+		return mr;
+	}
+	mr = R_NEW0 (RMetaRanges);
+	if (!mr) {
 		return NULL;
 	}
-	ut64 base = META_RANGE_BASE (addr);
-	ut64 base2 = META_RANGE_BASE (addr + size - 1);
-	char *res = NULL;
-	// return string array of all the offsets where there are stuff
-	for (; base <= base2; base++) {
-		const char *key = sdb_fmt ("range.0x%"PFMT64x, base);
-		// char *r = sdb_array_get (DB, key, 0, 0);
-		char *r = sdb_get (DB, key, 0);
-		if (r) {
-			if (res) {
-				res = r_str_append (res, ",");
+	r_pvector_init (&mr->pending, free);
+	if (!ht_up_insert (a->meta_ranges, type, mr)) {
+		free (mr);
+		return NULL;
+	}
+	return mr;
+}
+
+static void meta_range_set(RMetaRanges *mr, RMetaRange *r) {
+	r_rbtree_aug_delete (&mr->root, &r->from, meta_range_cmp, meta_range_free, meta_range_calc_max_to);
+	r_rbtree_aug_insert (&mr->root, &r->from, &r->rb, meta_range_cmp, meta_range_calc_max_to);
+}
+
+static int meta_pending_cmp(const void *a_, const void *b_) {
+	const RMetaRange *a = a_, *b = b_;
+	if (a->from != b->from) {
+		return a->from < b->from ? -1 : 1;
+	}
+	// the last one added wins
+	return a->max_to < b->max_to ? -1 : a->max_to > b->max_to;
+}
+
+// balanced tree out of the sorted ranges, nodes below the last complete
+// level are red so every path has the same number of black nodes
+static RBNode *meta_range_build(RMetaRange **v, int lo, int hi, int depth, int red_depth) {
+	if (lo >= hi) {
+		return NULL;
+	}
+	int mid = lo + (hi - lo) / 2;
+	RBNode *node = &v[mid]->rb;
+	node->child[0] = meta_range_build (v, lo, mid, depth + 1, red_depth);
+	node->child[1] = meta_range_build (v, mid + 1, hi, depth + 1, red_depth);
+	node->red = depth == red_depth;
+	meta_range_calc_max_to (node);
+	return node;
+}
+
+// move the ranges added in batch into the tree, in O(n) if it is empty
+static void meta_ranges_flush(RMetaRanges *mr) {
+	int i, n = 0, count = r_pvector_len (&mr->pending);
+	if (!count) {
+		return;
+	}
+	RMetaRange **v = (RMetaRange **)mr->pending.v.a;
+	r_pvector_sort (&mr->pending, meta_pending_cmp);
+	if (mr->root) {
+		for (i = 0; i < count; i++) {
+			meta_range_set (mr, v[i]);
+		}
+	} else {
+		// drop all but the last added range of each address
+		for (i = 0; i < count; i++) {
+			if (i + 1 < count && v[i + 1]->from == v[i]->from) {
+				free (v[i]);
+			} else {
+				v[n++] = v[i];
 			}
-			res = r_str_append (res, r);
-			free (r);
 		}
+		int red_depth = 0;
+		while (((ut64)2 << red_depth) <= (ut64)n + 1) {
+			red_depth++;
+		}
+		mr->root = meta_range_build (v, 0, n, 0, red_depth);
 	}
-	return res;
+	// the nodes are owned by the tree now
+	mr->pending.v.len = 0;
+	r_pvector_clear (&mr->pending);
 }
 
-static bool meta_inrange_add (RAnal *a, ut64 addr, int size) {
-	if (size <= 0) {
-		return false;
+static bool meta_ranges_flush_cb(void *user, const ut64 type, const void *value) {
+	meta_ranges_flush ((RMetaRanges *)value);
+	return true;
+}
+
+static void meta_range_add(RAnal *a, int type, ut64 from, ut64 to, bool batch) {
+	RMetaRanges *mr = meta_ranges_get (a, type, true);
+	if (!mr) {
+		return;
+	}
+	RMetaRange *r = R_NEW0 (RMetaRange);
+	if (!r) {
+		return;
 	}
-	bool set = false;
-	ut64 base, base2;
-	base = META_RANGE_BASE (addr);
-	base2 = META_RANGE_BASE (addr + size - 1);
-	for (; base <= base2; base++) {
-		const char *key = sdb_fmt ("range.0x%"PFMT64x, base);
-		if (sdb_array_add_num (DB, key, addr, 0)) {
-			set = true;
+	r->from = from;
+	r->to = to;
+	if (batch) {
+		r->max_to = r_pvector_len (&mr->pending);
+		if (!r_pvector_push (&mr->pending, r)) {
+			free (r);
 		}
+		return;
 	}
-	return set;
+	meta_ranges_flush (mr);
+	r->max_to = to;
+	meta_range_set (mr, r);
 }
 
-static bool meta_inrange_del (RAnal *a, ut64 addr, int size) {
-	if (size <= 0) {
-		return false;
+static bool meta_range_del_cb(void *user, const ut64 type, const void *value) {
+	RMetaRanges *mr = (RMetaRanges *)value;
+	meta_ranges_flush (mr);
+	r_rbtree_aug_delete (&mr->root, user, meta_range_cmp, meta_range_free, meta_range_calc_max_to);
+	return true;
+}
+
+static void meta_range_del(RAnal *a, int type, ut64 addr) {
+	if (!a->meta_ranges) {
+		return;
+	}
+	if (type == R_META_TYPE_ANY) {
+		// all the types starting at addr
+		ht_up_foreach (a->meta_ranges, meta_range_del_cb, &addr);
+		return;
 	}
-	bool set = false;
-	ut64 base = META_RANGE_BASE (addr);
-	ut64 base2 = META_RANGE_BASE (addr + size - 1);
-	for (; base <= base2; base++) {
-		const char *key = sdb_fmt ("range.0x%"PFMT64x, base);
-		if (sdb_array_remove_num (DB, key, addr, 0)) {
-			set = true;
+	RMetaRanges *mr = meta_ranges_get (a, type, false);
+	if (mr) {
+		meta_range_del_cb (&addr, type, mr);
+	}
+}
+
+// lowest range of the tree that contains at
+static RMetaRange *meta_range_find_in(RBNode *node, ut64 at) {
+	while (node) {
+		RMetaRange *r = META_RANGE_CONTAINER (node);
+		if (r->max_to <= at) {
+			return NULL;
+		}
+		RMetaRange *r1 = meta_range_find_in (node->child[0], at);
+		if (r1) {
+			return r1;
+		}
+		if (r->from > at) {
+			return NULL;
 		}
+		if (at < r->to) {
+			return r;
+		}
+		node = node->child[1];
+	}
+	return NULL;
+}
+
+typedef struct {
+	ut64 at;
+	int type;
+	RMetaRange *r;
+} MetaFindInCtx;
+
+static bool meta_find_in_cb(void *user, const ut64 type, const void *value) {
+	MetaFindInCtx *ctx = user;
+	RMetaRanges *mr = (RMetaRanges *)value;
+	meta_ranges_flush (mr);
+	RMetaRange *r = meta_range_find_in (mr->root, ctx->at);
+	if (r && (!ctx->r || r->from < ctx->r->from || (r->from == ctx->r->from && (int)type < ctx->type))) {
+		ctx->r = r;
+		ctx->type = (int)type;
+	}
+	return true;
+}
+
+R_API void r_meta_update(RAnal *a) {
+	r_return_if_fail (a);
+	if (a->meta_ranges) {
+		ht_up_foreach (a->meta_ranges, meta_ranges_flush_cb, NULL);
 	}
-	return set;
+}
+
+R_API void r_meta_free(RAnal *a) {
+	ht_up_free (a->meta_ranges);
+	a->meta_ranges = NULL;
 }
 
 // 512 = 1.5s
@@ -118,7 +295,6 @@ R_API int r_meta_set_string(RAnal *a, int type, ut64 addr, const char *s) {
 	size = sdb_array_get_num (DB, key, 0, 0);
 	if (!size) {
 		size = strlen (s);
-		meta_inrange_add (a, addr, size);
 		ret = true;
 	} else {
 		ret = false;
@@ -155,7 +331,6 @@ R_API int r_meta_set_var_comment(RAnal *a, int type, ut64 idx, ut64 addr, const
 	size = sdb_array_get_num (DB, key, 0, 0);
 	if (!size) {
 		size = strlen (s);
-		meta_inrange_add (a, addr, size);
 		ret = true;
 	} else {
 		ret = false;
@@ -230,7 +405,11 @@ R_API int r_meta_del(RAnal *a, int type, ut64 addr, ut64 size) {
 		// XXX: this thing ignores the type
 		if (type == R_META_TYPE_ANY) {
 			sdb_reset (DB);
+			r_meta_free (a);
 		} else {
+			if (a->meta_ranges) {
+				ht_up_delete (a->meta_ranges, type);
+			}
 			snprintf (key, sizeof (key)-1, "meta.%c.count", type);
 			int last = (ut64)sdb_num_get (DB, key, NULL)/K;
 			for (i = 0; i < last; i++) {
@@ -261,7 +440,7 @@ R_API int r_meta_del(RAnal *a, int type, ut64 addr, ut64 size) {
 	} else {
 		snprintf (key, sizeof (key)-1, "meta.0x%"PFMT64x, addr);
 	}
-	meta_inrange_del (a, addr, size);
+	meta_range_del (a, type, addr);
 	val = sdb_const_get (DB, key, 0);
 	if (val) {
 		if (type == R_META_TYPE_ANY) {
@@ -379,7 +558,7 @@ R_API bool r_meta_deserialize_val(RAnal *a, RAnalMetaItem *it, int type, ut64 fr
 	return true;
 }
 
-static int meta_add(RAnal *a, int type, int subtype, ut64 from, ut64 to, const char *str) {
+static int meta_add(RAnal *a, int type, int subtype, ut64 from, ut64 to, const char *str, bool batch) {
 	const RSpace *space = r_spaces_current (&a->meta_spaces);
 	char key[100], val[2048];
 	if (from > to) {
@@ -418,16 +597,20 @@ static int meta_add(RAnal *a, int type, int subtype, ut64 from, ut64 to, const c
 	val[0] = type;
 	val[1] = '\0';
 	sdb_array_add (DB, key, val, 0);
-	meta_inrange_add (a, from, to - from);
+	meta_range_add (a, type, from, to, batch);
 	return true;
 }
 
 R_API int r_meta_add(RAnal *a, int type, ut64 from, ut64 to, const char *str) {
-	return meta_add (a, type, 0, from, to, str);
+	return meta_add (a, type, 0, from, to, str, false);
+}
+
+R_API int r_meta_add_batch(RAnal *a, int type, ut64 from, ut64 to, const char *str) {
+	return meta_add (a, type, 0, from, to, str, true);
 }
 
 R_API int r_meta_add_with_subtype(RAnal *a, int type, int subtype, ut64 from, ut64 to, const char *str) {
-	return meta_add (a, type, subtype, from, to, str);
+	return meta_add (a, type, subtype, from, to, str, false);
 }
 
 static RAnalMetaItem *r_meta_find_(RAnal *a, ut64 at, int type, int where, int excl_type) {
@@ -478,24 +661,23 @@ R_API RAnalMetaItem *r_meta_find_any_except(RAnal *a, ut64 at, int type, int whe
 }
 
 R_API RAnalMetaItem *r_meta_find_in(RAnal *a, ut64 at, int type, int where) {
-	char *res = meta_inrange_get (a, at, 1);
-	if (!res) {
+	MetaFindInCtx ctx = { at, type, NULL };
+	if (!a->meta_ranges) {
 		return NULL;
 	}
-	RList *list = r_str_split_list (res, ",");
-	RListIter *iter;
-	const char *meta;
-	r_list_foreach (list, iter, meta) {
-		ut64 mia = r_num_math (NULL, meta);
-		RAnalMetaItem *mi = r_meta_find (a, mia, type, where);
-		if (mi && (at >= mi->from && at < mi->to)) {
-			free (res);
-			return mi;
+	if (type == R_META_TYPE_ANY) {
+		ht_up_foreach (a->meta_ranges, meta_find_in_cb, &ctx);
+	} else {
+		RMetaRanges *mr = meta_ranges_get (a, type, false);
+		if (mr) {
+			meta_find_in_cb (&ctx, type, mr);
 		}
 	}
-	r_list_free (list);
-	free (res);
-	return NULL;
+	if (!ctx.r) {
+		return NULL;
+	}
+	RAnalMetaItem *mi = r_meta_find (a, ctx.r->from, ctx.type, where);
+	return (mi && at >= mi->from && at < mi->to)? mi: NULL;
 }
 
 R_API const char *r_meta_type_to_string(int type) {
@@ -177,11 +177,7 @@ R_API int r_anal_op(RAnal *anal, RAnalOp *op, ut64 addr, const ut8 *data, int le
 		}
 	}
 	if (mask & R_ANAL_OP_MASK_HINT) {
-		RAnalHint *hint = r_anal_hint_get (anal, addr);
-		if (hint) {
-			r_anal_op_hint (op, hint);
-			r_anal_hint_free (hint);
-		}
+		r_anal_op_hint (op, r_anal_hint_at (anal, addr));
 	}
 	return ret;
 }
@@ -728,7 +724,7 @@ R_API int r_anal_op_family_from_string(const char *f) {
 }
 
 /* apply hint to op, return the number of hints applied */
-R_API int r_anal_op_hint(RAnalOp *op, RAnalHint *hint) {
+R_API int r_anal_op_hint(RAnalOp *op, const RAnalHint *hint) {
 	int changes = 0;
 	if (hint) {
 		if (hint->type > 0) {
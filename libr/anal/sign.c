@@ -385,6 +385,7 @@ static bool addItem(RAnal *a, RSignItem *it) {
 		serialize (a, curit, key, val);
 	}
 	sdb_set (a->sdb_zigns, key, val, 0);
+	r_sign_index_invalidate (a);
 
 out:
 	r_sign_item_free (curit);
@@ -656,6 +657,7 @@ R_API bool r_sign_delete(RAnal *a, const char *name) {
 	if (!a || !name) {
 		return false;
 	}
+	r_sign_index_invalidate (a);
 	// Remove all zigns
 	if (*name == '*') {
 		if (!r_spaces_current (&a->zign_spaces)) {
@@ -979,6 +981,9 @@ R_API char *r_sign_calc_bbhash(RAnal *a, RAnalFunction *fcn) {
 	RListIter *iter = NULL;
 	RAnalBlock *bbi = NULL;
 	char *digest_hex = NULL;
+	if (r_anal_fcn_features_valid (a, fcn, R_ANAL_FCN_FEAT_BBHASH)) {
+		return strdup (fcn->features.bbhash);
+	}
 	RHash *ctx = r_hash_new (true, R_ZIGN_HASH);
 	if (!ctx) {
 		goto beach;
@@ -1001,6 +1006,11 @@ R_API char *r_sign_calc_bbhash(RAnal *a, RAnalFunction *fcn) {
 	r_hash_do_end (ctx, R_ZIGN_HASH);
 
 	digest_hex = r_hex_bin2strdup (ctx->digest, r_hash_size (R_ZIGN_HASH));
+	if (digest_hex) {
+		free (fcn->features.bbhash);
+		fcn->features.bbhash = strdup (digest_hex);
+		r_anal_fcn_features_set (a, fcn, R_ANAL_FCN_FEAT_BBHASH);
+	}
 beach:
 	free (ctx);
 	return digest_hex;
@@ -1085,6 +1095,7 @@ R_API void r_sign_space_unset_for(RAnal *a, const RSpace *space) {
 	}
 
 	sdb_foreach (a->sdb_zigns, unsetForCB, &ctx);
+	r_sign_index_invalidate (a);
 }
 
 struct ctxRenameForCB {
@@ -1122,6 +1133,7 @@ R_API void r_sign_space_rename_for(RAnal *a, const RSpace *space, const char *on
 	serializeKeySpaceStr (a, nname, "", ctx.nprefix);
 
 	sdb_foreach (a->sdb_zigns, renameForCB, &ctx);
+	r_sign_index_invalidate (a);
 }
 
 struct ctxForeachCB {
@@ -1166,6 +1178,186 @@ R_API bool r_sign_foreach(RAnal *a, RSignForeachCallback cb, void *user) {
 	return sdb_foreach (a->sdb_zigns, foreachCB, &ctx);
 }
 
+// Function matching walks an index of the loaded zignatures, so every
+// function is looked up by its features instead of being compared with
+// every zignature. The index is built from sdb_zigns on first use (usually
+// right after zo) and dropped whenever the zignatures change.
+typedef struct r_sign_index_t {
+	const RSpace *space; // zign space the index was built for
+	int count;           // records in sdb_zigns when it was built
+	RPVector items;      // RSignItem, in sdb order
+	HtPP *bbhash;        // bbhash -> RVector of item indices
+	HtUP *addr;          // addr -> item indices
+	HtUP *graph;         // cc and nbbs -> item indices
+	RVector graph_any;   // graph items with a wildcard cc or nbbs
+	HtUP *refs;          // fingerprint of the refs -> item indices
+	HtUP *vars;          // fingerprint of the vars -> item indices
+} RSignIndex;
+
+struct ctxIndexCB {
+	RAnal *anal;
+	RSignIndex *idx;
+};
+
+#define GRAPH_KEY(cc, nbbs) (((ut64)(ut32)(cc) << 32) | (ut32)(nbbs))
+
+static void index_bucket_free(HtUPKv *kv) {
+	r_vector_free (kv->value);
+}
+
+static void index_bucket_free_str(HtPPKv *kv) {
+	free (kv->key);
+	r_vector_free (kv->value);
+}
+
+static bool index_add(HtUP *ht, ut64 key, ut32 n) {
+	RVector *v = ht_up_find (ht, key, NULL);
+	if (!v) {
+		v = r_vector_new (sizeof (ut32), NULL, NULL);
+		if (!v || !ht_up_insert (ht, key, v)) {
+			r_vector_free (v);
+			return false;
+		}
+	}
+	return r_vector_push (v, &n);
+}
+
+static bool index_add_str(HtPP *ht, const char *key, ut32 n) {
+	RVector *v = ht_pp_find (ht, key, NULL);
+	if (!v) {
+		v = r_vector_new (sizeof (ut32), NULL, NULL);
+		if (!v || !ht_pp_insert (ht, key, v)) {
+			r_vector_free (v);
+			return false;
+		}
+	}
+	return r_vector_push (v, &n);
+}
+
+static ut64 list_fingerprint(RList *list) {
+	RListIter *iter;
+	const char *s;
+	ut64 h = r_list_length (list);
+	r_list_foreach (list, iter, s) {
+		h = (h * 0x100000001b3ULL) ^ sdb_hash (s);
+	}
+	return h;
+}
+
+static bool list_equal(RList *a, RList *b) {
+	RListIter *ia = a? a->head: NULL;
+	RListIter *ib = b? b->head: NULL;
+	for (; ia && ib; ia = ia->n, ib = ib->n) {
+		if (strcmp (ia->data, ib->data)) {
+			return false;
+		}
+	}
+	return ia == ib;
+}
+
+static void index_free(RSignIndex *idx) {
+	if (!idx) {
+		return;
+	}
+	r_pvector_clear (&idx->items);
+	ht_pp_free (idx->bbhash);
+	ht_up_free (idx->addr);
+	ht_up_free (idx->graph);
+	r_vector_clear (&idx->graph_any);
+	ht_up_free (idx->refs);
+	ht_up_free (idx->vars);
+	free (idx);
+}
+
+static int indexAddCB(void *user, const char *k, const char *v) {
+	struct ctxIndexCB *ctx = (struct ctxIndexCB *) user;
+	RSignIndex *idx = ctx->idx;
+	RSignItem *it = r_sign_item_new ();
+	if (!it) {
+		return 0;
+	}
+	if (!deserialize (ctx->anal, it, k, v)) {
+		eprintf ("error: cannot deserialize zign\n");
+		r_sign_item_free (it);
+		return 1;
+	}
+	if (idx->space && idx->space != it->space) {
+		r_sign_item_free (it);
+		return 1;
+	}
+	ut32 n = r_pvector_len (&idx->items);
+	if (!r_pvector_push (&idx->items, it)) {
+		r_sign_item_free (it);
+		return 0;
+	}
+	bool ok = true;
+	if (it->hash && it->hash->bbhash && *it->hash->bbhash) {
+		ok &= index_add_str (idx->bbhash, it->hash->bbhash, n);
+	}
+	if (it->addr != UT64_MAX) {
+		ok &= index_add (idx->addr, it->addr, n);
+	}
+	if (it->graph) {
+		if (it->graph->cc == -1 || it->graph->nbbs == -1) {
+			ok &= r_vector_push (&idx->graph_any, &n) != NULL;
+		} else {
+			ok &= index_add (idx->graph, GRAPH_KEY (it->graph->cc, it->graph->nbbs), n);
+		}
+	}
+	if (it->refs) {
+		ok &= index_add (idx->refs, list_fingerprint (it->refs), n);
+	}
+	if (it->vars) {
+		ok &= index_add (idx->vars, list_fingerprint (it->vars), n);
+	}
+	return ok;
+}
+
+static RSignIndex *index_new(RAnal *a) {
+	RSignIndex *idx = R_NEW0 (RSignIndex);
+	if (!idx) {
+		return NULL;
+	}
+	r_pvector_init (&idx->items, (RPVectorFree) r_sign_item_free);
+	r_vector_init (&idx->graph_any, sizeof (ut32), NULL, NULL);
+	idx->space = r_spaces_current (&a->zign_spaces);
+	idx->count = sdb_count (a->sdb_zigns);
+	idx->bbhash = ht_pp_new (NULL, index_bucket_free_str, NULL);
+	idx->addr = ht_up_new (NULL, index_bucket_free, NULL);
+	idx->graph = ht_up_new (NULL, index_bucket_free, NULL);
+	idx->refs = ht_up_new (NULL, index_bucket_free, NULL);
+	idx->vars = ht_up_new (NULL, index_bucket_free, NULL);
+	if (!idx->bbhash || !idx->addr || !idx->graph || !idx->refs || !idx->vars) {
+		index_free (idx);
+		return NULL;
+	}
+	struct ctxIndexCB ctx = { a, idx };
+	if (!sdb_foreach (a->sdb_zigns, indexAddCB, &ctx)) {
+		index_free (idx);
+		return NULL;
+	}
+	return idx;
+}
+
+R_API void r_sign_index_invalidate(RAnal *a) {
+	r_return_if_fail (a);
+	index_free (a->zign_index);
+	a->zign_index = NULL;
+}
+
+static RSignIndex *sign_index(RAnal *a) {
+	RSignIndex *idx = a->zign_index;
+	if (idx && (idx->space != r_spaces_current (&a->zign_spaces)
+			|| idx->count != sdb_count (a->sdb_zigns))) {
+		// changed behind our back, ie: through the k command
+		r_sign_index_invalidate (a);
+	}
+	if (!a->zign_index) {
+		a->zign_index = index_new (a);
+	}
+	return a->zign_index;
+}
+
 R_API RSignSearch *r_sign_search_new() {
 	RSignSearch *ret = R_NEW0 (RSignSearch);
 
@@ -1238,7 +1430,15 @@ R_API void r_sign_search_init(RAnal *a, RSignSearch *ss, int minsz, RSignSearchC
 	r_list_purge (ss->items);
 	r_search_reset (ss->search, R_SEARCH_KEYWORD);
 
-	r_sign_foreach (a, addSearchKwCB, &ctx);
+	RSignIndex *idx = sign_index (a);
+	if (idx) {
+		void **it;
+		r_pvector_foreach (&idx->items, it) {
+			addSearchKwCB (*it, &ctx);
+		}
+	} else {
+		r_sign_foreach (a, addSearchKwCB, &ctx);
+	}
 	r_search_begin (ss->search);
 	r_search_set_callback (ss->search, searchHitCB, ss);
 }
@@ -1257,23 +1457,38 @@ static int matchCount(int a, int b) {
 	return R_ABS (c) < m;
 }
 
-static bool fcnMetricsCmp(RSignItem *it, RAnalFunction *fcn) {
+typedef struct {
+	int cc;
+	int nbbs;
+	int edges;
+	int ebbs;
+	int size;
+} FcnMetrics;
+
+static void fcnMetrics(RAnalFunction *fcn, FcnMetrics *m) {
+	m->cc = r_anal_fcn_cc (NULL, fcn);
+	m->nbbs = r_list_length (fcn->bbs);
+	m->edges = r_anal_fcn_count_edges (fcn, &m->ebbs);
+	m->size = r_anal_fcn_size (fcn);
+}
+
+static bool fcnMetricsCmp(RSignItem *it, const FcnMetrics *m) {
 	RSignGraph *graph = it->graph;
-	int ebbs = -1;
 
-	if (graph->cc != -1 && graph->cc != r_anal_fcn_cc (NULL, fcn)) {
+	if (graph->cc != -1 && graph->cc != m->cc) {
 		return false;
 	}
-	if (graph->nbbs != -1 && graph->nbbs != r_list_length (fcn->bbs)) {
+	if (graph->nbbs != -1 && graph->nbbs != m->nbbs) {
 		return false;
 	}
-	if (graph->edges != -1 && graph->edges != r_anal_fcn_count_edges (fcn, &ebbs)) {
+	if (graph->edges != -1 && graph->edges != m->edges) {
 		return false;
 	}
-	if (graph->ebbs != -1 && graph->ebbs != ebbs) {
+	// ebbs is only known once the edges have been counted
+	if (graph->ebbs != -1 && graph->ebbs != (graph->edges != -1? m->ebbs: -1)) {
 		return false;
 	}
-	if (graph->bbsum > 0 && matchCount (graph->bbsum, r_anal_fcn_size (fcn))) {
+	if (graph->bbsum > 0 && matchCount (graph->bbsum, m->size)) {
 		return false;
 	}
 	return true;
@@ -1285,205 +1500,136 @@ struct ctxFcnMatchCB {
 	RSignGraphMatchCallback cb;
 	void *user;
 	int mincc;
+	const FcnMetrics *metrics;
+	RList *list; // refs or vars of the function
 };
 
-static int graphMatchCB(RSignItem *it, void *user) {
-	struct ctxFcnMatchCB *ctx = (struct ctxFcnMatchCB *) user;
-	RSignGraph *graph = it->graph;
-
-	if (!graph) {
-		return 1;
-	}
-
-	if (graph->cc < ctx->mincc) {
-		return 1;
-	}
-
-	if (!fcnMetricsCmp (it, ctx->fcn)) {
-		return 1;
-	}
-
-	if (ctx->cb) {
-		return ctx->cb (it, ctx->fcn, ctx->user);
+typedef bool (*FcnMatchFilter)(RSignItem *it, struct ctxFcnMatchCB *ctx);
+
+// Report the items of both buckets that pass the filter, in sdb order.
+// Returns false if the callback asked to stop.
+static bool matchBuckets(RSignIndex *idx, RVector *a, RVector *b, FcnMatchFilter filter, struct ctxFcnMatchCB *ctx) {
+	size_t i = 0, j = 0;
+	size_t na = a? a->len: 0, nb = b? b->len: 0;
+	while (i < na || j < nb) {
+		ut32 n;
+		if (j >= nb || (i < na && *(ut32 *)r_vector_index_ptr (a, i) < *(ut32 *)r_vector_index_ptr (b, j))) {
+			n = *(ut32 *)r_vector_index_ptr (a, i++);
+		} else {
+			n = *(ut32 *)r_vector_index_ptr (b, j++);
+		}
+		RSignItem *it = r_pvector_at (&idx->items, n);
+		if (filter && !filter (it, ctx)) {
+			continue;
+		}
+		if (ctx->cb && !ctx->cb (it, ctx->fcn, ctx->user)) {
+			return false;
+		}
 	}
+	return true;
+}
 
-	return 1;
+static bool graphFilter(RSignItem *it, struct ctxFcnMatchCB *ctx) {
+	return it->graph->cc >= ctx->mincc && fcnMetricsCmp (it, ctx->metrics);
 }
 
 R_API bool r_sign_match_graph(RAnal *a, RAnalFunction *fcn, int mincc, RSignGraphMatchCallback cb, void *user) {
-	struct ctxFcnMatchCB ctx = { a, fcn, cb, user, mincc };
-
 	if (!a || !fcn || !cb) {
 		return false;
 	}
-
-	return r_sign_foreach (a, graphMatchCB, &ctx);
-}
-
-static int addrMatchCB(RSignItem *it, void *user) {
-	struct ctxFcnMatchCB *ctx = (struct ctxFcnMatchCB *) user;
-
-	if (it->addr == UT64_MAX) {
-		return 1;
-	}
-
-	if (it->addr != ctx->fcn->addr) {
-		return 1;
+	RSignIndex *idx = sign_index (a);
+	if (!idx) {
+		return false;
 	}
-
-	if (ctx->cb) {
-		return ctx->cb (it, ctx->fcn, ctx->user);
+	if (!idx->graph->count && !idx->graph_any.len) {
+		return true;
 	}
-
-	return 1;
+	FcnMetrics m;
+	fcnMetrics (fcn, &m);
+	struct ctxFcnMatchCB ctx = { a, fcn, cb, user, mincc, &m, NULL };
+	RVector *bucket = ht_up_find (idx->graph, GRAPH_KEY (m.cc, m.nbbs), NULL);
+	return matchBuckets (idx, bucket, &idx->graph_any, graphFilter, &ctx);
 }
 
 R_API bool r_sign_match_addr(RAnal *a, RAnalFunction *fcn, RSignOffsetMatchCallback cb, void *user) {
-	struct ctxFcnMatchCB ctx = { a, fcn, cb, user, 0 };
-
 	if (!a || !fcn || !cb) {
 		return false;
 	}
-
-	return r_sign_foreach (a, addrMatchCB, &ctx);
-}
-
-static int hashMatchCB(RSignItem *it, void *user) {
-	struct ctxFcnMatchCB *ctx = (struct ctxFcnMatchCB *) user;
-	RSignHash *hash = it->hash;
-
-	if (!hash) {
-		return 1;
+	RSignIndex *idx = sign_index (a);
+	if (!idx) {
+		return false;
 	}
+	struct ctxFcnMatchCB ctx = { a, fcn, cb, user, 0, NULL, NULL };
+	return matchBuckets (idx, ht_up_find (idx->addr, fcn->addr, NULL), NULL, NULL, &ctx);
+}
 
-	if (!hash->bbhash || hash->bbhash[0] == 0) {
-		return 1;
+R_API bool r_sign_match_hash(RAnal *a, RAnalFunction *fcn, RSignHashMatchCallback cb, void *user) {
+	r_return_val_if_fail (a && fcn && cb, false);
+	RSignIndex *idx = sign_index (a);
+	if (!idx) {
+		return false;
 	}
-
-	char *digest_hex = NULL;
-	bool retval = false;
-	digest_hex = r_sign_calc_bbhash (ctx->anal, ctx->fcn);
-	if (strcmp (hash->bbhash, digest_hex)) {
-		goto beach;
+	if (!idx->bbhash->count) {
+		return true;
 	}
-
-	if (ctx->cb) {
-		retval = ctx->cb (it, ctx->fcn, ctx->user);
+	char *digest_hex = r_sign_calc_bbhash (a, fcn);
+	if (!digest_hex) {
+		return false;
 	}
-beach:
+	struct ctxFcnMatchCB ctx = { a, fcn, cb, user, 0, NULL, NULL };
+	bool retval = matchBuckets (idx, ht_pp_find (idx->bbhash, digest_hex, NULL), NULL, NULL, &ctx);
 	free (digest_hex);
 	return retval;
 }
 
-R_API bool r_sign_match_hash(RAnal *a, RAnalFunction *fcn, RSignHashMatchCallback cb, void *user) {
-	struct ctxFcnMatchCB ctx = { a, fcn, cb, user, 0 };
-
-	r_return_val_if_fail (a && fcn && cb, false);
-
-	return r_sign_foreach (a, hashMatchCB, &ctx);
+static bool refsFilter(RSignItem *it, struct ctxFcnMatchCB *ctx) {
+	return list_equal (it->refs, ctx->list);
 }
 
-
-static int refsMatchCB(RSignItem *it, void *user) {
-	struct ctxFcnMatchCB *ctx = (struct ctxFcnMatchCB *) user;
-	RList *refs = NULL;
-	char *ref_a = NULL, *ref_b = NULL;
-	int i = 0, retval = 1;
-
-	if (!it->refs) {
-		return 1;
-	}
-
-	// TODO(nibble): slow operation, add cache
-	refs = r_sign_fcn_refs (ctx->anal, ctx->fcn);
-	if (!refs) {
-		return 1;
+R_API bool r_sign_match_refs(RAnal *a, RAnalFunction *fcn, RSignRefsMatchCallback cb, void *user) {
+	r_return_val_if_fail (a && fcn && cb, false);
+	RSignIndex *idx = sign_index (a);
+	if (!idx) {
+		return false;
 	}
-
-	for (i = 0; ; i++) {
-		ref_a = (char *) r_list_get_n (it->refs, i);
-		ref_b = (char *) r_list_get_n (refs, i);
-
-		if (!ref_a || !ref_b) {
-			if (ref_a != ref_b) {
-				retval = 1;
-				goto out;
-			}
-			break;
-		}
-		if (strcmp (ref_a, ref_b)) {
-			retval = 1;
-			goto out;
-		}
+	if (!idx->refs->count) {
+		return true;
 	}
-
-	if (ctx->cb) {
-		retval = ctx->cb (it, ctx->fcn, ctx->user);
-		goto out;
+	RList *refs = r_sign_fcn_refs (a, fcn);
+	if (!refs) {
+		return true;
 	}
-
-out:
+	struct ctxFcnMatchCB ctx = { a, fcn, cb, user, 0, NULL, refs };
+	RVector *bucket = ht_up_find (idx->refs, list_fingerprint (refs), NULL);
+	bool retval = matchBuckets (idx, bucket, NULL, refsFilter, &ctx);
 	r_list_free (refs);
-
 	return retval;
 }
 
-R_API bool r_sign_match_refs(RAnal *a, RAnalFunction *fcn, RSignRefsMatchCallback cb, void *user) {
-	r_return_val_if_fail (a && fcn && cb, false);
-	struct ctxFcnMatchCB ctx = { a, fcn, cb, user, 0 };
-	return r_sign_foreach (a, refsMatchCB, &ctx);
+static bool varsFilter(RSignItem *it, struct ctxFcnMatchCB *ctx) {
+	return list_equal (it->vars, ctx->list);
 }
 
-static int varsMatchCB(RSignItem *it, void *user) {
-	struct ctxFcnMatchCB *ctx = (struct ctxFcnMatchCB *) user;
-	RList *vars = NULL;
-	char *var_a = NULL, *var_b = NULL;
-	int i = 0, retval = 1;
-
-	if (!it->vars) {
-		return 1;
-	}
-
-	// TODO(nibble): slow operation, add cache
-	vars = r_sign_fcn_vars (ctx->anal, ctx->fcn);
-	if (!vars) {
-		return 1;
+R_API bool r_sign_match_vars(RAnal *a, RAnalFunction *fcn, RSignVarsMatchCallback cb, void *user) {
+	r_return_val_if_fail (a && fcn && cb, false);
+	RSignIndex *idx = sign_index (a);
+	if (!idx) {
+		return false;
 	}
-
-	for (i = 0; ; i++) {
-		var_a = (char *) r_list_get_n (it->vars, i);
-		var_b = (char *) r_list_get_n (vars, i);
-
-		if (!var_a || !var_b) {
-			if (var_a != var_b) {
-				retval = 1;
-				goto out;
-			}
-			break;
-		}
-		if (strcmp (var_a, var_b)) {
-			retval = 1;
-			goto out;
-		}
+	if (!idx->vars->count) {
+		return true;
 	}
-
-	if (ctx->cb) {
-		retval = ctx->cb (it, ctx->fcn, ctx->user);
-		goto out;
+	RList *vars = r_sign_fcn_vars (a, fcn);
+	if (!vars) {
+		return true;
 	}
-
-out:
+	struct ctxFcnMatchCB ctx = { a, fcn, cb, user, 0, NULL, vars };
+	RVector *bucket = ht_up_find (idx->vars, list_fingerprint (vars), NULL);
+	bool retval = matchBuckets (idx, bucket, NULL, varsFilter, &ctx);
 	r_list_free (vars);
-
 	return retval;
 }
 
-R_API bool r_sign_match_vars(RAnal *a, RAnalFunction *fcn, RSignVarsMatchCallback cb, void *user) {
-	r_return_val_if_fail (a && fcn && cb, false);
-	struct ctxFcnMatchCB ctx = { a, fcn, cb, user, 0 };
-	return r_sign_foreach (a, varsMatchCB, &ctx);
-}
-
 
 R_API RSignItem *r_sign_item_new() {
 	RSignItem *ret = R_NEW0 (RSignItem);
@@ -1631,6 +1777,7 @@ R_API bool r_sign_load(RAnal *a, const char *file) {
 		return false;
 	}
 	sdb_foreach (db, loadCB, a);
+	r_sign_index_invalidate (a);
 	sdb_close (db);
 	sdb_free (db);
 	free (path);
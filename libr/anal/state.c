@@ -47,6 +47,7 @@ R_API void r_anal_state_insert_bb(RAnalState* state, RAnalBlock *bb) {
 	}
 	if (!r_anal_state_search_bb (state, bb->addr) && state->current_fcn) {
 		r_list_append (state->current_fcn->bbs, bb);
+		r_anal_fcn_invalidate (state->current_fcn);
 		state->bytes_consumed += state->current_bb->op_sz;
 		if (!ht_up_insert (state->ht, bb->addr, bb)) {
 			eprintf ("Inserted bb 0x%04"PFMT64x" failure\n", bb->addr);
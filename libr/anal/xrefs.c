@@ -24,6 +24,19 @@ xrefs
 // XXX: is it possible to have multiple type for the same (from, to) pair?
 //      if it is, things need to be adjusted
 
+// Every address in dict_refs/dict_xrefs maps to a flat vector of RAnalRef.
+// The head of the vector is sorted by ref->addr, new refs are appended to the
+// tail and merged in batches, so adding refs costs no allocation per ref and
+// the lookups and iterations work on the stored refs without cloning them.
+// Adding only looks for the address in the head, duplicates in the tail are
+// dropped by the merge.
+#define XREFS_BATCH 32
+
+typedef struct {
+	RVector refs; // RAnalRef
+	size_t sorted; // refs [0, sorted) are ordered by addr
+} XrefsAt;
+
 static RAnalRef *r_anal_ref_new(ut64 addr, ut64 at, ut64 type) {
 	RAnalRef *ref = R_NEW (RAnalRef);
 	if (ref) {
@@ -42,17 +55,97 @@ R_API RList *r_anal_ref_list_new() {
 	return r_list_newf (r_anal_ref_free);
 }
 
-static void xrefs_ht_free(HtUPKv *kv) {
-	ht_up_free (kv->value);
+static void xrefs_at_free(HtUPKv *kv) {
+	XrefsAt *xa = kv->value;
+	r_vector_clear (&xa->refs);
+	free (xa);
+}
+
+// stable merge sort by addr, so the last ref set for an address comes last
+static void refs_sort(RAnalRef *refs, RAnalRef *tmp, size_t n) {
+	if (n < 2) {
+		return;
+	}
+	size_t mid = n / 2, i = 0, j = mid, k = 0;
+	refs_sort (refs, tmp, mid);
+	refs_sort (refs + mid, tmp, n - mid);
+	while (i < mid && j < n) {
+		tmp[k++] = (refs[j].addr < refs[i].addr)? refs[j++]: refs[i++];
+	}
+	while (i < mid) {
+		tmp[k++] = refs[i++];
+	}
+	memcpy (refs, tmp, k * sizeof (RAnalRef));
+}
+
+static RAnalRef *xrefs_at_find(XrefsAt *xa, ut64 addr) {
+	RAnalRef *refs = xa->refs.a;
+	size_t lo = 0, hi = xa->sorted;
+	while (lo < hi) {
+		size_t mid = (lo + hi) / 2;
+		if (refs[mid].addr < addr) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+	if (lo < xa->sorted && refs[lo].addr == addr) {
+		return &refs[lo];
+	}
+	return NULL;
+}
+
+static void xrefs_at_merge(XrefsAt *xa) {
+	RAnalRef *refs = xa->refs.a;
+	RAnalRef *tail = refs + xa->sorted;
+	size_t i, j, n = xa->refs.len - xa->sorted, m = 0;
+	if (!n) {
+		return;
+	}
+	RAnalRef *tmp = malloc (n * sizeof (RAnalRef));
+	if (!tmp) {
+		return;
+	}
+	// the tail may set an address more than once and may update refs
+	// already in the head, the last one set wins
+	refs_sort (tail, tmp, n);
+	for (i = 0; i < n; i++) {
+		if (i + 1 < n && tail[i + 1].addr == tail[i].addr) {
+			continue;
+		}
+		RAnalRef *ref = xrefs_at_find (xa, tail[i].addr);
+		if (ref) {
+			ref->type = tail[i].type;
+		} else {
+			tmp[m++] = tail[i];
+		}
+	}
+	// merge the new refs backwards into the head
+	i = xa->sorted;
+	j = m;
+	size_t k = xa->sorted + m;
+	while (j > 0) {
+		if (i > 0 && refs[i - 1].addr > tmp[j - 1].addr) {
+			refs[--k] = refs[--i];
+		} else {
+			refs[--k] = tmp[--j];
+		}
+	}
+	free (tmp);
+	xa->refs.len = xa->sorted + m;
+	xa->sorted = xa->refs.len;
 }
 
-static void xrefs_ref_free(HtUPKv *kv) {
-	r_anal_ref_free (kv->value);
+// returns the merged refs at addr, or NULL when there are none
+static XrefsAt *xrefs_at(HtUP *m, ut64 addr) {
+	XrefsAt *xa = ht_up_find (m, addr, NULL);
+	if (xa) {
+		xrefs_at_merge (xa);
+	}
+	return xa;
 }
 
-static bool appendRef(void *u, const ut64 k, const void *v) {
-	RList *list = (RList *)u;
-	RAnalRef *ref = (RAnalRef *)v;
+static bool appendRef(RList *list, const RAnalRef *ref) {
 	RAnalRef *cloned = r_anal_ref_new (ref->addr, ref->at, ref->type);
 	if (cloned) {
 		r_list_append (list, cloned);
@@ -61,9 +154,19 @@ static bool appendRef(void *u, const ut64 k, const void *v) {
 	return false;
 }
 
+static void appendRefs(RList *list, XrefsAt *xa) {
+	RAnalRef *ref;
+	r_vector_foreach (&xa->refs, ref) {
+		if (!appendRef (list, ref)) {
+			break;
+		}
+	}
+}
+
 static bool mylistrefs_cb(void *list, const ut64 k, const void *v) {
-	HtUP *ht = (HtUP *)v;
-	ht_up_foreach (ht, appendRef, list);
+	XrefsAt *xa = (XrefsAt *)v;
+	xrefs_at_merge (xa);
+	appendRefs (list, xa);
 	return true;
 }
 
@@ -86,32 +189,70 @@ static int ref_cmp(const RAnalRef *a, const RAnalRef *b) {
 static void listxrefs(HtUP *m, ut64 addr, RList *list) {
 	if (addr == UT64_MAX) {
 		ht_up_foreach (m, mylistrefs_cb, list);
+		r_list_sort (list, (RListComparator)ref_cmp);
 	} else {
-		bool found;
-		HtUP *d = ht_up_find (m, addr, &found);
-		if (!found) {
-			return;
+		XrefsAt *xa = xrefs_at (m, addr);
+		if (xa) {
+			// already sorted by addr
+			appendRefs (list, xa);
 		}
-
-		ht_up_foreach (d, appendRef, list);
 	}
-	r_list_sort (list, (RListComparator)ref_cmp);
 }
 
 static void setxref(HtUP *m, ut64 from, ut64 to, int type) {
-	bool found;
-	HtUP *ht = ht_up_find (m, from, &found);
-	if (!found) {
-		ht = ht_up_new (NULL, xrefs_ref_free, NULL);
-		if (!ht) {
+	XrefsAt *xa = ht_up_find (m, from, NULL);
+	if (!xa) {
+		xa = R_NEW0 (XrefsAt);
+		if (!xa) {
 			return;
 		}
-		ht_up_insert (m, from, ht);
+		r_vector_init (&xa->refs, sizeof (RAnalRef), NULL, NULL);
+		ht_up_insert (m, from, xa);
 	}
-	RAnalRef *ref = r_anal_ref_new (to, from, type);
+	RAnalRef *ref = xrefs_at_find (xa, to);
 	if (ref) {
-		ht_up_update (ht, to, ref);
+		ref->type = (type == -1)? R_ANAL_REF_TYPE_CODE: type;
+		return;
+	}
+	RAnalRef r = { to, from, (type == -1)? R_ANAL_REF_TYPE_CODE: type };
+	if (!r_vector_push (&xa->refs, &r)) {
+		return;
+	}
+	// larger lists take larger batches to keep the merges amortized
+	if (xa->refs.len - xa->sorted > R_MAX (XREFS_BATCH, xa->sorted / 8)) {
+		xrefs_at_merge (xa);
+	}
+}
+
+static bool delxref(HtUP *m, ut64 from, ut64 to) {
+	XrefsAt *xa = xrefs_at (m, from);
+	if (!xa) {
+		return false;
+	}
+	RAnalRef *ref = xrefs_at_find (xa, to);
+	if (!ref) {
+		return false;
+	}
+	r_vector_remove_at (&xa->refs, ref - (RAnalRef *)xa->refs.a, NULL);
+	xa->sorted--;
+	if (!xa->refs.len) {
+		ht_up_delete (m, from);
 	}
+	return true;
+}
+
+static bool foreachxref(HtUP *m, ut64 addr, RAnalRefCb cb, void *user) {
+	XrefsAt *xa = xrefs_at (m, addr);
+	RAnalRef *ref;
+	if (!xa) {
+		return true;
+	}
+	r_vector_foreach (&xa->refs, ref) {
+		if (!cb (ref, user)) {
+			return false;
+		}
+	}
+	return true;
 }
 
 // set a reference from FROM to TO and a cross-reference(xref) from TO to FROM.
@@ -134,19 +275,13 @@ R_API int r_anal_xrefs_deln(RAnal *anal, ut64 from, ut64 to, const RAnalRefType
 	if (!anal) {
 		return false;
 	}
-	ht_up_delete (anal->dict_refs, from);
-	ht_up_delete (anal->dict_xrefs, to);
-	return true;
+	bool res = delxref (anal->dict_refs, from, to);
+	res |= delxref (anal->dict_xrefs, to, from);
+	return res;
 }
 
 R_API int r_anal_xref_del(RAnal *anal, ut64 from, ut64 to) {
-	bool res = false;
-	res |= r_anal_xrefs_deln (anal, from, to, R_ANAL_REF_TYPE_NULL);
-	res |= r_anal_xrefs_deln (anal, from, to, R_ANAL_REF_TYPE_CODE);
-	res |= r_anal_xrefs_deln (anal, from, to, R_ANAL_REF_TYPE_CALL);
-	res |= r_anal_xrefs_deln (anal, from, to, R_ANAL_REF_TYPE_DATA);
-	res |= r_anal_xrefs_deln (anal, from, to, R_ANAL_REF_TYPE_STRING);
-	return res;
+	return r_anal_xrefs_deln (anal, from, to, R_ANAL_REF_TYPE_NULL);
 }
 
 R_API int r_anal_xrefs_from(RAnal *anal, RList *list, const char *kind, const RAnalRefType type, ut64 addr) {
@@ -154,59 +289,69 @@ R_API int r_anal_xrefs_from(RAnal *anal, RList *list, const char *kind, const RA
 	return true;
 }
 
-R_API RList *r_anal_xrefs_get(RAnal *anal, ut64 to) {
-	RList *list = r_anal_ref_list_new ();
-	if (!list) {
+// iterate the xrefs to the given address without copying them, the refs must
+// not be modified from the callback
+R_API bool r_anal_xrefs_foreach(RAnal *anal, ut64 to, RAnalRefCb cb, void *user) {
+	r_return_val_if_fail (anal && cb, false);
+	return foreachxref (anal->dict_xrefs, to, cb, user);
+}
+
+R_API bool r_anal_refs_foreach(RAnal *anal, ut64 from, RAnalRefCb cb, void *user) {
+	r_return_val_if_fail (anal && cb, false);
+	return foreachxref (anal->dict_refs, from, cb, user);
+}
+
+static RList *xrefs_list_at(HtUP *m, ut64 addr) {
+	XrefsAt *xa = xrefs_at (m, addr);
+	if (!xa) {
 		return NULL;
 	}
-	listxrefs (anal->dict_xrefs, to, list);
-	if (r_list_empty (list)) {
-		r_list_free (list);
-		list = NULL;
+	RList *list = r_anal_ref_list_new ();
+	if (list) {
+		appendRefs (list, xa);
 	}
 	return list;
 }
 
+R_API RList *r_anal_xrefs_get(RAnal *anal, ut64 to) {
+	return xrefs_list_at (anal->dict_xrefs, to);
+}
+
 R_API RList *r_anal_refs_get(RAnal *anal, ut64 from) {
-	RList *list = r_anal_ref_list_new ();
-	if (!list) {
-		return NULL;
-	}
-	listxrefs (anal->dict_refs, from, list);
-	if (r_list_empty (list)) {
-		r_list_free (list);
-		list = NULL;
-	}
-	return list;
+	return xrefs_list_at (anal->dict_refs, from);
 }
 
 R_API RList *r_anal_xrefs_get_from(RAnal *anal, ut64 to) {
-	RList *list = r_anal_ref_list_new ();
-	if (!list) {
-		return NULL;
-	}
-	listxrefs (anal->dict_refs, to, list);
-	if (r_list_empty (list)) {
-		r_list_free (list);
-		list = NULL;
+	return xrefs_list_at (anal->dict_refs, to);
+}
+
+static bool collectrefs_cb(void *user, const ut64 k, const void *v) {
+	XrefsAt *xa = (XrefsAt *)v;
+	RAnalRef *ref;
+	xrefs_at_merge (xa);
+	r_vector_foreach (&xa->refs, ref) {
+		r_pvector_push ((RPVector *)user, ref);
 	}
-	return list;
+	return true;
 }
 
 R_API void r_anal_xrefs_list(RAnal *anal, int rad) {
-	RListIter *iter;
-	RAnalRef *ref;
+	void **it;
 	PJ *pj = NULL;
-	RList *list = r_anal_ref_list_new();
-	listxrefs (anal->dict_refs, UT64_MAX, list);
+	RPVector refs;
+	r_pvector_init (&refs, NULL);
+	ht_up_foreach (anal->dict_refs, collectrefs_cb, &refs);
+	r_pvector_sort (&refs, (RPVectorComparator)ref_cmp);
 	if (rad == 'j') {
 		pj = pj_new ();
 		if (!pj) {
+			r_pvector_clear (&refs);
 			return;
 		}
 		pj_a (pj);
 	}
-	r_list_foreach (list, iter, ref) {
+	r_pvector_foreach (&refs, it) {
+		RAnalRef *ref = *it;
 		int t = ref->type ? ref->type: ' ';
 		switch (rad) {
 		case '*':
@@ -266,7 +411,7 @@ R_API void r_anal_xrefs_list(RAnal *anal, int rad) {
 		anal->cb_printf ("%s", pj_string (pj));
 		pj_free (pj);
 	}
-	r_list_free (list);
+	r_pvector_clear (&refs);
 }
 
 R_API const char *r_anal_xrefs_type_tostring(RAnalRefType type) {
@@ -304,13 +449,13 @@ R_API bool r_anal_xrefs_init(RAnal *anal) {
 	ht_up_free (anal->dict_xrefs);
 	anal->dict_xrefs = NULL;
 
-	HtUP *tmp = ht_up_new (NULL, xrefs_ht_free, NULL);
+	HtUP *tmp = ht_up_new (NULL, xrefs_at_free, NULL);
 	if (!tmp) {
 		return false;
 	}
 	anal->dict_refs = tmp;
 
-	tmp = ht_up_new (NULL, xrefs_ht_free, NULL);
+	tmp = ht_up_new (NULL, xrefs_at_free, NULL);
 	if (!tmp) {
 		ht_up_free (anal->dict_refs);
 		anal->dict_refs = NULL;
@@ -0,0 +1,612 @@
+/* radare - LGPL - Copyright 2026 - agent */
+
+#include <r_bin.h>
+#include <r_hash.h>
+#include "i/private.h"
+
+// On-disk cache of the sections, imports, symbols, relocs and strings of a
+// bin object, as they are after rebasing and filtering. A cache file is a
+// header followed by arrays of fixed size records and the string table they
+// point into, so it is mapped and read in place: loading an item from it
+// only allocates the RBin structs and copies the strings they own. Files
+// are named after a hash of the contents of the binary, the plugin, the
+// item families that were asked for and every option that changes them.
+
+#define CACHE_MAGIC 0x43423252 // "R2BC"
+#define CACHE_VERSION 1
+#define CACHE_NOSTR UT32_MAX
+#define CACHE_CHUNK (1024 * 1024)
+
+enum {
+	TAB_SECTIONS,
+	TAB_IMPORTS,
+	TAB_SYMBOLS,
+	TAB_RELOCS,
+	TAB_STRINGS,
+	TAB_RIMPORTS, // imports and symbols referenced by the relocs
+	TAB_RSYMBOLS,
+	TAB_STRTAB, // its count is the size in bytes
+	TAB_LAST
+};
+
+typedef struct {
+	ut32 magic;
+	ut32 version;
+	ut8 key[R_HASH_SIZE_MD5];
+	ut32 items; // 1 << R_BIN_ITEM_* stored in the file
+	ut64 off[TAB_LAST];
+	ut64 count[TAB_LAST];
+} CacheHeader;
+
+// strings are offsets in the string table, CACHE_NOSTR for NULL
+typedef struct {
+	ut64 size, vsize, vaddr, paddr;
+	ut32 name, format, arch, perm;
+	st32 bits;
+	ut8 has_strings, add, is_data, is_segment;
+} CacheSection;
+
+typedef struct {
+	ut32 name, bind, type, classname, descriptor;
+	ut32 ordinal, visibility;
+} CacheImport;
+
+typedef struct {
+	ut64 vaddr, paddr, method_flags;
+	ut32 name, dname, classname, forwarder, bind, type, rtype, visibility_str;
+	ut32 size, ordinal, visibility;
+	st32 bits, dup_count;
+} CacheSymbol;
+
+typedef struct {
+	st64 addend;
+	ut64 vaddr, paddr;
+	ut32 symbol, import; // index + 1 in the reloc tables, 0 for none
+	ut32 visibility;
+	ut8 type, additive, is_ifunc;
+} CacheReloc;
+
+typedef struct {
+	ut64 vaddr, paddr;
+	ut32 string, ordinal, size, length;
+	char type;
+} CacheString;
+
+static const size_t tab_size[TAB_LAST] = {
+	sizeof (CacheSection), sizeof (CacheImport), sizeof (CacheSymbol),
+	sizeof (CacheReloc), sizeof (CacheString), sizeof (CacheImport),
+	sizeof (CacheSymbol), 1
+};
+
+struct r_bin_cache_t {
+	char *path;
+	ut8 key[R_HASH_SIZE_MD5];
+	bool verbose;
+	RMmap *map; // NULL unless a valid cache file was found
+	const CacheHeader *hdr;
+	const char *strtab;
+	RPVector rimports; // owned here, the relocs point to them
+	RPVector rsymbols;
+};
+
+static bool cache_key(RBinFile *bf, RBinObject *o, ut32 items, ut8 *key) {
+	RBin *bin = bf->rbin;
+	ut64 off, size = r_buf_size (bf->buf);
+	RHash *ctx = r_hash_new (false, R_HASH_MD5);
+	ut8 *buf = malloc (CACHE_CHUNK);
+	if (!ctx || !buf) {
+		r_hash_free (ctx);
+		free (buf);
+		return false;
+	}
+	r_hash_do_begin (ctx, R_HASH_MD5);
+	for (off = 0; off < size;) {
+		int n = r_buf_read_at (bf->buf, off, buf, (int)R_MIN (CACHE_CHUNK, size - off));
+		if (n <= 0) {
+			break;
+		}
+		r_hash_do_md5 (ctx, buf, n);
+		off += n;
+	}
+	size_t recs = 0;
+	int i;
+	for (i = 0; i < TAB_LAST; i++) {
+		recs = recs * 31 + tab_size[i];
+	}
+	char *opts = r_str_newf ("%d %s %"PFMT64x" %x %s %"PFMT64x" %"PFMT64x" %"PFMT64x" %"PFMT64x" %"PFMT64x
+		" %d %d %d %d %d %d %"PFMT64x" %d %s", CACHE_VERSION, R2_VERSION, (ut64)recs, items,
+		o->plugin->name, size, o->baddr, o->baddr_shift, o->loadaddr, o->boffset,
+		bin->filter, bin->minstrlen, bin->maxstrlen, bin->rawstr, bf->rawstr, bin->debase64,
+		bin->maxstrbuf, bin->strfilter, r_str_get (bin->strpurge));
+	if (opts) {
+		r_hash_do_md5 (ctx, (const ut8 *)opts, strlen (opts));
+	}
+	r_hash_do_end (ctx, R_HASH_MD5);
+	memcpy (key, ctx->digest, R_HASH_SIZE_MD5);
+	r_hash_free (ctx);
+	free (opts);
+	free (buf);
+	return opts != NULL;
+}
+
+static bool cache_check(RBinCache *c, ut32 items) {
+	const CacheHeader *hdr = (const CacheHeader *)c->map->buf;
+	ut64 len = c->map->len;
+	int i;
+	if (len < sizeof (CacheHeader) || hdr->magic != CACHE_MAGIC || hdr->version != CACHE_VERSION) {
+		return false;
+	}
+	if (memcmp (hdr->key, c->key, R_HASH_SIZE_MD5) || (hdr->items & items) != items) {
+		return false;
+	}
+	for (i = 0; i < TAB_LAST; i++) {
+		if (hdr->off[i] > len || hdr->off[i] % 8 || hdr->count[i] > (len - hdr->off[i]) / tab_size[i]) {
+			return false;
+		}
+	}
+	// every string offset below the size is terminated
+	ut64 strsize = hdr->count[TAB_STRTAB];
+	if (strsize && c->map->buf[hdr->off[TAB_STRTAB] + strsize - 1]) {
+		return false;
+	}
+	c->hdr = hdr;
+	c->strtab = (const char *)c->map->buf + hdr->off[TAB_STRTAB];
+	return true;
+}
+
+/* Find the cache file of o. items are the item families the caller wants,
+ * they are part of the key so each set of filter rules has its own file. */
+R_IPI RBinCache *r_bin_cache_new(RBinFile *bf, RBinObject *o, ut32 items) {
+	r_return_val_if_fail (bf && o && o->plugin, NULL);
+	RBin *bin = bf->rbin;
+	RBinCache *c = R_NEW0 (RBinCache);
+	if (!c) {
+		return NULL;
+	}
+	r_pvector_init (&c->rimports, r_bin_import_free);
+	r_pvector_init (&c->rsymbols, r_bin_symbol_free);
+	c->verbose = bin->verbose;
+	char *dir = bin->cachedir? r_file_abspath (bin->cachedir): r_str_home (R2_HOME_BINCACHE);
+	if (!dir || !cache_key (bf, o, items, c->key)) {
+		free (dir);
+		r_bin_cache_free (c);
+		return NULL;
+	}
+	char hex[R_HASH_SIZE_MD5 * 2 + 1];
+	r_hex_bin2str (c->key, R_HASH_SIZE_MD5, hex);
+	c->path = r_str_newf ("%s" R_SYS_DIR "%s", dir, hex);
+	free (dir);
+	if (c->path && r_file_exists (c->path)) {
+		c->map = r_file_mmap (c->path, false, 0);
+		if (c->map && !cache_check (c, items)) {
+			r_file_mmap_free (c->map);
+			c->map = NULL;
+		}
+	}
+	return c;
+}
+
+R_IPI void r_bin_cache_free(RBinCache *c) {
+	if (!c) {
+		return;
+	}
+	r_pvector_clear (&c->rimports);
+	r_pvector_clear (&c->rsymbols);
+	r_file_mmap_free (c->map);
+	free (c->path);
+	free (c);
+}
+
+// true if the items can be taken from the cache file
+R_IPI bool r_bin_cache_ready(RBinCache *c) {
+	return c && c->map;
+}
+
+static const void *table(RBinCache *c, int tab) {
+	return c->map->buf + c->hdr->off[tab];
+}
+
+// the const strings of the RBin structs point into the mapped file
+static const char *cstr(RBinCache *c, ut32 off) {
+	return off < c->hdr->count[TAB_STRTAB]? c->strtab + off: NULL;
+}
+
+static char *dstr(RBinCache *c, ut32 off) {
+	const char *s = cstr (c, off);
+	return s? strdup (s): NULL;
+}
+
+static RBinImport *import_from(RBinCache *c, const CacheImport *ci) {
+	RBinImport *imp = R_NEW0 (RBinImport);
+	if (imp) {
+		imp->name = dstr (c, ci->name);
+		imp->bind = cstr (c, ci->bind);
+		imp->type = cstr (c, ci->type);
+		imp->classname = dstr (c, ci->classname);
+		imp->descriptor = dstr (c, ci->descriptor);
+		imp->ordinal = ci->ordinal;
+		imp->visibility = ci->visibility;
+	}
+	return imp;
+}
+
+static RBinSymbol *symbol_from(RBinCache *c, const CacheSymbol *cs) {
+	RBinSymbol *sym = R_NEW0 (RBinSymbol);
+	if (sym) {
+		sym->name = dstr (c, cs->name);
+		// the filter makes dname and name the same string
+		sym->dname = cs->dname == cs->name? sym->name: (char *)cstr (c, cs->dname);
+		sym->classname = dstr (c, cs->classname);
+		sym->forwarder = cstr (c, cs->forwarder);
+		sym->bind = cstr (c, cs->bind);
+		sym->type = cstr (c, cs->type);
+		sym->rtype = cstr (c, cs->rtype);
+		sym->visibility_str = cstr (c, cs->visibility_str);
+		sym->vaddr = cs->vaddr;
+		sym->paddr = cs->paddr;
+		sym->size = cs->size;
+		sym->ordinal = cs->ordinal;
+		sym->visibility = cs->visibility;
+		sym->bits = cs->bits;
+		sym->method_flags = cs->method_flags;
+		sym->dup_count = cs->dup_count;
+	}
+	return sym;
+}
+
+static RList *get_sections(RBinCache *c) {
+	const CacheSection *cs = table (c, TAB_SECTIONS);
+	RList *list = r_list_newf ((RListFree)r_bin_section_free);
+	ut64 i;
+	for (i = 0; list && i < c->hdr->count[TAB_SECTIONS]; i++, cs++) {
+		RBinSection *s = R_NEW0 (RBinSection);
+		if (!s) {
+			break;
+		}
+		s->name = dstr (c, cs->name);
+		s->size = cs->size;
+		s->vsize = cs->vsize;
+		s->vaddr = cs->vaddr;
+		s->paddr = cs->paddr;
+		s->perm = cs->perm;
+		s->arch = cstr (c, cs->arch);
+		s->format = dstr (c, cs->format);
+		s->bits = cs->bits;
+		s->has_strings = cs->has_strings;
+		s->add = cs->add;
+		s->is_data = cs->is_data;
+		s->is_segment = cs->is_segment;
+		r_list_append (list, s);
+	}
+	return list;
+}
+
+static RList *get_imports(RBinCache *c) {
+	const CacheImport *ci = table (c, TAB_IMPORTS);
+	RList *list = r_list_newf (r_bin_import_free);
+	ut64 i;
+	for (i = 0; list && i < c->hdr->count[TAB_IMPORTS]; i++) {
+		RBinImport *imp = import_from (c, ci + i);
+		if (!imp) {
+			break;
+		}
+		r_list_append (list, imp);
+	}
+	return list;
+}
+
+static RList *get_symbols(RBinCache *c) {
+	const CacheSymbol *cs = table (c, TAB_SYMBOLS);
+	RList *list = r_list_newf (r_bin_symbol_free);
+	ut64 i;
+	for (i = 0; list && i < c->hdr->count[TAB_SYMBOLS]; i++) {
+		RBinSymbol *sym = symbol_from (c, cs + i);
+		if (!sym) {
+			break;
+		}
+		r_list_append (list, sym);
+	}
+	return list;
+}
+
+static RList *get_relocs(RBinCache *c) {
+	const CacheImport *ci = table (c, TAB_RIMPORTS);
+	const CacheSymbol *cs = table (c, TAB_RSYMBOLS);
+	const CacheReloc *cr = table (c, TAB_RELOCS);
+	ut64 i;
+	if (r_pvector_empty (&c->rimports)) {
+		for (i = 0; i < c->hdr->count[TAB_RIMPORTS]; i++) {
+			r_pvector_push (&c->rimports, import_from (c, ci + i));
+		}
+	}
+	if (r_pvector_empty (&c->rsymbols)) {
+		for (i = 0; i < c->hdr->count[TAB_RSYMBOLS]; i++) {
+			r_pvector_push (&c->rsymbols, symbol_from (c, cs + i));
+		}
+	}
+	RList *list = r_list_newf (free);
+	for (i = 0; list && i < c->hdr->count[TAB_RELOCS]; i++, cr++) {
+		RBinReloc *r = R_NEW0 (RBinReloc);
+		if (!r) {
+			break;
+		}
+		r->type = cr->type;
+		r->additive = cr->additive;
+		r->addend = cr->addend;
+		r->vaddr = cr->vaddr;
+		r->paddr = cr->paddr;
+		r->visibility = cr->visibility;
+		r->is_ifunc = cr->is_ifunc;
+		if (cr->import && cr->import <= r_pvector_len (&c->rimports)) {
+			r->import = r_pvector_at (&c->rimports, cr->import - 1);
+		}
+		if (cr->symbol && cr->symbol <= r_pvector_len (&c->rsymbols)) {
+			r->symbol = r_pvector_at (&c->rsymbols, cr->symbol - 1);
+		}
+		r_list_append (list, r);
+	}
+	return list;
+}
+
+static RList *get_strings(RBinCache *c) {
+	const CacheString *cs = table (c, TAB_STRINGS);
+	RList *list = r_list_newf (r_bin_string_free);
+	ut64 i;
+	for (i = 0; list && i < c->hdr->count[TAB_STRINGS]; i++, cs++) {
+		RBinString *s = R_NEW0 (RBinString);
+		if (!s) {
+			break;
+		}
+		s->string = dstr (c, cs->string);
+		if (!s->string) {
+			s->string = strdup ("");
+		}
+		s->vaddr = cs->vaddr;
+		s->paddr = cs->paddr;
+		s->ordinal = cs->ordinal;
+		s->size = cs->size;
+		s->length = cs->length;
+		s->type = cs->type;
+		r_list_append (list, s);
+	}
+	return list;
+}
+
+/* A new list with the items of a family as they were saved, NULL if the
+ * cache does not have them. The relocs are returned as a list to be
+ * inserted in the tree of the object. */
+R_IPI RList *r_bin_cache_get(RBinCache *c, int item) {
+	if (!r_bin_cache_ready (c) || !(c->hdr->items & (1 << item))) {
+		return NULL;
+	}
+	switch (item) {
+	case R_BIN_ITEM_SECTIONS:
+		return get_sections (c);
+	case R_BIN_ITEM_IMPORTS:
+		return get_imports (c);
+	case R_BIN_ITEM_SYMBOLS:
+		return get_symbols (c);
+	case R_BIN_ITEM_RELOCS:
+		return get_relocs (c);
+	case R_BIN_ITEM_STRINGS:
+		return get_strings (c);
+	}
+	return NULL;
+}
+
+typedef struct {
+	HtPP *strs; // string -> offset in the table
+	ut64 size;
+	ut8 *data;
+} StrTab;
+
+static ut32 intern(StrTab *st, const char *s) {
+	if (!s) {
+		return CACHE_NOSTR;
+	}
+	bool found = false;
+	ut64 off = (ut64)(size_t)ht_pp_find (st->strs, s, &found);
+	if (found) {
+		return (ut32)off;
+	}
+	off = st->size;
+	if (off + strlen (s) + 1 >= CACHE_NOSTR) {
+		return CACHE_NOSTR;
+	}
+	ht_pp_insert (st->strs, s, (void *)(size_t)off);
+	st->size += strlen (s) + 1;
+	return (ut32)off;
+}
+
+static bool strtab_copy(void *user, const void *k, const void *v) {
+	StrTab *st = user;
+	const char *s = k;
+	memcpy (st->data + (size_t)v, s, strlen (s) + 1);
+	return true;
+}
+
+static void import_to(StrTab *st, CacheImport *ci, RBinImport *imp) {
+	ci->name = intern (st, imp->name);
+	ci->bind = intern (st, imp->bind);
+	ci->type = intern (st, imp->type);
+	ci->classname = intern (st, imp->classname);
+	ci->descriptor = intern (st, imp->descriptor);
+	ci->ordinal = imp->ordinal;
+	ci->visibility = imp->visibility;
+}
+
+static void symbol_to(StrTab *st, CacheSymbol *cs, RBinSymbol *sym) {
+	cs->name = intern (st, sym->name);
+	cs->dname = intern (st, sym->dname);
+	cs->classname = intern (st, sym->classname);
+	cs->forwarder = intern (st, sym->forwarder);
+	cs->bind = intern (st, sym->bind);
+	cs->type = intern (st, sym->type);
+	cs->rtype = intern (st, sym->rtype);
+	cs->visibility_str = intern (st, sym->visibility_str);
+	cs->vaddr = sym->vaddr;
+	cs->paddr = sym->paddr;
+	cs->size = sym->size;
+	cs->ordinal = sym->ordinal;
+	cs->visibility = sym->visibility;
+	cs->bits = sym->bits;
+	cs->method_flags = sym->method_flags;
+	cs->dup_count = sym->dup_count;
+}
+
+// index + 1 of p in v, appending it the first time
+static ut32 ref_index(HtUP *refs, RPVector *v, void *p) {
+	if (!p) {
+		return 0;
+	}
+	ut32 idx = (ut32)(size_t)ht_up_find (refs, (ut64)(size_t)p, NULL);
+	if (!idx) {
+		r_pvector_push (v, p);
+		idx = r_pvector_len (v);
+		ht_up_insert (refs, (ut64)(size_t)p, (void *)(size_t)idx);
+	}
+	return idx;
+}
+
+/* Write the loaded items of o to the cache file. The file is replaced
+ * atomically so other sessions never map a partial one. */
+R_IPI bool r_bin_cache_save(RBinCache *c, RBinObject *o) {
+	r_return_val_if_fail (c && o, false);
+	CacheHeader hdr = { CACHE_MAGIC, CACHE_VERSION };
+	RPVector rimports, rsymbols;
+	RBinReloc *reloc;
+	RBIter it;
+	ut64 i, off;
+	bool ret = false;
+
+	memcpy (hdr.key, c->key, R_HASH_SIZE_MD5);
+	hdr.items = o->loaded & R_BIN_CACHE_ITEMS;
+	r_pvector_init (&rimports, NULL);
+	r_pvector_init (&rsymbols, NULL);
+	HtUP *irefs = ht_up_new0 ();
+	HtUP *srefs = ht_up_new0 ();
+	StrTab st = { ht_pp_new0 (), 0, NULL };
+	ut8 *data = NULL;
+	if (!irefs || !srefs || !st.strs) {
+		goto beach;
+	}
+	r_rbtree_foreach (o->relocs, it, reloc, RBinReloc, vrb) {
+		ref_index (irefs, &rimports, reloc->import);
+		ref_index (srefs, &rsymbols, reloc->symbol);
+		hdr.count[TAB_RELOCS]++;
+	}
+	hdr.count[TAB_SECTIONS] = o->sections? r_list_length (o->sections): 0;
+	hdr.count[TAB_IMPORTS] = o->imports? r_list_length (o->imports): 0;
+	hdr.count[TAB_SYMBOLS] = o->symbols? r_list_length (o->symbols): 0;
+	hdr.count[TAB_STRINGS] = o->strings? r_list_length (o->strings): 0;
+	hdr.count[TAB_RIMPORTS] = r_pvector_len (&rimports);
+	hdr.count[TAB_RSYMBOLS] = r_pvector_len (&rsymbols);
+	off = R_ROUND (sizeof (CacheHeader), 8);
+	for (i = 0; i < TAB_STRTAB; i++) {
+		hdr.off[i] = off;
+		off = R_ROUND (off + hdr.count[i] * tab_size[i], 8);
+	}
+	hdr.off[TAB_STRTAB] = off;
+	data = calloc (1, off);
+	if (!data) {
+		goto beach;
+	}
+
+	RListIter *iter;
+	RBinSection *s;
+	CacheSection *csec = (CacheSection *)(data + hdr.off[TAB_SECTIONS]);
+	r_list_foreach (o->sections, iter, s) {
+		csec->name = intern (&st, s->name);
+		csec->size = s->size;
+		csec->vsize = s->vsize;
+		csec->vaddr = s->vaddr;
+		csec->paddr = s->paddr;
+		csec->perm = s->perm;
+		csec->arch = intern (&st, s->arch);
+		csec->format = intern (&st, s->format);
+		csec->bits = s->bits;
+		csec->has_strings = s->has_strings;
+		csec->add = s->add;
+		csec->is_data = s->is_data;
+		csec->is_segment = s->is_segment;
+		csec++;
+	}
+	RBinImport *imp;
+	CacheImport *cimp = (CacheImport *)(data + hdr.off[TAB_IMPORTS]);
+	r_list_foreach (o->imports, iter, imp) {
+		import_to (&st, cimp++, imp);
+	}
+	RBinSymbol *sym;
+	CacheSymbol *csym = (CacheSymbol *)(data + hdr.off[TAB_SYMBOLS]);
+	r_list_foreach (o->symbols, iter, sym) {
+		symbol_to (&st, csym++, sym);
+	}
+	cimp = (CacheImport *)(data + hdr.off[TAB_RIMPORTS]);
+	for (i = 0; i < hdr.count[TAB_RIMPORTS]; i++) {
+		import_to (&st, cimp++, r_pvector_at (&rimports, i));
+	}
+	csym = (CacheSymbol *)(data + hdr.off[TAB_RSYMBOLS]);
+	for (i = 0; i < hdr.count[TAB_RSYMBOLS]; i++) {
+		symbol_to (&st, csym++, r_pvector_at (&rsymbols, i));
+	}
+	CacheReloc *crel = (CacheReloc *)(data + hdr.off[TAB_RELOCS]);
+	r_rbtree_foreach (o->relocs, it, reloc, RBinReloc, vrb) {
+		crel->type = reloc->type;
+		crel->additive = reloc->additive;
+		crel->addend = reloc->addend;
+		crel->vaddr = reloc->vaddr;
+		crel->paddr = reloc->paddr;
+		crel->visibility = reloc->visibility;
+		crel->is_ifunc = reloc->is_ifunc;
+		crel->import = ref_index (irefs, &rimports, reloc->import);
+		crel->symbol = ref_index (srefs, &rsymbols, reloc->symbol);
+		crel++;
+	}
+	RBinString *str;
+	CacheString *cstring = (CacheString *)(data + hdr.off[TAB_STRINGS]);
+	r_list_foreach (o->strings, iter, str) {
+		cstring->string = intern (&st, str->string);
+		cstring->vaddr = str->vaddr;
+		cstring->paddr = str->paddr;
+		cstring->ordinal = str->ordinal;
+		cstring->size = str->size;
+		cstring->length = str->length;
+		cstring->type = str->type;
+		cstring++;
+	}
+
+	hdr.count[TAB_STRTAB] = st.size;
+	if (off + st.size > ST32_MAX) {
+		goto beach;
+	}
+	ut8 *d = realloc (data, off + st.size);
+	if (!d) {
+		goto beach;
+	}
+	data = d;
+	st.data = data + off;
+	ht_pp_foreach (st.strs, strtab_copy, &st);
+	memcpy (data, &hdr, sizeof (hdr));
+
+	char *dir = r_file_dirname (c->path);
+	char *tmp = r_str_newf ("%s.%d", c->path, r_sys_getpid ());
+	if (dir && tmp && r_sys_mkdirp (dir) && r_file_dump (tmp, data, (int)(off + st.size), false)) {
+		ret = !rename (tmp, c->path);
+		if (!ret) {
+			r_file_rm (tmp);
+		}
+	}
+	if (!ret && c->verbose) {
+		eprintf ("Cannot write the bin cache to %s\n", c->path);
+	}
+	free (dir);
+	free (tmp);
+beach:
+	free (data);
+	ht_pp_free (st.strs);
+	ht_up_free (irefs);
+	ht_up_free (srefs);
+	r_pvector_clear (&rimports);
+	r_pvector_clear (&rsymbols);
+	return ret;
+}
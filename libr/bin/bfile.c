@@ -79,41 +79,100 @@ static void print_string(RBinFile *bf, RBinString *string, int raw) {
 	}
 }
 
-static int string_scan_range(RList *list, RBinFile *bf, int min,
-			      const ut64 from, const ut64 to, int type, int raw, RBinSection *section) {
-	ut8 tmp[R_STRING_SCAN_BUFFER_SIZE];
-	ut64 str_start, needle = from;
-	int count = 0, i, rc, runes;
-	int str_type = R_STRING_TYPE_DETECT;
-
-	// if list is null it means its gonna dump
-	r_return_val_if_fail (bf, -1);
+/* Strings are scanned in chunks on several threads and merged in address
+ * order. A chunk only starts right after STRSCAN_SYNC zero bytes: every
+ * decoder stops at a NUL unit so no string runs across them, and the scan
+ * steps on the byte that follows them wherever it comes from, so each chunk
+ * finds exactly the strings a single pass would. */
+#define STRSCAN_CHUNK (4 * 1024 * 1024)
+#define STRSCAN_SYNC 8
+
+typedef struct {
+	ut64 from;
+	ut64 to;
+	RPVector strings;
+} StrScanChunk;
+
+typedef struct {
+	RBinFile *bf;
+	const ut8 *data; // the whole range, when the buffer has it in memory
+	ut64 from;
+	ut64 to;
+	int min;
+	int type;
+	StrScanChunk *chunks;
+	int nchunks;
+	int next;
+	RThreadLock *lock;
+} StrScanJobs;
+
+static const ut8 *buf_bytes_at(RBuffer *b, ut64 from, ut64 to) {
+	if (b->iob || b->fd != -1 || b->sparse || b->empty || !b->buf || from < b->base) {
+		return NULL;
+	}
+	ut64 start = from - b->base + b->offset;
+	if (start + (to - from) > b->length) {
+		return NULL;
+	}
+	return b->buf + start;
+}
 
-	if (type == -1) {
-		type = R_STRING_TYPE_DETECT;
+// how many zero bytes p starts with, a word at a time
+static ut64 zero_run(const ut8 *p, ut64 n) {
+	ut64 w, i = 0;
+	while (i + sizeof (w) <= n) {
+		memcpy (&w, p + i, sizeof (w));
+		if (w) {
+			break;
+		}
+		i += sizeof (w);
 	}
-	if (from >= to) {
-		eprintf ("Invalid range to find strings 0x%"PFMT64x" .. 0x%"PFMT64x"\n", from, to);
-		return -1;
+	while (i < n && !p[i]) {
+		i++;
 	}
-	int len = to - from;
-	ut8 *buf = calloc (len, 1);
-	if (!buf || !min) {
-		free (buf);
-		return -1;
+	return i;
+}
+
+#define BYTES8(x) (0x0101010101010101ULL * (x))
+
+// true if the 8 bytes at p are all in ' '..'~' and none is a backslash
+static inline bool printable8(const ut8 *p) {
+	ut64 w;
+	memcpy (&w, p, sizeof (w));
+	if ((w | (w + BYTES8 (1))) & BYTES8 (0x80)) {
+		return false; // >= 0x7f
 	}
-	st64 vdelta = 0, pdelta = 0;
-	RBinSection *s = NULL;
-	r_buf_read_at (bf->buf, from, buf, len);
-	// may oobread
-	while (needle < to) {
-		rc = r_utf8_decode (buf + needle - from, to - needle, NULL);
+	if ((w - BYTES8 (0x20)) & ~w & BYTES8 (0x80)) {
+		return false; // < ' '
+	}
+	ut64 bs = w ^ BYTES8 ('\\');
+	return !((bs - BYTES8 (1)) & ~bs & BYTES8 (0x80));
+}
+
+static void scan_chunk(StrScanJobs *jobs, StrScanChunk *c, const ut8 *buf, ut64 bfrom) {
+	ut8 tmp[R_STRING_SCAN_BUFFER_SIZE];
+	const ut64 from = jobs->from, to = jobs->to;
+	ut64 str_start, needle = c->from;
+	int i, rc, runes;
+	int str_type = R_STRING_TYPE_DETECT;
+
+	while (needle < c->to) {
+		if (!buf[needle - bfrom]) {
+			// nothing is found in zero padding and the scan leaves it
+			// exactly at its end, so long runs are skipped at once
+			ut64 n = zero_run (buf + needle - bfrom, c->to - needle);
+			if (n >= STRSCAN_SYNC) {
+				needle += n;
+				continue;
+			}
+		}
+		rc = buf[needle - bfrom] < 0x80? 1: r_utf8_decode (buf + needle - bfrom, to - needle, NULL);
 		if (!rc) {
 			needle++;
 			continue;
 		}
-		if (type == R_STRING_TYPE_DETECT) {
-			char *w = (char *)buf + needle + rc - from;
+		if (jobs->type == R_STRING_TYPE_DETECT) {
+			char *w = (char *)buf + needle + rc - bfrom;
 			if ((to - needle) > 5 + rc) {
 				bool is_wide32 = (needle + rc + 2 < to) && (!w[0] && !w[1] && !w[2] && w[3] && !w[4]);
 				if (is_wide32) {
@@ -126,7 +185,7 @@ static int string_scan_range(RList *list, RBinFile *bf, int min,
 				str_type = R_STRING_TYPE_ASCII;
 			}
 		} else {
-			str_type = type;
+			str_type = jobs->type;
 		}
 		runes = 0;
 		str_start = needle;
@@ -135,18 +194,28 @@ static int string_scan_range(RList *list, RBinFile *bf, int min,
 		for (i = 0; i < sizeof (tmp) - 3 && needle < to; i += rc) {
 			RRune r = {0};
 
+			if (str_type == R_STRING_TYPE_ASCII || str_type == R_STRING_TYPE_UTF8) {
+				// copy runs of plain printable characters 8 at a time
+				if (needle + 8 <= to && i + 8 <= sizeof (tmp) - 3 && printable8 (buf + needle - bfrom)) {
+					memcpy (tmp + i, buf + needle - bfrom, 8);
+					needle += 8;
+					runes += 8;
+					rc = 8;
+					continue;
+				}
+			}
 			if (str_type == R_STRING_TYPE_WIDE32) {
-				rc = r_utf32le_decode (buf + needle - from, to - needle, &r);
+				rc = r_utf32le_decode (buf + needle - bfrom, to - needle, &r);
 				if (rc) {
 					rc = 4;
 				}
 			} else if (str_type == R_STRING_TYPE_WIDE) {
-				rc = r_utf16le_decode (buf + needle - from, to - needle, &r);
+				rc = r_utf16le_decode (buf + needle - bfrom, to - needle, &r);
 				if (rc == 1) {
 					rc = 2;
 				}
 			} else {
-				rc = r_utf8_decode (buf + needle - from, to - needle, &r);
+				rc = r_utf8_decode (buf + needle - bfrom, to - needle, &r);
 				if (rc > 1) {
 					str_type = R_STRING_TYPE_UTF8;
 				}
@@ -190,7 +259,7 @@ static int string_scan_range(RList *list, RBinFile *bf, int min,
 
 		tmp[i++] = '\0';
 
-		if (runes >= min) {
+		if (runes >= jobs->min) {
 			// reduce false positives
 			int j, num_blocks, *block_list;
 			if (str_type == R_STRING_TYPE_ASCII) {
@@ -226,12 +295,11 @@ static int string_scan_range(RList *list, RBinFile *bf, int min,
 			bs->type = str_type;
 			bs->length = runes;
 			bs->size = needle - str_start;
-			bs->ordinal = count++;
 			// TODO: move into adjust_offset
 			switch (str_type) {
 			case R_STRING_TYPE_WIDE:
 				if (str_start - from > 1) {
-					const ut8 *p = buf + str_start - 2 - from;
+					const ut8 *p = buf + str_start - 2 - bfrom;
 					if (p[0] == 0xff && p[1] == 0xfe) {
 						str_start -= 2; // \xff\xfe
 					}
@@ -239,43 +307,199 @@ static int string_scan_range(RList *list, RBinFile *bf, int min,
 				break;
 			case R_STRING_TYPE_WIDE32:
 				if (str_start - from > 3) {
-					const ut8 *p = buf + str_start - 4 - from;
+					const ut8 *p = buf + str_start - 4 - bfrom;
 					if (p[0] == 0xff && p[1] == 0xfe) {
 						str_start -= 4; // \xff\xfe\x00\x00
 					}
 				}
 				break;
 			}
-			if (!s) {
-				if (section) {
-					s = section;
-				} else if (bf->o) {
-					s = r_bin_get_section_at (bf->o, str_start, false);
-				}
-				if (s) {
-					vdelta = s->vaddr;
-					pdelta = s->paddr;
-				}
-			}
 			bs->paddr = str_start;
-			bs->vaddr = str_start - pdelta + vdelta;
 			bs->string = r_str_ndup ((const char *)tmp, i);
-			if (list) {
-				r_list_append (list, bs);
-				if (bf->o) {
-					ht_up_insert (bf->o->strings_db, bs->vaddr, bs);
-				}
-			} else {
-				print_string (bf, bs, raw);
+			if (!r_pvector_push (&c->strings, bs)) {
 				r_bin_string_free (bs);
+				break;
+			}
+		}
+	}
+}
+
+static int strscan_claim(StrScanJobs *jobs) {
+	if (!jobs->lock) {
+		return jobs->next++;
+	}
+	r_th_lock_enter (jobs->lock);
+	int i = jobs->next++;
+	r_th_lock_leave (jobs->lock);
+	return i;
+}
+
+static void strscan_run(StrScanJobs *jobs) {
+	int i;
+	while ((i = strscan_claim (jobs)) < jobs->nchunks) {
+		StrScanChunk *c = &jobs->chunks[i];
+		if (jobs->data) {
+			scan_chunk (jobs, c, jobs->data, jobs->from);
+			continue;
+		}
+		// a string never runs past the end of its chunk, the margins
+		// cover the lookahead and the BOM before the first one
+		ut64 bfrom = c->from - R_MIN (4, c->from - jobs->from);
+		ut64 bto = R_MIN (jobs->to, c->to + 4 * R_STRING_SCAN_BUFFER_SIZE + 16);
+		ut8 *buf = calloc (bto - bfrom, 1);
+		if (!buf) {
+			continue;
+		}
+		// RBuffer reads are not thread safe
+		if (jobs->lock) {
+			r_th_lock_enter (jobs->lock);
+		}
+		r_buf_read_at (jobs->bf->buf, bfrom, buf, (int)(bto - bfrom));
+		if (jobs->lock) {
+			r_th_lock_leave (jobs->lock);
+		}
+		scan_chunk (jobs, c, buf, bfrom);
+		free (buf);
+	}
+}
+
+static RThreadFunctionRet strscan_th(RThread *th) {
+	strscan_run (th->user);
+	return R_TH_STOP;
+}
+
+static void strscan_spawn(StrScanJobs *jobs, int nthreads) {
+	int i;
+	nthreads = R_MIN (nthreads, jobs->nchunks);
+	RThread **ths = nthreads > 1? R_NEWS0 (RThread *, nthreads - 1): NULL;
+	if (ths) {
+		jobs->lock = r_th_lock_new (false);
+	}
+	if (!ths || !jobs->lock) {
+		nthreads = 1;
+	}
+	for (i = 0; i < nthreads - 1; i++) {
+		ths[i] = r_th_new (strscan_th, jobs, 0);
+	}
+	// the calling thread works too
+	strscan_run (jobs);
+	for (i = 0; i < nthreads - 1; i++) {
+		if (ths[i]) {
+			r_th_wait (ths[i]);
+			r_th_free (ths[i]);
+		}
+	}
+	r_th_lock_free (jobs->lock);
+	jobs->lock = NULL;
+	free (ths);
+}
+
+// first address in [at, end) preceded by STRSCAN_SYNC zero bytes
+static ut64 strscan_sync(StrScanJobs *jobs, ut64 at, ut64 end) {
+	ut8 tmp[4096];
+	int zeros = 0;
+	while (at < end) {
+		int i, n = (int)R_MIN (sizeof (tmp), end - at);
+		const ut8 *p = tmp;
+		if (jobs->data) {
+			p = jobs->data + at - jobs->from;
+		} else if (r_buf_read_at (jobs->bf->buf, at, tmp, n) != n) {
+			break;
+		}
+		for (i = 0; i < n; i++) {
+			if (p[i]) {
+				zeros = 0;
+			} else if (++zeros == STRSCAN_SYNC) {
+				return at + i + 1;
 			}
-			if (from == 0 && to == bf->size) {
-				/* force lookup section at the next one */
-				s = NULL;
+		}
+		at += n;
+	}
+	return end;
+}
+
+static int string_scan_range(RList *list, RBinFile *bf, int min,
+			      const ut64 from, const ut64 to, int type, int raw, RBinSection *section) {
+	int i, count = 0;
+
+	// if list is null it means its gonna dump
+	r_return_val_if_fail (bf, -1);
+
+	if (type == -1) {
+		type = R_STRING_TYPE_DETECT;
+	}
+	if (from >= to) {
+		eprintf ("Invalid range to find strings 0x%"PFMT64x" .. 0x%"PFMT64x"\n", from, to);
+		return -1;
+	}
+	if (!min) {
+		return -1;
+	}
+	int nthreads = r_th_ncpus ();
+	// a few chunks per thread at a time, so dumps do not pile up
+	int batch = R_MAX (4, nthreads * 4);
+	StrScanChunk *chunks = R_NEWS0 (StrScanChunk, batch);
+	if (!chunks) {
+		return -1;
+	}
+	StrScanJobs jobs = {
+		.bf = bf,
+		.data = buf_bytes_at (bf->buf, from, to),
+		.from = from,
+		.to = to,
+		.min = min,
+		.type = type,
+		.chunks = chunks,
+	};
+	st64 vdelta = 0, pdelta = 0;
+	RBinSection *s = NULL;
+	ut64 at = from;
+	while (at < to) {
+		for (jobs.nchunks = 0; at < to && jobs.nchunks < batch; jobs.nchunks++) {
+			StrScanChunk *c = &chunks[jobs.nchunks];
+			c->from = at;
+			c->to = to - at > STRSCAN_CHUNK? strscan_sync (&jobs, at + STRSCAN_CHUNK, to): to;
+			r_pvector_init (&c->strings, NULL);
+			at = c->to;
+		}
+		jobs.next = 0;
+		strscan_spawn (&jobs, nthreads);
+		for (i = 0; i < jobs.nchunks; i++) {
+			RBinString *bs;
+			void **it;
+			r_pvector_foreach (&chunks[i].strings, it) {
+				bs = *it;
+				bs->ordinal = count++;
+				if (!s) {
+					if (section) {
+						s = section;
+					} else if (bf->o) {
+						s = r_bin_get_section_at (bf->o, bs->paddr, false);
+					}
+					if (s) {
+						vdelta = s->vaddr;
+						pdelta = s->paddr;
+					}
+				}
+				bs->vaddr = bs->paddr - pdelta + vdelta;
+				if (list) {
+					r_list_append (list, bs);
+					if (bf->o) {
+						ht_up_insert (bf->o->strings_db, bs->vaddr, bs);
+					}
+				} else {
+					print_string (bf, bs, raw);
+					r_bin_string_free (bs);
+				}
+				if (from == 0 && to == bf->size) {
+					/* force lookup section at the next one */
+					s = NULL;
+				}
 			}
+			r_pvector_clear (&chunks[i].strings);
 		}
 	}
-	free (buf);
+	free (chunks);
 	return count;
 }
 
@@ -351,6 +575,7 @@ R_IPI RBinFile *r_bin_file_new(RBin *bin, const char *file, const ut8 *bytes, ut
 	binfile->size = file_sz;
 	binfile->xtr_data = r_list_newf ((RListFree)r_bin_xtrdata_free);
 	binfile->objs = r_list_newf ((RListFree)r_bin_object_free);
+	binfile->addrlines = r_bin_linetable_new ();
 	binfile->xtr_obj = NULL;
 
 	if (!binfile->buf) {
@@ -687,6 +912,7 @@ R_API void r_bin_file_free(void /*RBinFile*/ *bf_) {
 		sdb_free (a->sdb_addrinfo);
 		a->sdb_addrinfo = NULL;
 	}
+	r_bin_linetable_free (a->addrlines);
 	free (a->file);
 	a->o = NULL;
 	r_list_free (a->objs);
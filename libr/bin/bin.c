@@ -546,6 +546,7 @@ R_API void *r_bin_free(RBin *bin) {
 	bin->file = NULL;
 	free (bin->force);
 	free (bin->srcdir);
+	free (bin->cachedir);
 	//r_bin_free_bin_files (bin);
 	r_list_free (bin->binfiles);
 	r_list_free (bin->binxtrs);
@@ -735,9 +736,17 @@ R_API RList *r_bin_get_fields(RBin *bin) {
 	return o ? o->fields : NULL;
 }
 
+static RBinObject *cur_object_with(RBin *bin, int item) {
+	RBinObject *o = r_bin_cur_object (bin);
+	if (o) {
+		r_bin_object_load_item (bin->cur, o, item);
+	}
+	return o;
+}
+
 R_API RList *r_bin_get_imports(RBin *bin) {
 	r_return_val_if_fail (bin, NULL);
-	RBinObject *o = r_bin_cur_object (bin);
+	RBinObject *o = cur_object_with (bin, R_BIN_ITEM_IMPORTS);
 	return o ? o->imports : NULL;
 }
 
@@ -779,7 +788,7 @@ R_API RList *r_bin_patch_relocs_list(RBin *bin) {
 
 R_API RBNode *r_bin_get_relocs(RBin *bin) {
 	r_return_val_if_fail (bin, NULL);
-	RBinObject *o = r_bin_cur_object (bin);
+	RBinObject *o = cur_object_with (bin, R_BIN_ITEM_RELOCS);
 	return o ? o->relocs : NULL;
 }
 
@@ -830,6 +839,7 @@ R_API RList *r_bin_reset_strings(RBin *bin) {
 		return NULL;
 	}
 	a->rawstr = bin->rawstr;
+	o->loaded |= 1 << R_BIN_ITEM_STRINGS;
 
 	if (plugin && plugin->strings) {
 		o->strings = plugin->strings (a);
@@ -844,7 +854,7 @@ R_API RList *r_bin_reset_strings(RBin *bin) {
 
 R_API RList *r_bin_get_strings(RBin *bin) {
 	r_return_val_if_fail (bin, NULL);
-	RBinObject *o = r_bin_cur_object (bin);
+	RBinObject *o = cur_object_with (bin, R_BIN_ITEM_STRINGS);
 	return o ? o->strings : NULL;
 }
 
@@ -868,7 +878,7 @@ R_API int r_bin_is_string(RBin *bin, ut64 va) {
 
 R_API RList *r_bin_get_symbols(RBin *bin) {
 	r_return_val_if_fail (bin, NULL);
-	RBinObject *o = r_bin_cur_object (bin);
+	RBinObject *o = cur_object_with (bin, R_BIN_ITEM_SYMBOLS);
 	return o? o->symbols: NULL;
 }
 
@@ -1291,7 +1301,7 @@ R_API RBuffer *r_bin_package(RBin *bin, const char *type, const char *file, RLis
 
 R_API RList * /*<RBinClass>*/ r_bin_get_classes(RBin *bin) {
 	r_return_val_if_fail (bin, NULL);
-	RBinObject *o = r_bin_cur_object (bin);
+	RBinObject *o = cur_object_with (bin, R_BIN_ITEM_CLASSES);
 	return o ? o->classes : NULL;
 }
 
@@ -80,6 +80,7 @@ R_API int r_bin_load_languages(RBinFile *binfile) {
 		return R_BIN_NM_NONE;
 	}
 
+	r_bin_object_load_item (binfile, o, R_BIN_ITEM_SYMBOLS);
 	r_list_foreach (o->symbols, iter, sym) {
 		char *lib;
 		if (!cantbe.rust) {
@@ -27,28 +27,20 @@ R_API char *r_bin_addr2text(RBin *bin, ut64 addr, int origin) {
 	if (!bin || !bin->cur) {
 		return NULL;
 	}
-	{
-		char *key = r_str_newf ("0x%"PFMT64x, addr);
-		char *file_line = sdb_get (bin->cur->sdb_addrinfo, key, 0);
-		if (file_line) {
-			char *token = strchr (file_line, '|');
-			if (token) {
-				*token ++ = 0;
-				line = atoi (token);
-				out = r_file_slurp_line (file_line, line, 0);
-				*token ++ = ':';
-			}
-		}
-		free (key);
+	const char *path;
+	ut32 uline;
+	if (bin->cur->addrlines && r_bin_linetable_get (bin->cur->addrlines, addr, &path, &uline)) {
+		line = uline;
+		out = r_file_slurp_line (path, line, 0);
 		if (out) {
 			if (origin > 1) {
-				file_nopath = file_line;
+				file_nopath = (char *)path;
 			} else {
-				file_nopath = strrchr (file_line, '/');
+				file_nopath = strrchr (path, '/');
 				if (file_nopath) {
 					file_nopath ++;
 				} else {
-					file_nopath = file_line;
+					file_nopath = (char *)path;
 				}
 			}
 			if (origin) {
@@ -61,7 +53,6 @@ R_API char *r_bin_addr2text(RBin *bin, ut64 addr, int origin) {
 			}
 			return out;
 		}
-		free (file_line);
 	}
 	file[0] = 0;
 	if (r_bin_addr2line (bin, addr, file, sizeof (file), &line)) {
@@ -390,13 +390,10 @@ beach:
 	return buf;
 }
 
-static inline void add_sdb_addrline(Sdb *s, ut64 addr, const char *file, ut64 line, FILE *f, int mode) {
+static inline void add_addrline(RBinLineTable *lt, ut64 addr, const char *file, ut64 line, FILE *f, int mode) {
 	const char *p;
-	char *fileline;
-	char offset[64];
-	char *offset_ptr;
 
-	if (!s || !file) {
+	if (!lt || !file) {
 		return;
 	}
 	p = r_str_rchr (file, NULL, '/');
@@ -416,19 +413,7 @@ static inline void add_sdb_addrline(Sdb *s, ut64 addr, const char *file, ut64 li
 		fprintf (f, "CL %s:%d 0x%08"PFMT64x"\n", p, (int)line, addr);
 		break;
 	}
-#if 0
-	/* THIS IS TOO SLOW */
-	if (r_file_exists (file)) {
-		p = file;
-	}
-#else
-	p = file;
-#endif
-	fileline = r_str_newf ("%s|%"PFMT64d, p, line);
-	offset_ptr = sdb_itoa (addr, offset, 16);
-	sdb_add (s, offset_ptr, fileline, 0);
-	sdb_add (s, fileline, offset_ptr, 0);
-	free (fileline);
+	r_bin_linetable_add (lt, addr, file, (ut32)line);
 }
 
 static const ut8* r_bin_dwarf_parse_ext_opcode(const RBin *a, const ut8 *obuf,
@@ -462,10 +447,10 @@ static const ut8* r_bin_dwarf_parse_ext_opcode(const RBin *a, const ut8 *obuf,
 	case DW_LNE_end_sequence:
 		regs->end_sequence = DWARF_TRUE;
 
-		if (binfile && binfile->sdb_addrinfo && hdr->file_names) {
+		if (binfile && binfile->addrlines && hdr->file_names) {
 			int fnidx = regs->file - 1;
 			if (fnidx >= 0 && fnidx < hdr->file_names_count) {
-				add_sdb_addrline(binfile->sdb_addrinfo, regs->address,
+				add_addrline (binfile->addrlines, regs->address,
 						hdr->file_names[fnidx].name, regs->line, f, mode);
 			}
 		}
@@ -545,10 +530,10 @@ static const ut8* r_bin_dwarf_parse_spec_opcode(
 			advance_adr, regs->address, hdr->line_base +
 			(adj_opcode % hdr->line_range), regs->line);
 	}
-	if (binfile && binfile->sdb_addrinfo && hdr->file_names) {
+	if (binfile && binfile->addrlines && hdr->file_names) {
 		int idx = regs->file -1;
 		if (idx >= 0 && idx < hdr->file_names_count) {
-			add_sdb_addrline (binfile->sdb_addrinfo, regs->address,
+			add_addrline (binfile->addrlines, regs->address,
 					hdr->file_names[idx].name,
 					regs->line, f, mode);
 		}
@@ -582,10 +567,10 @@ static const ut8* r_bin_dwarf_parse_std_opcode(
 		if (f) {
 			fprintf (f, "Copy\n");
 		}
-		if (binfile && binfile->sdb_addrinfo && hdr->file_names) {
+		if (binfile && binfile->addrlines && hdr->file_names) {
 			int fnidx = regs->file - 1;
 			if (fnidx >= 0 && fnidx < hdr->file_names_count) {
-				add_sdb_addrline (binfile->sdb_addrinfo,
+				add_addrline (binfile->addrlines,
 					regs->address,
 					hdr->file_names[fnidx].name,
 					regs->line, f, mode);
@@ -1642,6 +1627,17 @@ static void r_bin_dwarf_row_free(void *p) {
 	free (row);
 }
 
+static bool add_row(void *user, ut64 addr, const char *file, ut32 line) {
+	RBinDwarfRow *row = r_bin_dwarf_row_new (addr, file, line, 0);
+	if (!row || !r_list_append (user, row)) {
+		if (row) {
+			r_bin_dwarf_row_free (row);
+		}
+		return false;
+	}
+	return true;
+}
+
 R_API RList *r_bin_dwarf_parse_line(RBin *a, int mode) {
 	ut8 *buf;
 	RList *list = NULL;
@@ -1669,34 +1665,9 @@ R_API RList *r_bin_dwarf_parse_line(RBin *a, int mode) {
 		}
 		list->free = r_bin_dwarf_row_free;
 		r_bin_dwarf_parse_line_raw2 (a, buf, len, mode);
-		// k bin/cur/addrinfo/*
-		SdbListIter *iter;
-		SdbKv *kv;
-		SdbList *ls = sdb_foreach_list (binfile->sdb_addrinfo, false);
-		ls_foreach (ls, iter, kv) {
-			if (!strncmp (sdbkv_key (kv), "0x", 2)) {
-				ut64 addr;
-				RBinDwarfRow *row;
-				int line;
-				char *file = strdup (sdbkv_value (kv));
-				if (!file) {
-					free (buf);
-					ls_free (ls);
-					r_list_free (list);
-					return NULL;
-				}
-				char *tok = strchr (file, '|');
-				if (tok) {
-					*tok++ = 0;
-					line = atoi (tok);
-					addr = r_num_math (NULL, sdbkv_key (kv));
-					row = r_bin_dwarf_row_new (addr, file, line, 0);
-					r_list_append (list, row);
-				}
-				free (file);
-			}
+		if (binfile->addrlines) {
+			r_bin_linetable_foreach (binfile->addrlines, add_row, list);
 		}
-		ls_free (ls);
 		free (buf);
 	}
 	return list;
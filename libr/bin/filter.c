@@ -62,13 +62,8 @@ R_API char *r_bin_filter_name(RBinFile *bf, Sdb *db, ut64 vaddr, char *name) {
 	return resname;
 }
 
-R_API void r_bin_filter_sym(RBinFile *bf, Sdb *db, ut64 vaddr, RBinSymbol *sym) {
-	if (!db || !sym || !sym->name) {
-		return;
-	}
-	char *name = sym->name;
-	// if (!strncmp (sym->name, "imp.", 4)) {
-	// demangle symbol name depending on the language specs if any
+// demangle symbol name depending on the language specs if any
+static void filter_demangle(RBinFile *bf, RBinSymbol *sym) {
 	if (bf && bf->o && bf->o->lang) {
 		const char *lang = r_bin_lang_tostring (bf->o->lang);
 		char *dn = r_bin_demangle (bf, lang, sym->name, sym->vaddr);
@@ -93,8 +88,17 @@ R_API void r_bin_filter_sym(RBinFile *bf, Sdb *db, ut64 vaddr, RBinSymbol *sym)
 			}
 		}
 	}
+}
+
+R_API void r_bin_filter_sym(RBinFile *bf, Sdb *db, ut64 vaddr, RBinSymbol *sym) {
+	if (!db || !sym || !sym->name) {
+		return;
+	}
+	char *name = sym->name;
+	// if (!strncmp (sym->name, "imp.", 4)) {
+	filter_demangle (bf, sym);
 
-	// XXX this is very slow, must be optimized
+	// XXX this is very slow, see r_bin_filter_symbols for whole lists
 	const char *uname = sdb_fmt ("%" PFMT64x ".%s", vaddr, name);
 	ut32 vhash = sdb_hash (uname); // vaddr hash - unique
 	ut32 hash = sdb_hash (name); // name hash - if dupped and not in unique hash must insert
@@ -107,18 +111,67 @@ R_API void r_bin_filter_sym(RBinFile *bf, Sdb *db, ut64 vaddr, RBinSymbol *sym)
 	sym->dup_count = count - 1;
 }
 
+typedef struct {
+	const char *name;
+	ut32 hash;
+	ut32 count; // symbols seen with this name
+} FilterName;
+
+typedef struct {
+	ut64 vaddr;
+	ut32 name; // index + 1 of its FilterName, 0 for a free slot
+} FilterAddr;
+
+/* Same as calling r_bin_filter_sym on each symbol with a shared db, but
+ * counting the names in open addressing tables sized for the list: the
+ * names are compared, not just their hashes, and nothing is formatted. */
 R_API void r_bin_filter_symbols(RBinFile *bf, RList *list) {
-	Sdb *db = sdb_new0 ();
-	if (db) {
-		RListIter *iter;
-		RBinSymbol *sym;
-		r_list_foreach (list, iter, sym) {
-			if (sym && sym->name && *sym->name) {
-				r_bin_filter_sym (bf, db, sym->vaddr, sym);
-			}
+	r_return_if_fail (list);
+	ut32 n = 16;
+	while (n < 2 * r_list_length (list) && n < UT32_MAX / 2) {
+		n <<= 1;
+	}
+	const ut32 mask = n - 1;
+	FilterName *names = R_NEWS0 (FilterName, n);
+	FilterAddr *addrs = R_NEWS0 (FilterAddr, n);
+	if (!names || !addrs) {
+		free (names);
+		free (addrs);
+		return;
+	}
+	RListIter *iter;
+	RBinSymbol *sym;
+	r_list_foreach (list, iter, sym) {
+		if (!sym || !sym->name || !*sym->name) {
+			continue;
+		}
+		// the count is for the name before demangling, which is not freed
+		const char *name = sym->name;
+		filter_demangle (bf, sym);
+		ut32 hash = sdb_hash (name);
+		ut32 i = hash & mask;
+		while (names[i].name && (names[i].hash != hash || strcmp (names[i].name, name))) {
+			i = (i + 1) & mask;
+		}
+		if (!names[i].name) {
+			names[i].name = name;
+			names[i].hash = hash;
+		}
+		ut32 count = ++names[i].count;
+		ut32 j = (ut32)(((sym->vaddr ^ i) * 0x9e3779b97f4a7c15ULL) >> 32) & mask;
+		while (addrs[j].name && (addrs[j].vaddr != sym->vaddr || addrs[j].name != i + 1)) {
+			j = (j + 1) & mask;
+		}
+		if (addrs[j].name) {
+			// TODO: symbol is dupped, so symbol can be removed!
+			continue;
 		}
-		sdb_free (db);
+		addrs[j].vaddr = sym->vaddr;
+		addrs[j].name = i + 1;
+		sym->dup_count = count - 1;
 	}
+	free (names);
+	free (addrs);
 }
 
 R_API void r_bin_filter_sections(RBinFile *bf, RList *list) {
@@ -31,6 +31,17 @@ R_IPI RBinObject *r_bin_object_get_cur(RBin *bin);
 R_IPI RBinObject *r_bin_object_find_by_arch_bits(RBinFile *binfile, const char *arch, int bits, const char *name);
 R_IPI RBNode *r_bin_object_patch_relocs(RBin *bin, RBinObject *o);
 
+// item families kept in the bin cache
+#define R_BIN_CACHE_ITEMS ((1 << R_BIN_ITEM_SECTIONS) | (1 << R_BIN_ITEM_IMPORTS) | \
+	(1 << R_BIN_ITEM_SYMBOLS) | (1 << R_BIN_ITEM_RELOCS) | (1 << R_BIN_ITEM_STRINGS))
+
+typedef struct r_bin_cache_t RBinCache;
+R_IPI RBinCache *r_bin_cache_new(RBinFile *bf, RBinObject *o, ut32 items);
+R_IPI void r_bin_cache_free(RBinCache *c);
+R_IPI bool r_bin_cache_ready(RBinCache *c);
+R_IPI RList *r_bin_cache_get(RBinCache *c, int item);
+R_IPI bool r_bin_cache_save(RBinCache *c, RBinObject *o);
+
 R_IPI const char *r_bin_lang_tostring(int lang);
 R_IPI int r_bin_lang_type(RBinFile *binfile, const char *def, const char *sym);
 R_IPI bool r_bin_lang_swift(RBinFile *binfile);
@@ -0,0 +1,279 @@
+/* radare - LGPL - Copyright 2026 - agent */
+
+#include <r_bin.h>
+
+// Source line information of a binary file. Debug info formats add one row
+// per address in any order, and the rows are sorted by address (keeping the
+// first row added for each one) the first time the table is queried. File
+// names are interned so a row only takes 16 bytes.
+
+R_API RBinLineTable *r_bin_linetable_new(void) {
+	RBinLineTable *lt = R_NEW0 (RBinLineTable);
+	if (!lt) {
+		return NULL;
+	}
+	r_pvector_init (&lt->files, free);
+	r_vector_init (&lt->rows, sizeof (RBinLineRow), NULL, NULL);
+	lt->file_idx = ht_pp_new0 ();
+	if (!lt->file_idx) {
+		free (lt);
+		return NULL;
+	}
+	lt->sorted = true;
+	return lt;
+}
+
+R_API void r_bin_linetable_reset(RBinLineTable *lt) {
+	r_return_if_fail (lt);
+	r_pvector_clear (&lt->files);
+	r_vector_clear (&lt->rows);
+	ht_pp_free (lt->file_idx);
+	lt->file_idx = ht_pp_new0 ();
+	R_FREE (lt->by_line);
+	lt->last_file = 0;
+	lt->sorted = true;
+}
+
+R_API void r_bin_linetable_free(RBinLineTable *lt) {
+	if (!lt) {
+		return;
+	}
+	r_pvector_clear (&lt->files);
+	r_vector_clear (&lt->rows);
+	ht_pp_free (lt->file_idx);
+	free (lt->by_line);
+	free (lt);
+}
+
+static ut32 file_intern(RBinLineTable *lt, const char *file) {
+	// consecutive rows almost always come from the same file
+	if (lt->last_file && !strcmp (r_pvector_at (&lt->files, lt->last_file - 1), file)) {
+		return lt->last_file;
+	}
+	bool found = false;
+	ut32 idx = (ut32)(size_t)ht_pp_find (lt->file_idx, file, &found);
+	if (!found) {
+		char *name = strdup (file);
+		if (!name || !r_pvector_push (&lt->files, name)) {
+			free (name);
+			return 0;
+		}
+		idx = r_pvector_len (&lt->files);
+		ht_pp_insert (lt->file_idx, file, (void *)(size_t)idx);
+	}
+	lt->last_file = idx;
+	return idx;
+}
+
+static ut32 file_lookup(RBinLineTable *lt, const char *file) {
+	bool found = false;
+	ut32 idx = (ut32)(size_t)ht_pp_find (lt->file_idx, file, &found);
+	return found? idx: 0;
+}
+
+// stable, so the first row added for an address is the one that stays
+static void rows_sort(RBinLineRow *rows, RBinLineRow *tmp, size_t n) {
+	size_t w, i;
+	for (w = 1; w < n; w *= 2) {
+		for (i = 0; i < n; i += 2 * w) {
+			size_t l = i, m = R_MIN (i + w, n), r = m, e = R_MIN (i + 2 * w, n), o = i;
+			if (m >= e || rows[m - 1].addr <= rows[m].addr) {
+				memcpy (tmp + i, rows + i, (e - i) * sizeof (RBinLineRow));
+				continue;
+			}
+			while (l < m && r < e) {
+				tmp[o++] = rows[r].addr < rows[l].addr? rows[r++]: rows[l++];
+			}
+			while (l < m) {
+				tmp[o++] = rows[l++];
+			}
+			while (r < e) {
+				tmp[o++] = rows[r++];
+			}
+		}
+		memcpy (rows, tmp, n * sizeof (RBinLineRow));
+	}
+}
+
+static void linetable_finalize(RBinLineTable *lt) {
+	if (lt->sorted) {
+		return;
+	}
+	RBinLineRow *rows = lt->rows.a;
+	size_t i, n = lt->rows.len, o = 0;
+	RBinLineRow *tmp = R_NEWS (RBinLineRow, n);
+	if (!tmp) {
+		return;
+	}
+	rows_sort (rows, tmp, n);
+	free (tmp);
+	for (i = 0; i < n; i++) {
+		if (!o || rows[o - 1].addr != rows[i].addr) {
+			rows[o++] = rows[i];
+		}
+	}
+	lt->rows.len = o;
+	r_vector_shrink (&lt->rows);
+	lt->sorted = true;
+}
+
+// index of the first row with an address not below addr
+static size_t rows_lower_bound(RBinLineTable *lt, ut64 addr) {
+	const RBinLineRow *rows = lt->rows.a;
+	size_t lo = 0, hi = lt->rows.len;
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+		if (rows[mid].addr < addr) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+	return lo;
+}
+
+R_API bool r_bin_linetable_add(RBinLineTable *lt, ut64 addr, const char *file, ut32 line) {
+	r_return_val_if_fail (lt && file, false);
+	ut32 idx = file_intern (lt, file);
+	if (!idx) {
+		return false;
+	}
+	if (lt->rows.len) {
+		const RBinLineRow *last = r_vector_index_ptr (&lt->rows, lt->rows.len - 1);
+		if (lt->sorted && last->addr == addr) {
+			return false;
+		}
+		if (addr < last->addr) {
+			lt->sorted = false;
+		}
+	}
+	RBinLineRow row = { addr, idx - 1, line };
+	if (!r_vector_push (&lt->rows, &row)) {
+		return false;
+	}
+	R_FREE (lt->by_line);
+	return true;
+}
+
+// like add, but replaces the row of addr if there is one
+R_API bool r_bin_linetable_set(RBinLineTable *lt, ut64 addr, const char *file, ut32 line) {
+	r_return_val_if_fail (lt && file, false);
+	r_bin_linetable_del (lt, addr);
+	return r_bin_linetable_add (lt, addr, file, line);
+}
+
+R_API bool r_bin_linetable_get(RBinLineTable *lt, ut64 addr, const char **file, ut32 *line) {
+	r_return_val_if_fail (lt, false);
+	linetable_finalize (lt);
+	size_t i = rows_lower_bound (lt, addr);
+	if (i >= lt->rows.len) {
+		return false;
+	}
+	const RBinLineRow *row = r_vector_index_ptr (&lt->rows, i);
+	if (row->addr != addr) {
+		return false;
+	}
+	if (file) {
+		*file = r_pvector_at (&lt->files, row->file);
+	}
+	if (line) {
+		*line = row->line;
+	}
+	return true;
+}
+
+static int by_line_cmp(const void *a, const void *b) {
+	const RBinLineRow *x = a, *y = b;
+	if (x->file != y->file) {
+		return x->file < y->file? -1: 1;
+	}
+	if (x->line != y->line) {
+		return x->line < y->line? -1: 1;
+	}
+	return x->addr < y->addr? -1: x->addr > y->addr;
+}
+
+// Lowest address of a file:line. The reverse index is a copy of the rows
+// sorted by file and line, it is only built when someone asks for it.
+R_API bool r_bin_linetable_find(RBinLineTable *lt, const char *file, ut32 line, ut64 *addr) {
+	r_return_val_if_fail (lt && file, false);
+	ut32 idx = file_lookup (lt, file);
+	if (!idx) {
+		return false;
+	}
+	linetable_finalize (lt);
+	size_t n = lt->rows.len;
+	if (!lt->by_line && n) {
+		lt->by_line = R_NEWS (RBinLineRow, n);
+		if (!lt->by_line) {
+			return false;
+		}
+		memcpy (lt->by_line, lt->rows.a, n * sizeof (RBinLineRow));
+		qsort (lt->by_line, n, sizeof (RBinLineRow), by_line_cmp);
+	}
+	RBinLineRow key = { 0, idx - 1, line };
+	size_t lo = 0, hi = n;
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+		if (by_line_cmp (&lt->by_line[mid], &key) < 0) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+	if (lo >= n || lt->by_line[lo].file != key.file || lt->by_line[lo].line != line) {
+		return false;
+	}
+	if (addr) {
+		*addr = lt->by_line[lo].addr;
+	}
+	return true;
+}
+
+R_API bool r_bin_linetable_del(RBinLineTable *lt, ut64 addr) {
+	r_return_val_if_fail (lt, false);
+	linetable_finalize (lt);
+	size_t i = rows_lower_bound (lt, addr);
+	if (i >= lt->rows.len || ((RBinLineRow *)r_vector_index_ptr (&lt->rows, i))->addr != addr) {
+		return false;
+	}
+	r_vector_remove_at (&lt->rows, i, NULL);
+	R_FREE (lt->by_line);
+	return true;
+}
+
+// remove every row of file:line, returns how many were removed
+R_API int r_bin_linetable_del_line(RBinLineTable *lt, const char *file, ut32 line) {
+	r_return_val_if_fail (lt && file, 0);
+	ut32 idx = file_lookup (lt, file);
+	if (!idx) {
+		return 0;
+	}
+	RBinLineRow *rows = lt->rows.a;
+	size_t i, o = 0, n = lt->rows.len;
+	for (i = 0; i < n; i++) {
+		if (rows[i].file != idx - 1 || rows[i].line != line) {
+			rows[o++] = rows[i];
+		}
+	}
+	lt->rows.len = o;
+	R_FREE (lt->by_line);
+	return (int)(n - o);
+}
+
+// iterate over the rows in address order until cb returns false
+R_API void r_bin_linetable_foreach(RBinLineTable *lt, RBinLineTableForeach cb, void *user) {
+	r_return_if_fail (lt && cb);
+	linetable_finalize (lt);
+	RBinLineRow *row;
+	r_vector_foreach (&lt->rows, row) {
+		if (!cb (user, row->addr, r_pvector_at (&lt->files, row->file), row->line)) {
+			break;
+		}
+	}
+}
+
+R_API RPVector *r_bin_linetable_files(RBinLineTable *lt) {
+	r_return_val_if_fail (lt, NULL);
+	return &lt->files;
+}
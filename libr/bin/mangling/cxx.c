@@ -20,6 +20,7 @@ R_API bool r_bin_is_cxx (RBinFile *binfile) {
 	RListIter *iter;
 	RBinImport *import;
 	RBinObject *o = binfile->o;
+	r_bin_object_load_item (binfile, o, R_BIN_ITEM_IMPORTS);
 	r_list_foreach (o->imports, iter, import) {
 		if (is_cxx_symbol (import->name)) {
 			return true;
@@ -57,6 +57,8 @@ static void object_delete_items(RBinObject *o) {
 	for (i = 0; i < R_BIN_SYM_LAST; i++) {
 		free (o->binsym[i]);
 	}
+	// after the items, some of their strings live in the mapped cache
+	r_bin_cache_free (o->cache);
 }
 
 R_IPI void r_bin_object_free(void /*RBinObject*/ *o_) {
@@ -285,18 +287,255 @@ static RBNode *list2rbtree(RList *relocs) {
 	return res;
 }
 
+static const char *item_names[R_BIN_ITEM_LAST] = {
+	"entries", "fields", "imports", "symbols",
+	"sections", "relocs", "strings", "classes"
+};
+
+R_API const char *r_bin_object_item_name(int item) {
+	return (item >= 0 && item < R_BIN_ITEM_LAST)? item_names[item]: NULL;
+}
+
+static bool item_is_lazy(int item) {
+	switch (item) {
+	case R_BIN_ITEM_IMPORTS:
+	case R_BIN_ITEM_SYMBOLS:
+	case R_BIN_ITEM_RELOCS:
+	case R_BIN_ITEM_STRINGS:
+	case R_BIN_ITEM_CLASSES:
+		return true;
+	}
+	return false;
+}
+
+// the filter rules of the bin can leave some items unloaded
+static bool item_is_wanted(RBin *bin, int item) {
+	switch (item) {
+	case R_BIN_ITEM_RELOCS:
+		return bin->filter_rules & (R_BIN_REQ_RELOCS | R_BIN_REQ_IMPORTS);
+	case R_BIN_ITEM_STRINGS:
+		return bin->filter_rules & R_BIN_REQ_STRINGS;
+	case R_BIN_ITEM_CLASSES:
+		return bin->filter_rules & R_BIN_REQ_CLASSES;
+	}
+	return true;
+}
+
+static void load_classes(RBinFile *binfile, RBinObject *o) {
+	RBin *bin = binfile->rbin;
+	RBinPlugin *cp = o->plugin;
+	if (cp->classes) {
+		o->classes = cp->classes (binfile);
+		if (r_bin_lang_swift (binfile)) {
+			o->classes = classes_from_symbols (binfile);
+		}
+	} else {
+		o->classes = classes_from_symbols (binfile);
+	}
+	if (bin->filter) {
+		filter_classes (binfile, o->classes);
+	}
+	// cache addr=class+method
+	if (o->classes) {
+		RList *klasses = o->classes;
+		RListIter *iter, *iter2;
+		RBinClass *klass;
+		RBinSymbol *method;
+		if (!o->addr2klassmethod) {
+			// this is slow. must be optimized, but at least its cached
+			o->addr2klassmethod = sdb_new0 ();
+			r_list_foreach (klasses, iter, klass) {
+				r_list_foreach (klass->methods, iter2, method) {
+					char *km = sdb_fmt ("method.%s.%s", klass->name, method->name);
+					char *at = sdb_fmt ("0x%08"PFMT64x, method->vaddr);
+					sdb_set (o->addr2klassmethod, at, km, 0);
+				}
+			}
+		}
+	}
+}
+
+static void load_item(RBinFile *binfile, RBinObject *o, int item) {
+	RBin *bin = binfile->rbin;
+	RBinPlugin *cp = o->plugin;
+	int minlen = (bin->minstrlen > 0) ? bin->minstrlen : cp->minstrlen;
+
+	switch (item) {
+	case R_BIN_ITEM_ENTRIES:
+		if (cp->entries) {
+			o->entries = cp->entries (binfile);
+			REBASE_PADDR (o, o->entries, RBinAddr);
+		}
+		break;
+	case R_BIN_ITEM_FIELDS:
+		if (cp->fields) {
+			o->fields = cp->fields (binfile);
+			if (o->fields) {
+				o->fields->free = r_bin_field_free;
+				REBASE_PADDR (o, o->fields, RBinField);
+			}
+		}
+		break;
+	case R_BIN_ITEM_IMPORTS:
+		if (cp->imports) {
+			r_list_free (o->imports);
+			o->imports = cp->imports (binfile);
+			if (o->imports) {
+				o->imports->free = r_bin_import_free;
+			}
+		}
+		break;
+	case R_BIN_ITEM_SYMBOLS:
+		if (cp->symbols) {
+			o->symbols = cp->symbols (binfile); // 5s
+			if (o->symbols) {
+				o->symbols->free = r_bin_symbol_free;
+				REBASE_PADDR (o, o->symbols, RBinSymbol);
+				if (bin->filter) {
+					r_bin_filter_symbols (binfile, o->symbols); // 5s
+				}
+			}
+		}
+		break;
+	case R_BIN_ITEM_SECTIONS:
+		if (cp->sections) {
+			// XXX sections are populated by call to size
+			if (!o->sections) {
+				o->sections = cp->sections (binfile);
+			}
+			REBASE_PADDR (o, o->sections, RBinSection);
+			if (bin->filter) {
+				r_bin_filter_sections (binfile, o->sections);
+			}
+		}
+		break;
+	case R_BIN_ITEM_RELOCS:
+		if (cp->relocs) {
+			RList *l = cp->relocs (binfile);
+			if (l) {
+				REBASE_PADDR (o, l, RBinReloc);
+				o->relocs = list2rbtree (l);
+				l->free = NULL;
+				r_list_free (l);
+			}
+		}
+		break;
+	case R_BIN_ITEM_STRINGS:
+		if (cp->strings) {
+			o->strings = cp->strings (binfile);
+		} else {
+			o->strings = r_bin_file_get_strings (binfile, minlen, 0, binfile->rawstr);
+		}
+		if (bin->debase64) {
+			r_bin_object_filter_strings (o);
+		}
+		REBASE_PADDR (o, o->strings, RBinString);
+		break;
+	case R_BIN_ITEM_CLASSES:
+		load_classes (binfile, o);
+		break;
+	}
+}
+
+static ut32 cache_items(RBin *bin) {
+	ut32 items = 0;
+	int i;
+	for (i = 0; i < R_BIN_ITEM_LAST; i++) {
+		if ((R_BIN_CACHE_ITEMS & (1 << i)) && item_is_wanted (bin, i)) {
+			items |= 1 << i;
+		}
+	}
+	return items;
+}
+
+static bool load_cached_item(RBinObject *o, int item) {
+	// some plugins fill the sections while computing the size
+	if (item == R_BIN_ITEM_SECTIONS && o->sections) {
+		return false;
+	}
+	RList *l = r_bin_cache_get (o->cache, item);
+	if (!l) {
+		return false;
+	}
+	RListIter *iter;
+	RBinString *s;
+	switch (item) {
+	case R_BIN_ITEM_SECTIONS:
+		o->sections = l;
+		break;
+	case R_BIN_ITEM_IMPORTS:
+		r_list_free (o->imports);
+		o->imports = l;
+		break;
+	case R_BIN_ITEM_SYMBOLS:
+		o->symbols = l;
+		break;
+	case R_BIN_ITEM_RELOCS:
+		o->relocs = list2rbtree (l);
+		l->free = NULL;
+		r_list_free (l);
+		break;
+	case R_BIN_ITEM_STRINGS:
+		o->strings = l;
+		r_list_foreach (l, iter, s) {
+			ht_up_insert (o->strings_db, s->vaddr, s);
+		}
+		break;
+	}
+	return true;
+}
+
+static ut64 load_usecs(void) {
+	ut64 now = r_sys_now ();
+	return (now >> 20) * 1000000 + (now & 0xfffff);
+}
+
+static void load_item_timed(RBinFile *binfile, RBinObject *o, int item) {
+	ut64 t = load_usecs ();
+	o->loaded |= 1 << item;
+	if (!load_cached_item (o, item)) {
+		load_item (binfile, o, item);
+	}
+	o->load_time[item] += load_usecs () - t;
+}
+
+/* Materialize an item family of o on first use. Plugins have always seen
+ * the lazy families loaded in order, and some of them rely on it (the
+ * relocs and symbols of mach0 need its imports, the objc classes need the
+ * strings), so the ones before item are loaded first. */
+R_API bool r_bin_object_load_item(RBinFile *binfile, RBinObject *o, int item) {
+	r_return_val_if_fail (binfile && o && item >= 0 && item < R_BIN_ITEM_LAST, false);
+	int i;
+	if (o->loaded & (1 << item)) {
+		return true;
+	}
+	if (!o->plugin) {
+		return false;
+	}
+	if (!item_is_wanted (binfile->rbin, item)) {
+		return false;
+	}
+	RBinObject *old_o = binfile->o;
+	binfile->o = o;
+	for (i = 0; i <= item; i++) {
+		if (item_is_lazy (i) && !(o->loaded & (1 << i)) && item_is_wanted (binfile->rbin, i)) {
+			load_item_timed (binfile, o, i);
+		}
+	}
+	binfile->o = old_o;
+	return true;
+}
+
 R_API int r_bin_object_set_items(RBinFile *binfile, RBinObject *o) {
 	RBinObject *old_o;
 	RBinPlugin *cp;
-	int i, minlen;
-	bool isSwift = false;
+	int i;
 
 	r_return_val_if_fail (binfile && o && o->plugin, false);
 
 	RBin *bin = binfile->rbin;
 	old_o = binfile->o;
 	cp = o->plugin;
-	minlen = (binfile->rbin->minstrlen > 0) ? binfile->rbin->minstrlen : cp->minstrlen;
 	binfile->o = o;
 
 	if (cp->file_type) {
@@ -334,102 +573,17 @@ R_API int r_bin_object_set_items(RBinFile *binfile, RBinObject *o) {
 			}
 		}
 	}
-	if (cp->entries) {
-		o->entries = cp->entries (binfile);
-		REBASE_PADDR (o, o->entries, RBinAddr);
-	}
-	if (cp->fields) {
-		o->fields = cp->fields (binfile);
-		if (o->fields) {
-			o->fields->free = r_bin_field_free;
-			REBASE_PADDR (o, o->fields, RBinField);
-		}
-	}
-	if (cp->imports) {
-		r_list_free (o->imports);
-		o->imports = cp->imports (binfile);
-		if (o->imports) {
-			o->imports->free = r_bin_import_free;
-		}
-	}
-	if (cp->symbols) {
-		o->symbols = cp->symbols (binfile); // 5s
-		if (o->symbols) {
-			o->symbols->free = r_bin_symbol_free;
-			REBASE_PADDR (o, o->symbols, RBinSymbol);
-			if (bin->filter) {
-				r_bin_filter_symbols (binfile, o->symbols); // 5s
-			}
-		}
+	if (bin->cache) {
+		o->cache = r_bin_cache_new (binfile, o, cache_items (bin));
 	}
+	// imports, symbols, relocs, strings and classes are loaded on first use
+	load_item_timed (binfile, o, R_BIN_ITEM_ENTRIES);
+	load_item_timed (binfile, o, R_BIN_ITEM_FIELDS);
 	o->info = cp->info? cp->info (binfile): NULL;
 	if (cp->libs) {
 		o->libs = cp->libs (binfile);
 	}
-	if (cp->sections) {
-		// XXX sections are populated by call to size
-		if (!o->sections) {
-			o->sections = cp->sections (binfile);
-		}
-		REBASE_PADDR (o, o->sections, RBinSection);
-		if (bin->filter) {
-			r_bin_filter_sections (binfile, o->sections);
-		}
-	}
-	if (bin->filter_rules & (R_BIN_REQ_RELOCS | R_BIN_REQ_IMPORTS)) {
-		if (cp->relocs) {
-			RList *l = cp->relocs (binfile);
-			if (l) {
-				REBASE_PADDR (o, l, RBinReloc);
-				o->relocs = list2rbtree (l);
-				l->free = NULL;
-				r_list_free (l);
-			}
-		}
-	}
-	if (bin->filter_rules & R_BIN_REQ_STRINGS) {
-		if (cp->strings) {
-			o->strings = cp->strings (binfile);
-		} else {
-			o->strings = r_bin_file_get_strings (binfile, minlen, 0, binfile->rawstr);
-		}
-		if (bin->debase64) {
-			r_bin_object_filter_strings (o);
-		}
-		REBASE_PADDR (o, o->strings, RBinString);
-	}
-	if (bin->filter_rules & R_BIN_REQ_CLASSES) {
-		if (cp->classes) {
-			o->classes = cp->classes (binfile);
-			isSwift = r_bin_lang_swift (binfile);
-			if (isSwift) {
-				o->classes = classes_from_symbols (binfile);
-			}
-		} else {
-			o->classes = classes_from_symbols (binfile);
-		}
-		if (bin->filter) {
-			filter_classes (binfile, o->classes);
-		}
-		// cache addr=class+method
-		if (o->classes) {
-			RList *klasses = o->classes;
-			RListIter *iter, *iter2;
-			RBinClass *klass;
-			RBinSymbol *method;
-			if (!o->addr2klassmethod) {
-				// this is slow. must be optimized, but at least its cached
-				o->addr2klassmethod = sdb_new0 ();
-				r_list_foreach (klasses, iter, klass) {
-					r_list_foreach (klass->methods, iter2, method) {
-						char *km = sdb_fmt ("method.%s.%s", klass->name, method->name);
-						char *at = sdb_fmt ("0x%08"PFMT64x, method->vaddr);
-						sdb_set (o->addr2klassmethod, at, km, 0);
-					}
-				}
-			}
-		}
-	}
+	load_item_timed (binfile, o, R_BIN_ITEM_SECTIONS);
 	if (cp->lines) {
 		o->lines = cp->lines (binfile);
 	}
@@ -444,12 +598,28 @@ R_API int r_bin_object_set_items(RBinFile *binfile, RBinObject *o) {
 		o->mem = cp->mem (binfile);
 	}
 	if (bin->filter_rules & (R_BIN_REQ_SYMBOLS | R_BIN_REQ_IMPORTS)) {
-		if (isSwift) {
+		// the language has always been guessed with all the wanted items
+		// loaded, loading the classes can set it
+		for (i = 0; i < R_BIN_ITEM_LAST; i++) {
+			if (item_is_lazy (i)) {
+				r_bin_object_load_item (binfile, o, i);
+			}
+		}
+		if (cp->classes && (bin->filter_rules & R_BIN_REQ_CLASSES) && r_bin_lang_swift (binfile)) {
 			o->lang = R_BIN_NM_SWIFT;
 		} else {
 			o->lang = r_bin_load_languages (binfile);
 		}
 	}
+	if (o->cache && !r_bin_cache_ready (o->cache)) {
+		// no usable cache file, load what it should have and write it
+		for (i = 0; i < R_BIN_ITEM_LAST; i++) {
+			if (R_BIN_CACHE_ITEMS & (1 << i)) {
+				r_bin_object_load_item (binfile, o, i);
+			}
+		}
+		r_bin_cache_save (o->cache, o);
+	}
 	binfile->o = old_o;
 	return true;
 }
@@ -462,6 +632,10 @@ R_IPI RBNode *r_bin_object_patch_relocs(RBin *bin, RBinObject *o) {
 	// to io
 	// so we need to be run from bin_relocs, free the previous reloc and get
 	// the patched ones
+	RBinFile *bf = r_bin_cur (bin);
+	if (bf) {
+		r_bin_object_load_item (bf, o, R_BIN_ITEM_RELOCS);
+	}
 	if (first && o->plugin && o->plugin->patch_relocs) {
 		RList *tmp = o->plugin->patch_relocs (bin);
 		first = false;
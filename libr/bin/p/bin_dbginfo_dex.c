@@ -4,19 +4,12 @@
 #include <r_bin.h>
 
 static int get_line(RBinFile *bf, ut64 addr, char *file, int len, int *line) {
-	if (bf->sdb_addrinfo) {
-		char offset[64];
-		char *offset_ptr = sdb_itoa (addr, offset, 16);
-		char *ret = sdb_get (bf->sdb_addrinfo, offset_ptr, 0);
-		if (ret) {
-			char *p = strchr (ret, '|');
-			if (p) {
-				*p = '\0';
-				strncpy (file, ret, len);
-				*line = atoi (p + 1);
-				return true;
-			}
-		}
+	const char *path;
+	ut32 l;
+	if (bf->addrlines && r_bin_linetable_get (bf->addrlines, addr, &path, &l)) {
+		r_str_ncpy (file, path, len);
+		*line = l;
+		return true;
 	}
 	return false;
 }
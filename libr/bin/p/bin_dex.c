@@ -627,8 +627,8 @@ static void dex_parse_debug_item(RBinFile *binfile, RBinDexObj *bin,
 		opcode = *(p4++) & 0xff;
 	}
 
-	if (!binfile->sdb_addrinfo) {
-		binfile->sdb_addrinfo = sdb_new0 ();
+	if (!binfile->addrlines) {
+		binfile->addrlines = r_bin_linetable_new ();
 	}
 
 	RListIter *iter1;
@@ -638,15 +638,12 @@ static void dex_parse_debug_item(RBinFile *binfile, RBinDexObj *bin,
 	r_list_foreach (debug_positions, iter1, pos) {
 		const char *line = getstr (bin, pos->source_file_idx);
 #if 1
-		char offset[64] = {0};
 		if (!line || !*line) {
 			continue;
 		}
-		char *fileline = r_str_newf ("%s|%"PFMT64d, line, pos->line);
-		char *offset_ptr = sdb_itoa (pos->address + paddr, offset, 16);
-		sdb_set (binfile->sdb_addrinfo, offset_ptr, fileline, 0);
-		sdb_set (binfile->sdb_addrinfo, fileline, offset_ptr, 0);
-		free (fileline);
+		if (binfile->addrlines) {
+			r_bin_linetable_add (binfile->addrlines, pos->address + paddr, line, pos->line);
+		}
 #endif
 		RBinDwarfRow *rbindwardrow = R_NEW0 (RBinDwarfRow);
 		if (!rbindwardrow) {
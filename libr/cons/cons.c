@@ -163,6 +163,98 @@ static inline void r_cons_write(const char *obuf, int olen) {
 	}
 }
 
+/* scr.stream: once the buffer of the main context grows past STREAM_CHUNK,
+ * everything but the last STREAM_KEEP bytes is written, so r_cons_drop and
+ * r_cons_chop still see the tail. With a grep, only whole lines go out,
+ * filtered with r_cons_grep_stream. */
+#define STREAM_CHUNK (1024 * 1024)
+#define STREAM_KEEP 4096
+
+static bool grep_active() {
+	return I.context->grep.nstrings > 0 || I.context->grep.tokens_used || I.context->grep.less || I.context->grep.json;
+}
+
+static void cons_tee(const char *buf, int len) {
+	const char *tee = I.teefile;
+	if (!tee || !*tee) {
+		return;
+	}
+	FILE *d = r_sandbox_fopen (tee, "a+");
+	if (d) {
+		if (len != fwrite (buf, 1, len, d)) {
+			eprintf ("r_cons_flush: fwrite: error (%s)\n", tee);
+		}
+		fclose (d);
+	} else {
+		eprintf ("Cannot write on '%s'\n", tee);
+	}
+}
+
+static bool cons_can_stream() {
+	if (I.null || I.noflush || I.is_html || I.filter || I.linesleep > 0) {
+		return false;
+	}
+	if (!r_cons_context_is_main () || !r_stack_is_empty (CTX (cons_stack))) {
+		return false;
+	}
+	if (I.highlight && *I.highlight) {
+		return false;
+	}
+	if (r_cons_is_interactive () && I.fdout == 1 && I.pager && *I.pager) {
+		return false;
+	}
+	return !grep_active () || r_cons_grep_streamable ();
+}
+
+static void cons_stream() {
+	char *buf = CTX (buffer);
+	int n = CTX (buffer_len) - STREAM_KEEP;
+	CTX (stream_mark) = CTX (buffer_len);
+	if (!cons_can_stream ()) {
+		return;
+	}
+	bool grep = grep_active ();
+	if (grep) {
+		while (n > 0 && buf[n - 1] != '\n') {
+			n--;
+		}
+	}
+	if (n <= 0) {
+		return;
+	}
+	if (grep) {
+		RStrBuf *ob = r_strbuf_new ("");
+		if (!ob) {
+			return;
+		}
+		char ch = buf[n];
+		buf[n] = 0;
+		if (!r_cons_grep_stream (ob, buf, n)) {
+			// same as r_cons_grepbuf, give up and show it as is
+			r_strbuf_set (ob, buf);
+		}
+		buf[n] = ch;
+		if (!I.context->grep.counter) {
+			r_cons_write (r_strbuf_get (ob), r_strbuf_length (ob));
+			cons_tee (r_strbuf_get (ob), r_strbuf_length (ob));
+		}
+		r_strbuf_free (ob);
+	} else {
+		r_cons_write (buf, n);
+		cons_tee (buf, n);
+	}
+	CTX (streamed) = true;
+	CTX (buffer_len) -= n;
+	memmove (buf, buf + n, CTX (buffer_len) + 1);
+	CTX (stream_mark) = 0;
+}
+
+static inline void stream_check() {
+	if (I.stream && CTX (buffer_len) - CTX (stream_mark) > STREAM_CHUNK) {
+		cons_stream ();
+	}
+}
+
 R_API RColor r_cons_color_random(ut8 alpha) {
 	RColor rcolor = {0};
 	if (I.context->color > COLOR_MODE_16) {
@@ -641,6 +733,10 @@ R_API void r_cons_reset() {
 	I.lastline = I.context->buffer;
 	cons_grep_reset (&I.context->grep);
 	CTX (pageable) = true;
+	CTX (streamed) = false;
+	CTX (stream_show) = false;
+	CTX (stream_chars) = 0;
+	CTX (stream_mark) = 0;
 }
 
 R_API const char *r_cons_get_buffer() {
@@ -777,7 +873,6 @@ static bool lastMatters() {
 }
 
 R_API void r_cons_flush(void) {
-	const char *tee = I.teefile;
 	if (I.noflush) {
 		return;
 	}
@@ -785,7 +880,7 @@ R_API void r_cons_flush(void) {
 		r_cons_reset ();
 		return;
 	}
-	if (lastMatters () && !CTX (lastMode)) {
+	if (lastMatters () && !CTX (lastMode) && !CTX (streamed)) {
 		// snapshot of the output
 		if (CTX (buffer_len) > CTX (lastLength)) {
 			free (CTX (lastOutput));
@@ -812,7 +907,7 @@ R_API void r_cons_flush(void) {
 				r_sys_cmd_str_full (I.pager, CTX (buffer), NULL, NULL, NULL);
 				r_cons_reset ();
 			}
-		} else if (I.context->buffer_len > CONS_MAX_USER) {
+		} else if (I.context->buffer_len > CONS_MAX_USER && !CTX (streamed)) {
 #if COUNT_LINES
 			int i, lines = 0;
 			for (i = 0; I.context->buffer[i]; i++) {
@@ -836,17 +931,7 @@ R_API void r_cons_flush(void) {
 			r_cons_set_raw (true);
 		}
 	}
-	if (tee && *tee) {
-		FILE *d = r_sandbox_fopen (tee, "a+");
-		if (d) {
-			if (I.context->buffer_len != fwrite (I.context->buffer, 1, I.context->buffer_len, d)) {
-				eprintf ("r_cons_flush: fwrite: error (%s)\n", tee);
-			}
-			fclose (d);
-		} else {
-			eprintf ("Cannot write on '%s'\n", tee);
-		}
-	}
+	cons_tee (I.context->buffer, I.context->buffer_len);
 	r_cons_highlight (I.highlight);
 
 	// is_html must be a filter, not a write endpoint
@@ -1029,6 +1114,7 @@ club:
 		}
 		I.context->buffer_len += written;
 		I.context->buffer[I.context->buffer_len] = 0;
+		stream_check ();
 	} else {
 		r_cons_strcat (format);
 	}
@@ -1074,6 +1160,7 @@ R_API int r_cons_memcat(const char *str, int len) {
 			memcpy (I.context->buffer + I.context->buffer_len, str, len);
 			I.context->buffer_len += len;
 			I.context->buffer[I.context->buffer_len] = 0;
+			stream_check ();
 		}
 	}
 	if (I.flush) {
@@ -1093,6 +1180,7 @@ R_API void r_cons_memset(char ch, int len) {
 		memset (I.context->buffer + I.context->buffer_len, ch, len);
 		I.context->buffer_len += len;
 		I.context->buffer[I.context->buffer_len] = 0;
+		stream_check ();
 	}
 }
 
@@ -440,13 +440,121 @@ static int cmp(const void *a, const void *b) {
 	return strcmp (a, b);
 }
 
+/* Filter the lines of buf that end with a newline into ob, cons->lines
+ * counts the ones that match. Returns false if the grep gives up. */
+static bool grep_lines(RStrBuf *ob, const char *buf, int len, bool *show) {
+	RCons *cons = r_cons_singleton ();
+	RConsGrep *grep = &cons->context->grep;
+	const char *in = buf;
+	int ret, l, tl;
+	while ((int) (size_t) (in - buf) < len) {
+		char *p = strchr (in, '\n');
+		if (!p) {
+			break;
+		}
+		l = p - in;
+		if (l > 0) {
+			char *tline = r_str_ndup (in, l);
+			if (cons->grep_color) {
+				tl = l;
+			} else {
+				tl = r_str_ansi_filter (tline, NULL, NULL, l);
+			}
+			if (tl < 0) {
+				ret = -1;
+			} else {
+				ret = r_cons_grep_line (tline, tl);
+				if (!grep->range_line) {
+					if (grep->line == cons->lines) {
+						*show = true;
+					}
+				} else if (grep->range_line == 1) {
+					if (grep->f_line == cons->lines) {
+						*show = true;
+					}
+					if (grep->l_line == cons->lines) {
+						*show = false;
+					}
+				} else {
+					*show = true;
+				}
+			}
+			if (ret > 0) {
+				if (*show) {
+					char *str = r_str_ndup (tline, ret);
+					if (cons->grep_highlight) {
+						int i;
+						for (i = 0; i < grep->nstrings; i++) {
+							char *newstr = r_str_newf (Color_INVERT"%s"Color_RESET, grep->strings[i]);
+							if (str && newstr) {
+								if (grep->icase) {
+									str = r_str_replace_icase (str, grep->strings[i], newstr, 1, 1);
+								} else {
+									str = r_str_replace (str, grep->strings[i], newstr, 1);
+								}
+							}
+							free (newstr);
+						}
+					}
+					if (str) {
+						r_strbuf_append (ob, str);
+						r_strbuf_append (ob, "\n");
+					}
+					free (str);
+				}
+				if (!grep->range_line) {
+					*show = false;
+				}
+				cons->lines++;
+			} else if (ret < 0) {
+				free (tline);
+				return false;
+			}
+			free (tline);
+			in += l + 1;
+		} else {
+			in++;
+		}
+	}
+	return true;
+}
+
+// negative line numbers count from the end of buf
+static void grep_resolve_lines(const char *buf, int len) {
+	RConsGrep *grep = &r_cons_singleton ()->context->grep;
+	const char *in = buf;
+	int l, total_lines = 0;
+	while ((int) (size_t) (in - buf) < len) {
+		char *p = strchr (in, '\n');
+		if (!p) {
+			break;
+		}
+		l = p - in;
+		if (l > 0) {
+			in += l + 1;
+		} else {
+			in++;
+		}
+		total_lines++;
+	}
+	if (!grep->range_line && grep->line < 0) {
+		grep->line = total_lines + grep->line;
+	}
+	if (grep->range_line == 1) {
+		if (grep->f_line < 0) {
+			grep->f_line = total_lines + grep->f_line;
+		}
+		if (grep->l_line < 0) {
+			grep->l_line = total_lines + grep->l_line;
+		}
+	}
+}
+
 R_API void r_cons_grepbuf() {
 	RCons *cons = r_cons_singleton ();
 	const char *buf = cons->context->buffer;
 	const int len = cons->context->buffer_len;
 	RConsGrep *grep = &cons->context->grep;
-	const char *in = buf;
-	int ret, total_lines = 0, buffer_len = 0, l = 0, tl = 0;
 	bool show = false;
 	if (cons->filter) {
 		cons->context->buffer_len = 0;
@@ -521,108 +629,22 @@ R_API void r_cons_grepbuf() {
 		cons->context->buffer[0] = 0;
 	}
 	RStrBuf *ob = r_strbuf_new ("");
-	// if we modify cons->lines we should update I.context->buffer too
-	cons->lines = 0;
-	// used to count lines and change negative grep.line values
-	while ((int) (size_t) (in - buf) < len) {
-		char *p = strchr (in, '\n');
-		if (!p) {
-			break;
-		}
-		l = p - in;
-		if (l > 0) {
-			in += l + 1;
-		} else {
-			in++;
-		}
-		total_lines++;
-	}
-	if (!grep->range_line && grep->line < 0) {
-		grep->line = total_lines + grep->line;
-	}
-	if (grep->range_line == 1) {
-		if (grep->f_line < 0) {
-			grep->f_line = total_lines + grep->f_line;
-		}
-		if (grep->l_line < 0) {
-			grep->l_line = total_lines + grep->l_line;
-		}
+	if (cons->context->streamed) {
+		// the first lines were already filtered by r_cons_grep_stream
+		show = cons->context->stream_show;
+	} else {
+		// if we modify cons->lines we should update I.context->buffer too
+		cons->lines = 0;
+		grep_resolve_lines (buf, len);
 	}
-	in = buf;
-	while ((int) (size_t) (in - buf) < len) {
-		char *p = strchr (in, '\n');
-		if (!p) {
-			break;
-		}
-		l = p - in;
-		if (l > 0) {
-			char *tline = r_str_ndup (in, l);
-			if (cons->grep_color) {
-				tl = l;
-			} else {
-				tl = r_str_ansi_filter (tline, NULL, NULL, l);
-			}
-			if (tl < 0) {
-				ret = -1;
-			} else {
-				ret = r_cons_grep_line (tline, tl);
-				if (!grep->range_line) {
-					if (grep->line == cons->lines) {
-						show = true;
-					}
-				} else if (grep->range_line == 1) {
-					if (grep->f_line == cons->lines) {
-						show = true;
-					}
-					if (grep->l_line == cons->lines) {
-						show = false;
-					}
-				} else {
-					show = true;
-				}
-			}
-			if (ret > 0) {
-				if (show) {
-					char *str = r_str_ndup (tline, ret);
-					if (cons->grep_highlight) {
-						int i;
-						for (i = 0; i < grep->nstrings; i++) {
-							char *newstr = r_str_newf (Color_INVERT"%s"Color_RESET, grep->strings[i]);
-							if (str && newstr) {
-								if (grep->icase) {
-									str = r_str_replace_icase (str, grep->strings[i], newstr, 1, 1);
-								} else {
-									str = r_str_replace (str, grep->strings[i], newstr, 1);
-								}
-							}
-							free (newstr);
-						}
-					}
-					if (str) {
-						r_strbuf_append (ob, str);
-						r_strbuf_append (ob, "\n");
-					}
-					buffer_len += ret + 1;
-					free (str);
-				}
-				if (!grep->range_line) {
-					show = false;
-				}
-				cons->lines++;
-			} else if (ret < 0) {
-				free (tline);
-				return;
-			}
-			free (tline);
-			in += l + 1;
-		} else {
-			in++;
-		}
+	if (!grep_lines (ob, buf, len, &show)) {
+		r_strbuf_free (ob);
+		return;
 	}
 
 	cons->context->buffer_len = r_strbuf_length (ob);
 	if (grep->counter) {
-		int cnt = grep->charCounter? strlen (cons->context->buffer): cons->lines;
+		int cnt = grep->charCounter? cons->context->stream_chars + strlen (cons->context->buffer): cons->lines;
 		if (cons->context->buffer_len < 10) {
 			cons->context->buffer_len = 10; // HACK
 		}
@@ -675,6 +697,37 @@ R_API void r_cons_grepbuf() {
 	}
 }
 
+/* Whether the grep can be applied a few lines at a time, as the output
+ * is produced. Sorting, json, the pager and line numbers counted from
+ * the end need the whole buffer. */
+R_API bool r_cons_grep_streamable(void) {
+	RCons *cons = r_cons_singleton ();
+	RConsGrep *grep = &cons->context->grep;
+	if (cons->filter || grep->json || grep->less || grep->sort != -1) {
+		return false;
+	}
+	switch (grep->range_line) {
+	case 0:
+		return grep->line >= 0;
+	case 1:
+		return grep->f_line >= 0 && grep->l_line >= 0;
+	}
+	return true;
+}
+
+/* Filter the lines in the first len bytes of buf into ob, before the
+ * command is done. r_cons_grepbuf picks up from there. */
+R_API bool r_cons_grep_stream(RStrBuf *ob, const char *buf, int len) {
+	RCons *cons = r_cons_singleton ();
+	RConsContext *ctx = cons->context;
+	if (!ctx->streamed) {
+		cons->lines = 0;
+		ctx->stream_show = false;
+	}
+	ctx->stream_chars += len;
+	return grep_lines (ob, buf, len, &ctx->stream_show);
+}
+
 R_API int r_cons_grep_line(char *buf, int len) {
 	RCons *cons = r_cons_singleton ();
 	RConsGrep *grep = &cons->context->grep;
@@ -38,6 +38,8 @@ static void loganal(ut64 from, ut64 to, int depth) {
 static char *getFunctionName(RCore *core, ut64 addr) {
 	RBinFile *bf = r_bin_cur (core->bin);
 	if (bf && bf->o) {
+		// the table is filled when the classes are loaded
+		r_bin_object_load_item (bf, bf->o, R_BIN_ITEM_CLASSES);
 		Sdb *kv = bf->o->addr2klassmethod;
 		char *at = sdb_fmt ("0x%08"PFMT64x, addr);
 		char *res = sdb_get (kv, at, 0);
@@ -696,7 +698,6 @@ static int core_anal_fcn(RCore *core, ut64 at, ut64 from, int reftype, int depth
 		return false;
 	}
 	int has_next = r_config_get_i (core->config, "anal.hasnext");
-	RAnalHint *hint = NULL;
 	ut8 *buf = NULL;
 	int i, nexti = 0;
 	ut64 *next = NULL;
@@ -711,7 +712,7 @@ static int core_anal_fcn(RCore *core, ut64 at, ut64 from, int reftype, int depth
 		return false;
 	}
 	fcn->cc = r_str_const (r_anal_cc_default (core->anal));
-	hint = r_anal_hint_get (core->anal, at);
+	const RAnalHint *hint = r_anal_hint_at (core->anal, at);
 	if (hint && hint->bits == 16) {
 		// expand 16bit for function
 		fcn->bits = 16;
@@ -860,7 +861,6 @@ static int core_anal_fcn(RCore *core, ut64 at, ut64 from, int reftype, int depth
 		}
 		free (next);
 	}
-	r_anal_hint_free (hint);
 	return true;
 
 error:
@@ -900,7 +900,6 @@ error:
 			}
 		}
 	}
-	r_anal_hint_free (hint);
 	return false;
 }
 
@@ -950,7 +949,7 @@ err_op:
 	return NULL;
 }
 
-static void print_hint_h_format(RAnalHint* hint) {
+static void print_hint_h_format(const RAnalHint *hint) {
 	r_cons_printf (" 0x%08"PFMT64x" - 0x%08"PFMT64x" =>", hint->addr, hint->addr + hint->size);
 	HINTCMD (hint, arch, " arch='%s'", false);
 	HINTCMD (hint, bits, " bits=%d", false);
@@ -969,13 +968,82 @@ static void print_hint_h_format(RAnalHint* hint) {
 	r_cons_newline ();
 }
 
-// TODO: move this into anal/hint.c ?
-static int cb(void *p, const char *k, const char *v) {
-	HintListState *hls = p;
-	RAnalHint *hint = r_anal_hint_from_string (hls->a, sdb_atoi (k + 5), v);
+static void hint_sdb_num(RStrBuf *sb, const char *type, ut64 n) {
+	char val[64];
+	r_strbuf_appendf (sb, "%s%s,%s", r_strbuf_length (sb)? ",": "", type, sdb_itoa (n, val, 16));
+}
+
+static void hint_sdb_str(RStrBuf *sb, const char *type, const char *str) {
+	char *val = sdb_encode ((const ut8 *)str, -1);
+	if (val) {
+		r_strbuf_appendf (sb, "%s%s,%s", r_strbuf_length (sb)? ",": "", type, val);
+		free (val);
+	}
+}
+
+// the sdb array format hints were stored in, see r_anal_hint_from_string
+static void print_hint_sdb(const RAnalHint *hint) {
+	RStrBuf *sb = r_strbuf_new ("");
+	if (!sb) {
+		return;
+	}
+	if (hint->immbase) {
+		hint_sdb_num (sb, "immbase:", hint->immbase);
+	}
+	if (hint->jump != UT64_MAX) {
+		hint_sdb_num (sb, "jump:", hint->jump);
+	}
+	if (hint->fail != UT64_MAX) {
+		hint_sdb_num (sb, "fail:", hint->fail);
+	}
+	if (hint->ptr) {
+		hint_sdb_num (sb, "ptr:", hint->ptr);
+	}
+	if (hint->nword) {
+		hint_sdb_num (sb, "nword:", hint->nword);
+	}
+	if (hint->ret != UT64_MAX) {
+		hint_sdb_num (sb, "ret:", hint->ret);
+	}
+	if (hint->bits) {
+		hint_sdb_num (sb, "bits:", hint->bits);
+	}
+	if (hint->new_bits) {
+		hint_sdb_num (sb, "Bits:", hint->new_bits);
+	}
+	if (hint->size) {
+		hint_sdb_num (sb, "size:", hint->size);
+	}
+	if (hint->type) {
+		hint_sdb_num (sb, "type:", hint->type);
+	}
+	if (hint->high) {
+		hint_sdb_num (sb, "high:", 1);
+	}
+	if (hint->syntax) {
+		hint_sdb_str (sb, "Syntax:", hint->syntax);
+	}
+	if (hint->opcode) {
+		hint_sdb_str (sb, "opcode:", hint->opcode);
+	}
+	if (hint->offset) {
+		hint_sdb_str (sb, "Offset:", hint->offset);
+	}
+	if (hint->esil) {
+		hint_sdb_str (sb, "esil:", hint->esil);
+	}
+	if (hint->arch) {
+		hint_sdb_str (sb, "arch:", hint->arch);
+	}
+	r_cons_printf ("hint.0x%08"PFMT64x"=%s\n", hint->addr, r_strbuf_get (sb));
+	r_strbuf_free (sb);
+}
+
+static bool print_hint_cb(const RAnalHint *hint, void *user) {
+	HintListState *hls = user;
 	switch (hls->mode) {
 	case 's':
-		r_cons_printf ("%s=%s\n", k, v);
+		print_hint_sdb (hint);
 		break;
 	case '*':
 		HINTCMD_ADDR (hint, arch, "aha %s");
@@ -1010,12 +1078,12 @@ static int cb(void *p, const char *k, const char *v) {
 		print_hint_h_format (hint);
 		break;
 	}
-	free (hint);
-	return 1;
+	hls->count++;
+	return true;
 }
 
 R_API void r_core_anal_hint_print(RAnal* a, ut64 addr, int mode) {
-	RAnalHint *hint = r_anal_hint_get (a, addr);
+	const RAnalHint *hint = r_anal_hint_at (a, addr);
 	if (!hint) {
 		return;
 	}
@@ -1030,7 +1098,6 @@ R_API void r_core_anal_hint_print(RAnal* a, ut64 addr, int mode) {
 	} else {
 		print_hint_h_format (hint);
 	}
-	free (hint);
 }
 
 R_API void r_core_anal_hint_list(RAnal *a, int mode) {
@@ -1045,13 +1112,7 @@ R_API void r_core_anal_hint_list(RAnal *a, int mode) {
 	if (mode == 'j') {
 		r_cons_strcat ("[");
 	}
-	SdbList *ls = sdb_foreach_list (a->sdb_hints, true);
-	SdbListIter *lsi;
-	SdbKv *kv;
-	ls_foreach (ls, lsi, kv) {
-		cb (&hls, sdbkv_key (kv), sdbkv_value (kv));
-	}
-	ls_free (ls);
+	r_anal_hint_foreach (a, print_hint_cb, &hls);
 	if (mode == 'j') {
 		r_cons_strcat ("]\n");
 	}
@@ -1535,6 +1596,7 @@ error:
 	rc = false;
 fin:
 	r_list_delete_data (fcn->bbs, bb);
+	r_anal_fcn_invalidate (fcn);
 	r_anal_bb_free (bb);
 	free (buf);
 	return rc;
@@ -1884,16 +1946,16 @@ R_API void r_core_anal_coderefs(RCore *core, ut64 addr) {
 
 R_API void r_core_anal_importxrefs(RCore *core) {
 	RBinInfo *info = r_bin_get_info (core->bin);
-	RBinObject *obj = r_bin_cur_object (core->bin);
+	RList *imports = r_bin_get_imports (core->bin);
 	bool lit = info ? info->has_lit: false;
 	int va = core->io->va || core->io->debug;
 
 	RListIter *iter;
 	RBinImport *imp;
-	if (!obj) {
+	if (!imports) {
 		return;
 	}
-	r_list_foreach (obj->imports, iter, imp) {
+	r_list_foreach (imports, iter, imp) {
 		ut64 addr = lit ? r_core_bin_impaddr (core->bin, va, imp->name): 0;
 		if (addr) {
 			r_core_anal_codexrefs (core, addr);
@@ -3443,6 +3505,258 @@ static void found_xref(RCore *core, ut64 at, ut64 xref_to, RAnalRefType type, in
 
 }
 
+// aar pre-decodes code in parallel when anal.jobs > 1. Worker threads decode
+// fixed size chunks of a read-only snapshot using private RAnal instances, and
+// the serial loop below consumes the results in address order, so the xrefs
+// found are the same as with a single job.
+#define REFS_CHUNK (64 * 1024)
+#define REFS_CHUNKS_PER_JOB 4
+
+// plugins that keep no decoder state in globals and do not read from io while
+// decoding, the capstone ones share a static handle and register buffers
+static const char *refs_reentrant_plugins[] = {
+	"6502", "bf", "chip8", "cr16", "ebc", "h8300", "i4004", "i8080", "malbolge",
+	"mcore", "msp430", "propeller", "rsp", "v810", "v850", "z80", NULL
+};
+
+static bool refs_reentrant(RAnalPlugin *cur) {
+	int i;
+	for (i = 0; cur && refs_reentrant_plugins[i]; i++) {
+		if (!strcmp (cur->name, refs_reentrant_plugins[i])) {
+			return true;
+		}
+	}
+	return false;
+}
+
+typedef struct {
+	ut64 addr;
+	ut64 jump;
+	ut64 ptr;
+	ut64 val;
+	int ret; // r_anal_op return value
+	int type;
+} RefsOp;
+
+typedef struct {
+	RAnal *anal;
+	struct refs_window_t *w;
+} RefsWorker;
+
+typedef struct refs_window_t {
+	ut64 addr;
+	ut8 *buf; // io snapshot at addr, never written by the workers
+	int len;
+	int bits; // decoder state used by the workers
+	RAnalPlugin *cur;
+	int maxop;
+	int nchunks;
+	RefsOp **ops; // per chunk, sorted by address
+	int *nops;
+	int next; // next chunk to decode
+	RThreadLock *lock;
+	int njobs;
+	RefsWorker *jobs;
+} RefsWindow;
+
+static void refs_decode_chunk(RAnal *anal, RefsWindow *w, int chunk) {
+	int i = chunk * REFS_CHUNK;
+	int end = R_MIN (i + REFS_CHUNK, w->len);
+	int n = 0, size = 1024;
+	RefsOp *ops = malloc (size * sizeof (RefsOp));
+	RAnalOp op;
+	while (ops && i < end) {
+		if (n == size) {
+			size *= 2;
+			RefsOp *o = realloc (ops, size * sizeof (RefsOp));
+			if (!o) {
+				break;
+			}
+			ops = o;
+		}
+		int ret = r_anal_op (anal, &op, w->addr + i, w->buf + i, w->len - i, 0);
+		RefsOp *ro = &ops[n++];
+		ro->addr = w->addr + i;
+		ro->jump = op.jump;
+		ro->ptr = op.ptr;
+		ro->val = op.val;
+		ro->ret = ret;
+		ro->type = op.type;
+		r_anal_op_fini (&op);
+		i += ret > 0 ? ret : 1;
+	}
+	w->ops[chunk] = ops;
+	w->nops[chunk] = ops? n: 0;
+}
+
+static RThreadFunctionRet refs_worker_th(RThread *th) {
+	RefsWorker *rw = th->user;
+	RefsWindow *w = rw->w;
+	for (;;) {
+		r_th_lock_enter (w->lock);
+		int chunk = w->next++;
+		r_th_lock_leave (w->lock);
+		if (chunk >= w->nchunks) {
+			break;
+		}
+		refs_decode_chunk (rw->anal, w, chunk);
+	}
+	return R_TH_STOP;
+}
+
+static void refs_window_reset(RefsWindow *w) {
+	int i;
+	for (i = 0; i < w->nchunks; i++) {
+		R_FREE (w->ops[i]);
+		w->nops[i] = 0;
+	}
+	w->len = 0;
+	w->nchunks = 0;
+}
+
+static void refs_window_free(RefsWindow *w) {
+	int i;
+	if (!w) {
+		return;
+	}
+	refs_window_reset (w);
+	for (i = 0; i < w->njobs; i++) {
+		r_anal_free (w->jobs[i].anal);
+	}
+	r_th_lock_free (w->lock);
+	free (w->jobs);
+	free (w->ops);
+	free (w->nops);
+	free (w->buf);
+	free (w);
+}
+
+static RefsWindow *refs_window_new(RCore *core, int njobs) {
+	// one more chunk for the block that overlaps the end of the window
+	const int maxchunks = njobs * REFS_CHUNKS_PER_JOB + 1;
+	int i;
+	if (!refs_reentrant (core->anal->cur) || core->blocksize > REFS_CHUNK) {
+		return NULL;
+	}
+	RefsWindow *w = R_NEW0 (RefsWindow);
+	if (!w) {
+		return NULL;
+	}
+	w->buf = malloc (maxchunks * REFS_CHUNK);
+	w->ops = calloc (maxchunks, sizeof (RefsOp *));
+	w->nops = calloc (maxchunks, sizeof (int));
+	w->jobs = calloc (njobs, sizeof (RefsWorker));
+	w->lock = r_th_lock_new (false);
+	if (!w->buf || !w->ops || !w->nops || !w->jobs || !w->lock) {
+		refs_window_free (w);
+		return NULL;
+	}
+	for (i = 0; i < njobs; i++) {
+		// private decoder state, the bindings are shared but the bits
+		// must not be switched from the workers
+		RAnal *anal = r_anal_new ();
+		if (!anal) {
+			break;
+		}
+		w->jobs[i].anal = anal;
+		w->jobs[i].w = w;
+		w->njobs++;
+		anal->iob = core->anal->iob;
+		anal->flb = core->anal->flb;
+		anal->binb = core->anal->binb;
+		anal->coreb = core->anal->coreb;
+		anal->coreb.archbits = NULL;
+		anal->pcalign = core->anal->pcalign;
+		r_anal_set_cpu (anal, core->anal->cpu);
+		r_anal_set_big_endian (anal, core->anal->big_endian);
+	}
+	if (w->njobs < 1) {
+		refs_window_free (w);
+		return NULL;
+	}
+	return w;
+}
+
+// snapshot and decode [addr, addr + len) with the decoder state in use at addr
+static bool refs_window_fill(RCore *core, RefsWindow *w, ut64 addr, ut64 len) {
+	const int maxlen = w->njobs * REFS_CHUNKS_PER_JOB * REFS_CHUNK;
+	RThread **ths = calloc (w->njobs, sizeof (RThread *));
+	int i;
+	refs_window_reset (w);
+	if (!ths) {
+		return false;
+	}
+	r_core_seek_archbits (core, addr);
+	if (!refs_reentrant (core->anal->cur)) {
+		free (ths);
+		return false;
+	}
+	w->addr = addr;
+	w->len = (int)R_MIN (len, (ut64)maxlen) + core->blocksize;
+	w->nchunks = (w->len + REFS_CHUNK - 1) / REFS_CHUNK;
+	w->bits = core->anal->bits;
+	w->cur = core->anal->cur;
+	// not all the plugins report a sane max op size
+	w->maxop = R_MAX (r_anal_archinfo (core->anal, R_ANAL_ARCHINFO_MAX_OP_SIZE), 16);
+	w->next = 0;
+	(void)r_io_read_at (core->io, addr, w->buf, w->len);
+	for (i = 0; i < w->njobs; i++) {
+		RAnal *anal = w->jobs[i].anal;
+		if (anal->cur != w->cur) {
+			r_anal_use (anal, w->cur->name);
+		}
+		r_anal_set_bits (anal, w->bits);
+	}
+	// the first decode may initialize the plugin globals, keep it serial
+	refs_decode_chunk (w->jobs[0].anal, w, w->next++);
+	for (i = 0; i < w->njobs; i++) {
+		ths[i] = r_th_new (refs_worker_th, &w->jobs[i], 0);
+	}
+	for (i = 0; i < w->njobs; i++) {
+		if (ths[i]) {
+			r_th_wait (ths[i]);
+			r_th_free (ths[i]);
+		}
+	}
+	free (ths);
+	return true;
+}
+
+// replay of r_anal_op (core->anal, op, at, buf, len, 0) from the decoded window,
+// returns 0 when the op must be decoded again
+static int refs_window_op(RCore *core, RefsWindow *w, RAnalOp *op, ut64 at, int len) {
+	// the workers had the following bytes available, the caller may not
+	if (len < w->maxop || at < w->addr || at - w->addr >= (ut64)w->len) {
+		return 0;
+	}
+	// r_anal_op would select the decoder for this address
+	r_core_seek_archbits (core, at);
+	if (core->anal->cur != w->cur || core->anal->bits != w->bits) {
+		return 0;
+	}
+	int chunk = (at - w->addr) / REFS_CHUNK;
+	const RefsOp *ops = w->ops[chunk];
+	int lo = 0, hi = w->nops[chunk];
+	while (lo < hi) {
+		int mid = (lo + hi) / 2;
+		if (ops[mid].addr < at) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+	if (lo == w->nops[chunk] || ops[lo].addr != at) {
+		return 0;
+	}
+	r_anal_op_init (op);
+	op->addr = at;
+	op->jump = ops[lo].jump;
+	op->ptr = ops[lo].ptr;
+	op->val = ops[lo].val;
+	op->type = ops[lo].type;
+	return ops[lo].ret? ops[lo].ret: -1;
+}
+
 R_API int r_core_anal_search_xrefs(RCore *core, ut64 from, ut64 to, int rad) {
 	int cfg_debug = r_config_get_i (core->config, "cfg.debug");
 	bool cfg_anal_strings = r_config_get_i (core->config, "anal.strings");
@@ -3478,6 +3792,8 @@ R_API int r_core_anal_search_xrefs(RCore *core, ut64 from, ut64 to, int rad) {
 	if (rad == 'j') {
 		r_cons_printf ("{");
 	}
+	int jobs = r_config_get_i (core->config, "anal.jobs");
+	RefsWindow *w = jobs > 1? refs_window_new (core, jobs): NULL;
 	r_cons_break_push (NULL, NULL);
 	at = from;
 	st64 asm_var_submin = r_config_get_i (core->config, "asm.var.submin");
@@ -3486,7 +3802,17 @@ R_API int r_core_anal_search_xrefs(RCore *core, ut64 from, ut64 to, int rad) {
 		if (!r_io_is_valid_offset (core->io, at, R_PERM_X)) {
 			break;
 		}
-		(void)r_io_read_at (core->io, at, buf, bsz);
+		if (w && (at < w->addr || at + bsz > w->addr + w->len)) {
+			if (!refs_window_fill (core, w, at, to - at)) {
+				refs_window_free (w);
+				w = NULL;
+			}
+		}
+		if (w) {
+			memcpy (buf, w->buf + (at - w->addr), bsz);
+		} else {
+			(void)r_io_read_at (core->io, at, buf, bsz);
+		}
 		memset (block, -1, bsz);
 		if (!memcmp (buf, block, bsz)) {
 		//	eprintf ("Error: skipping uninitialized block \n");
@@ -3500,7 +3826,10 @@ R_API int r_core_anal_search_xrefs(RCore *core, ut64 from, ut64 to, int rad) {
 			continue;
 		}
 		while (i < bsz && !r_cons_is_breaked ()) {
-			ret = r_anal_op (core->anal, &op, at, buf + i, bsz - i, 0);
+			ret = w? refs_window_op (core, w, &op, at, bsz - i): 0;
+			if (!ret) {
+				ret = r_anal_op (core->anal, &op, at, buf + i, bsz - i, 0);
+			}
 			ret = ret > 0 ? ret : 1;
 			i += ret;
 			if (ret <= 0 || i > bsz) {
@@ -3548,6 +3877,7 @@ R_API int r_core_anal_search_xrefs(RCore *core, ut64 from, ut64 to, int rad) {
 		r_anal_op_fini (&op);
 	}
 	r_cons_break_pop ();
+	refs_window_free (w);
 	free (buf);
 	free (block);
 	if (rad == 'j') {
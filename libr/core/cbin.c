@@ -227,7 +227,7 @@ static void _print_strings(RCore *r, RList *list, int mode, int va) {
 			if (r_cons_is_breaked ()) {
 				break;
 			}
-			r_meta_add (r->anal, R_META_TYPE_STRING, addr, addr + string->size, string->string);
+			r_meta_add_batch (r->anal, R_META_TYPE_STRING, addr, addr + string->size, string->string);
 			f_name = strdup (string->string);
 			r_name_filter (f_name, -1);
 			if (r->bin->prefix) {
@@ -356,6 +356,9 @@ static void _print_strings(RCore *r, RList *list, int mode, int va) {
 		}
 		last_processed = iter;
 	}
+	if (IS_MODE_SET (mode)) {
+		r_meta_update (r->anal);
+	}
 	R_FREE (b64.string);
 	if (IS_MODE_JSON (mode)) {
 		r_cons_printf ("]");
@@ -1006,43 +1009,21 @@ static int bin_pdb(RCore *core, int mode) {
 	return r_core_pdb_info (core, core->bin->file, baddr, mode);
 }
 
-static int srclineCmp(const void *a, const void *b) {
-	return r_str_cmp (a, b, -1);
-}
-
 static int bin_source(RCore *r, int mode) {
-	RList *final_list = r_list_new ();
 	RBinFile * binfile = r->bin->cur;
 
-	if (!binfile) {
+	if (!binfile || !binfile->addrlines) {
 		bprintf ("[Error bin file]\n");
-		r_list_free (final_list);
 		return false;
 	}
 
-	SdbListIter *iter;
-	RListIter *iter2;
-	char* srcline;
-	SdbKv *kv;
-	SdbList *ls = sdb_foreach_list (binfile->sdb_addrinfo, false);
-	ls_foreach (ls, iter, kv) {
-		char *v = sdbkv_value (kv);
-		RList *list = r_str_split_list (v, "|");
-		srcline = r_list_get_bottom (list);
-		if (srcline) {
-			if (!strstr (srcline, "0x")){
-				r_list_append (final_list, srcline);
-			}
-		}
-		r_list_free (list);
-	}
+	// file names are interned by the line table, so they are unique
+	void **it;
+	RPVector *files = r_bin_linetable_files (binfile->addrlines);
 	r_cons_printf ("[Source file]\n");
-	RList *uniqlist = r_list_uniq (final_list, srclineCmp);
-	r_list_foreach (uniqlist, iter2, srcline) {
-		r_cons_printf ("%s\n", srcline);
+	r_pvector_foreach (files, it) {
+		r_cons_printf ("%s\n", (const char *)*it);
 	}
-	r_list_free (uniqlist);
-	r_list_free (final_list);
 	return true;
 }
 
@@ -1345,7 +1326,7 @@ static void set_bin_relocs(RCore *r, RBinReloc *reloc, ut64 addr, Sdb **db, char
 			}
 			free (module);
 			r_anal_hint_set_size (r->anal, reloc->vaddr, 4);
-			r_meta_add (r->anal, R_META_TYPE_DATA, reloc->vaddr, reloc->vaddr+4, NULL);
+			r_meta_add_batch (r->anal, R_META_TYPE_DATA, reloc->vaddr, reloc->vaddr+4, NULL);
 		}
 		reloc_name = reloc->import->name;
 		if (r->bin->prefix) {
@@ -1394,7 +1375,7 @@ static void add_metadata(RCore *r, RBinReloc *reloc, ut64 addr, int mode) {
 		return;
 	}
 	if (IS_MODE_SET (mode)) {
-		r_meta_add (r->anal, R_META_TYPE_DATA, reloc->vaddr, reloc->vaddr + cdsz, NULL);
+		r_meta_add_batch (r->anal, R_META_TYPE_DATA, reloc->vaddr, reloc->vaddr + cdsz, NULL);
 	} else if (IS_MODE_RAD (mode)) {
 		r_cons_printf ("f Cd %d @ 0x%08" PFMT64x "\n", cdsz, addr);
 	}
@@ -1575,6 +1556,7 @@ static int bin_relocs(RCore *r, int mode, int va) {
 	R_FREE (sdb_module);
 	sdb_free (db);
 	db = NULL;
+	r_meta_update (r->anal);
 
 	R_TIME_END;
 	return relocs != NULL;
@@ -228,6 +228,13 @@ static int cb_analdepth(void *user, void *data) {
 	return true;
 }
 
+static int cb_diff_jobs(void *user, void *data) {
+	RCore *core = (RCore*) user;
+	RConfigNode *node = (RConfigNode*) data;
+	core->anal->diff_jobs = R_MAX (node->i_value, 1);
+	return true;
+}
+
 static int cb_analgraphdepth(void *user, void *data) {
 	RCore *core = (RCore *)user;
 	RConfigNode *node = (RConfigNode *)data;
@@ -829,6 +836,13 @@ static int cb_binfilter(void *user, void *data) {
 	return true;
 }
 
+static int cb_bincache(void *user, void *data) {
+	RCore *core = (RCore*) user;
+	RConfigNode *node = (RConfigNode*) data;
+	core->bin->cache = node->i_value;
+	return true;
+}
+
 /* BinDemangleCmd */
 static int cb_bdc(void *user, void *data) {
 	RCore *core = (RCore*) user;
@@ -944,6 +958,14 @@ static int cb_dirzigns(void *user, void *data) {
 	return true;
 }
 
+static int cb_dirbincache(void *user, void *data) {
+	RCore *core = (RCore*) user;
+	RConfigNode *node = (RConfigNode*) data;
+	free (core->bin->cachedir);
+	core->bin->cachedir = strdup (node->value);
+	return true;
+}
+
 static int cb_bigendian(void *user, void *data) {
 	RCore *core = (RCore *) user;
 	RConfigNode *node = (RConfigNode *) data;
@@ -990,6 +1012,7 @@ static int cb_cfgdebug(void *user, void *data) {
 	if (core->io) {
 		core->io->va = !node->i_value;
 		core->io->debug = node->i_value;
+		core->io->wgen++;
 	}
 	if (core->dbg && node->i_value) {
 		const char *dbgbackend = r_config_get (core->config, "dbg.backend");
@@ -1340,6 +1363,21 @@ static int cb_esilverbose (void *user, void *data) {
 	return true;
 }
 
+static int cb_esilcompile(void *user, void *data) {
+	RCore *core = (RCore *) user;
+	RConfigNode *node = (RConfigNode*) data;
+	core->anal->esil_compile = node->i_value;
+	return true;
+}
+
+static int cb_asmopcache(void *user, void *data) {
+	RCore *core = (RCore *) user;
+	RConfigNode *node = (RConfigNode*) data;
+	r_core_opcache_free (core->opcache);
+	core->opcache = (node->i_value > 0)? r_core_opcache_new (node->i_value): NULL;
+	return true;
+}
+
 static int cb_esilstackdepth (void *user, void *data) {
 	RConfigNode *node = (RConfigNode*) data;
 	if (node->i_value < 3) {
@@ -1748,6 +1786,7 @@ static int cb_iova(void *user, void *data) {
 	RConfigNode *node = (RConfigNode *) data;
 	if (node->i_value != core->io->va) {
 		core->io->va = node->i_value;
+		core->io->wgen++;
 		/* ugly fix for r2 -d ... "r2 is going to die soon ..." */
 		if (core->io->desc) {
 			r_core_block_read (core);
@@ -1921,6 +1960,12 @@ static int cb_scrflush(void *user, void *data) {
 	return true;
 }
 
+static int cb_scrstream(void *user, void *data) {
+	RConfigNode *node = (RConfigNode *) data;
+	r_cons_singleton ()->stream = node->i_value;
+	return true;
+}
+
 static int cb_scrstrconv(void *user, void *data) {
 	RCore *core = (RCore*) user;
 	RConfigNode *node = (RConfigNode*) data;
@@ -2638,6 +2683,7 @@ R_API int r_core_config_init(RCore *core) {
 	SETPREF ("anal.hasnext", "false", "Continue analysis after each function");
 	SETPREF ("anal.esil", "false", "Use the new ESIL code analysis");
 	SETCB ("anal.strings", "false", &cb_analstrings, "Identify and register strings during analysis (aar only)");
+	SETI ("anal.jobs", 1, "Threads used by aar to decode code, only with the 6502, bf, chip8, cr16, ebc, h8300, i4004, i8080, malbolge, mcore, msp430, propeller, rsp, v810, v850 and z80 anal plugins (function analysis is always serial)");
 	SETPREF ("anal.types.spec", "gcc",  "Set profile for specifying format chars used in type analysis");
 	SETPREF ("anal.types.verbose", "false", "Verbose output from type analysis");
 	SETPREF ("anal.types.constraint", "false", "Enable constraint types analysis for variables");
@@ -2697,6 +2743,7 @@ R_API int r_core_config_init(RCore *core) {
 	SETPREF ("esil.fillstack", "", "Initialize ESIL stack with (random, debrujn, sequence, zeros, ...)");
 	SETICB ("esil.verbose", 0, &cb_esilverbose, "Show ESIL verbose level (0, 1, 2)");
 	SETICB ("esil.gotolimit", core->anal->esil_goto_limit, &cb_gotolimit, "Maximum number of gotos per ESIL expression");
+	SETCB ("esil.compile", "false", &cb_esilcompile, "Cache ESIL expressions as pre-tokenized words with resolved ops");
 	SETICB ("esil.stack.depth", 32, &cb_esilstackdepth, "Number of elements that can be pushed on the esilstack");
 	SETI ("esil.stack.size", 0xf0000, "Set stack size in ESIL VM");
 	SETI ("esil.stack.addr", 0x100000, "Set stack address in ESIL VM");
@@ -2840,6 +2887,7 @@ R_API int r_core_config_init(RCore *core) {
 	SETDESC (n, "Select assembly syntax");
 	SETOPTIONS (n, "att", "intel", "masm", "jz", "regnum", NULL);
 	SETI ("asm.nbytes", 6, "Number of bytes for each opcode at disassembly");
+	SETICB ("asm.opcache", 16384, &cb_asmopcache, "Decoded instructions kept to print them again (0 to disable, see pdO)");
 	SETPREF ("asm.bytespace", "false", "Separate hexadecimal bytes with a whitespace");
 #if R_SYS_BITS == R_SYS_BITS_64
 	SETICB ("asm.bits", 64, &cb_asmbits, "Word size in bits at assembler");
@@ -2868,6 +2916,7 @@ R_API int r_core_config_init(RCore *core) {
 	SETDESC (n, "Filter strings");
 	SETOPTIONS (n, "a", "8", "p", "e", "u", "i", "U", "f", NULL);
 	SETCB ("bin.filter", "true", &cb_binfilter, "Filter symbol names to fix dupped names");
+	SETCB ("bin.cache", "false", &cb_bincache, "Keep the symbols, relocs, strings.. of the opened files in dir.bincache");
 	SETCB ("bin.force", "", &cb_binforce, "Force that rbin plugin");
 	SETPREF ("bin.lang", "", "Language for bin.demangle");
 	SETPREF ("bin.demangle", "true", "Import demangled symbols from RBin");
@@ -2969,6 +3018,7 @@ R_API int r_core_config_init(RCore *core) {
 	SETI ("diff.to", 0, "Set destination diffing address for px (uses cc command)");
 	SETPREF ("diff.bare", "false", "Never show function names in diff output");
 	SETPREF ("diff.levenstein", "false", "Use faster (and buggy) levenstein algorithm for buffer distance diffing");
+	SETICB ("diff.jobs", 1, &cb_diff_jobs, "Number of threads used to compare functions when diffing code (radiff2 -C)");
 
 	/* dir */
 	SETI ("dir.depth", 10,  "Maximum depth when searching recursively for files");
@@ -2991,6 +3041,7 @@ R_API int r_core_config_init(RCore *core) {
 	SETPREF ("dir.projects", R_JOIN_2_PATHS ("~", R2_HOME_PROJECTS), "Default path for projects");
 #endif
 	SETCB ("dir.zigns", R_JOIN_2_PATHS ("~", R2_HOME_ZIGNS), &cb_dirzigns, "Default path for zignatures (see zo command)");
+	SETCB ("dir.bincache", R_JOIN_2_PATHS ("~", R2_HOME_BINCACHE), &cb_dirbincache, "Path of the bin cache files (see bin.cache)");
 	SETPREF ("stack.reg", "SP", "Which register to use as stack pointer in the visual debug");
 	SETPREF ("stack.bytes", "true", "Show bytes instead of words in stack");
 	SETPREF ("stack.anotated", "false", "Show anotated hexdump in visual debug");
@@ -3149,6 +3200,8 @@ R_API int r_core_config_init(RCore *core) {
 	SETPREF ("http.ui", "m", "Default webui (enyo, m, p, t)");
 	SETPREF ("http.sandbox", "true", "Sandbox the HTTP server");
 	SETI ("http.timeout", 3, "Disconnect clients after N seconds of inactivity");
+	SETPREF ("http.keepalive", "true", "Reuse the client connections (HTTP/1.1 keep-alive)");
+	SETI ("http.maxclients", 8, "Number of clients served at the same time");
 	SETI ("http.dietime", 0, "Kill server after N seconds with no client");
 	SETPREF ("http.verbose", "false", "Output server logs to stdout");
 	SETPREF ("http.upget", "false", "/up/ answers GET requests, in addition to POST");
@@ -3216,6 +3269,7 @@ R_API int r_core_config_init(RCore *core) {
 	SETICB ("scr.linesleep", 0, &cb_scrlinesleep, "Flush sleeping some ms in every line");
 	SETICB ("scr.pagesize", 1, &cb_scrpagesize, "Flush in pages when scr.linesleep is != 0");
 	SETCB ("scr.flush", "false", &cb_scrflush, "Force flush to console in realtime (breaks scripting)");
+	SETCB ("scr.stream", "false", &cb_scrstream, "Write long outputs while they are produced, grepping them a few lines at a time");
 	/* TODO: rename to asm.color.ops ? */
 	SETPREF ("scr.zoneflags", "true", "Show zoneflags in visual mode before the title (see fz?)");
 	SETPREF ("scr.slow", "true", "Do slow stuff on visual mode like RFlag.get_at(true)");
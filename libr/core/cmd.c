@@ -2652,6 +2652,10 @@ escape_backtick:
 	}
 	if (*cmd != '.') {
 		grep = r_cons_grep_strip (cmd, quotestr);
+		if (grep && core->cons->stream) {
+			// set up the grep now so long outputs can be filtered as they come
+			r_cons_grep_process (strdup (grep));
+		}
 	}
 
 	/* temporary seek commands */
@@ -1955,6 +1955,7 @@ static bool anal_fcn_del_bb(RCore *core, const char *input) {
 	}
 	RAnalFunction *fcn = r_anal_get_fcn_in (core->anal, addr, -1);
 	if (fcn) {
+		r_anal_fcn_invalidate (fcn);
 		if (!strcmp (input, "*")) {
 			r_list_free (fcn->bbs);
 			fcn->bbs = NULL;
@@ -5511,7 +5512,7 @@ static void _anal_calls(RCore *core, ut64 addr, ut64 addr_end, bool printCommand
 			addr += bsz;
 			continue;
 		}
-		RAnalHint *hint = r_anal_hint_get (core->anal, addr);
+		const RAnalHint *hint = r_anal_hint_at (core->anal, addr);
 		if (hint && hint->bits) {
 			setBits = hint->bits;
 		}
@@ -795,7 +795,7 @@ rep:
 			}
 			f = r_flag_get_i (core->flags, off);
 			if (f) {
-				f->space = r_flag_space_cur (core->flags);
+				r_flag_item_set_space (core->flags, f, r_flag_space_cur (core->flags));
 			} else {
 				eprintf ("Cannot find any flag at 0x%"PFMT64x".\n", off);
 			}
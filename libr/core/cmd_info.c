@@ -48,6 +48,7 @@ static const char *help_msg_i[] = {
 	"iS=", "", "Show ascii-art color bars with the section ranges",
 	"iSS", "", "List memory segments (maps with om)",
 	"it", "", "File hashes",
+	"iT", "", "Time spent loading each kind of bin item (- if not loaded yet)",
 	"iV", "", "Display file version info",
 	"iX", "", "Display source files used (via dwarf)",
 	"iz|izj", "", "Strings in data sections (in JSON/Base64)",
@@ -293,6 +294,40 @@ static void cmd_info_bin(RCore *core, int va, int mode) {
 	}
 }
 
+static RBinObject *cur_object_with(RCore *core, int item) {
+	RBinObject *obj = r_bin_cur_object (core->bin);
+	if (obj) {
+		r_bin_object_load_item (core->bin->cur, obj, item);
+	}
+	return obj;
+}
+
+static void cmd_info_load_times(RCore *core, int mode) {
+	RBinObject *obj = r_bin_cur_object (core->bin);
+	int i;
+	if (!obj) {
+		return;
+	}
+	if (mode == R_MODE_JSON) {
+		r_cons_printf ("{");
+	}
+	for (i = 0; i < R_BIN_ITEM_LAST; i++) {
+		const char *name = r_bin_object_item_name (i);
+		bool loaded = obj->loaded & (1 << i);
+		if (mode == R_MODE_JSON) {
+			r_cons_printf ("%s\"%s\":{\"loaded\":%s,\"usec\":%"PFMT64u"}",
+				i? ",": "", name, r_str_bool (loaded), obj->load_time[i]);
+		} else if (loaded) {
+			r_cons_printf ("%-9s %10.3f ms\n", name, obj->load_time[i] / 1000.0);
+		} else {
+			r_cons_printf ("%-9s %13s\n", name, "-");
+		}
+	}
+	if (mode == R_MODE_JSON) {
+		r_cons_printf ("}\n");
+	}
+}
+
 static void playMsg(RCore *core, const char *n, int len) {
 	if (r_config_get_i (core->config, "scr.tts")) {
 		if (len > 0) {
@@ -582,7 +617,7 @@ static int cmd_info(void *data, const char *input) {
 			goto done;
 		}
 		case 's': { // "is"
-			RBinObject *obj = r_bin_cur_object (core->bin);
+			RBinObject *obj = cur_object_with (core, R_BIN_ITEM_SYMBOLS);
 			// Case for isj.
 			if (input[1] == 'j' && input[2] == '.') {
 				mode = R_MODE_JSON;
@@ -713,7 +748,7 @@ static int cmd_info(void *data, const char *input) {
 			}
 			break;
 		case 'i': { // "ii"
-			RBinObject *obj = r_bin_cur_object (core->bin);
+			RBinObject *obj = cur_object_with (core, R_BIN_ITEM_IMPORTS);
 			RBININFO ("imports", R_CORE_BIN_ACC_IMPORTS, NULL,
 				(obj && obj->imports)? r_list_length (obj->imports): 0);
 			break;
@@ -729,6 +764,9 @@ static int cmd_info(void *data, const char *input) {
 				RBININFO ("entries", R_CORE_BIN_ACC_ENTRIES, NULL, 0);
 			}
 			break;
+		case 'T': // "iT"
+			cmd_info_load_times (core, mode);
+			break;
 		case 'M': // "iM"
 			RBININFO ("main", R_CORE_BIN_ACC_MAIN, NULL, 0);
 			break;
@@ -797,7 +835,7 @@ static int cmd_info(void *data, const char *input) {
 				}
 				RBININFO ("strings", R_CORE_BIN_ACC_RAW_STRINGS, NULL, 0);
 			} else {
-				RBinObject *obj = r_bin_cur_object (core->bin);
+				RBinObject *obj = cur_object_with (core, R_BIN_ITEM_STRINGS);
 				if (input[1] == 'q') {
 					mode = (input[2] == 'q')
 					? R_MODE_SIMPLEST
@@ -817,7 +855,7 @@ static int cmd_info(void *data, const char *input) {
 				RBinClass *cls;
 				RBinSymbol *sym;
 				RListIter *iter, *iter2;
-				RBinObject *obj = r_bin_cur_object (core->bin);
+				RBinObject *obj = cur_object_with (core, R_BIN_ITEM_CLASSES);
 				if (obj) {
 					if (input[2]) {
 						int idx = -1;
@@ -907,7 +945,7 @@ static int cmd_info(void *data, const char *input) {
 					}
         			}
 			} else {
-				RBinObject *obj = r_bin_cur_object (core->bin);
+				RBinObject *obj = cur_object_with (core, R_BIN_ITEM_CLASSES);
 				if (obj && obj->classes) {
 					int len = r_list_length (obj->classes);
 					RBININFO ("classes", R_CORE_BIN_ACC_CLASSES, NULL, len);
@@ -141,13 +141,7 @@ static void cmd_meta_init(RCore *core) {
 }
 
 static int remove_meta_offset(RCore *core, ut64 offset) {
-	char aoffset[64];
-	char *aoffsetptr = sdb_itoa (offset, aoffset, 16);
-	if (!aoffsetptr) {
-		eprintf ("Failed to convert %"PFMT64x" to a key", offset);
-		return -1;
-	}
-	return sdb_unset (core->bin->cur->sdb_addrinfo, aoffsetptr, 0);
+	return r_bin_linetable_del (core->bin->cur->addrlines, offset);
 }
 
 static void print_meta_offset(RCore *core, ut64 offset) {
@@ -178,53 +172,50 @@ static void print_meta_offset(RCore *core, ut64 offset) {
 	}
 }
 
-static int remove_meta_fileline(RCore *core, const char *file_line) {
-	return sdb_unset (core->bin->cur->sdb_addrinfo, file_line, 0);
+// file_line is "file|line", the line number is split in place
+static bool parse_fileline(char *file_line, ut32 *line) {
+	char *sep = strrchr (file_line, '|');
+	if (!sep) {
+		return false;
+	}
+	*sep = 0;
+	*line = (ut32)r_num_get (NULL, sep + 1);
+	return true;
 }
 
-static int print_meta_fileline(RCore *core, const char *file_line) {
-	char *meta_info = sdb_get (core->bin->cur->sdb_addrinfo, file_line, 0);
-	if (meta_info) {
-		r_cons_printf ("Meta info %s\n", meta_info);
-	} else {
-		r_cons_printf ("No meta info for %s found\n", file_line);
+static int remove_meta_fileline(RCore *core, char *file_line) {
+	ut32 line;
+	if (!parse_fileline (file_line, &line)) {
+		return 0;
 	}
-	return 0;
+	return r_bin_linetable_del_line (core->bin->cur->addrlines, file_line, line);
 }
 
-static int print_addrinfo (void *user, const char *k, const char *v) {
-	char *colonpos, *subst;
-
-	ut64 offset = sdb_atoi (k);
-	if (!offset) {
-		return true;
+static int print_meta_fileline(RCore *core, char *file_line) {
+	ut64 addr;
+	ut32 line = 0;
+	if (parse_fileline (file_line, &line)
+			&& r_bin_linetable_find (core->bin->cur->addrlines, file_line, line, &addr)) {
+		r_cons_printf ("Meta info 0x%"PFMT64x"\n", addr);
+	} else {
+		r_cons_printf ("No meta info for %s:%d found\n", file_line, line);
 	}
-	subst = strdup (v);
-	colonpos = strchr (subst, '|');
+	return 0;
+}
 
-	if (colonpos) {
-		*colonpos = ':';
+static bool print_addrinfo(void *user, ut64 addr, const char *file, ut32 line) {
+	if (addr) {
+		r_cons_printf ("CL %s:%d 0x%"PFMT64x"\n", file, line, addr);
 	}
-	r_cons_printf ("CL %s %s\n", subst, k);
-	free (subst);
-
 	return true;
 }
 
-static int cmd_meta_add_fileline(Sdb *s, char *fileline, ut64 offset) {
-	char aoffset[64];
-	char *aoffsetptr = sdb_itoa (offset, aoffset, 16);
-
-	if (!aoffsetptr) {
+static int cmd_meta_add_fileline(RBinLineTable *lt, char *fileline, ut64 offset) {
+	ut32 line;
+	if (!parse_fileline (fileline, &line)) {
 		return -1;
 	}
-	if (!sdb_add (s, aoffsetptr, fileline, 0)) {
-		sdb_set (s, aoffsetptr, fileline, 0);
-	}
-	if (!sdb_add (s, fileline, aoffsetptr, 0)) {
-		sdb_set (s, fileline, aoffsetptr, 0);
-	}
-	return 0;
+	return r_bin_linetable_set (lt, offset, fileline, line)? 0: -1;
 }
 
 static int cmd_meta_lineinfo(RCore *core, const char *input) {
@@ -239,6 +230,10 @@ static int cmd_meta_lineinfo(RCore *core, const char *input) {
 		eprintf ("Usage: CL[-][*] [file:line] [addr]");
 		return 0;
 	}
+	if (!core->bin->cur || !core->bin->cur->addrlines) {
+		eprintf ("No bin file to hold the line information\n");
+		return -1;
+	}
 
 	if (*p == '-') {
 		p++;
@@ -252,9 +247,9 @@ static int cmd_meta_lineinfo(RCore *core, const char *input) {
 
 	if (all) {
 		if (remove) {
-			sdb_reset (core->bin->cur->sdb_addrinfo);
+			r_bin_linetable_reset (core->bin->cur->addrlines);
 		} else {
-			sdb_foreach (core->bin->cur->sdb_addrinfo, print_addrinfo, NULL);
+			r_bin_linetable_foreach (core->bin->cur->addrlines, print_addrinfo, NULL);
 		}
 		return 0;
 	}
@@ -302,7 +297,7 @@ static int cmd_meta_lineinfo(RCore *core, const char *input) {
 				eprintf ("Failed to parse addr at %s\n", p);
 				// goto error;
 			} else {
-				ret = cmd_meta_add_fileline (core->bin->cur->sdb_addrinfo,
+				ret = cmd_meta_add_fileline (core->bin->cur->addrlines,
 						file_line, offset);
 				goto error;
 			}
@@ -280,6 +280,7 @@ static const char *help_msg_pd[] = {
 	"pdJ", "", "formatted disassembly like pd as json",
 	"pdk", "", "disassemble all methods of a class",
 	"pdl", "", "show instruction sizes",
+	"pdO", "[j-]", "show hit rates of the decode cache (pdO- to flush it, see asm.opcache)",
 	"pdp", "", "disassemble by following pointers to read ropchains",
 	"pdr", "", "recursive disassemble across the function graph",
 	"pdr.", "", "recursive disassemble across the function graph (from current basic block)",
@@ -3109,17 +3110,30 @@ static void cmd_print_bars(RCore *core, const char *input) {
 				eprintf ("Error: failed to malloc memory");
 				goto beach;
 			}
-			p = malloc (blocksize);
-			if (!p) {
+			// hash a batch of consecutive blocks at once so the entropy of
+			// each one is computed on all the cpus
+			int batch = R_MAX (1, R_MIN (nblocks, (16 * 1024 * 1024) / blocksize));
+			p = malloc ((size_t)batch * blocksize);
+			RHashBlock *hb = R_NEWS (RHashBlock, batch);
+			if (!p || !hb) {
 				R_FREE (ptr);
+				free (p);
+				free (hb);
 				eprintf ("Error: failed to malloc memory");
 				goto beach;
 			}
-			for (i = 0; i < nblocks; i++) {
+			double bits = log2 ((double) R_MIN (blocksize, 256));
+			int nth = r_th_ncpus ();
+			for (i = 0; i < nblocks; i += batch) {
+				int j, n = R_MIN (batch, nblocks - i);
 				ut64 off = from + (blocksize * (i + skipblocks));
-				r_io_read_at (core->io, off, p, blocksize);
-				ptr[i] = (ut8) (255 * r_hash_entropy_fraction (p, blocksize));
+				r_io_read_at (core->io, off, p, n * blocksize);
+				r_hash_calculate_blocks (R_HASH_ENTROPY, p, (ut64)n * blocksize, blocksize, hb, nth);
+				for (j = 0; j < n; j++) {
+					ptr[i + j] = bits > 0? (ut8) (255 * (hb[j].entropy / bits)): 0;
+				}
 			}
+			free (hb);
 			free (p);
 			r_print_columns (core->print, ptr, nblocks, 14);
 		}
@@ -4952,6 +4966,17 @@ static int cmd_print(void *data, const char *input) {
 			disasm_ropchain (core, core->offset, 'D');
 			pd_result = true;
 			break;
+		case 'O': // "pdO"
+			processed_cmd = true;
+			if (input[2] == '-') {
+				if (core->opcache) {
+					r_core_opcache_flush (core->opcache);
+				}
+			} else {
+				r_core_opcache_print (core, input[2]);
+			}
+			pd_result = 0;
+			break;
 		case 'l': // "pdl"
 			processed_cmd = true;
 			{
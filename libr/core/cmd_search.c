@@ -2309,6 +2309,7 @@ static void do_string_search(RCore *core, RInterval search_itv, struct search_pa
 					eprintf ("\n\n");
 					break;
 				}
+				const ut8 *data = buf;
 				if (search->bckwrds) {
 					len = R_MIN (core->blocksize, at - from);
 					// TODO prefix_read_at
@@ -2321,15 +2322,21 @@ static void do_string_search(RCore *core, RInterval search_itv, struct search_pa
 					if (!r_io_is_valid_offset (core->io, at, 0)) {
 						break;
 					}
-					(void)r_io_read_at (core->io, at, buf, len);
+					// scan mmap'd files in place instead of copying each block,
+					// unless a hit command could write and remap the file
+					data = *param->cmd_hit? NULL: r_io_peek (core->io, at, len);
+					if (!data) {
+						(void)r_io_read_at (core->io, at, buf, len);
+						data = buf;
+					}
 				}
 				if (param->crypto_search) {
 					// TODO support backward search
 					int delta = 0;
 					if (param->aes_search) {
-						delta = r_search_aes_update (core->search, at, buf, len);
+						delta = r_search_aes_update (core->search, at, data, len);
 					} else if (param->rsa_search) {
-						delta = r_search_rsa_update (core->search, at, buf, len);
+						delta = r_search_rsa_update (core->search, at, data, len);
 					}
 					if (delta != -1) {
 						int t = r_search_hit_new (core->search, &aeskw, at + delta);
@@ -2338,7 +2345,7 @@ static void do_string_search(RCore *core, RInterval search_itv, struct search_pa
 						}
 					}
 				} else {
-					(void)r_search_update (core->search, at, buf, len);
+					(void)r_search_update (core->search, at, data, len);
 					if (core->search->maxhits > 0 && core->search->nhits >= core->search->maxhits) {
 						goto done;
 					}
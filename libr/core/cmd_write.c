@@ -1111,6 +1111,7 @@ static int cmd_write(void *data, const char *input) {
 		case '-': { // "wc-"
 			if (input[2]=='*') { // "wc-*"
 				r_io_cache_reset (core->io, true);
+				r_core_block_read (core);
 				break;
 			}
 			ut64 from, to;
@@ -2746,6 +2746,8 @@ R_API RCore *r_core_fini(RCore *c) {
 	//update_sdb (c);
 	// avoid double free
 	r_list_free (c->ropchain);
+	r_core_opcache_free (c->opcache);
+	c->opcache = NULL;
 	r_core_free_autocomplete (c);
 	r_event_free (c->ev);
 	R_FREE (c->cmdlog);
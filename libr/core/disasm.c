@@ -225,7 +225,7 @@ typedef struct {
 	const char *color_func_var_addr;
 
 	RFlagItem *lastflag;
-	RAnalHint *hint;
+	const RAnalHint *hint;
 	RPrint *print;
 
 	ut64 esil_old_pc;
@@ -841,7 +841,6 @@ static void ds_free(RDisasmState *ds) {
 	}
 	r_asm_op_fini (&ds->asmop);
 	r_anal_op_fini (&ds->analop);
-	r_anal_hint_free (ds->hint);
 	ds_print_esil_anal_fini (ds);
 	ds_reflines_fini (ds);
 	ds_print_esil_anal_fini (ds);
@@ -927,6 +926,14 @@ static char *get_op_ireg (void *user, ut64 addr) {
 	return res;
 }
 
+// commands run from the disassembly may add or remove hints, which
+// invalidates the record ds->hint points to
+static void ds_hint_refresh(RDisasmState *ds) {
+	if (ds->hint) {
+		ds->hint = r_anal_hint_at (ds->core->anal, ds->at);
+	}
+}
+
 static void ds_build_op_str(RDisasmState *ds, bool print_color) {
 	RCore *core = ds->core;
 	if (!ds->opstr) {
@@ -1048,11 +1055,11 @@ static void ds_build_op_str(RDisasmState *ds, bool print_color) {
 
 //removed hints bits from since r_anal_build_range_on_hints along with
 //r_core_seek_archbits will be used instead. The ranges are built from hints
-R_API RAnalHint *r_core_hint_begin(RCore *core, RAnalHint* hint, ut64 at) {
+// the returned hint is owned by the anal and valid until the hints change
+R_API const RAnalHint *r_core_hint_begin(RCore *core, ut64 at) {
 	static char *hint_arch = NULL;
 	static char *hint_syntax = NULL;
-	r_anal_hint_free (hint);
-	hint = r_anal_hint_get (core->anal, at);
+	const RAnalHint *hint = r_anal_hint_at (core->anal, at);
 	if (hint_arch) {
 		r_config_set (core->config, "asm.arch", hint_arch);
 		hint_arch = NULL;
@@ -2108,7 +2115,7 @@ static int ds_disassemble(RDisasmState *ds, ut8 *buf, int len) {
 		return true;
 	}
 	r_asm_op_fini (&ds->asmop);
-	ret = r_asm_disassemble (core->assembler, &ds->asmop, buf, len);
+	ret = r_core_opcache_asm (core, &ds->asmop, buf, len);
 	if (ds->asmop.size < 1) {
 		ds->asmop.size = 1;
 	}
@@ -2139,6 +2146,7 @@ static int ds_disassemble(RDisasmState *ds, ut8 *buf, int len) {
 				break;
 			case R_META_TYPE_RUN:
 				r_core_cmd0 (core, meta->str);
+				ds_hint_refresh (ds);
 				break;
 			}
 			int sz = R_MIN (16, meta->size - (ds->at - meta->from));
@@ -2229,6 +2237,7 @@ static void ds_control_flow_comments(RDisasmState *ds) {
 			switch (ds->analop.type) {
 			case R_ANAL_OP_TYPE_CALL:
 				r_core_cmdf (ds->core, "af @ 0x%"PFMT64x, ds->analop.jump);
+				ds_hint_refresh (ds);
 				break;
 			}
 		}
@@ -2705,6 +2714,7 @@ static int ds_print_meta_infos(RDisasmState *ds, ut8* buf, int len, int idx) {
 					break;
 				case R_META_TYPE_RUN:
 					r_core_cmdf (core, "%s @ 0x%"PFMT64x, mi->str, ds->at);
+					ds_hint_refresh (ds);
 					ds->asmop.size = mi->size;
 					ds->oplen = mi->size;
 					ds->mi_found = true;
@@ -3177,12 +3187,11 @@ static int ds_print_shortcut(RDisasmState *ds, ut64 addr, int pos) {
 static bool ds_print_core_vmode_jump_hit(RDisasmState *ds, int pos) {
 	RCore *core = ds->core;
 	RAnal *a = core->anal;
-	RAnalHint *hint = r_anal_hint_get (a, ds->at);
+	const RAnalHint *hint = r_anal_hint_at (a, ds->at);
 	if (hint) {
 		if (hint->jump != UT64_MAX) {
 			ds_print_shortcut (ds, hint->jump, pos);
 		}
-		r_anal_hint_free (hint);
 		return true;
 	}
 	return false;
@@ -4803,7 +4812,7 @@ toro:
 		}
 		r_core_seek_archbits (core, ds->at); // slow but safe
 		ds->has_description = false;
-		ds->hint = r_core_hint_begin (core, ds->hint, ds->at);
+		ds->hint = r_core_hint_begin (core, ds->at);
 		ds->printed_str_addr = UT64_MAX;
 		ds->printed_flag_addr = UT64_MAX;
 		// XXX. this must be done in ds_update_pc()
@@ -4811,7 +4820,7 @@ toro:
 		r_asm_set_pc (core->assembler, ds->at);
 		ds_update_ref_lines (ds);
 		r_anal_op_fini (&ds->analop);
-		r_anal_op (core->anal, &ds->analop, ds->at, buf + addrbytes * idx, (int)(len - addrbytes * idx), R_ANAL_OP_MASK_ALL);
+		r_core_opcache_anal (core, &ds->analop, ds->at, buf + addrbytes * idx, (int)(len - addrbytes * idx));
 		if (ds_must_strip (ds)) {
 			inc = ds->analop.size;
 			// inc = ds->asmop.payload + (ds->asmop.payload % ds->core->assembler->dataalign);
@@ -4908,7 +4917,7 @@ toro:
 #else
 		if (ds->analop.addr != ds->at) {
 			r_anal_op_fini (&ds->analop);
-			r_anal_op (core->anal, &ds->analop, ds->at, buf + addrbytes * idx, (int)(len - addrbytes * idx), R_ANAL_OP_MASK_ALL);
+			r_core_opcache_anal (core, &ds->analop, ds->at, buf + addrbytes * idx, (int)(len - addrbytes * idx));
 		}
 #endif
 		if (ret < 1) {
@@ -5282,12 +5291,12 @@ R_API int r_core_print_disasm_instructions(RCore *core, int nb_bytes, int nb_opc
 		if (r_cons_is_breaked ()) {
 			break;
 		}
-		ds->hint = r_core_hint_begin (core, ds->hint, ds->at);
+		ds->hint = r_core_hint_begin (core, ds->at);
 		ds->has_description = false;
 		r_asm_set_pc (core->assembler, ds->at);
 		// XXX copypasta from main disassembler function
 		// r_anal_get_fcn_in (core->anal, ds->at, R_ANAL_FCN_TYPE_NULL);
-		ret = r_asm_disassemble (core->assembler, &ds->asmop,
+		ret = r_core_opcache_asm (core, &ds->asmop,
 			core->block + addrbytes * i, core->blocksize - addrbytes * i);
 		ds->oplen = ret;
 		if (ds->midflags) {
@@ -5304,7 +5313,7 @@ R_API int r_core_print_disasm_instructions(RCore *core, int nb_bytes, int nb_opc
 		}
 		r_anal_op_fini (&ds->analop);
 		if (ds->show_color && !hasanal) {
-			r_anal_op (core->anal, &ds->analop, ds->at, core->block + addrbytes * i, core->blocksize - addrbytes * i, R_ANAL_OP_MASK_ALL);
+			r_core_opcache_anal (core, &ds->analop, ds->at, core->block + addrbytes * i, core->blocksize - addrbytes * i);
 			hasanal = true;
 		}
 		if (ds_must_strip (ds)) {
@@ -5330,7 +5339,7 @@ R_API int r_core_print_disasm_instructions(RCore *core, int nb_bytes, int nb_opc
 			if (ds->decode && !ds->immtrim) {
 				free (ds->opstr);
 				if (!hasanal) {
-					r_anal_op (core->anal, &ds->analop, ds->at, core->block+i, core->blocksize-i, R_ANAL_OP_MASK_ALL);
+					r_core_opcache_anal (core, &ds->analop, ds->at, core->block + i, core->blocksize - i);
 					hasanal = true;
 				}
 				tmpopstr = r_anal_op_to_string (core->anal, &ds->analop);
@@ -5366,7 +5375,6 @@ R_API int r_core_print_disasm_instructions(RCore *core, int nb_bytes, int nb_opc
 					}
 				}
 				core->parser->hint = ds->hint;
-				ds->hint = NULL;
 				r_parse_filter (core->parser, ds->vat, core->flags, r_asm_op_get_asm (&ds->asmop),
 					ds->str, sizeof (ds->str), core->print->big_endian);
 				ds->opstr = strdup (ds->str);
@@ -5394,10 +5402,7 @@ R_API int r_core_print_disasm_instructions(RCore *core, int nb_bytes, int nb_opc
 			}
 			R_FREE (ds->opstr);
 		}
-		if (ds->hint) {
-			r_anal_hint_free (ds->hint);
-			ds->hint = NULL;
-		}
+		ds->hint = NULL;
 	}
 	r_cons_break_pop ();
 	ds_free (ds);
@@ -5501,7 +5506,7 @@ R_API int r_core_print_disasm_json(RCore *core, ut64 addr, ut8 *buf, int nb_byte
 		int skip_bytes_flag = 0, skip_bytes_bb = 0;
 
 		at = addr + k;
-		ds->hint = r_core_hint_begin (core, ds->hint, ds->at);
+		ds->hint = r_core_hint_begin (core, ds->at);
 		r_asm_set_pc (core->assembler, at);
 		// 32 is the biggest opcode length in intel
 		// Make sure we have room for it
@@ -5519,7 +5524,7 @@ R_API int r_core_print_disasm_json(RCore *core, ut64 addr, ut8 *buf, int nb_byte
 			break;
 		}
 		memset (&asmop, 0, sizeof (RAsmOp));
-		ret = r_asm_disassemble (core->assembler, &asmop, buf + i, nb_bytes - i);
+		ret = r_core_opcache_asm (core, &asmop, buf + i, nb_bytes - i);
 		if (ret < 1) {
 			pj_o (pj);
 			pj_kn (pj, "offset", at);
@@ -5538,7 +5543,7 @@ R_API int r_core_print_disasm_json(RCore *core, ut64 addr, ut8 *buf, int nb_byte
 
 		ds->has_description = false;
 		r_anal_op_fini (&ds->analop);
-		r_anal_op (core->anal, &ds->analop, at, buf + i, nb_bytes - i, R_ANAL_OP_MASK_ALL);
+		r_core_opcache_anal (core, &ds->analop, at, buf + i, nb_bytes - i);
 
 		if (ds->pseudo) {
 			r_parse_parse (core->parser, opstr, opstr);
@@ -6032,7 +6037,7 @@ toro:
 					r_parse_immtrim (asm_str);
 				}
 				if (filter) {
-					core->parser->hint = r_anal_hint_get (core->anal, at);
+					core->parser->hint = r_anal_hint_at (core->anal, at);
 					r_parse_filter (core->parser, at, core->flags,
 						asm_str, opstr, sizeof (opstr) - 1, core->print->big_endian);
 					asm_str = (char *)&opstr;
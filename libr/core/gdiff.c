@@ -36,7 +36,6 @@ R_API int r_core_gdiff_fcn(RCore *c, ut64 addr, ut64 addr2) {
 R_API int r_core_gdiff(RCore *c, RCore *c2) {
 	RCore *cores[2] = {c, c2};
 	RAnalFunction *fcn;
-	RAnalBlock *bb;
 	RListIter *iter, *iter2;
 	int i;
 
@@ -51,13 +50,7 @@ R_API int r_core_gdiff(RCore *c, RCore *c2) {
 				r_list_delete (cores[i]->anal->fcns, iter);
 			}
 		}
-		/* Fingerprint fcn bbs (functions basic-blocks) */
-		r_list_foreach (cores[i]->anal->fcns, iter, fcn) {
-			r_list_foreach (fcn->bbs, iter2, bb) {
-				r_anal_diff_fingerprint_bb (cores[i]->anal, bb);
-			}
-		}
-		/* Fingerprint fcn */
+		/* Fingerprint fcn and its bbs, reusing the cached ones */
 		r_list_foreach (cores[i]->anal->fcns, iter, fcn) {
 			int newsize = r_anal_diff_fingerprint_fcn (cores[i]->anal, fcn);
 			r_anal_fcn_set_size (cores[i]->anal, fcn, newsize);
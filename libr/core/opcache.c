@@ -0,0 +1,295 @@
+/* radare - LGPL - Copyright 2026 - agent */
+
+#include <r_core.h>
+
+// Decoded instructions by address, so that printing the same code again
+// (pd, pdf, scrolling in visual mode) does not run the asm and anal plugins
+// over the same bytes once more. An entry is only used if the bytes and the
+// decoder settings it was made with are still the current ones, writes and
+// hint changes are caught through the io and hint generation counters.
+
+// bytes compared on lookup, instructions longer than this are not cached
+#define OPCACHE_BYTES 32
+
+typedef struct {
+	const void *asm_cur;
+	const void *anal_cur;
+	const void *ofilter;
+	const void *regs;
+	const void *bobj;
+	ut32 asm_cpu;
+	ut32 anal_cpu;
+	ut32 features;
+	int bits;
+	int anal_bits;
+	int syntax;
+	int big_endian;
+	int anal_big_endian;
+	int invhex;
+	int immdisp;
+	int seggrn;
+	ut64 gp;
+	ut32 wgen;
+	ut32 hgen;
+} OpCacheKey;
+
+typedef struct {
+	OpCacheKey key;
+	int len;
+	ut8 bytes[OPCACHE_BYTES];
+	bool has_asm;
+	int asm_ret;
+	int asm_size;
+	int asm_payload;
+	char *asm_str;
+	bool has_anal;
+	int anal_ret;
+	RAnalOp op;
+} OpCacheItem;
+
+static void item_reset(OpCacheItem *it) {
+	if (it->has_anal) {
+		r_anal_op_fini (&it->op);
+		it->has_anal = false;
+	}
+	R_FREE (it->asm_str);
+	it->has_asm = false;
+}
+
+static void item_free(HtUPKv *kv) {
+	OpCacheItem *it = kv->value;
+	item_reset (it);
+	free (it);
+}
+
+R_API RCoreOpCache *r_core_opcache_new(int max) {
+	RCoreOpCache *oc = R_NEW0 (RCoreOpCache);
+	if (!oc) {
+		return NULL;
+	}
+	oc->ht = ht_up_new (NULL, item_free, NULL);
+	if (!oc->ht) {
+		free (oc);
+		return NULL;
+	}
+	oc->max = R_MAX (max, 1);
+	return oc;
+}
+
+R_API void r_core_opcache_free(RCoreOpCache *oc) {
+	if (oc) {
+		ht_up_free (oc->ht);
+		free (oc);
+	}
+}
+
+R_API void r_core_opcache_flush(RCoreOpCache *oc) {
+	r_return_if_fail (oc);
+	ht_up_free (oc->ht);
+	oc->ht = ht_up_new (NULL, item_free, NULL);
+	oc->stats.flushes++;
+}
+
+// decoders that depend on more than the bytes of one instruction: hexagon
+// keeps the constant extender of the previous one, java tracks switch tables
+// and 8051 maps memory through the current register values
+static const char *stateful_archs[] = { "8051", "hexagon", "java", NULL };
+
+static bool is_stateful(const char *arch) {
+	int i;
+	for (i = 0; arch && stateful_archs[i]; i++) {
+		if (!strcmp (arch, stateful_archs[i])) {
+			return true;
+		}
+	}
+	return false;
+}
+
+static ut32 str_hash(const char *s) {
+	return s? sdb_hash (s): 0;
+}
+
+// everything besides the bytes that the decoded text and op depend on
+static void opcache_key(RCore *core, OpCacheKey *key) {
+	RAsm *a = core->assembler;
+	RAnal *anal = core->anal;
+	memset (key, 0, sizeof (*key));
+	key->asm_cur = a->cur;
+	key->anal_cur = anal->cur;
+	key->ofilter = a->ofilter;
+	key->regs = anal->reg? anal->reg->reg_profile_str: NULL;
+	key->bobj = r_bin_cur_object (core->bin);
+	key->asm_cpu = str_hash (a->cpu);
+	key->anal_cpu = str_hash (anal->cpu);
+	key->features = str_hash (a->features);
+	key->bits = a->bits;
+	key->anal_bits = anal->bits;
+	key->syntax = a->syntax;
+	key->big_endian = a->big_endian;
+	key->anal_big_endian = anal->big_endian;
+	key->invhex = a->invhex;
+	key->immdisp = a->immdisp;
+	key->seggrn = a->seggrn;
+	key->gp = anal->gp;
+	key->wgen = core->io->wgen;
+	key->hgen = anal->hints_gen;
+}
+
+// returns the entry of addr, emptied unless it was made from the same
+// bytes and settings
+static OpCacheItem *opcache_get(RCoreOpCache *oc, ut64 addr, const OpCacheKey *key, const ut8 *buf, int len) {
+	int n = R_MIN (len, OPCACHE_BYTES);
+	OpCacheItem *it = ht_up_find (oc->ht, addr, NULL);
+	if (it) {
+		if (it->len == n && !memcmp (&it->key, key, sizeof (*key)) && !memcmp (it->bytes, buf, n)) {
+			return it;
+		}
+		if (it->has_asm || it->has_anal) {
+			oc->stats.stale++;
+		}
+		item_reset (it);
+	} else {
+		if (oc->ht->count >= oc->max) {
+			r_core_opcache_flush (oc);
+		}
+		it = R_NEW0 (OpCacheItem);
+		if (!it) {
+			return NULL;
+		}
+		if (!ht_up_insert (oc->ht, addr, it)) {
+			free (it);
+			return NULL;
+		}
+	}
+	it->key = *key;
+	it->len = n;
+	memcpy (it->bytes, buf, n);
+	return it;
+}
+
+// like r_anal_op_copy but into dst and also copying opex, var is left out
+// because it comes from the function analysis and not from the bytes
+static void op_copy(RAnalOp *dst, RAnalOp *src) {
+	int i;
+	*dst = *src;
+	dst->mnemonic = src->mnemonic? strdup (src->mnemonic): NULL;
+	for (i = 0; i < 3; i++) {
+		dst->src[i] = src->src[i]? r_anal_value_copy (src->src[i]): NULL;
+	}
+	dst->dst = src->dst? r_anal_value_copy (src->dst): NULL;
+	dst->var = NULL;
+	dst->next = NULL;
+	dst->switch_op = NULL;
+	r_strbuf_init (&dst->esil);
+	r_strbuf_set (&dst->esil, r_strbuf_get (&src->esil));
+	r_strbuf_init (&dst->opex);
+	r_strbuf_set (&dst->opex, r_strbuf_get (&src->opex));
+}
+
+// r_asm_disassemble at the current asm pc
+R_API int r_core_opcache_asm(RCore *core, RAsmOp *op, const ut8 *buf, int len) {
+	r_return_val_if_fail (core && op && buf, -1);
+	RAsm *a = core->assembler;
+	RCoreOpCache *oc = core->opcache;
+	// bit shifted and misaligned decoding depends on more than the bytes
+	if (!oc || len < 1 || a->bitshift || (a->pcalign && a->pc % a->pcalign)
+			|| !a->cur || is_stateful (a->cur->arch)) {
+		return r_asm_disassemble (a, op, buf, len);
+	}
+	OpCacheKey key;
+	opcache_key (core, &key);
+	OpCacheItem *it = opcache_get (oc, a->pc, &key, buf, len);
+	if (it && it->has_asm) {
+		oc->stats.asm_hits++;
+		r_asm_op_init (op);
+		op->size = it->asm_size;
+		op->payload = it->asm_payload;
+		r_asm_op_set_asm (op, it->asm_str);
+		r_asm_op_set_buf (op, buf, (op->size > 0)? R_MIN (len, op->size): 1);
+		return it->asm_ret;
+	}
+	oc->stats.asm_misses++;
+	int ret = r_asm_disassemble (a, op, buf, len);
+	if (it && op->bitsize < 1 && !op->buf_inc && op->size <= it->len) {
+		it->asm_str = strdup (r_asm_op_get_asm (op));
+		if (it->asm_str) {
+			it->asm_ret = ret;
+			it->asm_size = op->size;
+			it->asm_payload = op->payload;
+			it->has_asm = true;
+		}
+	}
+	return ret;
+}
+
+// r_anal_op with R_ANAL_OP_MASK_ALL, except that op->var is not filled
+// for cached ops
+R_API int r_core_opcache_anal(RCore *core, RAnalOp *op, ut64 addr, const ut8 *buf, int len) {
+	r_return_val_if_fail (core && op && buf, -1);
+	RAnal *anal = core->anal;
+	RCoreOpCache *oc = core->opcache;
+	// plugins with a reset_counter keep decoding state of their own
+	if (!oc || len < 1 || (anal->pcalign && addr % anal->pcalign)
+			|| !anal->cur || anal->cur->reset_counter || is_stateful (anal->cur->arch)) {
+		return r_anal_op (anal, op, addr, buf, len, R_ANAL_OP_MASK_ALL);
+	}
+	OpCacheKey key, now;
+	opcache_key (core, &key);
+	OpCacheItem *it = opcache_get (oc, addr, &key, buf, len);
+	if (it && it->has_anal) {
+		oc->stats.anal_hits++;
+		op_copy (op, &it->op);
+		return it->anal_ret;
+	}
+	oc->stats.anal_misses++;
+	int ret = r_anal_op (anal, op, addr, buf, len, R_ANAL_OP_MASK_ALL);
+	// r_anal_op may switch the bits on its own, those ops are not kept
+	opcache_key (core, &now);
+	if (it && !op->switch_op && !op->next && op->size <= it->len && !memcmp (&key, &now, sizeof (key))) {
+		op_copy (&it->op, op);
+		it->anal_ret = ret;
+		it->has_anal = true;
+	}
+	return ret;
+}
+
+static int percent(ut64 hits, ut64 misses) {
+	ut64 total = hits + misses;
+	return total? (int)((hits * 100) / total): 0;
+}
+
+R_API void r_core_opcache_print(RCore *core, int mode) {
+	r_return_if_fail (core);
+	RCoreOpCache *oc = core->opcache;
+	if (!oc) {
+		eprintf ("The decode cache is disabled, see asm.opcache\n");
+		return;
+	}
+	RCoreOpCacheStats *st = &oc->stats;
+	if (mode == 'j') {
+		PJ *pj = pj_new ();
+		if (!pj) {
+			return;
+		}
+		pj_o (pj);
+		pj_kn (pj, "entries", oc->ht->count);
+		pj_kn (pj, "max", oc->max);
+		pj_kn (pj, "asm_hits", st->asm_hits);
+		pj_kn (pj, "asm_misses", st->asm_misses);
+		pj_kn (pj, "anal_hits", st->anal_hits);
+		pj_kn (pj, "anal_misses", st->anal_misses);
+		pj_kn (pj, "stale", st->stale);
+		pj_kn (pj, "flushes", st->flushes);
+		pj_end (pj);
+		r_cons_println (pj_string (pj));
+		pj_free (pj);
+		return;
+	}
+	r_cons_printf ("entries: %d (max %d)\n", (int)oc->ht->count, oc->max);
+	r_cons_printf ("asm:     %"PFMT64u" hits, %"PFMT64u" misses (%d%%)\n",
+		st->asm_hits, st->asm_misses, percent (st->asm_hits, st->asm_misses));
+	r_cons_printf ("anal:    %"PFMT64u" hits, %"PFMT64u" misses (%d%%)\n",
+		st->anal_hits, st->anal_misses, percent (st->anal_hits, st->anal_misses));
+	r_cons_printf ("stale:   %"PFMT64u"\n", st->stale);
+	r_cons_printf ("flushes: %"PFMT64u"\n", st->flushes);
+}
@@ -46,6 +46,44 @@ typedef struct {
 	char* input;
 } RapThread;
 
+typedef struct {
+	ut64 started_at;
+	ut64 connections;
+	ut64 requests;
+	ut64 reused; // requests read from a kept-alive connection
+	ut64 commands;
+	ut64 wait_total; // usecs the requests spent queued for the core
+	ut64 time_total; // usecs from reading the request to sending the response
+	ut64 time_max;
+	ut64 hist[32]; // requests by log2 of their latency in usecs
+} HttpStats;
+
+typedef struct {
+	RSocketHTTPRequest *rs;
+	RThreadSemaphore *done;
+	ut64 queued_at;
+	ut64 started_at;
+	bool close; // do not reuse the connection after the response
+} HttpJob;
+
+// Clients are served by a fixed number of threads that parse the requests
+// and keep the connections alive, but only the thread running the server
+// loop touches the core: the jobs are queued for it one by one.
+typedef struct {
+	RSocket *s;
+	RSocketHTTPOptions *so;
+	RThread **workers;
+	int nworkers;
+	RThreadLock *lock; // the queue and the stats
+	RThreadSemaphore *queued;
+	RList *queue;
+	HttpStats stats;
+	char *allow; // http.allow, the workers answer /stats on their own
+	bool stop; // set under the lock, no jobs are queued after it
+} HttpPool;
+
+static HttpPool *httppool = NULL;
+
 R_API void r_core_wait(RCore *core) {
 	r_cons_singleton ()->context->breaked = true;
 	r_th_kill (httpthread, true);
@@ -350,6 +388,250 @@ TODO:
 	return true;
 }
 
+static ut64 http_usecs(void) {
+	ut64 now = r_sys_now ();
+	return (now >> 20) * 1000000 + (now & 0xfffff);
+}
+
+static void http_stats_add(HttpPool *pool, RSocketHTTPRequest *rs, ut64 from, ut64 wait) {
+	HttpStats *st = &pool->stats;
+	ut64 t = http_usecs () - from;
+	r_th_lock_enter (pool->lock);
+	st->requests++;
+	if (rs->count) {
+		st->reused++;
+	} else {
+		st->connections++;
+	}
+	st->wait_total += wait;
+	st->time_total += t;
+	if (t > st->time_max) {
+		st->time_max = t;
+	}
+	int b = 0;
+	while (b < 31 && (1ULL << (b + 1)) <= t) {
+		b++;
+	}
+	st->hist[b]++;
+	r_th_lock_leave (pool->lock);
+}
+
+// upper bound of the latency of the given permille of the requests
+static ut64 http_stats_percentile(HttpStats *st, int pm) {
+	ut64 n = 0, want = (st->requests * pm + 999) / 1000;
+	int b;
+	for (b = 0; b < 32; b++) {
+		n += st->hist[b];
+		if (n && n >= want) {
+			return R_MIN (1ULL << (b + 1), st->time_max);
+		}
+	}
+	return st->time_max;
+}
+
+// check the peer against the comma separated list of hosts in http.allow
+static bool http_allowed(const char *allow, RSocket *s) {
+	if (!allow || !*allow) {
+		return true;
+	}
+	bool accepted = false;
+	const char *allows_host;
+	char *p, *peer = r_socket_to_string (s);
+	char *allows = strdup (allow);
+	if (!peer || !allows) {
+		free (peer);
+		free (allows);
+		return false;
+	}
+	//eprintf ("Firewall (%s)\n", allows);
+	int i, count = r_str_split (allows, ',');
+	p = strchr (peer, ':');
+	if (p) {
+		*p = 0;
+	}
+	for (i = 0; i < count; i++) {
+		allows_host = r_str_word_get0 (allows, i);
+		//eprintf ("--- (%s) (%s)\n", host, peer);
+		if (!strcmp (allows_host, peer)) {
+			accepted = true;
+			break;
+		}
+	}
+	free (peer);
+	free (allows);
+	return accepted;
+}
+
+static void http_stats_send(HttpPool *pool, RSocketHTTPRequest *rs) {
+	PJ *pj = pj_new ();
+	if (!pj) {
+		r_socket_http_response (rs, 500, "", 0, NULL);
+		return;
+	}
+	r_th_lock_enter (pool->lock);
+	HttpStats *st = &pool->stats;
+	ut64 uptime = http_usecs () - st->started_at;
+	ut64 done = st->requests;
+	pj_o (pj);
+	pj_kn (pj, "uptime", uptime / 1000000);
+	pj_ki (pj, "workers", pool->nworkers);
+	pj_ki (pj, "queued", r_list_length (pool->queue));
+	pj_kn (pj, "connections", st->connections);
+	pj_kn (pj, "requests", done);
+	pj_kn (pj, "reused", st->reused);
+	pj_kn (pj, "commands", st->commands);
+	pj_kd (pj, "rps", uptime? done * 1000000.0 / uptime: 0);
+	pj_k (pj, "latency");
+	pj_o (pj);
+	pj_kn (pj, "avg", done? st->time_total / done: 0);
+	pj_kn (pj, "p50", http_stats_percentile (st, 500));
+	pj_kn (pj, "p90", http_stats_percentile (st, 900));
+	pj_kn (pj, "p99", http_stats_percentile (st, 990));
+	pj_kn (pj, "max", st->time_max);
+	pj_kn (pj, "wait", done? st->wait_total / done: 0);
+	pj_end (pj);
+	pj_end (pj);
+	r_th_lock_leave (pool->lock);
+	char *out = pj_drain (pj);
+	r_socket_http_response (rs, 200, out, 0, "Content-Type: application/json\n");
+	free (out);
+}
+
+static RThreadFunctionRet http_worker(RThread *th) {
+	HttpPool *pool = th->user;
+	HttpJob job = {0};
+	job.done = r_th_sem_new (0);
+	if (!job.done) {
+		return R_TH_STOP;
+	}
+	while (!pool->stop) {
+		RSocketHTTPRequest *rs = r_socket_http_accept (pool->s, pool->so);
+		while (rs) {
+			ut64 from = http_usecs ();
+			ut64 wait = 0;
+			if (rs->auth && rs->path && !strcmp (rs->path, "/stats")) {
+				if (http_allowed (pool->allow, rs->s)) {
+					http_stats_send (pool, rs);
+				} else {
+					rs->keepalive = false;
+				}
+			} else {
+				job.rs = rs;
+				job.close = false;
+				job.queued_at = from;
+				job.started_at = 0;
+				// once stopping nobody takes jobs from the queue anymore
+				r_th_lock_enter (pool->lock);
+				bool stopped = pool->stop;
+				if (!stopped) {
+					r_list_append (pool->queue, &job);
+				}
+				r_th_lock_leave (pool->lock);
+				if (stopped) {
+					rs->keepalive = false;
+				} else {
+					r_th_sem_post (pool->queued);
+					r_th_sem_wait (job.done);
+					wait = job.started_at? job.started_at - job.queued_at: 0;
+					if (job.close) {
+						rs->keepalive = false;
+					}
+				}
+			}
+			http_stats_add (pool, rs, from, wait);
+			rs = r_socket_http_next (rs, pool->so);
+		}
+	}
+	r_th_sem_free (job.done);
+	return R_TH_STOP;
+}
+
+static void http_pool_free(HttpPool *pool) {
+	if (!pool) {
+		return;
+	}
+	int i;
+	if (pool->lock) {
+		// jobs queued after the server loop is gone are not answered
+		HttpJob *job;
+		r_th_lock_enter (pool->lock);
+		pool->stop = true;
+		while ((job = r_list_pop_head (pool->queue))) {
+			job->close = true;
+			r_th_sem_post (job->done);
+		}
+		r_th_lock_leave (pool->lock);
+	}
+	for (i = 0; i < pool->nworkers; i++) {
+		r_th_wait (pool->workers[i]);
+		r_th_free (pool->workers[i]);
+	}
+	if (httppool == pool) {
+		httppool = NULL;
+	}
+	free (pool->workers);
+	r_list_free (pool->queue);
+	r_th_sem_free (pool->queued);
+	r_th_lock_free (pool->lock);
+	free (pool->allow);
+	free (pool);
+}
+
+static HttpPool *http_pool_new(RSocket *s, RSocketHTTPOptions *so, const char *allow, int nworkers) {
+	HttpPool *pool = R_NEW0 (HttpPool);
+	if (!pool) {
+		return NULL;
+	}
+	pool->s = s;
+	pool->so = so;
+	pool->allow = (allow && *allow)? strdup (allow): NULL;
+	so->stop = &pool->stop;
+	pool->stats.started_at = http_usecs ();
+	pool->queue = r_list_new ();
+	pool->queued = r_th_sem_new (0);
+	pool->lock = r_th_lock_new (false);
+	pool->workers = R_NEWS0 (RThread *, R_MAX (nworkers, 1));
+	if (!pool->queue || !pool->queued || !pool->lock || !pool->workers) {
+		http_pool_free (pool);
+		return NULL;
+	}
+	// all the workers wait for clients, the ones that lose the race for a
+	// connection must not block in accept
+	r_socket_block_time (s, 0, 0);
+	for (; pool->nworkers < R_MAX (nworkers, 1); pool->nworkers++) {
+		RThread *th = r_th_new (http_worker, pool, false);
+		if (!th) {
+			break;
+		}
+		pool->workers[pool->nworkers] = th;
+	}
+	if (!pool->nworkers) {
+		http_pool_free (pool);
+		return NULL;
+	}
+	httppool = pool;
+	return pool;
+}
+
+// wait for the next request, NULL when woken up by r_core_rtr_http_stop
+static HttpJob *http_pool_next(HttpPool *pool) {
+	r_th_sem_wait (pool->queued);
+	r_th_lock_enter (pool->lock);
+	HttpJob *job = r_list_pop_head (pool->queue);
+	if (job) {
+		job->started_at = http_usecs ();
+	}
+	r_th_lock_leave (pool->lock);
+	return job;
+}
+
+static void http_job_done(HttpJob *job, bool close) {
+	if (close) {
+		job->close = true;
+	}
+	r_th_sem_post (job->done);
+}
+
 R_API int r_core_rtr_http_stop(RCore *u) {
 	RCore *core = (RCore*)u;
 	const int timeout = 1; // 1 second
@@ -367,6 +649,9 @@ R_API int r_core_rtr_http_stop(RCore *u) {
 			port, R_SOCKET_PROTO_TCP, timeout);
 		r_socket_free (sock);
 	}
+	if (httppool) {
+		r_th_sem_post (httppool->queued);
+	}
 	r_socket_free (s);
 	s = NULL;
 	return 0;
@@ -414,6 +699,8 @@ static int r_core_rtr_http_run(RCore *core, int launch, int browse, const char *
 	RConfig *newcfg = NULL, *origcfg = NULL;
 	char headers[128] = R_EMPTY;
 	RSocketHTTPRequest *rs;
+	HttpPool *pool = NULL;
+	HttpJob *job;
 	char buf[32];
 	int ret = 0;
 	RSocket *s;
@@ -520,9 +807,17 @@ static int r_core_rtr_http_run(RCore *core, int launch, int browse, const char *
 			eprintf ("Empty list of HTTP users\n");
 			return 1;
 		}
-
-		so.timeout = r_config_get_i (core->config, "http.timeout");
-		so.accept_timeout = 1;
+	}
+	so.timeout = r_config_get_i (core->config, "http.timeout");
+	so.keepalive = r_config_get_i (core->config, "http.keepalive");
+	// the workers need to check if the server is stopping
+	so.accept_timeout = 1;
+	pool = http_pool_new (s, &so, allow, r_config_get_i (core->config, "http.maxclients"));
+	if (!pool) {
+		r_socket_free (s);
+		r_list_free (so.authtokens);
+		free (pfile);
+		return 1;
 	}
 
 	origcfg = core->config;
@@ -554,6 +849,7 @@ static int r_core_rtr_http_run(RCore *core, int launch, int browse, const char *
 
 	newblk = malloc (core->blocksize);
 	if (!newblk) {
+		http_pool_free (pool);
 		r_socket_free (s);
 		r_list_free (so.authtokens);
 		free (pfile);
@@ -562,7 +858,6 @@ static int r_core_rtr_http_run(RCore *core, int launch, int browse, const char *
 	memcpy (newblk, core->block, core->blocksize);
 
 	core->block = newblk;
-// TODO: handle mutex lock/unlock here
 	r_cons_break_push ((RConsBreak)r_core_rtr_http_stop, core);
 	while (!r_cons_is_breaked ()) {
 		/* restore environment */
@@ -586,7 +881,7 @@ static int r_core_rtr_http_run(RCore *core, int launch, int browse, const char *
 		activateDieTime (core);
 
 		void *bed = r_cons_sleep_begin ();
-		rs = r_socket_http_accept (s, &so);
+		job = http_pool_next (pool);
 		r_cons_sleep_end (bed);
 
 		origoff = core->offset;
@@ -603,47 +898,25 @@ static int r_core_rtr_http_run(RCore *core, int launch, int browse, const char *
 		r_config_set_i (newcfg, "scr.color", r_config_get_i (newcfg, "scr.color"));
 		r_config_set (newcfg, "scr.interactive", r_config_get (newcfg, "scr.interactive"));
 
-		if (!rs) {
-			bed = r_cons_sleep_begin ();
-			r_sys_usleep (100);
-			r_cons_sleep_end (bed);
+		if (!job) {
 			continue;
 		}
-		if (allow && *allow) {
-			bool accepted = false;
-			const char *allows_host;
-			char *p, *peer = r_socket_to_string (rs->s);
-			char *allows = strdup (allow);
-			//eprintf ("Firewall (%s)\n", allows);
-			int i, count = r_str_split (allows, ',');
-			p = strchr (peer, ':');
-			if (p) {
-				*p = 0;
-			}
-			for (i = 0; i < count; i++) {
-				allows_host = r_str_word_get0 (allows, i);
-				//eprintf ("--- (%s) (%s)\n", host, peer);
-				if (!strcmp (allows_host, peer)) {
-					accepted = true;
-					break;
-				}
-			}
-			free (peer);
-			free (allows);
-			if (!accepted) {
-				r_socket_http_close (rs);
-				continue;
-			}
+		rs = job->rs;
+		if (!http_allowed (pool->allow, rs->s)) {
+			http_job_done (job, true);
+			continue;
 		}
 		if (!rs->method || !rs->path) {
 			http_logf (core, "Invalid http headers received from client\n");
-			r_socket_http_close (rs);
+			http_job_done (job, true);
 			continue;
 		}
 		dir = NULL;
 
 		if (!rs->auth) {
 			r_socket_http_response (rs, 401, "", 0, NULL);
+			http_job_done (job, false);
+			continue;
 		}
 
 		if (r_config_get_i (core->config, "http.verbose")) {
@@ -749,6 +1022,9 @@ static int r_core_rtr_http_run(RCore *core, int launch, int browse, const char *
 							} else {
 								out = r_core_cmd_str_pipe (core, cmd);
 							}
+							r_th_lock_enter (pool->lock);
+							pool->stats.commands++;
+							r_th_lock_leave (pool->lock);
 
 							if (out) {
 								char *res = r_str_uri_encode (out);
@@ -765,13 +1041,13 @@ static int r_core_rtr_http_run(RCore *core, int launch, int browse, const char *
 							if (!r_sandbox_enable (0)) {
 								if (!strcmp (cmd, "=h*")) {
 									/* do stuff */
-									r_socket_http_close (rs);
+									http_job_done (job, true);
 									free (dir);
 									free (refstr);
 									ret = -2;
 									goto the_end;
 								} else if (!strcmp (cmd, "=h--")) {
-									r_socket_http_close (rs);
+									http_job_done (job, true);
 									free (dir);
 									free (refstr);
 									ret = 0;
@@ -810,7 +1086,7 @@ static int r_core_rtr_http_run(RCore *core, int launch, int browse, const char *
 					if (r_file_is_directory (path)) {
 						char *res = r_str_newf ("Location: %s/\n%s", rs->path, headers);
 						r_socket_http_response (rs, 302, NULL, 0, res);
-						r_socket_http_close (rs);
+						http_job_done (job, false);
 						free (path);
 						free (res);
 						R_FREE (dir);
@@ -881,10 +1157,11 @@ static int r_core_rtr_http_run(RCore *core, int launch, int browse, const char *
 		} else {
 			r_socket_http_response (rs, 404, "Invalid protocol", 0, headers);
 		}
-		r_socket_http_close (rs);
+		http_job_done (job, false);
 		free (dir);
 	}
 the_end:
+	http_pool_free (pool);
 	{
 		int timeout = r_config_get_i (core->config, "http.timeout");
 		const char *host = r_config_get (core->config, "http.bind");
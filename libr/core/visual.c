@@ -348,7 +348,7 @@ static void printSnow(RCore *core) {
 #endif
 
 static void rotateAsmBits(RCore *core) {
-	RAnalHint *hint = r_anal_hint_get (core->anal, core->offset);
+	const RAnalHint *hint = r_anal_hint_at (core->anal, core->offset);
 	// const char *arch = r_config_get_i (core->config, "asm.arch");
 	int bits = hint? hint->bits : r_config_get_i (core->config, "asm.bits");
 	int retries = 4;
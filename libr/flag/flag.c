@@ -87,9 +87,101 @@ static RFlagsAtOffset *r_flag_get_nearest_list(RFlag *f, ut64 off, int dir) {
 	return (dir == 0 && flags && flags->off != off)? NULL: flags;
 }
 
+/* the index is only rebuilt once lookups outnumber mutations for a while,
+ * so analysis loops that interleave flag sets and gets keep the skiplist */
+#define FLAG_INDEX_WARMUP 16
+#define FLAG_SPACE_BIT(s) (1ULL << (((size_t)(s) >> 4) & 63))
+
+static void flag_index_dirty(RFlag *f) {
+	f->index.dirty = true;
+	f->index.misses = 0;
+}
+
+static void flag_index_fini(RFlag *f) {
+	RFlagIndex *idx = &f->index;
+	free (idx->offs);
+	free (idx->masks);
+	free (idx->at);
+	memset (idx, 0, sizeof (RFlagIndex));
+}
+
+static bool flag_index_build(RFlag *f) {
+	RFlagIndex *idx = &f->index;
+	size_t n = f->by_off->size;
+	if (n > idx->size) {
+		size_t size = R_MAX (n, idx->size * 2);
+		ut64 *offs = realloc (idx->offs, size * sizeof (ut64));
+		if (!offs) {
+			return false;
+		}
+		idx->offs = offs;
+		ut64 *masks = realloc (idx->masks, size * sizeof (ut64));
+		if (!masks) {
+			return false;
+		}
+		idx->masks = masks;
+		RFlagsAtOffset **at = realloc (idx->at, size * sizeof (RFlagsAtOffset *));
+		if (!at) {
+			return false;
+		}
+		idx->at = at;
+		idx->size = size;
+	}
+	RSkipListNode *it;
+	RFlagsAtOffset *flags_at;
+	RListIter *iter;
+	RFlagItem *fi;
+	size_t i = 0;
+	r_skiplist_foreach (f->by_off, it, flags_at) {
+		ut64 mask = 0;
+		r_list_foreach (flags_at->flags, iter, fi) {
+			mask |= FLAG_SPACE_BIT (fi->space);
+		}
+		idx->offs[i] = flags_at->off;
+		idx->masks[i] = mask;
+		idx->at[i] = flags_at;
+		i++;
+	}
+	idx->count = i;
+	idx->dirty = false;
+	return true;
+}
+
+/* return the index snapshot, or NULL if the skiplist should be used */
+static RFlagIndex *flag_index(RFlag *f) {
+	RFlagIndex *idx = &f->index;
+	if (idx->dirty) {
+		if (++idx->misses < FLAG_INDEX_WARMUP || !flag_index_build (f)) {
+			return NULL;
+		}
+	}
+	return idx;
+}
+
+/* position of the last offset <= off in the index, -1 if there is none */
+static st64 flag_index_leq(const RFlagIndex *idx, ut64 off) {
+	const ut64 *offs = idx->offs;
+	size_t base = 0, n = idx->count;
+	if (!n) {
+		return -1;
+	}
+	while (n > 1) {
+		size_t half = n / 2;
+		base = (offs[base + half] <= off)? base + half: base;
+		n -= half;
+	}
+	return offs[base] <= off? (st64)base: -1;
+}
+
+static const RFlagsAtOffset *flag_index_at(const RFlagIndex *idx, ut64 off) {
+	st64 i = flag_index_leq (idx, off);
+	return (i >= 0 && idx->offs[i] == off)? idx->at[i]: NULL;
+}
+
 static void remove_offsetmap(RFlag *f, RFlagItem *item) {
 	r_return_if_fail (f && item);
 	RFlagsAtOffset *flags = r_flag_get_nearest_list (f, item->offset, 0);
+	flag_index_dirty (f);
 	if (flags) {
 		r_list_delete_data (flags->flags, item);
 		if (r_list_empty (flags->flags)) {
@@ -213,6 +305,7 @@ static void unset_flagspace(REvent *ev, int type, void *user, void *data) {
 	RFlag *f = container_of (sp, RFlag, spaces);
 	const RSpaceEvent *spe = (const RSpaceEvent *)data;
 	r_flag_foreach_space (f, spe->data.unset.space, unset_flags_space, NULL);
+	flag_index_dirty (f);
 }
 
 static void new_spaces(RFlag *f) {
@@ -284,6 +377,7 @@ R_API void r_flag_item_free(RFlagItem *item) {
 R_API RFlag *r_flag_free(RFlag *f) {
 	r_return_val_if_fail (f, NULL);
 	r_skiplist_free (f->by_off);
+	flag_index_fini (f);
 	ht_pp_free (f->ht_name);
 	sdb_free (f->tags);
 	r_spaces_fini (&f->spaces);
@@ -511,7 +605,8 @@ R_API RFlagItem *r_flag_get_by_spaces(RFlag *f, ut64 off, ...) {
 	const RList *list = r_flag_get_list (f, off);
 	RFlagItem *ret = NULL;
 	const char *spacename;
-	RSpace **spaces;
+	RSpace *spaces_buf[16];
+	RSpace **spaces = spaces_buf;
 	RListIter *iter;
 	RFlagItem *flg;
 	va_list ap, aq;
@@ -538,7 +633,12 @@ R_API RFlagItem *r_flag_get_by_spaces(RFlag *f, ut64 off, ...) {
 
 	// get RSpaces from the names
 	i = 0;
-	spaces = R_NEWS (RSpace *, n_spaces);
+	if (n_spaces > R_ARRAY_SIZE (spaces_buf)) {
+		spaces = R_NEWS (RSpace *, n_spaces);
+		if (!spaces) {
+			goto beach;
+		}
+	}
 	spacename = va_arg (ap, const char *);
 	while (spacename) {
 		RSpace *space = r_flag_space_get (f, spacename);
@@ -571,7 +671,9 @@ R_API RFlagItem *r_flag_get_by_spaces(RFlag *f, ut64 off, ...) {
 			break;
 		}
 	}
-	free (spaces);
+	if (spaces != spaces_buf) {
+		free (spaces);
+	}
 beach:
 	va_end (ap);
 	return ret? evalFlag (f, ret): NULL;
@@ -585,11 +687,64 @@ static bool isFunctionFlag(const char *n) {
 	|| !strncmp (n, "fcn.0", 5));
 }
 
+/* pick the flag to show for an offset, preferring non-function names */
+static RFlagItem *flags_at_nice(RFlag *f, const RFlagsAtOffset *flags_at) {
+	RFlagItem *item, *nice = NULL;
+	RListIter *iter;
+	r_list_foreach (flags_at->flags, iter, item) {
+		if (IS_FI_NOTIN_SPACE (f, item)) {
+			continue;
+		}
+		if (nice) {
+			if (isFunctionFlag (nice->name)) {
+				nice = item;
+			}
+		} else {
+			nice = item;
+		}
+	}
+	return nice;
+}
+
+static RFlagItem *flag_index_get_at(RFlag *f, const RFlagIndex *idx, ut64 off, bool closest) {
+	st64 i = flag_index_leq (idx, off);
+	if (i < 0) {
+		return NULL;
+	}
+	if (idx->offs[i] == off) {
+		return flags_at_nice (f, idx->at[i]);
+	}
+	if (!closest) {
+		return NULL;
+	}
+	RSpace *cur = r_flag_space_cur (f);
+	const ut64 bit = FLAG_SPACE_BIT (cur);
+	RFlagItem *item, *nice = NULL;
+	RListIter *iter;
+	for (; i >= 0 && !nice; i--) {
+		// skip offsets that surely have no flags in the current space
+		if (cur && !(idx->masks[i] & bit)) {
+			continue;
+		}
+		r_list_foreach (idx->at[i]->flags, iter, item) {
+			if (!IS_FI_NOTIN_SPACE (f, item)) {
+				nice = item;
+				break;
+			}
+		}
+	}
+	return nice? evalFlag (f, nice): NULL;
+}
+
 /* returns the last flag item defined before or at the given offset.
  * NULL is returned if such a item is not found. */
 R_API RFlagItem *r_flag_get_at(RFlag *f, ut64 off, bool closest) {
 	r_return_val_if_fail (f, NULL);
 
+	const RFlagIndex *idx = flag_index (f);
+	if (idx) {
+		return flag_index_get_at (f, idx, off, closest);
+	}
 	RFlagItem *item, *nice = NULL;
 	RListIter *iter;
 	const RFlagsAtOffset *flags_at = r_flag_get_nearest_list (f, off, -1);
@@ -597,19 +752,7 @@ R_API RFlagItem *r_flag_get_at(RFlag *f, ut64 off, bool closest) {
 		return NULL;
 	}
 	if (flags_at->off == off) {
-		r_list_foreach (flags_at->flags, iter, item) {
-			if (IS_FI_NOTIN_SPACE (f, item)) {
-				continue;
-			}
-			if (nice) {
-				if (isFunctionFlag (nice->name)) {
-					nice = item;
-				}
-			} else {
-				nice = item;
-			}
-		}
-		return nice;
+		return flags_at_nice (f, flags_at);
 	}
 
 	if (!closest) {
@@ -655,7 +798,10 @@ R_API RList *r_flag_all_list(RFlag *f, bool by_space) {
 
 /* return the list of flag items that are associated with a given offset */
 R_API const RList* /*<RFlagItem*>*/ r_flag_get_list(RFlag *f, ut64 off) {
-	const RFlagsAtOffset *item = r_flag_get_nearest_list (f, off, 0);
+	const RFlagIndex *idx = flag_index (f);
+	const RFlagsAtOffset *item = idx
+		? flag_index_at (idx, off)
+		: r_flag_get_nearest_list (f, off, 0);
 	return item ? item->flags : NULL;
 }
 
@@ -663,12 +809,27 @@ R_API char *r_flag_get_liststr(RFlag *f, ut64 off) {
 	RFlagItem *fi;
 	RListIter *iter;
 	const RList *list = r_flag_get_list (f, off);
-	char *p = NULL;
+	if (r_list_empty (list)) {
+		return NULL;
+	}
+	size_t len = 1;
 	r_list_foreach (list, iter, fi) {
-		p = r_str_appendf (p, "%s%s",
-			fi->realname, iter->n? ",": ":");
+		len += strlen (r_str_get (fi->realname)) + 1;
 	}
-	return p;
+	char *p, *s = malloc (len);
+	if (!s) {
+		return NULL;
+	}
+	p = s;
+	r_list_foreach (list, iter, fi) {
+		const char *name = r_str_get (fi->realname);
+		size_t n = strlen (name);
+		memcpy (p, name, n);
+		p += n;
+		*p++ = iter->n? ',': ':';
+	}
+	*p = 0;
+	return s;
 }
 
 // Set a new flag named `name` at offset `off`. If there's already a flag with
@@ -755,6 +916,14 @@ R_API void r_flag_item_set_realname(RFlagItem *item, const char *realname) {
 	item->realname = R_STR_ISEMPTY (realname)? NULL: strdup (realname);
 }
 
+/* move a flag item to another flag space, the index keeps the spaces used at
+ * each offset so it must be rebuilt */
+R_API void r_flag_item_set_space(RFlag *f, RFlagItem *item, RSpace *space) {
+	r_return_if_fail (f && item);
+	item->space = space;
+	flag_index_dirty (f);
+}
+
 /* change the name of a flag item, if the new name is available.
  * true is returned if everything works well, false otherwise */
 R_API int r_flag_rename(RFlag *f, RFlagItem *item, const char *name) {
@@ -824,6 +993,7 @@ R_API void r_flag_unset_all(RFlag *f) {
 	ht_pp_free (f->ht_name);
 	f->ht_name = ht_pp_new (NULL, ht_free_flag, NULL);
 	r_skiplist_purge (f->by_off);
+	flag_index_dirty (f);
 	r_spaces_fini (&f->spaces);
 	new_spaces (f);
 }
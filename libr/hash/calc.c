@@ -1,6 +1,8 @@
 /* radare2 - LGPL - Copyright 2009-2018 pancake */
 
 #include "r_hash.h"
+#include <r_th.h>
+#include <r_util/r_assert.h>
 
 
 #define HANDLE_CRC_PRESET(rbits, aname) \
@@ -201,3 +203,177 @@ R_API int r_hash_calculate(RHash *ctx, ut64 algobit, const ut8 *buf, int len) {
 
 	return 0;
 }
+
+/* Parallel hashing. Blocks are independent so they are spread over the
+ * workers, each one with its own context. Whole buffers are only split
+ * for the algorithms that can be derived from a byte histogram, which
+ * gives the same result as hashing them in one go. */
+
+// keep the workers busy with at least this many bytes per job
+#define HASH_JOB_MIN (64 * 1024)
+
+typedef struct {
+	ut64 algobit;
+	const ut8 *buf;
+	ut64 len;
+	ut64 bsize;
+	int nblocks;
+	int step;   // blocks claimed per job
+	int next;   // next block to claim
+	RHashBlock *out;
+	ut64 (*counts)[256]; // per part histograms when splitting a buffer
+	RThreadLock *lock;
+} HashJobs;
+
+static int hash_jobs_claim(HashJobs *jobs) {
+	if (!jobs->lock) {
+		int i = jobs->next;
+		jobs->next += jobs->step;
+		return i;
+	}
+	r_th_lock_enter (jobs->lock);
+	int i = jobs->next;
+	jobs->next += jobs->step;
+	r_th_lock_leave (jobs->lock);
+	return i;
+}
+
+static void hash_jobs_run(HashJobs *jobs) {
+	RHash *ctx = NULL;
+	int i, j;
+	if (!jobs->counts && !(ctx = r_hash_new (true, jobs->algobit))) {
+		return;
+	}
+	while ((i = hash_jobs_claim (jobs)) < jobs->nblocks) {
+		int end = R_MIN (i + jobs->step, jobs->nblocks);
+		for (; i < end; i++) {
+			ut64 off = jobs->bsize * i;
+			ut64 len = R_MIN (jobs->bsize, jobs->len - off);
+			const ut8 *p = jobs->buf + off;
+			if (jobs->counts) {
+				ut64 *count = jobs->counts[i];
+				for (j = 0; j < len; j++) {
+					count[p[j]]++;
+				}
+				continue;
+			}
+			RHashBlock *b = &jobs->out[i];
+			int dlen = r_hash_calculate (ctx, jobs->algobit, p, (int)len);
+			memcpy (b->digest, ctx->digest, R_MIN (dlen, sizeof (b->digest)));
+			b->entropy = ctx->entropy;
+		}
+	}
+	r_hash_free (ctx);
+}
+
+static RThreadFunctionRet hash_jobs_th(RThread *th) {
+	hash_jobs_run (th->user);
+	return R_TH_STOP;
+}
+
+static void hash_jobs_spawn(HashJobs *jobs, int nthreads) {
+	int i;
+	nthreads = R_MIN (nthreads, (jobs->nblocks + jobs->step - 1) / jobs->step);
+	RThread **ths = nthreads > 1? R_NEWS0 (RThread *, nthreads - 1): NULL;
+	if (ths) {
+		jobs->lock = r_th_lock_new (false);
+	}
+	if (!ths || !jobs->lock) {
+		nthreads = 1;
+	}
+	for (i = 0; i < nthreads - 1; i++) {
+		ths[i] = r_th_new (hash_jobs_th, jobs, 0);
+	}
+	// the calling thread works too
+	hash_jobs_run (jobs);
+	for (i = 0; i < nthreads - 1; i++) {
+		if (ths[i]) {
+			r_th_wait (ths[i]);
+			r_th_free (ths[i]);
+		}
+	}
+	r_th_lock_free (jobs->lock);
+	free (ths);
+}
+
+/* Hash each bsize block of buf with algobit into out, which must hold one
+ * entry per block (the last one may be shorter). Returns the digest size. */
+R_API int r_hash_calculate_blocks(ut64 algobit, const ut8 *buf, ut64 len, int bsize, RHashBlock *out, int nthreads) {
+	r_return_val_if_fail (buf && out && bsize > 0, -1);
+	HashJobs jobs = {
+		.algobit = algobit,
+		.buf = buf,
+		.len = len,
+		.bsize = bsize,
+		.nblocks = (int)((len + bsize - 1) / bsize),
+		.step = R_MAX (1, HASH_JOB_MIN / bsize),
+		.out = out,
+	};
+	hash_jobs_spawn (&jobs, nthreads);
+	return r_hash_size (algobit);
+}
+
+/* Same as r_hash_calculate, splitting the buffer across nthreads workers
+ * when the algorithm allows combining the partial results. */
+R_API int r_hash_calculate_threads(RHash *ctx, ut64 algobit, const ut8 *buf, ut64 len, int nthreads) {
+	const ut64 splittable = R_HASH_ENTROPY | R_HASH_XOR | R_HASH_PARITY | R_HASH_PCPRINT;
+	if (nthreads < 2 || len < 2 * HASH_JOB_MIN || len > ST32_MAX
+			|| !(algobit & splittable) || (algobit & (algobit - 1))) {
+		return r_hash_calculate (ctx, algobit, buf, (int)len);
+	}
+	int i, j, nparts = R_MIN (nthreads * 4, len / HASH_JOB_MIN);
+	ut64 (*counts)[256] = calloc (nparts, sizeof (*counts));
+	if (!counts) {
+		return r_hash_calculate (ctx, algobit, buf, (int)len);
+	}
+	HashJobs jobs = {
+		.algobit = algobit,
+		.buf = buf,
+		.len = len,
+		.bsize = (len + nparts - 1) / nparts,
+		.step = 1,
+		.counts = counts,
+	};
+	jobs.nblocks = (int)((len + jobs.bsize - 1) / jobs.bsize);
+	hash_jobs_spawn (&jobs, nthreads);
+	ut64 count[256] = {0};
+	for (i = 0; i < jobs.nblocks; i++) {
+		for (j = 0; j < 256; j++) {
+			count[j] += counts[i][j];
+		}
+	}
+	free (counts);
+	ut64 n = 0;
+	ut8 x = 0;
+	switch (algobit) {
+	case R_HASH_ENTROPY:
+		r_mem_memzero (ctx->digest, sizeof (ctx->entropy));
+		ctx->entropy = r_hash_entropy_histogram (count, len);
+		break;
+	case R_HASH_XOR:
+		for (j = 0; j < 256; j++) {
+			if (count[j] & 1) {
+				x ^= j;
+			}
+		}
+		*ctx->digest = x;
+		break;
+	case R_HASH_PARITY:
+		for (j = 0; j < 256; j++) {
+			int b, ones = 0;
+			for (b = j; b; b >>= 1) {
+				ones += b & 1;
+			}
+			n += count[j] * ones;
+		}
+		*ctx->digest = n % 2;
+		break;
+	case R_HASH_PCPRINT:
+		for (j = ' '; j <= '~'; j++) {
+			n += count[j];
+		}
+		*ctx->digest = (100 * (int)n) / len;
+		break;
+	}
+	return r_hash_size (algobit);
+}
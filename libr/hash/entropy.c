@@ -9,14 +9,12 @@
 #include <math.h>
 #include "r_types.h"
 
-R_API double r_hash_entropy(const ut8 *data, ut64 size) {
-	if (!data || !size) {
-		return 0;
-	}
-	ut64 i, count[256] = {0};
+// entropy of a buffer of size bytes given how many times each byte value appears
+R_API double r_hash_entropy_histogram(const ut64 *count, ut64 size) {
+	ut64 i;
 	double h = 0;
-	for (i = 0; i < size; i++) {
-		count[data[i]]++;
+	if (!size) {
+		return 0;
 	}
 	for (i = 0; i < 256; i++) {
 		if (count[i]) {
@@ -26,6 +24,18 @@ R_API double r_hash_entropy(const ut8 *data, ut64 size) {
 	}
 	return h;
 }
+
+R_API double r_hash_entropy(const ut8 *data, ut64 size) {
+	if (!data || !size) {
+		return 0;
+	}
+	ut64 i, count[256] = {0};
+	for (i = 0; i < size; i++) {
+		count[data[i]]++;
+	}
+	return r_hash_entropy_histogram (count, size);
+}
+
 R_API double r_hash_entropy_fraction(const ut8 *data, ut64 size) {
 	return size ? r_hash_entropy (data, size) / \
 		log2 ((double) R_MIN (size, 256)) : 0;
@@ -264,6 +264,26 @@ typedef struct r_anal_fcn_meta_t {
 	int sgec;           // edge cardinality of the functions callgraph
 } RAnalFcnMeta;
 
+enum {
+	R_ANAL_FCN_FEAT_CC = 1 << 0,
+	R_ANAL_FCN_FEAT_EDGES = 1 << 1,
+	R_ANAL_FCN_FEAT_BBHASH = 1 << 2,
+	R_ANAL_FCN_FEAT_FINGERPRINT = 1 << 3,
+};
+
+/* Values derived from the basic blocks of a function, computed on demand
+ * and kept until the blocks change (see r_anal_fcn_invalidate) */
+typedef struct r_anal_fcn_features_t {
+	ut32 valid;         // R_ANAL_FCN_FEAT_* values that are up to date
+	ut32 iogen;         // io->wgen when the byte based values were computed
+	int cc;             // cyclomatic complexity
+	int edges;
+	int ebbs;           // exit basic blocks
+	char *bbhash;       // hex digest of the block bytes, see r_sign_calc_bbhash
+	int fplen;          // length of fcn->fingerprint
+	bool fpops;         // fingerprint was built with diff.ops
+} RAnalFcnFeatures;
+
 /* Store various function information,
  * variables, arguments, refs and even
  * description */
@@ -290,6 +310,7 @@ typedef struct r_anal_function_t {
 	bool has_changed; // true if function may have changed since last anaysis TODO: set this attribute where necessary
 	RAnalType *args; // list of arguments
 	ut8 *fingerprint; // TODO: make is fuzzy and smarter
+	RAnalFcnFeatures features;
 	RAnalDiff *diff;
 	RList *locs; // list of local variables
 	RList *fcn_locs; //sorted list of a function *.loc refs
@@ -650,6 +671,7 @@ typedef struct r_anal_t {
 	int diff_ops;
 	double diff_thbb;
 	double diff_thfcn;
+	int diff_jobs; // threads used to compare functions
 	RIOBind iob;
 	RFlagBind flb;
 	RFlagSet flg_class_set;
@@ -661,6 +683,7 @@ typedef struct r_anal_t {
 	int maxreflines;
 	int trace;
 	int esil_goto_limit;
+	bool esil_compile;
 	int pcalign;
 	int bitshift;
 	//struct r_anal_ctx_t *ctx;
@@ -671,6 +694,7 @@ typedef struct r_anal_t {
 	Sdb *sdb_types;
 	Sdb *sdb_fmts;
 	Sdb *sdb_meta; // TODO: Future r_meta api
+	HtUP *meta_ranges; // meta type => interval tree of the ranges of that type
 	Sdb *sdb_zigns;
 	HtUP *dict_refs;
 	HtUP *dict_xrefs;
@@ -678,6 +702,7 @@ typedef struct r_anal_t {
 	RSpaces meta_spaces;
 	RSpaces zign_spaces;
 	char *zign_path;
+	struct r_sign_index_t *zign_index; // lookup tables over sdb_zigns, see sign.c
 	PrintfCallback cb_printf;
 	//moved from RAnalFcn
 	Sdb *sdb; // root
@@ -688,13 +713,13 @@ typedef struct r_anal_t {
 	Sdb *sdb_args;  //
 	Sdb *sdb_vars; // globals?
 #endif
-	Sdb *sdb_hints; // OK
+	RBTree hints; // RAnalHint records sorted by address
+	ut32 hints_gen; // bumped on every hint change, tells users of decoded ops to refresh them
 	RHintCb hint_cbs;
 	Sdb *sdb_fcnsign; // OK
 	Sdb *sdb_cc; // calling conventions
 	Sdb *sdb_classes;
 	Sdb *sdb_classes_attrs;
-	//RList *hints; // XXX use better data structure here (slist?)
 	RAnalCallbacks cb;
 	RAnalOptions opt;
 	RList *reflines;
@@ -745,6 +770,8 @@ typedef struct r_anal_hint_t {
 	int nword;
 } RAnalHint;
 
+typedef bool (*RAnalHintCb)(const RAnalHint *hint, void *user);
+
 typedef struct r_anal_var_access_t {
 	ut64 addr;
 	int set;
@@ -993,6 +1020,16 @@ enum {
 	R_ANAL_ESIL_PARM_NUM,
 };
 
+#define R_ANAL_ESIL_VALUE_BUFSZ 32
+
+/* ESIL stack slot, numeric tokens are parsed once when pushed */
+typedef struct r_anal_esil_value_t {
+	int type; // R_ANAL_ESIL_PARM_*
+	ut64 num; // parsed value for R_ANAL_ESIL_PARM_NUM
+	char *str; // heap copy for tokens that don't fit in buf
+	char buf[R_ANAL_ESIL_VALUE_BUFSZ];
+} RAnalEsilValue;
+
 /* Constructs to convert from ESIL to REIL */
 #define FOREACHOP(GENERATE)                     \
 /* No Operation */               GENERATE(NOP)  \
@@ -1121,7 +1158,7 @@ typedef struct r_anal_esil_callbacks_t {
 
 typedef struct r_anal_esil_t {
 	RAnal *anal;
-	char **stack;
+	RAnalEsilValue *stack;
 	ut64 addrmask;
 	int stacksize;
 	int stackptr;
@@ -1149,6 +1186,7 @@ typedef struct r_anal_esil_t {
 	ut8 lastsz;	//in bits //used for signature-flag
 	/* native ops and custom ops */
 	Sdb *ops;
+	HtPP *compiled; // expression -> pre-tokenized word list, see esil.compile
 	RIDStorage *sources;
 	SdbMini *interrupts;
 	//this is a disgusting workaround, because we have no ht-like storage without magic keys, that you cannot use, with int-keys
@@ -1314,7 +1352,7 @@ R_API const char *r_anal_optype_to_string(int t);
 R_API int r_anal_optype_from_string(const char *type);
 R_API const char *r_anal_op_family_to_string (int n);
 R_API int r_anal_op_family_from_string(const char *f);
-R_API int r_anal_op_hint(RAnalOp *op, RAnalHint *hint);
+R_API int r_anal_op_hint(RAnalOp *op, const RAnalHint *hint);
 R_API RAnalType *r_anal_type_free(RAnalType *t);
 R_API RAnalType *r_anal_type_loadfile(RAnal *a, const char *path);
 
@@ -1394,6 +1432,7 @@ R_API int r_anal_esil_set_op(RAnalEsil *esil, const char *op, RAnalEsilOp code);
 R_API void r_anal_esil_stack_free(RAnalEsil *esil);
 R_API int r_anal_esil_get_parm_type(RAnalEsil *esil, const char *str);
 R_API int r_anal_esil_get_parm(RAnalEsil *esil, const char *str, ut64 *num);
+R_API int r_anal_esil_get_parm_size(RAnalEsil *esil, const char *str, ut64 *num, int *size);
 R_API int r_anal_esil_condition(RAnalEsil *esil, const char *str);
 
 // esil_interrupt.c
@@ -1495,9 +1534,13 @@ R_API RAnalBlock *r_anal_fcn_bbget_at(RAnalFunction *fcn, ut64 addr);
 R_API bool r_anal_fcn_contains(RAnalFunction *fcn, ut64 addr);
 R_API bool r_anal_fcn_bbadd(RAnalFunction *fcn, RAnalBlock *bb);
 R_API int r_anal_fcn_resize (RAnal *anal, RAnalFunction *fcn, int newsize);
+R_API void r_anal_fcn_invalidate(RAnalFunction *fcn);
+R_API bool r_anal_fcn_features_valid(RAnal *anal, RAnalFunction *fcn, ut32 feat);
+R_API void r_anal_fcn_features_set(RAnal *anal, RAnalFunction *fcn, ut32 feat);
 R_API bool r_anal_fcn_get_purity(RAnal *anal, RAnalFunction *fcn);
 
 typedef bool (* RAnalRefCmp)(RAnalRef *ref, void *data);
+typedef bool (* RAnalRefCb)(const RAnalRef *ref, void *user);
 R_API RList *r_anal_ref_list_new(void);
 R_API int r_anal_xrefs_count(RAnal *anal);
 R_API const char *r_anal_xrefs_type_tostring(RAnalRefType type);
@@ -1505,6 +1548,8 @@ R_API RAnalRefType r_anal_xrefs_type(char ch);
 R_API RList *r_anal_xrefs_get(RAnal *anal, ut64 to);
 R_API RList *r_anal_refs_get(RAnal *anal, ut64 to);
 R_API RList *r_anal_xrefs_get_from(RAnal *anal, ut64 from);
+R_API bool r_anal_xrefs_foreach(RAnal *anal, ut64 to, RAnalRefCb cb, void *user);
+R_API bool r_anal_refs_foreach(RAnal *anal, ut64 from, RAnalRefCb cb, void *user);
 R_API void r_anal_xrefs_list(RAnal *anal, int rad);
 R_API RList *r_anal_fcn_get_refs(RAnal *anal, RAnalFunction *fcn);
 R_API RList *r_anal_fcn_get_xrefs(RAnal *anal, RAnalFunction *fcn);
@@ -1649,6 +1694,10 @@ R_API int r_meta_set_var_comment (RAnal *a, int type, ut64 idx, ut64 addr, const
 R_API int r_meta_del(RAnal *m, int type, ut64 from, ut64 size);
 R_API int r_meta_var_comment_del(RAnal *a, int type, ut64 idx, ut64 addr);
 R_API int r_meta_add(RAnal *m, int type, ut64 from, ut64 to, const char *str);
+// same as r_meta_add but used when many metas are added. Call r_meta_update when all of them have been added.
+R_API int r_meta_add_batch(RAnal *m, int type, ut64 from, ut64 to, const char *str);
+// update the range index after a series of r_meta_add_batch calls
+R_API void r_meta_update(RAnal *m);
 R_API int r_meta_add_with_subtype(RAnal *m, int type, int subtype, ut64 from, ut64 to, const char *str);
 R_API RAnalMetaItem *r_meta_find(RAnal *m, ut64 off, int type, int where);
 R_API RAnalMetaItem *r_meta_find_any_except(RAnal *m, ut64 at, int type, int where);
@@ -1673,10 +1722,11 @@ R_API void r_anal_merge_hint_ranges(RAnal *a);
 R_API void r_anal_hint_del (RAnal *anal, ut64 addr, int size);
 R_API void r_anal_hint_clear (RAnal *a);
 R_API RAnalHint *r_anal_hint_from_string(RAnal *a, ut64 addr, const char *str);
-R_API RAnalHint *r_anal_hint_at (RAnal *a, ut64 from);
+R_API const RAnalHint *r_anal_hint_at(RAnal *a, ut64 addr);
 R_API RAnalHint *r_anal_hint_add (RAnal *a, ut64 from, int size);
 R_API void r_anal_hint_free (RAnalHint *h);
 R_API RAnalHint *r_anal_hint_get(RAnal *anal, ut64 addr);
+R_API void r_anal_hint_foreach(RAnal *a, RAnalHintCb cb, void *user);
 R_API void r_anal_hint_set_syntax (RAnal *a, ut64 addr, const char *syn);
 R_API void r_anal_hint_set_type (RAnal *a, ut64 addr, int type);
 R_API void r_anal_hint_set_jump (RAnal *a, ut64 addr, ut64 ptr);
@@ -1762,6 +1812,7 @@ R_API bool r_anal_noreturn_at_addr(RAnal *anal, ut64 addr);
 R_API int r_sign_space_count_for(RAnal *a, const RSpace *space);
 R_API void r_sign_space_unset_for(RAnal *a, const RSpace *space);
 R_API void r_sign_space_rename_for(RAnal *a, const RSpace *space, const char *oname, const char *nname);
+R_API void r_sign_index_invalidate(RAnal *a);
 
 /* vtables */
 typedef struct {
@@ -65,6 +65,19 @@ R_LIB_VERSION_HEADER (r_bin);
 #define R_BIN_REQ_HASHES 0x40000000
 #define R_BIN_REQ_SIGNATURE 0x80000000
 
+/* item families of an RBinObject, the costly ones are loaded on first use */
+enum {
+	R_BIN_ITEM_ENTRIES = 0,
+	R_BIN_ITEM_FIELDS,
+	R_BIN_ITEM_IMPORTS,
+	R_BIN_ITEM_SYMBOLS,
+	R_BIN_ITEM_SECTIONS,
+	R_BIN_ITEM_RELOCS,
+	R_BIN_ITEM_STRINGS,
+	R_BIN_ITEM_CLASSES,
+	R_BIN_ITEM_LAST
+};
+
 /* RBinSymbol->method_flags : */
 #define R_BIN_METH_CLASS 0x0000000000000001L
 #define R_BIN_METH_STATIC 0x0000000000000002L
@@ -248,8 +261,29 @@ typedef struct r_bin_object_t {
 	Sdb *kv;
 	Sdb *addr2klassmethod;
 	void *bin_obj; // internal pointer used by formats
+	ut32 loaded; // 1 << R_BIN_ITEM_* of the item families already loaded
+	ut64 load_time[R_BIN_ITEM_LAST]; // microseconds spent loading each one
+	struct r_bin_cache_t *cache; // on-disk copy of the items, see bin.cache
 } RBinObject;
 
+typedef struct r_bin_line_row_t {
+	ut64 addr;
+	ut32 file; // index in RBinLineTable.files
+	ut32 line;
+} RBinLineRow;
+
+// address to source line mapping, one row per address
+typedef struct r_bin_line_table_t {
+	RPVector files;  // interned file names
+	HtPP *file_idx;  // file name -> index + 1
+	ut32 last_file;  // index + 1 of the last interned file
+	RVector rows;    // RBinLineRow sorted by address once finalized
+	RBinLineRow *by_line; // rows sorted by file and line, built on demand
+	bool sorted;
+} RBinLineTable;
+
+typedef bool (*RBinLineTableForeach)(void *user, ut64 addr, const char *file, ut32 line);
+
 // XXX: RbinFile may hold more than one RBinObject
 /// XX curplugin == o->plugin
 typedef struct r_bin_file_t {
@@ -275,6 +309,7 @@ typedef struct r_bin_file_t {
 	Sdb *sdb;
 	Sdb *sdb_info;
 	Sdb *sdb_addrinfo;
+	RBinLineTable *addrlines;
 	struct r_bin_t *rbin;
 } RBinFile;
 
@@ -320,6 +355,8 @@ typedef struct r_bin_t {
 	bool verbose;
 	bool use_xtr; // use extract plugins when loading a file?
 	bool use_ldr; // use loader plugins when loading a file?
+	bool cache; // keep the loaded items of each object in cachedir
+	char *cachedir; // dir.bincache
 } RBin;
 
 typedef struct r_bin_xtr_metadata_t {
@@ -707,6 +744,8 @@ R_API bool r_bin_file_hash(RBin *bin, ut64 limit, const char *file);
 
 // binobject functions
 R_API int r_bin_object_set_items(RBinFile *binfile, RBinObject *o);
+R_API bool r_bin_object_load_item(RBinFile *binfile, RBinObject *o, int item);
+R_API const char *r_bin_object_item_name(int item);
 R_API bool r_bin_object_delete(RBin *bin, ut32 binfile_id, ut32 binobj_id);
 
 // demangle functions
@@ -728,6 +767,18 @@ R_API RBinSection *r_bin_get_section_at(RBinObject *o, ut64 off, int va);
 R_API int r_bin_addr2line(RBin *bin, ut64 addr, char *file, int len, int *line);
 R_API char *r_bin_addr2text(RBin *bin, ut64 addr, int origin);
 R_API char *r_bin_addr2fileline(RBin *bin, ut64 addr);
+/* linetable.c */
+R_API RBinLineTable *r_bin_linetable_new(void);
+R_API void r_bin_linetable_free(RBinLineTable *lt);
+R_API void r_bin_linetable_reset(RBinLineTable *lt);
+R_API bool r_bin_linetable_add(RBinLineTable *lt, ut64 addr, const char *file, ut32 line);
+R_API bool r_bin_linetable_set(RBinLineTable *lt, ut64 addr, const char *file, ut32 line);
+R_API bool r_bin_linetable_get(RBinLineTable *lt, ut64 addr, const char **file, ut32 *line);
+R_API bool r_bin_linetable_find(RBinLineTable *lt, const char *file, ut32 line, ut64 *addr);
+R_API bool r_bin_linetable_del(RBinLineTable *lt, ut64 addr);
+R_API int r_bin_linetable_del_line(RBinLineTable *lt, const char *file, ut32 line);
+R_API void r_bin_linetable_foreach(RBinLineTable *lt, RBinLineTableForeach cb, void *user);
+R_API RPVector *r_bin_linetable_files(RBinLineTable *lt);
 /* bin_write.c */
 R_API bool r_bin_wr_addlib(RBin *bin, const char *lib);
 R_API ut64 r_bin_wr_scn_resize(RBin *bin, const char *name, ut64 size);
@@ -16,6 +16,7 @@ extern "C" {
 #include <r_util/r_signal.h>
 #include <r_util/r_stack.h>
 #include <r_util/r_str.h>
+#include <r_util/r_strbuf.h>
 #include <r_util/r_sys.h>
 #include <r_util/r_file.h>
 #include <sdb.h>
@@ -416,6 +417,12 @@ typedef struct r_cons_context_t {
 	bool is_interactive;
 	bool pageable;
 
+	// scr.stream state, reset on every flush
+	bool streamed; // part of the output was already written
+	bool stream_show; // grep line range state between chunks
+	ut64 stream_chars; // raw bytes already grepped
+	int stream_mark; // buffer length at the last attempt
+
 	RConsColorMode color;
 	RConsPalette cpal;
 	RConsPrintablePalette pal;
@@ -474,6 +481,7 @@ typedef struct r_cons_t {
 	bool ansicon;
 #endif
 	bool flush;
+	bool stream; // write long outputs while they are produced
 	bool use_utf8; // use utf8 features
 	bool use_utf8_curvy; // use utf8 curved corners
 	bool dotted_lines;
@@ -814,6 +822,8 @@ R_API char * r_cons_grep_strip(char *cmd, const char *quotestr);
 R_API void r_cons_grep_process(char * grep);
 R_API int r_cons_grep_line(char *buf, int len); // must be static
 R_API void r_cons_grepbuf();
+R_API bool r_cons_grep_streamable(void);
+R_API bool r_cons_grep_stream(RStrBuf *ob, const char *buf, int len);
 
 R_API void r_cons_rgb(ut8 r, ut8 g, ut8 b, ut8 a);
 R_API void r_cons_rgb_fgbg(ut8 r, ut8 g, ut8 b, ut8 R, ut8 G, ut8 B);
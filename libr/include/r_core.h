@@ -217,6 +217,21 @@ typedef struct {
 
 R_API void r_core_gadget_free (RCoreGadget *g);
 
+typedef struct r_core_opcache_stats_t {
+	ut64 asm_hits;
+	ut64 asm_misses;
+	ut64 anal_hits;
+	ut64 anal_misses;
+	ut64 stale; // entries decoded from other bytes or with other settings
+	ut64 flushes;
+} RCoreOpCacheStats;
+
+typedef struct r_core_opcache_t {
+	HtUP *ht; // decoded instructions by address, see opcache.c
+	int max;
+	RCoreOpCacheStats stats;
+} RCoreOpCache;
+
 typedef struct r_core_t {
 	RBin *bin;
 	RConfig *config;
@@ -243,6 +258,7 @@ typedef struct r_core_t {
 	RList/*<RCmdDescriptor>*/ *cmd_descriptors;
 	RAnal *anal;
 	RAsm *assembler;
+	RCoreOpCache *opcache; // NULL when asm.opcache is 0
 	/* ^^ */
 	RCoreTimes *times;
 	RParse *parser;
@@ -591,6 +607,12 @@ R_API RList *r_core_asm_bwdisassemble (RCore *core, ut64 addr, int n, int len);
 R_API RList *r_core_asm_back_disassemble_instr (RCore *core, ut64 addr, int len, ut32 hit_count, ut32 extra_padding);
 R_API RList *r_core_asm_back_disassemble_byte (RCore *core, ut64 addr, int len, ut32 hit_count, ut32 extra_padding);
 R_API ut32 r_core_asm_bwdis_len (RCore* core, int* len, ut64* start_addr, ut32 l);
+R_API RCoreOpCache *r_core_opcache_new(int max);
+R_API void r_core_opcache_free(RCoreOpCache *oc);
+R_API void r_core_opcache_flush(RCoreOpCache *oc);
+R_API int r_core_opcache_asm(RCore *core, RAsmOp *op, const ut8 *buf, int len);
+R_API int r_core_opcache_anal(RCore *core, RAnalOp *op, ut64 addr, const ut8 *buf, int len);
+R_API void r_core_opcache_print(RCore *core, int mode);
 R_API int r_core_print_disasm(RPrint *p, RCore *core, ut64 addr, ut8 *buf, int len, int lines, int invbreak, int nbytes, bool json, PJ *pj, RAnalFunction *pdf);
 R_API int r_core_print_disasm_json(RCore *core, ut64 addr, ut8 *buf, int len, int lines, PJ *pj);
 R_API int r_core_print_disasm_instructions (RCore *core, int len, int l);
@@ -47,6 +47,17 @@ typedef struct r_flag_item_t {
 	char *alias;    /* used to define a flag based on a math expression (e.g. foo + 3) */
 } RFlagItem;
 
+/* read-only snapshot of by_off, rebuilt lazily after mutations */
+typedef struct r_flag_index_t {
+	ut64 *offs;              /* sorted offsets */
+	ut64 *masks;             /* bitmask of the flagspaces used at each offset */
+	RFlagsAtOffset **at;
+	size_t count;
+	size_t size;
+	bool dirty;
+	int misses;              /* lookups done since the last mutation */
+} RFlagIndex;
+
 typedef struct r_flag_t {
 	RSpaces spaces;   /* handle flag spaces */
 	st64 base;         /* base address for all flag items */
@@ -55,6 +66,7 @@ typedef struct r_flag_t {
 	RNum *num;
 	RSkipList *by_off; /* flags sorted by offset, value=RFlagsAtOffset */
 	HtPP *ht_name; /* hashmap key=item name, value=RList of items */
+	RFlagIndex index;
 	PrintfCallback cb_printf;
 #if R_FLAG_ZONE_USE_SDB
 	Sdb *zones;
@@ -119,6 +131,7 @@ R_API void r_flag_item_set_alias(RFlagItem *item, const char *alias);
 R_API void r_flag_item_free (RFlagItem *item);
 R_API void r_flag_item_set_comment(RFlagItem *item, const char *comment);
 R_API void r_flag_item_set_realname(RFlagItem *item, const char *realname);
+R_API void r_flag_item_set_space(RFlag *f, RFlagItem *item, RSpace *space);
 R_API RFlagItem *r_flag_item_clone(RFlagItem *item);
 R_API int r_flag_unset_glob(RFlag *f, const char *name);
 R_API int r_flag_rename(RFlag *f, RFlagItem *item, const char *name);
@@ -461,6 +461,12 @@ enum HASH_INDICES {
 
 #define R_HASH_ALL ((1ULL << R_MIN(63, R_HASH_NUM_INDICES))-1)
 
+/* digest of one block, see r_hash_calculate_blocks */
+typedef struct r_hash_block_t {
+	double entropy;
+	ut8 digest[R_HASH_SIZE_SHA512];
+} RHashBlock;
+
 #ifdef R_API
 /* OO */
 R_API RHash *r_hash_new(bool rst, ut64 flags);
@@ -481,6 +487,8 @@ R_API const char *r_hash_name(ut64 bit);
 R_API ut64 r_hash_name_to_bits(const char *name);
 R_API int r_hash_size(ut64 bit);
 R_API int r_hash_calculate(RHash *ctx, ut64 algobit, const ut8 *input, int len);
+R_API int r_hash_calculate_blocks(ut64 algobit, const ut8 *buf, ut64 len, int bsize, RHashBlock *out, int nthreads);
+R_API int r_hash_calculate_threads(RHash *ctx, ut64 algobit, const ut8 *buf, ut64 len, int nthreads);
 
 /* checksums */
 /* XXX : crc16 should use 0 as arg0 by default */
@@ -498,6 +506,7 @@ R_API utcrc r_hash_crc_preset (const ut8 *data, ut32 size, enum CRC_PRESETS pres
 /* analysis */
 R_API ut8  r_hash_hamdist(const ut8 *buf, int len);
 R_API double r_hash_entropy(const ut8 *data, ut64 len);
+R_API double r_hash_entropy_histogram(const ut64 *count, ut64 size);
 R_API double r_hash_entropy_fraction(const ut8 *data, ut64 len);
 R_API int r_hash_pcprint(const ut8 *buffer, ut64 len);
 
@@ -96,10 +96,10 @@ typedef struct r_io_t {
 	RPVector map_skyline_shadow; // map parts that are not covered by others
 	RIDStorage *files;
 	RCache *buffer;
-	RList *cache;	//sdblist?
-	RBNode cacheTree;
+	RBTree cache; // RIOCache interval tree
 	ut8 *write_mask;
 	int write_mask_len;
+	ut32 wgen; // bumped on every write or map, file and cache change, tells users of cached bytes to refresh them
 	RIOUndo undo;
 	SdbList *plugins;
 	char *runprofile;
@@ -168,6 +168,7 @@ typedef struct r_io_plugin_t {
 	RIODesc* (*open)(RIO *io, const char *, int rw, int mode);
 	RList* /*RIODesc* */ (*open_many)(RIO *io, const char *, int rw, int mode);
 	int (*read)(RIO *io, RIODesc *fd, ut8 *buf, int count);
+	const ut8 *(*peek)(RIO *io, RIODesc *fd, ut64 addr, int count); // borrowed pointer to the backing storage or NULL
 	ut64 (*lseek)(RIO *io, RIODesc *fd, ut64 offset, int whence);
 	int (*write)(RIO *io, RIODesc *fd, const ut8 *buf, int count);
 	int (*close)(RIODesc *desc);
@@ -202,6 +203,7 @@ typedef struct r_io_cache_t {
 	ut8 *data;
 	ut8 *odata;
 	int written;
+	RBNode rb;
 } RIOCache;
 
 #define R_IO_DESC_CACHE_SIZE (sizeof(ut64) * 8)
@@ -325,6 +327,7 @@ R_API bool r_io_vread_at_mapped(RIO* io, ut64 vaddr, ut8* buf, int len);
 R_API bool r_io_read_at (RIO *io, ut64 addr, ut8 *buf, int len);
 R_API bool r_io_read_at_mapped(RIO *io, ut64 addr, ut8 *buf, int len);
 R_API int r_io_nread_at (RIO *io, ut64 addr, ut8 *buf, int len);
+R_API const ut8 *r_io_peek(RIO *io, ut64 addr, int len);
 R_API void r_io_alprint(RList *ls);
 R_API bool r_io_write_at (RIO *io, ut64 addr, const ut8 *buf, int len);
 R_API bool r_io_read (RIO *io, ut8 *buf, int len);
@@ -408,6 +411,7 @@ R_API bool r_io_desc_fini (RIO *io);
 /* io/cache.c */
 R_API int r_io_cache_invalidate(RIO *io, ut64 from, ut64 to);
 R_API bool r_io_cache_at(RIO *io, ut64 addr);
+R_API bool r_io_cache_in(RIO *io, ut64 addr, int len);
 R_API void r_io_cache_commit(RIO *io, ut64 from, ut64 to);
 R_API void r_io_cache_init(RIO *io);
 R_API void r_io_cache_fini (RIO *io);
@@ -32,7 +32,7 @@ typedef struct r_parse_t {
 	char *retleave_asm;
 	struct r_parse_plugin_t *cur;
 	RAnal *anal; // weak anal ref
-	RAnalHint *hint; // weak anal ref
+	const RAnalHint *hint; // weak anal ref
 	RList *parsers;
 	RAnalVarList varlist;
 	char* (*get_op_ireg)(void *user, ut64 addr);
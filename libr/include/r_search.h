@@ -69,6 +69,7 @@ typedef struct r_search_t {
 	int align;
 	int (*update)(struct r_search_t *s, ut64 from, const ut8 *buf, int len);
 	RList *kws; // TODO: Use r_search_kw_new ()
+	void *ac; // multi-pattern automaton over kws, built on demand
 	RIOBind iob;
 	char bckwrds;
 } RSearch;
@@ -77,6 +77,8 @@ typedef struct r_socket_http_options {
 	bool accept_timeout;
 	int timeout;
 	bool httpauth;
+	bool keepalive; // answer with HTTP/1.1 and reuse the connections
+	bool *stop; // stop waiting for the next request of idle connections
 } RSocketHTTPOptions;
 
 
@@ -146,9 +148,15 @@ typedef struct r_socket_http_request {
 	ut8 *data;
 	int data_length;
 	bool auth;
+	bool keepalive; // the connection can be reused after the response
+	int count; // requests read before this one from the same connection
+	ut8 *rbuf; // bytes read ahead, the start of pipelined requests
+	int rbuf_off;
+	int rbuf_len;
 } RSocketHTTPRequest;
 
 R_API RSocketHTTPRequest *r_socket_http_accept(RSocket *s, RSocketHTTPOptions *so);
+R_API RSocketHTTPRequest *r_socket_http_next(RSocketHTTPRequest *rs, RSocketHTTPOptions *so);
 R_API void r_socket_http_response(RSocketHTTPRequest *rs, int code, const char *out, int x, const char *headers);
 R_API void r_socket_http_close(RSocketHTTPRequest *rs);
 R_API ut8 *r_socket_http_handle_upload(const ut8 *str, int len, int *olen);
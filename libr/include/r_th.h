@@ -87,6 +87,7 @@ R_API bool r_th_kill(RThread *th, bool force);
 R_API bool r_th_pause(RThread *th, bool enable);
 R_API bool r_th_try_pause(RThread *th);
 R_API R_TH_TID r_th_self(void);
+R_API int r_th_ncpus(void);
 R_API bool r_th_setname(RThread *th, const char *name);
 R_API bool r_th_getname(RThread *th, char *name, size_t len);
 
@@ -8,7 +8,7 @@ extern "C" {
 typedef struct r_mmap_t {
 	ut8 *buf;
 	ut64 base;
-	int len;
+	ut64 len;
 	int fd;
 	int rw;
 #if __WINDOWS__
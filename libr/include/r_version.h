@@ -0,0 +1,8 @@
+#ifndef R_VERSION_H
+#define R_VERSION_H 1
+#define R2_VERSION_COMMIT 1
+#define R2_VERSION "3.4.0-git"
+#define R2_GITTAP "3.4.0-git"
+#define R2_GITTIP "fb1c654aa6ccbbf63fb4146940f13a52d21449a9"
+#define R2_BIRTH "2026-10-18__01:24:50"
+#endif
@@ -1,16 +1,13 @@
-/* radare - LGPL - Copyright 2008-2018 - pancake */
-
-// TODO: implement a more inteligent way to store cached memory
+/* radare - LGPL - Copyright 2008-2019 - pancake */
 
 #include "r_io.h"
 
-#if 0
-#define CACHE_CONTAINER(x) container_of ((RBNode*)x, RCache, rb)
+// Cached writes are kept in a red-black tree of disjoint intervals sorted by
+// address. Writes overlapping or adjacent to existing items are coalesced
+// into a single item, so reads only visit the items they intersect in
+// O(log(n) + k) time regardless of how many writes were performed.
 
-static void _fcn_tree_calc_max_addr(RBNode *node) {
-	RIOCache *c = CACHE_CONTAINER (node);
-}
-#endif // 0
+#define CACHE_CONTAINER(x) container_of ((RBNode*)(x), RIOCache, rb)
 
 static void cache_item_free(RIOCache *cache) {
 	if (!cache) {
@@ -21,25 +18,97 @@ static void cache_item_free(RIOCache *cache) {
 	free (cache);
 }
 
-R_API bool r_io_cache_at(RIO *io, ut64 addr) {
-	RIOCache *c;
-	RListIter *iter;
-	r_list_foreach (io->cache, iter, c) {
-		if (r_itv_contain (c->itv, addr)) {
-			return true;
+static void _cache_tree_free(RBNode *node) {
+	cache_item_free (CACHE_CONTAINER (node));
+}
+
+// items never overlap, so sorting by begin also sorts them by end
+static int _cache_tree_cmp(const void *a_, const RBNode *b_) {
+	const RIOCache *a = (const RIOCache *)a_;
+	const RIOCache *b = CACHE_CONTAINER (b_);
+	const ut64 from0 = r_itv_begin (a->itv), from1 = r_itv_begin (b->itv);
+	if (from0 != from1) {
+		return from0 < from1 ? -1 : 1;
+	}
+	return 0;
+}
+
+// used with lower_bound to find the first item whose end is after addr
+static int _cache_tree_end_cmp(const void *a_, const RBNode *b_) {
+	const ut64 addr = *(const ut64 *)a_;
+	return addr < r_itv_end (CACHE_CONTAINER (b_)->itv) ? -1 : 1;
+}
+
+// used with lower_bound to find the first item ending at or after addr
+static int _cache_tree_touch_cmp(const void *a_, const RBNode *b_) {
+	const ut64 addr = *(const ut64 *)a_;
+	return addr <= r_itv_end (CACHE_CONTAINER (b_)->itv) ? -1 : 1;
+}
+
+// returns the first item intersecting [from, last], the bound is inclusive
+// so that ranges ending at UT64_MAX do not overflow
+static RIOCache *cache_tree_first_in(RIO *io, ut64 from, ut64 last) {
+	RBNode *node = r_rbtree_lower_bound (io->cache, &from, _cache_tree_end_cmp);
+	if (node) {
+		RIOCache *c = CACHE_CONTAINER (node);
+		if (r_itv_begin (c->itv) <= last) {
+			return c;
 		}
 	}
-	return false;
+	return NULL;
+}
+
+// returns the first item intersecting or adjacent to [from, to)
+static RIOCache *cache_tree_first_touching(RIO *io, ut64 from, ut64 to) {
+	RBNode *node = r_rbtree_lower_bound (io->cache, &from, _cache_tree_touch_cmp);
+	if (node) {
+		RIOCache *c = CACHE_CONTAINER (node);
+		if (r_itv_begin (c->itv) <= to) {
+			return c;
+		}
+	}
+	return NULL;
+}
+
+// ranges reaching the end of the address space are clamped to UT64_MAX
+static ut64 cache_range_end(ut64 addr, int len) {
+	ut64 end = addr + len;
+	return (end < addr)? UT64_MAX: end;
+}
+
+static bool cache_read_original(RIO *io, ut64 addr, ut8 *buf, int len) {
+	const int cached = io->cached;
+	const bool cm = io->cachemode;
+	io->cached = 0;
+	io->cachemode = false;
+	bool ret = r_io_read_at (io, addr, buf, len);
+	io->cached = cached;
+	io->cachemode = cm;
+	return ret;
+}
+
+R_API bool r_io_cache_at(RIO *io, ut64 addr) {
+	r_return_val_if_fail (io, false);
+	return cache_tree_first_in (io, addr, addr) != NULL;
+}
+
+R_API bool r_io_cache_in(RIO *io, ut64 addr, int len) {
+	r_return_val_if_fail (io, false);
+	if (len < 1) {
+		return false;
+	}
+	ut64 last = addr + len - 1;
+	return cache_tree_first_in (io, addr, (last < addr)? UT64_MAX: last) != NULL;
 }
 
 R_API void r_io_cache_init(RIO *io) {
-	io->cache = r_list_newf ((RListFree)cache_item_free);
+	io->cache = NULL;
 	io->buffer = r_cache_new ();
 	io->cached = 0;
 }
 
 R_API void r_io_cache_fini (RIO *io) {
-	r_list_free (io->cache);
+	r_rbtree_free (io->cache, _cache_tree_free);
 	r_cache_free (io->buffer);
 	io->cache = NULL;
 	io->buffer = NULL;
@@ -47,57 +116,58 @@ R_API void r_io_cache_fini (RIO *io) {
 }
 
 R_API void r_io_cache_commit(RIO *io, ut64 from, ut64 to) {
-	RListIter *iter;
 	RIOCache *c;
-	RInterval range = (RInterval){from, to - from};
-	r_list_foreach (io->cache, iter, c) {
-		// if (from <= c->to - 1 && c->from <= to - 1) {
-		if (r_itv_overlap (c->itv, range)) {
-			int cached = io->cached;
-			io->cached = 0;
-			if (r_io_write_at (io, r_itv_begin (c->itv), c->data, r_itv_size (c->itv))) {
-				c->written = true;
-			} else {
-				eprintf ("Error writing change at 0x%08"PFMT64x"\n", r_itv_begin (c->itv));
-			}
-			io->cached = cached;
-			break; // XXX old behavior, revisit this
+	RBIter it = r_rbtree_lower_bound_forward (io->cache, &from, _cache_tree_end_cmp);
+	r_rbtree_iter_while (it, c, RIOCache, rb) {
+		if (r_itv_begin (c->itv) >= to) {
+			break;
+		}
+		int cached = io->cached;
+		io->cached = 0;
+		if (r_io_write_at (io, r_itv_begin (c->itv), c->data, r_itv_size (c->itv))) {
+			c->written = true;
+		} else {
+			eprintf ("Error writing change at 0x%08"PFMT64x"\n", r_itv_begin (c->itv));
 		}
+		io->cached = cached;
 	}
 }
 
 R_API void r_io_cache_reset(RIO *io, int set) {
 	io->cached = set;
-	r_list_purge (io->cache);
+	r_rbtree_free (io->cache, _cache_tree_free);
+	io->cache = NULL;
+	io->wgen++;
 }
 
 R_API int r_io_cache_invalidate(RIO *io, ut64 from, ut64 to) {
 	int invalidated = 0;
-	RListIter *iter, *tmp;
 	RIOCache *c;
-	RInterval range = (RInterval){from, to - from};
-	r_list_foreach_prev_safe (io->cache, iter, tmp, c) {
-		if (r_itv_overlap (c->itv, range)) {
-			int cached = io->cached;
-			io->cached = 0;
-			r_io_write_at (io, r_itv_begin (c->itv), c->odata, r_itv_size (c->itv));
-			io->cached = cached;
-			c->written = false;
-			r_list_delete (io->cache, iter);
-			invalidated++;
-		}
+	if (to <= from) {
+		return 0;
+	}
+	while ((c = cache_tree_first_in (io, from, to - 1))) {
+		int cached = io->cached;
+		io->cached = 0;
+		r_io_write_at (io, r_itv_begin (c->itv), c->odata, r_itv_size (c->itv));
+		io->cached = cached;
+		r_rbtree_delete (&io->cache, c, _cache_tree_cmp, _cache_tree_free);
+		invalidated++;
+	}
+	if (invalidated) {
+		io->wgen++;
 	}
 	return invalidated;
 }
 
 R_API int r_io_cache_list(RIO *io, int rad) {
 	int i, j = 0;
-	RListIter *iter;
+	RBIter it;
 	RIOCache *c;
 	if (rad == 2) {
 		io->cb_printf ("[");
 	}
-	r_list_foreach (io->cache, iter, c) {
+	r_rbtree_foreach (io->cache, it, c, RIOCache, rb) {
 		const int dataSize = r_itv_size (c->itv);
 		if (rad == 1) {
 			io->cb_printf ("wx ");
@@ -111,8 +181,8 @@ R_API int r_io_cache_list(RIO *io, int rad) {
 			}
 			io->cb_printf ("\n");
 		} else if (rad == 2) {
-			io->cb_printf ("{\"idx\":%"PFMT64d",\"addr\":%"PFMT64d",\"size\":%d,",
-				j, r_itv_begin (c->itv), dataSize);
+			io->cb_printf ("%s{\"idx\":%"PFMT64d",\"addr\":%"PFMT64d",\"size\":%d,",
+				j? ",": "", j, r_itv_begin (c->itv), dataSize);
 			io->cb_printf ("\"before\":\"");
 		  	for (i = 0; i < dataSize; i++) {
 				io->cb_printf ("%02x", c->odata[i]);
@@ -121,8 +191,7 @@ R_API int r_io_cache_list(RIO *io, int rad) {
 		  	for (i = 0; i < dataSize; i++) {
 				io->cb_printf ("%02x", c->data[i]);
 			}
-			io->cb_printf ("\",\"written\":%s}%s", c->written
-				? "true": "false", iter->n? ",": "");
+			io->cb_printf ("\",\"written\":%s}", c->written? "true": "false");
 		} else if (rad == 0) {
 			io->cb_printf ("idx=%d addr=0x%08"PFMT64x" size=%d ", j, r_itv_begin (c->itv), dataSize);
 			for (i = 0; i < dataSize; i++) {
@@ -143,54 +212,122 @@ R_API int r_io_cache_list(RIO *io, int rad) {
 }
 
 R_API bool r_io_cache_write(RIO *io, ut64 addr, const ut8 *buf, int len) {
-	RIOCache *ch;
-	ch = R_NEW0 (RIOCache);
-	if (!ch) {
+	r_return_val_if_fail (io && buf, false);
+	if (len < 1) {
 		return false;
 	}
-	ch->itv = (RInterval){addr, len};
-	ch->odata = (ut8*)calloc (1, len + 1);
-	if (!ch->odata) {
-		free (ch);
+	const ut64 end = cache_range_end (addr, len);
+	len = end - addr;
+	if (len < 1) {
 		return false;
 	}
-	ch->data = (ut8*)calloc (1, len + 1);
-	if (!ch->data) {
-		free (ch->odata);
-		free (ch);
-		return false;
+	io->wgen++;
+	// fast path: overwriting bytes of a single cached item
+	RIOCache *c = cache_tree_first_in (io, addr, end - 1);
+	if (c && r_itv_begin (c->itv) <= addr && end <= r_itv_end (c->itv)) {
+		memcpy (c->data + (addr - r_itv_begin (c->itv)), buf, len);
+		c->written = false;
+		return true;
+	}
+	// the first touching item is reused when it starts before the new write,
+	// the rest are absorbed into it and removed from the tree
+	RIOCache *ch = NULL;
+	ut64 begin = addr, last = end, covered = addr;
+	RPVector absorbed;
+	void **vit;
+	r_pvector_init (&absorbed, NULL);
+	while ((c = cache_tree_first_touching (io, addr, end))) {
+		r_rbtree_delete (&io->cache, c, _cache_tree_cmp, NULL);
+		if (!ch && r_itv_begin (c->itv) <= addr) {
+			ch = c;
+			begin = r_itv_begin (ch->itv);
+			covered = r_itv_end (ch->itv);
+		} else {
+			r_pvector_push (&absorbed, c);
+		}
+		last = R_MAX (last, r_itv_end (c->itv));
+	}
+	const ut64 size = last - begin;
+	if (size > ST32_MAX) {
+		eprintf ("r_io_cache_write: cannot coalesce more than 2GB of cached writes\n");
+		goto beach;
 	}
+	if (ch) {
+		ut8 *data = realloc (ch->data, size);
+		if (!data) {
+			goto beach;
+		}
+		ch->data = data;
+		ut8 *odata = realloc (ch->odata, size);
+		if (!odata) {
+			goto beach;
+		}
+		ch->odata = odata;
+	} else {
+		ch = R_NEW0 (RIOCache);
+		if (!ch) {
+			goto beach;
+		}
+		ch->data = malloc (size);
+		ch->odata = malloc (size);
+		if (!ch->data || !ch->odata) {
+			cache_item_free (ch);
+			ch = NULL;
+			goto beach;
+		}
+	}
+	ch->itv = (RInterval){ begin, size };
 	ch->written = false;
-	{
-		bool cm = io->cachemode;
-		io->cachemode = false;
-		r_io_read_at (io, addr, ch->odata, len);
-		io->cachemode = cm;
-	}
-	memcpy (ch->data, buf, len);
-	r_list_append (io->cache, ch);
+	// bytes not covered by the reused item come from the backend, absorbed
+	// items carry older originals so their odata wins over what is read now
+	if (covered < end) {
+		const ut64 from = R_MAX (covered, addr);
+		cache_read_original (io, from, ch->odata + (from - begin), end - from);
+	}
+	r_pvector_foreach (&absorbed, vit) {
+		RIOCache *o = *vit;
+		const ut64 obegin = r_itv_begin (o->itv);
+		memcpy (ch->data + (obegin - begin), o->data, r_itv_size (o->itv));
+		memcpy (ch->odata + (obegin - begin), o->odata, r_itv_size (o->itv));
+		cache_item_free (o);
+	}
+	r_pvector_clear (&absorbed);
+	memcpy (ch->data + (addr - begin), buf, len);
+	r_rbtree_insert (&io->cache, ch, &ch->rb, _cache_tree_cmp);
 	return true;
+beach:
+	// keep whatever was removed from the tree to not lose older writes
+	if (ch) {
+		r_rbtree_insert (&io->cache, ch, &ch->rb, _cache_tree_cmp);
+	}
+	r_pvector_foreach (&absorbed, vit) {
+		RIOCache *o = *vit;
+		r_rbtree_insert (&io->cache, o, &o->rb, _cache_tree_cmp);
+	}
+	r_pvector_clear (&absorbed);
+	return false;
 }
 
 R_API bool r_io_cache_read(RIO *io, ut64 addr, ut8 *buf, int len) {
-	int l, covered = 0;
-	RListIter *iter;
+	r_return_val_if_fail (io && buf, false);
+	bool covered = false;
 	RIOCache *c;
-	RInterval range = (RInterval){ addr, len };
-	r_list_foreach (io->cache, iter, c) {
-		if (r_itv_overlap (c->itv, range)) {
-			const ut64 begin = r_itv_begin (c->itv);
-			if (addr < begin) {
-				l = R_MIN (addr + len - begin, r_itv_size (c->itv));
-				memcpy (buf + begin - addr, c->data, l);
-			} else {
-				l = R_MIN (r_itv_end (c->itv) - addr, len);
-				memcpy (buf, c->data + addr - begin, l);
-			}
-			covered += l;
+	if (len < 1) {
+		return false;
+	}
+	const ut64 end = cache_range_end (addr, len);
+	RBIter it = r_rbtree_lower_bound_forward (io->cache, &addr, _cache_tree_end_cmp);
+	r_rbtree_iter_while (it, c, RIOCache, rb) {
+		const ut64 begin = r_itv_begin (c->itv);
+		if (begin >= end) {
+			break;
 		}
+		const ut64 from = R_MAX (begin, addr);
+		const ut64 to = R_MIN (r_itv_end (c->itv), end);
+		memcpy (buf + (from - addr), c->data + (from - begin), to - from);
+		covered = true;
 	}
-	return (covered == 0) ? false: true;
+	return covered;
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -70,6 +70,7 @@ R_API bool r_io_desc_add(RIO* io, RIODesc* desc) {
 		r_sys_backtrace ();
 		return false;
 	}
+	io->wgen++;
 	return true;
 }
 
@@ -82,6 +83,7 @@ R_API bool r_io_desc_del(RIO* io, int fd) {		//can we pass this a riodesc and ch
 	if (desc == io->desc) {
 		io->desc = NULL;
 	}
+	io->wgen++;
 	// remove all dead maps
 	r_io_map_cleanup (io);
 	return true;
@@ -168,6 +170,9 @@ R_API int r_io_desc_write(RIODesc *desc, const ut8* buf, int len) {
 	if (!buf || !desc || !desc->plugin || len < 1) {
 		return 0;
 	}
+	if (desc->io) {
+		desc->io->wgen++;
+	}
 	//check pointers and pcache
 	if (desc->io && (desc->io->p_cache & 2)) {
 		return r_io_desc_cache_write (desc,
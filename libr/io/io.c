@@ -355,6 +355,48 @@ R_API int r_io_nread_at(RIO *io, ut64 addr, ut8 *buf, int len) {
 	return ret;
 }
 
+// Returns a pointer to the bytes at [addr, addr + len) when they can be read
+// in place, that is, when the whole range lives in a single skyline part of a
+// descriptor that exposes its storage (mmap'd local files) and no cache layer
+// could change them. Otherwise NULL is returned and the caller must fall back
+// to r_io_read_at. The pointer is borrowed: it is only valid until the next
+// write, map change or close.
+R_API const ut8 *r_io_peek(RIO *io, ut64 addr, int len) {
+	r_return_val_if_fail (io && len >= 0, NULL);
+	if (!len || io->p_cache) {
+		return NULL;
+	}
+	if ((io->cached & R_PERM_R) && r_io_cache_in (io, addr, len)) {
+		return NULL;
+	}
+	RIODesc *desc = io->desc;
+	ut64 paddr = addr;
+	if (io->va) {
+		const RPVector *skyline = &io->map_skyline;
+		size_t i;
+#define CMP(addr, part) ((addr) < r_itv_end (((RIOMapSkyline *)(part))->itv) - 1 ? -1 : \
+			(addr) > r_itv_end (((RIOMapSkyline *)(part))->itv) - 1 ? 1 : 0)
+		r_pvector_lower_bound (skyline, addr, i, CMP);
+#undef CMP
+		if (i >= r_pvector_len (skyline)) {
+			return NULL;
+		}
+		const RIOMapSkyline *part = r_pvector_at (skyline, i);
+		if (addr < part->itv.addr || (ut64)len - 1 > r_itv_end (part->itv) - 1 - addr) {
+			return NULL;
+		}
+		if (!(part->map->perm & R_PERM_R)) {
+			return NULL;
+		}
+		paddr = part->map->delta + addr - part->map->itv.addr;
+		desc = r_io_desc_get (io, part->map->fd);
+	}
+	if (!desc || !desc->plugin || !desc->plugin->peek || !(desc->perm & R_PERM_R)) {
+		return NULL;
+	}
+	return desc->plugin->peek (io, desc, paddr, len);
+}
+
 R_API bool r_io_write_at(RIO* io, ut64 addr, const ut8* buf, int len) {
 	int i;
 	bool ret = false;
@@ -663,7 +705,7 @@ R_API int r_io_fini(RIO* io) {
 	r_io_desc_fini (io);
 	r_io_map_fini (io);
 	ls_free (io->plugins);
-	r_list_free (io->cache);
+	r_io_cache_fini (io);
 	r_list_free (io->undo.w_list);
 	if (io->runprofile) {
 		R_FREE (io->runprofile);
@@ -78,6 +78,8 @@ void io_map_calculate_skyline(RIO *io) {
 	RBinHeap heap;
 	struct map_event_t *ev;
 	bool *deleted = NULL;
+	// the bytes seen at some addresses may have changed
+	io->wgen++;
 	r_pvector_clear (&io->map_skyline);
 	r_pvector_clear (&io->map_skyline_shadow);
 	r_pvector_init (&events, free);
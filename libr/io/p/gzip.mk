@@ -4,6 +4,8 @@ STATIC_OBJ+=${OBJ_GZIP}
 TARGET_GZIP=io_gzip.${EXT_SO}
 ALL_TARGETS+=${TARGET_GZIP}
 
+CFLAGS+=-I../../shlr/zip/include
+
 ifeq (${WITHPIC},0)
 LINKFLAGS+=../../util/libr_util.a
 LINKFLAGS+=../../io/libr_io.a
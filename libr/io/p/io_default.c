@@ -16,6 +16,8 @@ typedef struct r_io_mmo_t {
 	RBuffer *buf;
 	RIO * io_backref;
 	int rawio;
+	RMmap *peek;    /* read-only mapping of huge files, only used by peek */
+	bool nopeek;
 } RIOMMapFileObj;
 
 static int __io_posix_open(const char *file, int perm, int mode) {
@@ -84,6 +86,8 @@ static int r_io_def_mmap_refresh_def_mmap_buf(RIOMMapFileObj *mmo) {
 	} else {
 		cur = 0;
 	}
+	r_file_mmap_free (mmo->peek);
+	mmo->peek = NULL;
 	st64 sz = r_file_size (mmo->filename);
 	if (sz > ST32_MAX) {
 		// Do not use mmap if the file is huge
@@ -118,6 +122,7 @@ static int r_io_def_mmap_refresh_def_mmap_buf(RIOMMapFileObj *mmo) {
 static void r_io_def_mmap_free (RIOMMapFileObj *mmo) {
 	free (mmo->filename);
 	r_buf_free (mmo->buf);
+	r_file_mmap_free (mmo->peek);
 	close (mmo->fd);
 	memset (mmo, 0, sizeof (RIOMMapFileObj));
 	free (mmo);
@@ -238,6 +243,38 @@ static int r_io_def_mmap_read(RIO *io, RIODesc *fd, ut8 *buf, int count) {
 	return r_buf_read_at (mmo->buf, io->off, buf, count);
 }
 
+// files over 2GB are read with read(2), but they are still mapped on
+// 64 bit unix hosts to let r_io_peek() hand out pointers into them
+static const ut8 *r_io_def_mmap_peek(RIO *io, RIODesc *fd, ut64 addr, int len) {
+	RIOMMapFileObj *mmo = fd->data;
+	if (!mmo || mmo->nocache) {
+		return NULL;
+	}
+	const ut8 *buf = NULL;
+	ut64 size = 0;
+	if (!mmo->rawio) {
+		if (mmo->buf && mmo->buf->mmap) {
+			buf = mmo->buf->buf;
+			size = mmo->buf->length;
+		}
+	} else {
+#if __UNIX__
+		if (!mmo->peek && !mmo->nopeek && sizeof (void *) == 8) {
+			mmo->peek = r_file_mmap (mmo->filename, false, 0);
+			mmo->nopeek = !mmo->peek || !mmo->peek->buf;
+		}
+		if (mmo->peek && !mmo->nopeek) {
+			buf = mmo->peek->buf;
+			size = mmo->peek->len;
+		}
+#endif
+	}
+	if (!buf || addr > size || (ut64)len > size - addr) {
+		return NULL;
+	}
+	return buf + addr;
+}
+
 static int r_io_def_mmap_write(RIO *io, RIODesc *fd, const ut8 *buf, int count) {
 	RIOMMapFileObj *mmo;
 	int len = -1;
@@ -288,6 +325,11 @@ static int r_io_def_mmap_write(RIO *io, RIODesc *fd, const ut8 *buf, int count)
 			return -1;
 		}
 		len = write (mmo->fd, buf, count);
+		if (mmo->peek && addr + count > mmo->peek->len) {
+			// the mapping does not cover the grown file anymore
+			r_file_mmap_free (mmo->peek);
+			mmo->peek = NULL;
+		}
 		return len;
 	}
 
@@ -368,6 +410,10 @@ static int __write(RIO *io, RIODesc *fd, const ut8 *buf, int len) {
 	return r_io_def_mmap_write(io, fd, buf, len);
 }
 
+static const ut8 *__peek(RIO *io, RIODesc *fd, ut64 addr, int len) {
+	return r_io_def_mmap_peek (io, fd, addr, len);
+}
+
 static ut64 __lseek(RIO *io, RIODesc *fd, ut64 offset, int whence) {
 	return r_io_def_mmap_lseek (io, fd, offset, whence);
 }
@@ -414,6 +460,7 @@ RIOPlugin r_io_plugin_default = {
 	.open = __open_default,
 	.close = __close,
 	.read = __read,
+	.peek = __peek,
 	.check = __plugin_open_default,
 	.lseek = __lseek,
 	.write = __write,
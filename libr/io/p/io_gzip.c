@@ -1,106 +1,456 @@
-/* radare - LGPL - Copyright 2008-2017 - pancake */
+/* radare - LGPL - Copyright 2008-2019 - pancake */
 
 #include "r_io.h"
 #include "r_lib.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <sys/types.h>
+#include <zlib.h>
+
+// Random access to gzip files without inflating them in memory. Opening
+// the file inflates it once to find the uncompressed size and to take a
+// checkpoint (the inflate state, which is the position in the compressed
+// stream plus the last 32K of output) every GZ_SPAN bytes. Reads inflate
+// the spans they touch starting from the closest checkpoint, and keep the
+// last GZ_CACHE decoded spans around.
+
+#define GZ_SPAN (1024 * 1024)
+// longest span accepted from an index file
+#define GZ_SPAN_MAX (64 * GZ_SPAN)
+#define GZ_WINSIZE 32768
+#define GZ_CHUNK 16384
+#define GZ_CACHE 64
+#define GZ_INDEX_MAGIC "R2GZI\x01"
+#define GZ_INDEX_EXT ".r2gzi"
+
+typedef struct {
+	ut64 out; // offset in the uncompressed data
+	ut64 in; // offset of the first whole byte of compressed data
+	int bits; // bits of the byte before 'in' that are still to be used
+	ut8 *window; // deflated copy of the 32K of output before 'out'
+	ut32 wlen; // 0 for the start of the stream, that needs no window
+} GzPoint;
 
 typedef struct {
-	ut8 *buf;
+	int point;
+	ut8 *data;
 	ut32 size;
+	ut64 used;
+} GzSpan;
+
+typedef struct {
+	int fd;
+	ut64 insize;
+	ut64 size;
 	ut64 offset;
+	ut8 trailer[8];
+	bool gzip; // otherwise zlib, which can not have several members
+	GzPoint *points;
+	int npoints;
+	GzSpan cache[GZ_CACHE];
+	ut64 tick;
+	// stats
+	ut64 hits;
+	ut64 misses;
+	ut64 inflated;
+	ut64 inflate_time;
+	ut64 index_time;
 } RIOGzip;
 
-static inline ut32 _io_malloc_sz(RIODesc *desc) {
-	if (!desc) {
+static ut64 gz_now(void) {
+	ut64 now = r_sys_now ();
+	return (now >> 20) * 1000000 + (now & 0xfffff);
+}
+
+static int gz_read_at(RIOGzip *gz, ut64 off, ut8 *buf, int len) {
+	if (off >= gz->insize) {
 		return 0;
 	}
-	RIOGzip *mal = (RIOGzip*)desc->data;
-	return mal? mal->size: 0;
+	if (lseek (gz->fd, off, SEEK_SET) < 0) {
+		return -1;
+	}
+	int n = 0;
+	while (n < len) {
+		int r = read (gz->fd, buf + n, len - n);
+		if (r <= 0) {
+			break;
+		}
+		n += r;
+	}
+	return n;
 }
 
-static inline void _io_malloc_set_sz(RIODesc *desc, ut32 sz) {
-	if (!desc) {
-		return;
+static bool gz_add_point(RIOGzip *gz, ut64 in, ut64 out, int bits, const ut8 *window, ut32 left) {
+	if (!(gz->npoints & 255)) {
+		GzPoint *p = realloc (gz->points, (gz->npoints + 256) * sizeof (GzPoint));
+		if (!p) {
+			return false;
+		}
+		gz->points = p;
 	}
-	RIOGzip *mal = (RIOGzip*)desc->data;
-	if (mal) {
-		mal->size = sz;
+	GzPoint *p = &gz->points[gz->npoints];
+	p->in = in;
+	p->out = out;
+	p->bits = bits;
+	p->window = NULL;
+	p->wlen = 0;
+	if (window) {
+		// the window is circular, 'left' bytes of it were not written yet
+		ut8 *win = malloc (GZ_WINSIZE);
+		uLongf wlen = compressBound (GZ_WINSIZE);
+		p->window = malloc (wlen);
+		if (!win || !p->window) {
+			free (win);
+			free (p->window);
+			return false;
+		}
+		if (left) {
+			memcpy (win, window + GZ_WINSIZE - left, left);
+		}
+		memcpy (win + left, window, GZ_WINSIZE - left);
+		if (compress2 (p->window, &wlen, win, GZ_WINSIZE, Z_BEST_SPEED) != Z_OK) {
+			free (win);
+			free (p->window);
+			return false;
+		}
+		free (win);
+		ut8 *w = realloc (p->window, wlen);
+		if (w) {
+			p->window = w;
+		}
+		p->wlen = wlen;
 	}
+	gz->npoints++;
+	return true;
 }
 
-static inline ut8* _io_malloc_buf(RIODesc *desc) {
-	if (!desc) {
-		return NULL;
+// inflate the whole file once, taking a checkpoint at the end of the
+// first deflate block found after every GZ_SPAN bytes of output
+static bool gz_build_index(RIOGzip *gz) {
+	ut8 *input = malloc (GZ_CHUNK);
+	ut8 *window = calloc (1, GZ_WINSIZE);
+	z_stream strm = {0};
+	ut64 totin = 0, totout = 0, last = 0;
+	bool ok = false;
+	int ret = Z_OK;
+
+	if (!input || !window || inflateInit2 (&strm, MAX_WBITS + 32) != Z_OK) {
+		free (input);
+		free (window);
+		return false;
+	}
+	if (!gz_add_point (gz, 0, 0, 0, NULL, 0)) {
+		goto beach;
 	}
-	RIOGzip *mal = (RIOGzip*)desc->data;
-	return mal->buf;
+	strm.avail_out = 0;
+	for (;;) {
+		if (!strm.avail_in) {
+			int n = gz_read_at (gz, totin, input, GZ_CHUNK);
+			if (n <= 0) {
+				// truncated file, keep what could be inflated
+				eprintf ("gzip: unexpected end of file\n");
+				ok = totout > 0;
+				break;
+			}
+			strm.avail_in = n;
+			strm.next_in = input;
+		}
+		if (!strm.avail_out) {
+			strm.avail_out = GZ_WINSIZE;
+			strm.next_out = window;
+		}
+		ut32 avail_in = strm.avail_in;
+		ut32 avail_out = strm.avail_out;
+		ret = inflate (&strm, Z_BLOCK);
+		totin += avail_in - strm.avail_in;
+		totout += avail_out - strm.avail_out;
+		if (ret == Z_STREAM_END) {
+			ok = true;
+			if (!gz->gzip) {
+				break;
+			}
+			// concatenated gzip members are one stream for gunzip
+			ut8 magic[2];
+			if (gz_read_at (gz, totin, magic, 2) != 2 || magic[0] != 0x1f || magic[1] != 0x8b) {
+				break;
+			}
+			inflateReset (&strm);
+			continue;
+		}
+		if (ret != Z_OK) {
+			eprintf ("gzip: inflate error %d at 0x%"PFMT64x"\n", ret, totin);
+			ok = totout > 0;
+			break;
+		}
+		if ((strm.data_type & 128) && !(strm.data_type & 64) && totout - last >= GZ_SPAN) {
+			if (!gz_add_point (gz, totin, totout, strm.data_type & 7, window, strm.avail_out)) {
+				goto beach;
+			}
+			last = totout;
+		}
+	}
+	gz->size = totout;
+beach:
+	inflateEnd (&strm);
+	free (input);
+	free (window);
+	return ok;
+}
+
+static void gz_free_points(RIOGzip *gz) {
+	int i;
+	for (i = 0; i < gz->npoints; i++) {
+		free (gz->points[i].window);
+	}
+	R_FREE (gz->points);
+	gz->npoints = 0;
 }
 
+static ut64 gz_point_end(RIOGzip *gz, int i) {
+	return i + 1 < gz->npoints? gz->points[i + 1].out: gz->size;
+}
+
+// inflate the span of output that starts at the checkpoint i
+static ut8 *gz_inflate_span(RIOGzip *gz, int i, ut32 *size) {
+	GzPoint *p = &gz->points[i];
+	ut64 to = gz_point_end (gz, i);
+	if (to < p->out || to - p->out >= UT32_MAX) {
+		return NULL;
+	}
+	ut32 len = to - p->out;
+	ut8 *input = malloc (GZ_CHUNK);
+	ut8 *out = malloc (len + 1);
+	z_stream strm = {0};
+	ut64 pos = p->in;
+	bool raw = p->wlen != 0;
+	bool ok = false;
 
-static inline ut8* _io_malloc_set_buf(RIODesc *desc, ut8* buf) {
-	if (!desc) {
+	if (!input || !out) {
+		goto fail;
+	}
+	if (inflateInit2 (&strm, raw? -MAX_WBITS: MAX_WBITS + 32) != Z_OK) {
+		goto fail;
+	}
+	if (p->wlen) {
+		ut8 *win = malloc (GZ_WINSIZE);
+		uLongf wlen = GZ_WINSIZE;
+		if (!win || uncompress (win, &wlen, p->window, p->wlen) != Z_OK) {
+			free (win);
+			goto end;
+		}
+		if (p->bits) {
+			ut8 b;
+			if (gz_read_at (gz, --pos, &b, 1) != 1) {
+				free (win);
+				goto end;
+			}
+			pos++;
+			inflatePrime (&strm, p->bits, b >> (8 - p->bits));
+		}
+		inflateSetDictionary (&strm, win, wlen);
+		free (win);
+	}
+	strm.next_out = out;
+	strm.avail_out = len;
+	while (strm.avail_out) {
+		if (!strm.avail_in) {
+			int n = gz_read_at (gz, pos, input, GZ_CHUNK);
+			if (n <= 0) {
+				break;
+			}
+			strm.avail_in = n;
+			strm.next_in = input;
+		}
+		ut32 avail_in = strm.avail_in;
+		int ret = inflate (&strm, Z_NO_FLUSH);
+		pos += avail_in - strm.avail_in;
+		if (ret == Z_STREAM_END) {
+			if (!strm.avail_out || !gz->gzip) {
+				break;
+			}
+			// raw inflate stops before the trailer of the gzip member
+			if (raw) {
+				pos += 8;
+			}
+			ut8 magic[2];
+			if (gz_read_at (gz, pos, magic, 2) != 2 || magic[0] != 0x1f || magic[1] != 0x8b) {
+				break;
+			}
+			inflateReset2 (&strm, MAX_WBITS + 32);
+			strm.avail_in = 0;
+			raw = false;
+			continue;
+		}
+		if (ret != Z_OK) {
+			break;
+		}
+	}
+	ok = !strm.avail_out;
+end:
+	inflateEnd (&strm);
+fail:
+	free (input);
+	if (!ok) {
+		free (out);
 		return NULL;
 	}
-	RIOGzip *mal = (RIOGzip*)desc->data;
-	return mal->buf = buf;
+	*size = len;
+	return out;
 }
 
-static inline ut64 _io_malloc_off(RIODesc *desc) {
-	if (!desc) {
-		return 0;
+// decoded span starting at the checkpoint i, from the cache if possible
+static GzSpan *gz_span(RIOGzip *gz, int i) {
+	GzSpan *s, *lru = &gz->cache[0];
+	int j;
+	for (j = 0; j < GZ_CACHE; j++) {
+		s = &gz->cache[j];
+		if (s->data && s->point == i) {
+			s->used = ++gz->tick;
+			gz->hits++;
+			return s;
+		}
+		if (!s->data || (lru->data && s->used < lru->used)) {
+			lru = s;
+		}
+	}
+	ut64 t = gz_now ();
+	ut32 size = 0;
+	ut8 *data = gz_inflate_span (gz, i, &size);
+	if (!data) {
+		return NULL;
 	}
-	RIOGzip *mal = (RIOGzip*)desc->data;
-	return mal->offset;
+	gz->misses++;
+	gz->inflated += size;
+	gz->inflate_time += gz_now () - t;
+	free (lru->data);
+	lru->data = data;
+	lru->size = size;
+	lru->point = i;
+	lru->used = ++gz->tick;
+	return lru;
 }
 
-static inline void _io_malloc_set_off(RIODesc *desc, ut64 off) {
-	if (!desc) {
-		return;
+static int gz_find_point(RIOGzip *gz, ut64 off) {
+	int lo = 0, hi = gz->npoints;
+	while (hi - lo > 1) {
+		int mid = lo + (hi - lo) / 2;
+		if (gz->points[mid].out <= off) {
+			lo = mid;
+		} else {
+			hi = mid;
+		}
 	}
-	RIOGzip *mal = (RIOGzip*)desc->data;
-	mal->offset = off;
+	return lo;
 }
 
-static int __write(RIO *io, RIODesc *fd, const ut8 *buf, int count) {
-	if (!fd || !buf || count < 0 || !fd->data) {
-		return -1;
+static void gz_cache_flush(RIOGzip *gz) {
+	int j;
+	for (j = 0; j < GZ_CACHE; j++) {
+		R_FREE (gz->cache[j].data);
 	}
-	if (_io_malloc_off (fd) > _io_malloc_sz (fd)) {
-		return -1;
+}
+
+/* index files: magic, the size and trailer of the gzip file they belong
+ * to, the uncompressed size, the number of checkpoints and the span, and
+ * then the checkpoints */
+
+static bool gz_index_save(RIOGzip *gz, const char *file) {
+	ut64 size = 38;
+	int i;
+	for (i = 0; i < gz->npoints; i++) {
+		size += 24 + gz->points[i].wlen;
 	}
-	if (_io_malloc_off (fd) + count > _io_malloc_sz (fd)) {
-		count -= (_io_malloc_off (fd) + count -_io_malloc_sz (fd));
+	if (size > INT_MAX) {
+		return false;
+	}
+	ut8 *data = malloc (size), *p = data;
+	if (!data) {
+		return false;
 	}
-	if (count > 0) {
-		memcpy (_io_malloc_buf (fd) + _io_malloc_off (fd), buf, count);
-		_io_malloc_set_off (fd, _io_malloc_off (fd) + count);
-		return count;
+	memcpy (p, GZ_INDEX_MAGIC, 6);
+	r_write_le64 (p + 6, gz->insize);
+	memcpy (p + 14, gz->trailer, sizeof (gz->trailer));
+	r_write_le64 (p + 22, gz->size);
+	r_write_le32 (p + 30, gz->npoints);
+	r_write_le32 (p + 34, GZ_SPAN);
+	p += 38;
+	for (i = 0; i < gz->npoints; i++) {
+		GzPoint *gp = &gz->points[i];
+		r_write_le64 (p, gp->out);
+		r_write_le64 (p + 8, gp->in);
+		r_write_le32 (p + 16, gp->bits);
+		r_write_le32 (p + 20, gp->wlen);
+		if (gp->wlen) {
+			memcpy (p + 24, gp->window, gp->wlen);
+		}
+		p += 24 + gp->wlen;
 	}
-	return -1;
+	bool ret = r_file_dump (file, data, (int)size, false);
+	free (data);
+	return ret;
 }
 
-static bool __resize(RIO *io, RIODesc *fd, ut64 count) {
-	ut8 * new_buf = NULL;
-	if (!fd || !fd->data || count == 0) {
+static bool gz_index_load(RIOGzip *gz, const char *file) {
+	int len = 0;
+	ut8 *data = (ut8 *)r_file_slurp (file, &len);
+	ut8 *p = data, *end = data + len;
+	int i, n;
+	if (!data || len < 38 || memcmp (p, GZ_INDEX_MAGIC, 6)) {
+		free (data);
+		return false;
+	}
+	p += 6;
+	if (r_read_le64 (p) != gz->insize || memcmp (p + 8, gz->trailer, sizeof (gz->trailer))) {
+		// the index is for another file
+		free (data);
 		return false;
 	}
-	ut32 mallocsz = _io_malloc_sz (fd);
-	if (_io_malloc_off (fd) > mallocsz) {
+	ut64 size = r_read_le64 (p + 16);
+	n = r_read_le32 (p + 24);
+	if (r_read_le32 (p + 28) != GZ_SPAN) {
+		free (data);
 		return false;
 	}
-	new_buf = malloc (count);
-	if (!new_buf) {
-		return -1;
+	p += 32;
+	gz_free_points (gz);
+	for (i = 0; i < n; i++) {
+		if (end - p < 24) {
+			break;
+		}
+		ut64 out = r_read_le64 (p);
+		ut64 in = r_read_le64 (p + 8);
+		int bits = r_read_le32 (p + 16) & 7;
+		ut32 wlen = r_read_le32 (p + 20);
+		p += 24;
+		if (wlen > end - p || in > gz->insize || out > size || (bits && !in)) {
+			break;
+		}
+		// the first checkpoint is the start of the stream, and the spans
+		// between them must be short enough to be inflated in memory
+		if (i? (out <= gz->points[i - 1].out || out - gz->points[i - 1].out > GZ_SPAN_MAX)
+				: (out || in || bits || wlen)) {
+			break;
+		}
+		if (!gz_add_point (gz, in, out, bits, NULL, 0)) {
+			break;
+		}
+		if (wlen) {
+			GzPoint *gp = &gz->points[i];
+			gp->window = malloc (wlen);
+			if (!gp->window) {
+				break;
+			}
+			memcpy (gp->window, p, wlen);
+			gp->wlen = wlen;
+			p += wlen;
+		}
 	}
-	memcpy (new_buf, _io_malloc_buf (fd), R_MIN (count, mallocsz));
-	if (count > mallocsz) {
-		memset (new_buf + mallocsz, 0, count - mallocsz);
+	free (data);
+	if (i != n || !n || size - gz->points[n - 1].out > GZ_SPAN_MAX) {
+		gz_free_points (gz);
+		return false;
 	}
-	free (_io_malloc_buf (fd));
-	_io_malloc_set_buf (fd, new_buf);
-	_io_malloc_set_sz (fd, count);
+	gz->size = size;
 	return true;
 }
 
@@ -109,48 +459,118 @@ static int __read(RIO *io, RIODesc *fd, ut8 *buf, int count) {
 	if (!fd || !fd->data) {
 		return -1;
 	}
-	ut32 mallocsz = _io_malloc_sz (fd);
-	if (_io_malloc_off (fd) > mallocsz) {
+	RIOGzip *gz = fd->data;
+	if (gz->offset > gz->size) {
 		return -1;
 	}
-	if (_io_malloc_off (fd) + count >= mallocsz) {
-		count = mallocsz - _io_malloc_off (fd);
+	if (gz->offset + count >= gz->size) {
+		count = gz->size - gz->offset;
+	}
+	int done = 0;
+	while (done < count) {
+		ut64 off = gz->offset + done;
+		int i = gz_find_point (gz, off);
+		GzSpan *s = gz_span (gz, i);
+		if (!s) {
+			break;
+		}
+		ut32 delta = off - gz->points[i].out;
+		int n = R_MIN (count - done, s->size - delta);
+		if (n <= 0) {
+			break;
+		}
+		memcpy (buf + done, s->data + delta, n);
+		done += n;
 	}
-	memcpy (buf, _io_malloc_buf (fd) + _io_malloc_off (fd), count);
-	return count;
+	gz->offset += done;
+	return done? done: -1;
 }
 
 static int __close(RIODesc *fd) {
-	RIOGzip *riom;
 	if (!fd || !fd->data) {
 		return -1;
 	}
-	riom = fd->data;
-	R_FREE (riom->buf);
+	RIOGzip *gz = fd->data;
+	gz_cache_flush (gz);
+	gz_free_points (gz);
+	close (gz->fd);
 	R_FREE (fd->data);
-	eprintf ("TODO: Writing changes into gzipped files is not yet supported\n");
 	return 0;
 }
 
 static ut64 __lseek(RIO* io, RIODesc *fd, ut64 offset, int whence) {
-	ut64 r_offset = offset;
 	if (!fd || !fd->data) {
 		return offset;
 	}
-	ut32 mallocsz = _io_malloc_sz (fd);
+	RIOGzip *gz = fd->data;
 	switch (whence) {
 	case SEEK_SET:
-		r_offset = (offset <= mallocsz) ? offset : mallocsz;
+		gz->offset = R_MIN (offset, gz->size);
 		break;
 	case SEEK_CUR:
-		r_offset = (_io_malloc_off (fd) + offset <= mallocsz ) ? _io_malloc_off (fd) + offset : mallocsz;
+		gz->offset = R_MIN (gz->offset + offset, gz->size);
 		break;
 	case SEEK_END:
-		r_offset = _io_malloc_sz (fd);
+		gz->offset = gz->size;
 		break;
 	}
-	_io_malloc_set_off (fd, r_offset);
-	return r_offset;
+	return gz->offset;
+}
+
+static char *__system(RIO *io, RIODesc *fd, const char *cmd) {
+	if (!fd || !fd->data) {
+		return NULL;
+	}
+	RIOGzip *gz = fd->data;
+	const char *file = fd->uri + 7;
+	if (r_str_startswith (cmd, "save") || r_str_startswith (cmd, "load")) {
+		const char *arg = r_str_trim_ro (cmd + 4);
+		char *path = *arg? strdup (arg): r_str_newf ("%s"GZ_INDEX_EXT, file);
+		bool ok;
+		if (*cmd == 's') {
+			ok = gz_index_save (gz, path);
+		} else {
+			gz_cache_flush (gz);
+			ok = gz_index_load (gz, path);
+			if (!ok && !gz->npoints) {
+				// a broken index was half loaded
+				gz_build_index (gz);
+			}
+		}
+		char *res = ok? NULL: r_str_newf ("Cannot %s index %s", *cmd == 's'? "save": "load", path);
+		free (path);
+		return res;
+	}
+	if (!strcmp (cmd, "stats")) {
+		ut64 wsize = 0;
+		int i, cached = 0;
+		for (i = 0; i < gz->npoints; i++) {
+			wsize += gz->points[i].wlen;
+		}
+		for (i = 0; i < GZ_CACHE; i++) {
+			cached += gz->cache[i].data? 1: 0;
+		}
+		return r_str_newf ("size: %"PFMT64u"\ncompressed: %"PFMT64u"\n"
+			"checkpoints: %d (%"PFMT64u" bytes)\nindex time: %"PFMT64u"us\n"
+			"cached spans: %d/%d\nhits: %"PFMT64u"\nmisses: %"PFMT64u"\n"
+			"inflated: %"PFMT64u"\ninflate time: %"PFMT64u"us",
+			gz->size, gz->insize, gz->npoints, wsize, gz->index_time,
+			cached, GZ_CACHE, gz->hits, gz->misses, gz->inflated, gz->inflate_time);
+	}
+	if (!strcmp (cmd, "index")) {
+		RStrBuf *sb = r_strbuf_new ("");
+		int i;
+		for (i = 0; i < gz->npoints; i++) {
+			GzPoint *p = &gz->points[i];
+			r_strbuf_appendf (sb, "0x%08"PFMT64x" 0x%08"PFMT64x" %d %d\n", p->out, p->in, p->bits, p->wlen);
+		}
+		return r_strbuf_drain (sb);
+	}
+	return strdup ("Usage: =!cmd args\n"
+		" =!stats          show the index and cache statistics\n"
+		" =!index          list the checkpoints (out, in, bits, window size)\n"
+		" =!save [file]    save the index (default is <file>"GZ_INDEX_EXT")\n"
+		" =!load [file]    load the index");
 }
 
 static bool __plugin_open(RIO *io, const char *pathname, bool many) {
@@ -158,28 +578,51 @@ static bool __plugin_open(RIO *io, const char *pathname, bool many) {
 }
 
 static RIODesc *__open(RIO *io, const char *pathname, int rw, int mode) {
-	if (__plugin_open (io, pathname, 0)) {
-		RIOGzip *mal = R_NEW0 (RIOGzip);
-		if (!mal) {
-			return NULL;
-		}
-		int len;
-		ut8 *data = (ut8*)r_file_slurp (pathname+7, &len);	//memleak here?
-		int *size = (int*)&mal->size;
-		mal->buf = r_inflate (data, len, NULL, size);
-		if (mal->buf) {
-			return r_io_desc_new (io, &r_io_plugin_gzip, pathname, rw, mode, mal);
-		}
-		free (data);
-		eprintf ("Cannot allocate (%s) %d byte(s)\n", pathname+9, mal->size);
-		free (mal);
+	if (!__plugin_open (io, pathname, 0)) {
+		return NULL;
+	}
+	const char *file = pathname + 7;
+	RIOGzip *gz = R_NEW0 (RIOGzip);
+	if (!gz) {
+		return NULL;
+	}
+	gz->fd = r_sandbox_open (file, O_BINARY | O_RDONLY, 0);
+	if (gz->fd == -1) {
+		eprintf ("Cannot open %s\n", file);
+		free (gz);
+		return NULL;
+	}
+	st64 insize = lseek (gz->fd, 0, SEEK_END);
+	ut8 magic[2] = {0};
+	gz->insize = insize > 0? insize: 0;
+	gz_read_at (gz, 0, magic, 2);
+	gz->gzip = magic[0] == 0x1f && magic[1] == 0x8b;
+	if (gz->insize >= 8) {
+		gz_read_at (gz, gz->insize - 8, gz->trailer, 8);
+	}
+	char *index = r_str_newf ("%s"GZ_INDEX_EXT, file);
+	ut64 t = gz_now ();
+	bool ok = r_file_exists (index) && gz_index_load (gz, index);
+	if (!ok) {
+		gz_free_points (gz);
+		ok = gz_build_index (gz);
+	}
+	gz->index_time = gz_now () - t;
+	free (index);
+	if (!ok) {
+		eprintf ("Cannot inflate %s\n", file);
+		gz_free_points (gz);
+		close (gz->fd);
+		free (gz);
+		return NULL;
 	}
-	return NULL;
+	// the compressed file is never written, changes can go to the io cache
+	return r_io_desc_new (io, &r_io_plugin_gzip, pathname, R_PERM_R | (rw & R_PERM_X), mode, gz);
 }
 
 RIOPlugin r_io_plugin_gzip = {
 	.name = "gzip",
-	.desc = "Read/write gzipped files",
+	.desc = "Read gzipped files with random access",
 	.license = "LGPL3",
 	.uris = "gzip://",
 	.open = __open,
@@ -187,8 +630,7 @@ RIOPlugin r_io_plugin_gzip = {
 	.read = __read,
 	.check = __plugin_open,
 	.lseek = __lseek,
-	.write = __write,
-	.resize = __resize,
+	.system = __system,
 };
 
 #ifndef CORELIB
@@ -95,6 +95,7 @@ static int rabin_show_help(int v) {
 		" RABIN2_STRFILTER: e bin.strfilter    # r2 -qe bin.strfilter=? -c '' --\n"
 		" RABIN2_STRPURGE:  e bin.strpurge     # try to purge false positives\n"
 		" RABIN2_DEBASE64:  e bin.debase64     # try to debase64 all strings\n"
+		" RABIN2_CACHE:     e bin.cache        # keep the parsed items in dir.bincache\n"
 		" RABIN2_DMNGLRCMD: e bin.demanglercmd # try to purge false positives\n"
 		" RABIN2_PDBSERVER: e pdb.server       # use alternative PDB server\n"
 		" RABIN2_SYMSTORE:  e pdb.symstore     # path to downstream symbol store\n"
@@ -618,6 +619,10 @@ R_API int r_main_rabin2(int argc, char **argv) {
 		r_config_set (core.config, "bin.debase64", tmp);
 		free (tmp);
 	}
+	if ((tmp = r_sys_getenv ("RABIN2_CACHE"))) {
+		r_config_set (core.config, "bin.cache", tmp);
+		free (tmp);
+	}
 	if ((tmp = r_sys_getenv ("RABIN2_PDBSERVER"))) {
 		r_config_set (core.config, "pdb.server", tmp);
 		free (tmp);
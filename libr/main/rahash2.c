@@ -14,6 +14,8 @@ static ut64 to = 0LL;
 static int incremental = 1;
 static int iterations = 0;
 static int quiet = 0;
+static int nthreads = 0;
+static int treehash = 0;
 static RHashSeed s = {
 	0
 }, *_s = NULL;
@@ -125,7 +127,7 @@ static int do_hash_internal(RHash *ctx, ut64 hash, const ut8 *buf, int len, int
 	if (len < 0) {
 		return 0;
 	}
-	int dlen = r_hash_calculate (ctx, hash, buf, len);
+	int dlen = r_hash_calculate_threads (ctx, hash, buf, len, nthreads);
 	if (!print) {
 		return 1;
 	}
@@ -136,8 +138,181 @@ static int do_hash_internal(RHash *ctx, ut64 hash, const ut8 *buf, int len, int
 	return 1;
 }
 
+// bytes read at once when hashing blocks
+#define HASH_BATCH (16 * 1024 * 1024)
+// default leaf size of the tree hashes
+#define HASH_TREE_LEAF (1024 * 1024)
+// streaming digests that can be computed as a tree of leaf digests
+#define HASH_TREE_ALGOS (R_HASH_MD4 | R_HASH_MD5 | R_HASH_SHA1 | R_HASH_SHA256 | R_HASH_SHA384 | R_HASH_SHA512)
+
+static ut64 hash_usecs(void) {
+	ut64 now = r_sys_now ();
+	return (now >> 20) * 1000000 + (now & 0xfffff);
+}
+
+typedef struct {
+	RIO *io;
+	ut64 at;
+	int len;
+	const ut8 *data;
+	ut8 *buf;
+} HashBatch;
+
+static void hash_batch_read(HashBatch *b) {
+	b->data = r_io_peek (b->io, b->at, b->len);
+	if (!b->data) {
+		r_io_pread_at (b->io, b->at, b->buf, b->len);
+		b->data = b->buf;
+	}
+}
+
+static RThreadFunctionRet hash_batch_th(RThread *th) {
+	hash_batch_read (th->user);
+	return R_TH_STOP;
+}
+
+// Print the digest of every bsize block in [f, t). The next batch of blocks
+// is read in the background while the workers hash the current one.
+static void do_hash_blocks(RIO *io, RHash *ctx, ut64 hashbit, ut64 f, ut64 t, ut64 fsize, int bsize, int rad, int ule, bool *first) {
+	int i, nb = R_MAX (1, HASH_BATCH / bsize);
+	RHashBlock *out = R_NEWS0 (RHashBlock, nb);
+	HashBatch batch[2] = {
+		{ io, f, 0, NULL, malloc ((size_t)nb * bsize) },
+		{ io, f, 0, NULL, malloc ((size_t)nb * bsize) },
+	};
+	if (!out || !batch[0].buf || !batch[1].buf) {
+		eprintf ("rahash2: Cannot allocate %d blocks\n", nb);
+		goto beach;
+	}
+	t = R_MIN (t, fsize);
+	if (f >= t) {
+		goto beach;
+	}
+	HashBatch *cur = &batch[0], *next = &batch[1];
+	cur->len = R_MIN ((ut64)nb * bsize, fsize - f);
+	hash_batch_read (cur);
+	while (cur->at < t) {
+		RThread *reader = NULL;
+		int n = R_MIN (nb, (t - cur->at + bsize - 1) / bsize);
+		ut64 end = cur->at + (ut64)n * bsize;
+		next->at = end;
+		if (end < t) {
+			next->len = R_MIN ((ut64)nb * bsize, fsize - end);
+			if (nthreads > 1) {
+				reader = r_th_new (hash_batch_th, next, 0);
+			}
+		}
+		r_hash_calculate_blocks (hashbit, cur->data, R_MIN (cur->len, (ut64)n * bsize), bsize, out, nthreads);
+		int dlen = r_hash_size (hashbit);
+		for (i = 0; i < n; i++) {
+			from = cur->at + (ut64)i * bsize;
+			to = R_MIN (from + bsize, fsize);
+			memcpy (ctx->digest, out[i].digest, dlen);
+			ctx->entropy = out[i].entropy;
+			if (iterations > 0) {
+				r_hash_do_spice (ctx, hashbit, iterations, _s);
+			}
+			if (rad == 'j') {
+				if (*first) {
+					*first = false;
+				} else {
+					printf (",");
+				}
+			}
+			do_hash_print (ctx, hashbit, dlen, rad, ule);
+		}
+		if (reader) {
+			r_th_wait (reader);
+			r_th_free (reader);
+		} else if (end < t) {
+			hash_batch_read (next);
+		}
+		HashBatch *tmp = cur;
+		cur = next;
+		next = tmp;
+	}
+beach:
+	free (batch[0].buf);
+	free (batch[1].buf);
+	free (out);
+}
+
+typedef struct {
+	RHash *ctx;
+	ut64 hashbit;
+	RIO *io;         // NULL when the whole range is in data
+	const ut8 *data;
+	ut8 *buf;
+	int bsize;       // also the leaf size of tree hashes
+	int nthreads;    // workers left for splitting each block
+} HashAlgo;
+
+// -M: the digest of the concatenated digests of every bsize leaf of the
+// range, the leaves of each batch are hashed on several threads
+static void hash_tree(HashAlgo *ha) {
+	int i, dlen = r_hash_size (ha->hashbit);
+	int nb = R_MAX (1, HASH_BATCH / ha->bsize);
+	ut64 j, batch = (ut64)nb * ha->bsize;
+	RHashBlock *out = R_NEWS0 (RHashBlock, nb);
+	ut8 *buf = ha->io? malloc (batch): NULL;
+	if (!out || (ha->io && !buf)) {
+		eprintf ("rahash2: Cannot allocate %d leaves\n", nb);
+		goto beach;
+	}
+	for (j = from; j < to; j += batch) {
+		int len = R_MIN (batch, to - j);
+		const ut8 *data = ha->io? r_io_peek (ha->io, j, len): ha->data + (j - from);
+		if (!data) {
+			r_io_pread_at (ha->io, j, buf, len);
+			data = buf;
+		}
+		r_hash_calculate_blocks (ha->hashbit, data, len, ha->bsize, out, ha->nthreads);
+		int n = (len + ha->bsize - 1) / ha->bsize;
+		for (i = 0; i < n; i++) {
+			r_hash_calculate (ha->ctx, ha->hashbit, out[i].digest, dlen);
+		}
+	}
+beach:
+	free (buf);
+	free (out);
+}
+
+static void hash_algo(HashAlgo *ha) {
+	RHash *ctx = ha->ctx;
+	ut64 j, hashbit = ha->hashbit;
+	r_hash_do_begin (ctx, hashbit);
+	if (s.buf && s.prefix) {
+		r_hash_calculate (ctx, hashbit, s.buf, s.len);
+	}
+	if (treehash) {
+		hash_tree (ha);
+	} else {
+		for (j = from; j < to; j += ha->bsize) {
+			int len = ((j + ha->bsize) > to)? (to - j): ha->bsize;
+			const ut8 *data = ha->io? r_io_peek (ha->io, j, len): ha->data + (j - from);
+			if (!data) {
+				r_io_pread_at (ha->io, j, ha->buf, len);
+				data = ha->buf;
+			}
+			r_hash_calculate_threads (ctx, hashbit, data, len, ha->nthreads);
+		}
+	}
+	if (s.buf && !s.prefix) {
+		r_hash_calculate (ctx, hashbit, s.buf, s.len);
+	}
+	r_hash_do_end (ctx, hashbit);
+	if (iterations > 0) {
+		r_hash_do_spice (ctx, hashbit, iterations, _s);
+	}
+}
+
+static RThreadFunctionRet hash_algo_th(RThread *th) {
+	hash_algo (th->user);
+	return R_TH_STOP;
+}
+
 static int do_hash(const char *file, const char *algo, RIO *io, int bsize, int rad, int ule, const ut8 *compare) {
-	ut64 j, fsize, algobit = r_hash_name_to_bits (algo);
+	ut64 fsize, algobit = r_hash_name_to_bits (algo);
 	RHash *ctx;
 	ut8 *buf;
 	int ret = 0;
@@ -169,8 +344,8 @@ static int do_hash(const char *file, const char *algo, RIO *io, int bsize, int r
 		eprintf ("rahash2: Unknown file size\n");
 		return 1;
 	}
-	buf = calloc (1, bsize + 1);
-	if (!buf) {
+	if (treehash && (algobit & ~HASH_TREE_ALGOS)) {
+		eprintf ("rahash2: Tree hashes (-M) only work with md4, md5, sha1, sha256, sha384 and sha512\n");
 		return 1;
 	}
 	ctx = r_hash_new (true, algobit);
@@ -179,46 +354,63 @@ static int do_hash(const char *file, const char *algo, RIO *io, int bsize, int r
 		printf ("[");
 	}
 	if (incremental) {
+		HashAlgo algos[R_HASH_NBITS] = {{0}};
+		RThread *ths[R_HASH_NBITS] = {0};
+		int n, nalgos = 0;
+		// the whole range is needed in memory to run the algorithms at once
+		const ut8 *data = (nthreads > 1 && (algobit & (algobit - 1)))
+			? r_io_peek (io, from, to - from): NULL;
+		buf = data? NULL: calloc (1, bsize + 1);
+		if (!data && !buf) {
+			r_hash_free (ctx);
+			return 1;
+		}
 		for (i = 1; i < R_HASH_ALL; i <<= 1) {
 			if (algobit & i) {
-				ut64 hashbit = i & algobit;
-				int dlen = r_hash_size (hashbit);
-				r_hash_do_begin (ctx, i);
-				if (s.buf && s.prefix) {
-					do_hash_internal (ctx, hashbit, s.buf, s.len, rad, 0, ule);
-				}
-				for (j = from; j < to; j += bsize) {
-					int len = ((j + bsize) > to)? (to - j): bsize;
-					r_io_pread_at (io, j, buf, len);
-					do_hash_internal (ctx, hashbit, buf, len, rad, 0, ule);
-				}
-				if (s.buf && !s.prefix) {
-					do_hash_internal (ctx, hashbit, s.buf, s.len, rad, 0, ule);
-				}
-				r_hash_do_end (ctx, i);
-				if (iterations > 0) {
-					r_hash_do_spice (ctx, i, iterations, _s);
+				HashAlgo *ha = &algos[nalgos++];
+				ha->ctx = r_hash_new (true, i);
+				ha->hashbit = i;
+				ha->io = data? NULL: io;
+				ha->data = data;
+				ha->buf = buf;
+				ha->bsize = bsize;
+				ha->nthreads = data? 1: nthreads;
+				if (data && nalgos <= nthreads) {
+					ths[nalgos - 1] = r_th_new (hash_algo_th, ha, 0);
 				}
-				if (!*r_hash_name (i)) {
-					continue;
-				}
-				if (rad == 'j') {
-					if (first) {
-						first = false;
-					} else {
-						printf (",");
-					}
-				}
-				if (!quiet && rad != 'j') {
-					printf ("%s: ", file);
-				}
-				do_hash_print (ctx, i, dlen, quiet? 'n': rad, ule);
-				if (quiet == 1) {
-					printf (" %s\n", file);
+			}
+		}
+		for (n = 0; n < nalgos; n++) {
+			HashAlgo *ha = &algos[n];
+			if (ths[n]) {
+				r_th_wait (ths[n]);
+				r_th_free (ths[n]);
+			} else {
+				hash_algo (ha);
+			}
+			i = ha->hashbit;
+			memcpy (ctx, ha->ctx, sizeof (RHash));
+			r_hash_free (ha->ctx);
+			int dlen = r_hash_size (i);
+			if (!*r_hash_name (i)) {
+				continue;
+			}
+			if (rad == 'j') {
+				if (first) {
+					first = false;
 				} else {
-					if (quiet && !rad) {
-						printf ("\n");
-					}
+					printf (",");
+				}
+			}
+			if (!quiet && rad != 'j') {
+				printf ("%s: ", file);
+			}
+			do_hash_print (ctx, i, dlen, quiet? 'n': rad, ule);
+			if (quiet == 1) {
+				printf (" %s\n", file);
+			} else {
+				if (quiet && !rad) {
+					printf ("\n");
 				}
 			}
 		}
@@ -226,29 +418,15 @@ static int do_hash(const char *file, const char *algo, RIO *io, int bsize, int r
 			free (_s->buf);
 		}
 	} else {
+		buf = NULL;
 		/* iterate over all algorithm bits */
 		if (s.buf) {
 			eprintf ("Warning: Seed ignored on per-block hashing.\n");
 		}
 		for (i = 1; i < R_HASH_ALL; i <<= 1) {
-			ut64 f, t, ofrom, oto;
 			if (algobit & i) {
-				ut64 hashbit = i & algobit;
-				ofrom = from;
-				oto = to;
-				f = from;
-				t = to;
-				for (j = f; j < t; j += bsize) {
-					int nsize = (j + bsize < fsize)? bsize: (fsize - j);
-					r_io_pread_at (io, j, buf, bsize);
-					from = j;
-					to = j + bsize;
-					if (to > fsize) {
-						to = fsize;
-					}
-					do_hash_internal (ctx, hashbit, buf, nsize, rad, 0, ule);
-				}
-				do_hash_internal (ctx, hashbit, NULL, 0, rad, 1, ule);
+				ut64 ofrom = from, oto = to;
+				do_hash_blocks (io, ctx, i & algobit, from, to, fsize, bsize, rad, ule, &first);
 				from = ofrom;
 				to = oto;
 			}
@@ -264,8 +442,106 @@ static int do_hash(const char *file, const char *algo, RIO *io, int bsize, int r
 	return ret;
 }
 
+static double bench_gbps(ut64 size, ut64 usecs) {
+	return size / (R_MAX (usecs, 1) * 1000.0);
+}
+
+// -P: hash size bytes of generated data in memory with each algorithm, on
+// one thread, split across the threads when the algorithm allows it, as
+// bsize blocks and as a tree of bsize leaves, and show the GB/s of each
+static int do_bench(const char *algo, ut64 size, int bsize, int rad) {
+	ut64 i, j, algobit = r_hash_name_to_bits (algo);
+	bool first = true;
+	if (algobit == R_HASH_NONE) {
+		eprintf ("rahash2: Invalid hashing algorithm specified\n");
+		return 1;
+	}
+	if (size < 1 || size > ST32_MAX) {
+		eprintf ("rahash2: Invalid benchmark size\n");
+		return 1;
+	}
+	if (bsize < 1 || bsize > size) {
+		bsize = R_MIN (HASH_TREE_LEAF, size);
+	}
+	ut8 *buf = malloc (size);
+	RHashBlock *out = R_NEWS0 (RHashBlock, (size + bsize - 1) / bsize);
+	if (!buf || !out) {
+		eprintf ("rahash2: Cannot allocate %"PFMT64u" bytes\n", size);
+		free (buf);
+		free (out);
+		return 1;
+	}
+	ut32 x = 0x2545f491;
+	for (j = 0; j < size; j++) {
+		x ^= x << 13;
+		x ^= x >> 17;
+		x ^= x << 5;
+		buf[j] = x;
+	}
+	if (rad == 'j') {
+		printf ("[");
+	} else {
+		printf ("%"PFMT64u" bytes, %d threads, %d bytes blocks (GB/s)\n", size, nthreads, bsize);
+		printf ("%-12s %10s %10s %10s %10s\n", "algo", "serial", "threads", "blocks", "tree");
+	}
+	for (i = 1; i < R_HASH_ALL; i <<= 1) {
+		if (!(algobit & i) || !*r_hash_name (i)) {
+			continue;
+		}
+		RHash *ctx = r_hash_new (true, i);
+		if (!ctx) {
+			break;
+		}
+		double gbps[4] = {0};
+		int k;
+		for (k = 0; k < 2; k++) {
+			ut64 t = hash_usecs ();
+			r_hash_do_begin (ctx, i);
+			r_hash_calculate_threads (ctx, i, buf, size, k? nthreads: 1);
+			r_hash_do_end (ctx, i);
+			gbps[k] = bench_gbps (size, hash_usecs () - t);
+		}
+		ut64 t = hash_usecs ();
+		r_hash_calculate_blocks (i, buf, size, bsize, out, nthreads);
+		gbps[2] = bench_gbps (size, hash_usecs () - t);
+		if (i & HASH_TREE_ALGOS) {
+			HashAlgo ha = { ctx, i, NULL, buf, NULL, bsize, nthreads };
+			from = 0;
+			to = size;
+			t = hash_usecs ();
+			r_hash_do_begin (ctx, i);
+			hash_tree (&ha);
+			r_hash_do_end (ctx, i);
+			gbps[3] = bench_gbps (size, hash_usecs () - t);
+		}
+		r_hash_free (ctx);
+		if (rad == 'j') {
+			printf ("%s{\"name\":\"%s\",\"serial\":%.3f,\"threads\":%.3f,\"blocks\":%.3f",
+				first? "": ",", r_hash_name (i), gbps[0], gbps[1], gbps[2]);
+			if (gbps[3] > 0) {
+				printf (",\"tree\":%.3f", gbps[3]);
+			}
+			printf ("}");
+			first = false;
+		} else {
+			printf ("%-12s %10.3f %10.3f %10.3f", r_hash_name (i), gbps[0], gbps[1], gbps[2]);
+			if (gbps[3] > 0) {
+				printf (" %10.3f\n", gbps[3]);
+			} else {
+				printf (" %10s\n", "-");
+			}
+		}
+	}
+	if (rad == 'j') {
+		printf ("]\n");
+	}
+	free (buf);
+	free (out);
+	return 0;
+}
+
 static int do_help(int line) {
-	printf ("Usage: rahash2 [-rBhLkv] [-b S] [-a A] [-c H] [-E A] [-s S] [-f O] [-t O] [file] ...\n");
+	printf ("Usage: rahash2 [-rBhLkMv] [-b S] [-a A] [-c H] [-E A] [-s S] [-f O] [-t O] [-T N] [-P S] [file] ...\n");
 	if (line) {
 		return 0;
 	}
@@ -285,9 +561,13 @@ static int do_help(int line) {
 		" -k          show hash using the openssh's randomkey algorithm\n"
 		" -q          run in quiet mode (-qq to show only the hash)\n"
 		" -L          list all available algorithms (see -a)\n"
+		" -M          tree hash: digest of the digests of every -b leaf (1M by default), leaves are\n"
+		"             hashed in parallel (md4, md5 and sha only, does not match the plain digest)\n"
+		" -P size     benchmark hashing size bytes of random data in memory and show the GB/s\n"
 		" -r          output radare commands\n"
 		" -s string   hash this string instead of files\n"
 		" -t to       stop hashing at given address\n"
+		" -T threads  number of threads used to hash (default is the number of cpus)\n"
 		" -x hexstr   hash this hexpair string instead of files\n"
 		" -v          show version information\n");
 	return 0;
@@ -419,6 +699,7 @@ static int encrypt_or_decrypt_file(const char *algo, int direction, char *filena
 int r_main_rahash2(int argc, char **argv) {
 	ut64 i;
 	int ret, c, rad = 0, bsize = 0, numblocks = 0, ule = 0;
+	ut64 benchsize = 0;
 	const char *algo = "sha256"; /* default hashing algorithm */
 	const char *seed = NULL;
 	const char *decrypt = NULL;
@@ -437,7 +718,7 @@ int r_main_rahash2(int argc, char **argv) {
 	RHash *ctx;
 	RIO *io;
 
-	while ((c = r_getopt (argc, argv, "p:jD:rveE:a:i:I:S:s:x:b:nBhf:t:kLqc:")) != -1) {
+	while ((c = r_getopt (argc, argv, "p:jD:rveE:a:i:I:S:s:x:b:nBhf:t:T:kLMP:qc:")) != -1) {
 		switch (c) {
 		case 'q': quiet++; break;
 		case 'i':
@@ -460,7 +741,10 @@ int r_main_rahash2(int argc, char **argv) {
 		case 'p': ptype = r_optarg; break;
 		case 'a': algo = r_optarg; break;
 		case 'B': incremental = 0; break;
+		case 'M': treehash = 1; break;
+		case 'P': benchsize = r_num_math (NULL, r_optarg); break;
 		case 'b': bsize = (int) r_num_math (NULL, r_optarg); break;
+		case 'T': nthreads = (int) r_num_math (NULL, r_optarg); break;
 		case 'f': from = r_num_math (NULL, r_optarg); break;
 		case 't': to = 1 + r_num_math (NULL, r_optarg); break;
 		case 'v': return r_main_version ("rahash2");
@@ -471,6 +755,21 @@ int r_main_rahash2(int argc, char **argv) {
 		default: return do_help (0);
 		}
 	}
+	if (nthreads < 1) {
+		nthreads = r_th_ncpus ();
+	}
+	if (benchsize) {
+		return do_bench (algo, benchsize, bsize, rad);
+	}
+	if (treehash) {
+		if (!incremental) {
+			eprintf ("rahash2: Option -M is incompatible with -B.\n");
+			return 1;
+		}
+		if (!bsize) {
+			bsize = HASH_TREE_LEAF;
+		}
+	}
 	if (encrypt && decrypt) {
 		eprintf ("rahash2: Option -E and -D are incompatible with each other.\n");
 		return 1;
@@ -0,0 +1,304 @@
+/* radare - LGPL - Copyright 2026 - agent */
+
+#include <r_search.h>
+#include <ctype.h>
+#include <sdb/ht_uu.h>
+#include "search_private.h"
+
+// Aho-Corasick automaton used as a filter for keyword searches with many
+// keywords. Every keyword contributes its longest run of unmasked bytes
+// (its anchor) to the trie, and each anchor match is reported as a
+// candidate start that the caller verifies with the exact matcher. This
+// keeps binmask and icase keywords exact without growing the alphabet.
+
+#define AC_ANCHOR_MAX 32
+// the shallowest nodes get a full transition row, it is where the scan
+// spends most of its time and it avoids walking failure links there
+#define AC_DENSE_MAX 512
+
+typedef struct r_search_ac_pat_t {
+	int kw;
+	int off; /* anchor offset inside the keyword */
+	int len; /* anchor length */
+	int next; /* next pattern ending at the same node */
+} RSearchACPat;
+
+typedef struct {
+	int from;
+	int to;
+	ut8 ch;
+} ACEdge;
+
+static bool kw_anchor(RSearchKeyword *kw, int *off, int *len) {
+	int j, run = 0, best = 0, best_off = 0;
+	for (j = 0; j < kw->keyword_length; j++) {
+		ut8 m = kw->binmask_length > 0? kw->bin_binmask[j % kw->binmask_length]: 0xff;
+		if (m == 0xff) {
+			run++;
+			if (run > best) {
+				best = run;
+				best_off = j - run + 1;
+			}
+		} else {
+			run = 0;
+		}
+	}
+	*off = best_off;
+	*len = R_MIN (best, AC_ANCHOR_MAX);
+	return best > 0;
+}
+
+static int edge_cmp(const void *a, const void *b) {
+	const ACEdge *x = a, *y = b;
+	if (x->from != y->from) {
+		return x->from < y->from? -1: 1;
+	}
+	return (int)x->ch - (int)y->ch;
+}
+
+static int cand_cmp(const void *a, const void *b) {
+	const RSearchACCand *x = a, *y = b;
+	if (x->kw != y->kw) {
+		return x->kw < y->kw? -1: 1;
+	}
+	return x->pos < y->pos? -1: x->pos > y->pos;
+}
+
+static inline int ac_goto(const RSearchAC *ac, int node, ut8 ch) {
+	if (!node) {
+		return ac->root[ch];
+	}
+	int lo = ac->edges[node], hi = lo + ac->nedges[node];
+	if (hi - lo <= 8) {
+		for (; lo < hi; lo++) {
+			if (ac->edge_byte[lo] == ch) {
+				return ac->edge_to[lo];
+			}
+		}
+		return -1;
+	}
+	while (lo < hi) {
+		int mid = (lo + hi) / 2;
+		if (ac->edge_byte[mid] < ch) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+	return (lo < ac->edges[node] + ac->nedges[node] && ac->edge_byte[lo] == ch)? ac->edge_to[lo]: -1;
+}
+
+static bool ac_build_dense(RSearchAC *ac, const int *order) {
+	int i, c, ndense = R_MIN (ac->nodes, AC_DENSE_MAX);
+	ac->dense = malloc (sizeof (int) * 256 * ndense);
+	ac->dense_idx = malloc (sizeof (int) * ac->nodes);
+	if (!ac->dense || !ac->dense_idx) {
+		return false;
+	}
+	memset (ac->dense_idx, 0xff, sizeof (int) * ac->nodes);
+	// BFS order puts every failure link target before the node itself
+	for (i = 0; i < ndense; i++) {
+		int u = order[i];
+		int *row = ac->dense + i * 256;
+		ac->dense_idx[u] = i;
+		for (c = 0; c < 256; c++) {
+			int v = ac_goto (ac, u, c);
+			if (v < 0) {
+				v = u? ac->dense[ac->dense_idx[ac->fail[u]] * 256 + c]: 0;
+			}
+			row[c] = v;
+		}
+	}
+	return true;
+}
+
+static bool ac_build_links(RSearchAC *ac) {
+	int *queue = malloc (sizeof (int) * ac->nodes);
+	if (!queue) {
+		return false;
+	}
+	int head = 0, tail = 0, i, c;
+	queue[tail++] = 0;
+	head++;
+	for (c = 0; c < 256; c++) {
+		int v = ac->root[c];
+		if (v > 0) {
+			ac->fail[v] = 0;
+			ac->dict[v] = 0;
+			queue[tail++] = v;
+		}
+	}
+	while (head < tail) {
+		int u = queue[head++];
+		for (i = ac->edges[u]; i < ac->edges[u] + ac->nedges[u]; i++) {
+			ut8 ch = ac->edge_byte[i];
+			int v = ac->edge_to[i];
+			int f = ac->fail[u], g;
+			while ((g = ac_goto (ac, f, ch)) < 0 && f) {
+				f = ac->fail[f];
+			}
+			ac->fail[v] = g > 0? g: 0;
+			int fv = ac->fail[v];
+			ac->dict[v] = ac->out[fv] != -1? fv: ac->dict[fv];
+			queue[tail++] = v;
+		}
+	}
+	bool ret = ac_build_dense (ac, queue);
+	free (queue);
+	return ret;
+}
+
+R_IPI void r_search_ac_free(RSearchAC *ac) {
+	if (!ac) {
+		return;
+	}
+	free (ac->root);
+	free (ac->fail);
+	free (ac->dict);
+	free (ac->out);
+	free (ac->edges);
+	free (ac->nedges);
+	free (ac->edge_byte);
+	free (ac->edge_to);
+	free (ac->dense);
+	free (ac->dense_idx);
+	free (ac->pats);
+	free (ac->anchored);
+	r_vector_clear (&ac->cands);
+	free (ac);
+}
+
+R_IPI RSearchAC *r_search_ac_new(RList *kws) {
+	RSearchKeyword *kw;
+	RListIter *iter;
+	int i, c, nkws = r_list_length (kws);
+	if (nkws < R_SEARCH_AC_MIN_KWS) {
+		return NULL;
+	}
+	RSearchAC *ac = R_NEW0 (RSearchAC);
+	if (!ac) {
+		return NULL;
+	}
+	r_vector_init (&ac->cands, sizeof (RSearchACCand), NULL, NULL);
+	bool icase = false;
+	size_t maxnodes = 1;
+	r_list_foreach (kws, iter, kw) {
+		icase |= kw->icase;
+		maxnodes += R_MIN (kw->keyword_length, AC_ANCHOR_MAX);
+	}
+	for (c = 0; c < 256; c++) {
+		ac->fold[c] = icase? tolower (c): c;
+	}
+	ac->nkws = nkws;
+	ac->pats = R_NEWS0 (RSearchACPat, nkws);
+	ac->anchored = R_NEWS0 (bool, nkws);
+	ac->root = malloc (sizeof (int) * 256);
+	ac->fail = R_NEWS0 (int, maxnodes);
+	ac->dict = R_NEWS0 (int, maxnodes);
+	ac->out = malloc (sizeof (int) * maxnodes);
+	ac->edges = R_NEWS0 (int, maxnodes);
+	ac->nedges = R_NEWS0 (int, maxnodes);
+	ACEdge *edges = malloc (sizeof (ACEdge) * maxnodes);
+	HtUU *trie = ht_uu_new0 ();
+	if (!ac->pats || !ac->anchored || !ac->root || !ac->fail || !ac->dict
+			|| !ac->out || !ac->edges || !ac->nedges || !edges || !trie) {
+		goto fail;
+	}
+	memset (ac->out, 0xff, sizeof (int) * maxnodes);
+	int nedges = 0;
+	ac->nodes = 1;
+	i = 0;
+	r_list_foreach (kws, iter, kw) {
+		RSearchACPat *pat = &ac->pats[i];
+		pat->kw = i;
+		pat->next = -1;
+		if (kw_anchor (kw, &pat->off, &pat->len)) {
+			int j, node = 0;
+			for (j = 0; j < pat->len; j++) {
+				ut8 ch = ac->fold[kw->bin_keyword[pat->off + j]];
+				ut64 key = ((ut64)node << 8) | ch;
+				bool found;
+				int next = (int)ht_uu_find (trie, key, &found);
+				if (!found) {
+					next = ac->nodes++;
+					ht_uu_insert (trie, key, next);
+					edges[nedges++] = (ACEdge){ node, next, ch };
+				}
+				node = next;
+			}
+			pat->next = ac->out[node];
+			ac->out[node] = i;
+			ac->anchored[i] = true;
+			ac->npats++;
+		}
+		i++;
+	}
+	ht_uu_free (trie);
+	trie = NULL;
+	qsort (edges, nedges, sizeof (ACEdge), edge_cmp);
+	ac->edge_byte = malloc (R_MAX (nedges, 1));
+	ac->edge_to = malloc (sizeof (int) * R_MAX (nedges, 1));
+	if (!ac->edge_byte || !ac->edge_to) {
+		goto fail;
+	}
+	memset (ac->root, 0xff, sizeof (int) * 256);
+	for (i = 0; i < nedges; i++) {
+		const ACEdge *e = &edges[i];
+		if (!ac->nedges[e->from]++) {
+			ac->edges[e->from] = i;
+		}
+		ac->edge_byte[i] = e->ch;
+		ac->edge_to[i] = e->to;
+		if (!e->from) {
+			ac->root[e->ch] = e->to;
+		}
+	}
+	free (edges);
+	edges = NULL;
+	if (!ac_build_links (ac)) {
+		goto fail;
+	}
+	return ac;
+fail:
+	ht_uu_free (trie);
+	free (edges);
+	r_search_ac_free (ac);
+	return NULL;
+}
+
+// Scan buf and append the candidate starts of every anchor found. Positions
+// are relative to base, which allows scanning a stream in several pieces.
+R_IPI void r_search_ac_scan(RSearchAC *ac, const ut8 *buf, int len, st64 base, int *state) {
+	int i, node = *state;
+	for (i = 0; i < len; i++) {
+		const ut8 ch = ac->fold[buf[i]];
+		for (;;) {
+			int d = ac->dense_idx[node];
+			if (d >= 0) {
+				node = ac->dense[d * 256 + ch];
+				break;
+			}
+			int next = ac_goto (ac, node, ch);
+			if (next >= 0) {
+				node = next;
+				break;
+			}
+			node = ac->fail[node];
+		}
+		int n = ac->out[node] != -1? node: ac->dict[node];
+		for (; n > 0; n = ac->dict[n]) {
+			int p;
+			for (p = ac->out[n]; p != -1; p = ac->pats[p].next) {
+				const RSearchACPat *pat = &ac->pats[p];
+				RSearchACCand cand = { pat->kw, base + i - pat->len + 1 - pat->off };
+				r_vector_push (&ac->cands, &cand);
+			}
+		}
+	}
+	*state = node;
+}
+
+// group the candidates by keyword, keeping them sorted by position
+R_IPI void r_search_ac_sort(RSearchAC *ac) {
+	qsort (ac->cands.a, ac->cands.len, sizeof (RSearchACCand), cand_cmp);
+}
@@ -0,0 +1,143 @@
+/* radare - LGPL - Copyright 2026 - agent */
+
+#include <r_search.h>
+#include <ctype.h>
+#include "search_private.h"
+
+// Candidate filter for single keyword searches. The first and last bytes of
+// the keyword that can be compared (not fully masked out) are checked
+// 16 or 32 offsets at a time, and only the offsets passing both probes
+// reach the exact matcher. icase letters are compared with the case bit
+// masked out, so the filter is always a superset of the real matches.
+
+#if (__x86_64__ || __i386__) && (__GNUC__ >= 5 || __clang__)
+#define FILTER_X86 1
+#include <immintrin.h>
+#endif
+
+typedef int (*RSearchFilterNext)(const RSearchFilter *f, const ut8 *buf, int len, int i);
+
+R_IPI bool r_search_filter_init(RSearchFilter *f, RSearchKeyword *kw) {
+	int j, first = -1, last = -1;
+	ut8 m[2] = {0}, v[2] = {0};
+	if (kw->icase && kw->binmask_length > 0) {
+		return false;
+	}
+	for (j = 0; j < kw->keyword_length; j++) {
+		ut8 b = kw->bin_keyword[j];
+		ut8 mask = kw->binmask_length > 0? kw->bin_binmask[j % kw->binmask_length]: 0xff;
+		if (kw->icase && isalpha (b)) {
+			mask &= 0xdf;
+		}
+		if (!mask) {
+			continue;
+		}
+		if (first < 0) {
+			first = j;
+			m[0] = mask;
+			v[0] = b & mask;
+		}
+		last = j;
+		m[1] = mask;
+		v[1] = b & mask;
+	}
+	if (first < 0) {
+		return false;
+	}
+	f->len = kw->keyword_length;
+	f->off = first;
+	f->d = last - first;
+	f->m0 = m[0];
+	f->v0 = v[0];
+	f->m1 = m[1];
+	f->v1 = v[1];
+	return true;
+}
+
+static int filter_next_scalar(const RSearchFilter *f, const ut8 *buf, int len, int i) {
+	const int end = len - f->len;
+	const ut8 *p0 = buf + f->off, *p1 = p0 + f->d;
+	if (f->m0 == 0xff) {
+		// memchr is vectorized by most libcs
+		while (i <= end) {
+			const ut8 *p = memchr (p0 + i, f->v0, end - i + 1);
+			if (!p) {
+				return -1;
+			}
+			i = p - p0;
+			if ((p1[i] & f->m1) == f->v1) {
+				return i;
+			}
+			i++;
+		}
+		return -1;
+	}
+	for (; i <= end; i++) {
+		if ((p0[i] & f->m0) == f->v0 && (p1[i] & f->m1) == f->v1) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+#if FILTER_X86
+__attribute__((target("sse2")))
+static int filter_next_sse2(const RSearchFilter *f, const ut8 *buf, int len, int i) {
+	const int end = len - f->len;
+	const ut8 *p0 = buf + f->off, *p1 = p0 + f->d;
+	const __m128i m0 = _mm_set1_epi8 ((char)f->m0), v0 = _mm_set1_epi8 ((char)f->v0);
+	const __m128i m1 = _mm_set1_epi8 ((char)f->m1), v1 = _mm_set1_epi8 ((char)f->v1);
+	for (; i + 15 <= end; i += 16) {
+		__m128i a = _mm_loadu_si128 ((const __m128i *)(p0 + i));
+		__m128i b = _mm_loadu_si128 ((const __m128i *)(p1 + i));
+		a = _mm_cmpeq_epi8 (_mm_and_si128 (a, m0), v0);
+		b = _mm_cmpeq_epi8 (_mm_and_si128 (b, m1), v1);
+		int mask = _mm_movemask_epi8 (_mm_and_si128 (a, b));
+		if (mask) {
+			return i + __builtin_ctz (mask);
+		}
+	}
+	return filter_next_scalar (f, buf, len, i);
+}
+
+__attribute__((target("avx2")))
+static int filter_next_avx2(const RSearchFilter *f, const ut8 *buf, int len, int i) {
+	const int end = len - f->len;
+	const ut8 *p0 = buf + f->off, *p1 = p0 + f->d;
+	const __m256i m0 = _mm256_set1_epi8 ((char)f->m0), v0 = _mm256_set1_epi8 ((char)f->v0);
+	const __m256i m1 = _mm256_set1_epi8 ((char)f->m1), v1 = _mm256_set1_epi8 ((char)f->v1);
+	for (; i + 31 <= end; i += 32) {
+		__m256i a = _mm256_loadu_si256 ((const __m256i *)(p0 + i));
+		__m256i b = _mm256_loadu_si256 ((const __m256i *)(p1 + i));
+		a = _mm256_cmpeq_epi8 (_mm256_and_si256 (a, m0), v0);
+		b = _mm256_cmpeq_epi8 (_mm256_and_si256 (b, m1), v1);
+		ut32 mask = (ut32)_mm256_movemask_epi8 (_mm256_and_si256 (a, b));
+		if (mask) {
+			return i + __builtin_ctz (mask);
+		}
+	}
+	return filter_next_sse2 (f, buf, len, i);
+}
+#endif
+
+static RSearchFilterNext filter_next_pick(void) {
+#if FILTER_X86
+	__builtin_cpu_init ();
+	if (__builtin_cpu_supports ("avx2")) {
+		return filter_next_avx2;
+	}
+	if (__builtin_cpu_supports ("sse2")) {
+		return filter_next_sse2;
+	}
+#endif
+	return filter_next_scalar;
+}
+
+// Returns the first offset >= i where the keyword may start, or -1.
+R_IPI int r_search_filter_next(const RSearchFilter *f, const ut8 *buf, int len, int i) {
+	static RSearchFilterNext next = NULL;
+	if (!next) {
+		next = filter_next_pick ();
+	}
+	return next (f, buf, len, i);
+}
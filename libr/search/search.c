@@ -3,6 +3,7 @@
 #include <r_search.h>
 #include <r_list.h>
 #include <ctype.h>
+#include "search_private.h"
 
 // Experimental search engine (fails, because stops at first hit of every block read
 #define USE_BMH 0
@@ -54,6 +55,7 @@ R_API RSearch *r_search_free(RSearch *s) {
 	}
 	r_list_free (s->hits);
 	r_list_free (s->kws);
+	r_search_ac_free (s->ac);
 	//r_io_free(s->iob.io); this is suposed to be a weak reference
 	free (s->data);
 	free (s);
@@ -354,7 +356,49 @@ static bool brute_force_match(RSearch *s, RSearchKeyword *kw, const ut8 *buf, in
 	return j == kw->keyword_length;
 }
 
+// Verifies the automaton candidates of one keyword the same way the brute
+// force loops below scan every offset, so hits come out in the same order.
+static int search_kw_cands(RSearch *s, RSearchKeyword *kw, ut64 from, const ut8 *buf, int len, RSearchLeftover *left, ut64 len1, const RSearchACCand **cand, const RSearchACCand *end) {
+	const RSearchACCand *c = *cand;
+	const int klen = kw->keyword_length;
+	st64 i = s->overlap || !kw->count ? 0 :
+			s->bckwrds
+			? kw->last - from < left->len ? from + left->len - kw->last : 0
+			: from - kw->last < left->len ? kw->last + left->len - from : 0;
+	for (; c < end && c->pos < left->len; c++) {
+		if (c->pos < i || c->pos + klen > len1 || !brute_force_match (s, kw, left->data, c->pos)) {
+			continue;
+		}
+		int t = r_search_hit_new (s, kw, s->bckwrds ? from - klen - c->pos + left->len : from + c->pos - left->len);
+		if (t != 1) {
+			*cand = end;
+			return t;
+		}
+		i = s->overlap? c->pos + 1: c->pos + klen;
+	}
+	i = s->overlap || !kw->count ? 0 :
+			s->bckwrds
+			? from > kw->last ? from - kw->last : 0
+			: from < kw->last ? kw->last - from : 0;
+	for (; c < end; c++) {
+		st64 pos = c->pos - left->len;
+		if (pos < i || pos + klen > len || !brute_force_match (s, kw, buf, pos)) {
+			continue;
+		}
+		int t = r_search_hit_new (s, kw, s->bckwrds ? from - klen - pos : from + pos);
+		if (t != 1) {
+			*cand = end;
+			return t;
+		}
+		i = s->overlap? pos + 1: pos + klen;
+	}
+	*cand = end;
+	return 1;
+}
+
 // Supported search variants: backward, binmask, icase, inverse, overlap
+// With many keywords an Aho-Corasick automaton finds the candidate offsets
+// in a single pass instead of trying every keyword at every offset.
 R_API int r_search_mybinparse_update(RSearch *s, ut64 from, const ut8 *buf, int len) {
 	RSearchKeyword *kw;
 	RListIter *iter;
@@ -393,7 +437,45 @@ R_API int r_search_mybinparse_update(RSearch *s, ut64 from, const ut8 *buf, int
 
 	ut64 len1 = left->len + R_MIN (longest - 1, len);
 	memcpy (left->data + left->len, buf, len1 - left->len);
+	RSearchAC *ac = NULL;
+	if (!s->inverse && !s->distance) {
+		if (!s->ac) {
+			s->ac = r_search_ac_new (s->kws);
+		}
+		ac = s->ac;
+	}
+	const RSearchACCand *cand = NULL, *cand_end = NULL;
+	if (ac) {
+		int state = 0;
+		r_vector_clear (&ac->cands);
+		r_search_ac_scan (ac, left->data, left->len, 0, &state);
+		r_search_ac_scan (ac, buf, len, left->len, &state);
+		r_search_ac_sort (ac);
+		cand = ac->cands.a;
+		cand_end = cand + ac->cands.len;
+	}
+	int kwi = 0;
 	r_list_foreach (s->kws, iter, kw) {
+		if (ac && ac->anchored[kwi]) {
+			const RSearchACCand *end = cand;
+			while (cand < cand_end && cand->kw < kwi) {
+				cand++;
+			}
+			end = cand;
+			while (end < cand_end && end->kw == kwi) {
+				end++;
+			}
+			int t = search_kw_cands (s, kw, from, buf, len, left, len1, &cand, end);
+			if (!t) {
+				return -1;
+			}
+			if (t > 1) {
+				return s->nhits - old_nhits;
+			}
+			kwi++;
+			continue;
+		}
+		kwi++;
 		i = s->overlap || !kw->count ? 0 :
 				s->bckwrds
 				? kw->last - from < left->len ? from + left->len - kw->last : 0
@@ -416,7 +498,12 @@ R_API int r_search_mybinparse_update(RSearch *s, ut64 from, const ut8 *buf, int
 				s->bckwrds
 				? from > kw->last ? from - kw->last : 0
 				: from < kw->last ? kw->last - from : 0;
+		RSearchFilter filter;
+		const bool filtered = !s->inverse && !s->distance && r_search_filter_init (&filter, kw);
 		for (; i + kw->keyword_length <= len; i++) {
+			if (filtered && (i = r_search_filter_next (&filter, buf, len, i)) < 0) {
+				break;
+			}
 			if (brute_force_match (s, kw, buf, i) != s->inverse) {
 				int t = r_search_hit_new (s, kw, s->bckwrds ? from - kw->keyword_length - i : from + i);
 				if (!t) {
@@ -513,6 +600,8 @@ R_API int r_search_kw_add(RSearch *s, RSearchKeyword *kw) {
 	}
 	kw->kwidx = s->n_kws++;
 	r_list_append (s->kws, kw);
+	r_search_ac_free (s->ac);
+	s->ac = NULL;
 	return true;
 }
 
@@ -520,6 +609,8 @@ R_API int r_search_kw_add(RSearch *s, RSearchKeyword *kw) {
 R_API void r_search_string_prepare_backward(RSearch *s) {
 	RListIter *iter;
 	RSearchKeyword *kw;
+	r_search_ac_free (s->ac);
+	s->ac = NULL;
 	// Precondition: !kw->binmask_length || kw->keyword_length % kw->binmask_length == 0
 	r_list_foreach (s->kws, iter, kw) {
 		ut8 *i = kw->bin_keyword, *j = kw->bin_keyword + kw->keyword_length;
@@ -549,4 +640,6 @@ R_API void r_search_kw_reset(RSearch *s) {
 	r_list_purge (s->kws);
 	r_list_purge (s->hits);
 	R_FREE (s->data);
+	r_search_ac_free (s->ac);
+	s->ac = NULL;
 }
@@ -0,0 +1,51 @@
+#ifndef R_SEARCH_PRIVATE_H
+#define R_SEARCH_PRIVATE_H
+
+#include <r_search.h>
+
+/* keyword searches switch to the automaton from this many keywords on */
+#define R_SEARCH_AC_MIN_KWS 8
+
+typedef struct r_search_ac_cand_t {
+	int kw;    /* index of the keyword in s->kws */
+	st64 pos;  /* candidate start, relative to the scanned stream */
+} RSearchACCand;
+
+typedef struct r_search_ac_t {
+	int *root;      /* dense transitions of the root node */
+	int *fail;      /* failure link of each node */
+	int *dict;      /* nearest node with output through failure links */
+	int *out;       /* first pattern ending at each node, -1 if none */
+	int *edges;     /* first edge of each node */
+	int *nedges;
+	ut8 *edge_byte; /* edges sorted by byte within each node */
+	int *edge_to;
+	int *dense;     /* full transition rows of the shallowest nodes */
+	int *dense_idx; /* row of each node in dense, -1 if it has none */
+	int nodes;
+	struct r_search_ac_pat_t *pats;
+	int npats;
+	int nkws;
+	bool *anchored; /* keywords that must be brute forced have no anchor */
+	ut8 fold[256];  /* alphabet map, folds case if any keyword is icase */
+	RVector cands;  /* RSearchACCand found by the last scan */
+} RSearchAC;
+
+/* two probe bytes that every match of a keyword must have, used to skip
+ * most offsets before running the exact matcher */
+typedef struct r_search_filter_t {
+	int len;  /* keyword length */
+	int off;  /* offset of the first probe in the keyword */
+	int d;    /* distance from the first probe to the second one */
+	ut8 m0, v0, m1, v1;
+} RSearchFilter;
+
+R_IPI bool r_search_filter_init(RSearchFilter *f, RSearchKeyword *kw);
+R_IPI int r_search_filter_next(const RSearchFilter *f, const ut8 *buf, int len, int i);
+
+R_IPI RSearchAC *r_search_ac_new(RList *kws);
+R_IPI void r_search_ac_free(RSearchAC *ac);
+R_IPI void r_search_ac_scan(RSearchAC *ac, const ut8 *buf, int len, st64 base, int *state);
+R_IPI void r_search_ac_sort(RSearchAC *ac);
+
+#endif
@@ -3,54 +3,126 @@
 #include <r_socket.h>
 #include <r_util.h>
 
+#define HTTP_RBUF_SIZE 4096
+// how long a client can pause while sending the headers and body
+#define HTTP_READ_MSECS 1000
+
 static bool *breaked = NULL;
 
 R_API void r_socket_http_server_set_breaked(bool *b) {
 	breaked = b;
 }
 
-R_API RSocketHTTPRequest *r_socket_http_accept (RSocket *s, RSocketHTTPOptions *so) {
-	int content_length = 0, xx, yy;
-	int pxx = 1, first = 0;
-	char buf[1500], *p, *q;
-	RSocketHTTPRequest *hr = R_NEW0 (RSocketHTTPRequest);
-	if (!hr) {
-		return NULL;
+// wait up to msecs for the client to send something, the bytes read ahead
+// are kept in the request so pipelined requests are not lost
+static bool http_fill(RSocketHTTPRequest *hr, int msecs) {
+	if (hr->rbuf_off < hr->rbuf_len) {
+		return true;
 	}
-	if (so->accept_timeout) {
-		hr->s = r_socket_accept_timeout (s, 1);
-	} else {
-		hr->s = r_socket_accept (s);
+	if (!hr->rbuf) {
+		hr->rbuf = malloc (HTTP_RBUF_SIZE);
+		if (!hr->rbuf) {
+			return false;
+		}
 	}
-	if (!hr->s) {
-		free (hr);
-		return NULL;
+	// r_socket_ready only looks at the usecs on unix
+	if (r_socket_ready (hr->s, 0, msecs * 1000) <= 0) {
+		return false;
+	}
+	int n = r_socket_read (hr->s, hr->rbuf, HTTP_RBUF_SIZE);
+	if (n <= 0) {
+		return false;
 	}
-	if (so->timeout > 0) {
-		r_socket_block_time (hr->s, 1, so->timeout);
+	hr->rbuf_off = 0;
+	hr->rbuf_len = n;
+	return true;
+}
+
+// read a line without its \r\n, longer lines are truncated. returns -1
+// when the client closed the connection or stopped sending
+static int http_gets(RSocketHTTPRequest *hr, char *buf, int size) {
+	int i = 0;
+	for (;;) {
+		if (!http_fill (hr, HTTP_READ_MSECS)) {
+			buf[i] = 0;
+			return -1;
+		}
+		const ut8 *p = hr->rbuf + hr->rbuf_off;
+		const ut8 *nl = memchr (p, '\n', hr->rbuf_len - hr->rbuf_off);
+		int n = nl? (int)(nl - p): hr->rbuf_len - hr->rbuf_off;
+		int cp = R_MIN (n, size - 1 - i);
+		memcpy (buf + i, p, cp);
+		i += cp;
+		hr->rbuf_off += nl? n + 1: n;
+		if (nl) {
+			break;
+		}
+	}
+	if (i > 0 && buf[i - 1] == '\r') {
+		i--;
+	}
+	buf[i] = 0;
+	return i;
+}
+
+static bool http_read(RSocketHTTPRequest *hr, ut8 *buf, int len) {
+	while (len > 0) {
+		if (!http_fill (hr, HTTP_READ_MSECS)) {
+			return false;
+		}
+		int n = R_MIN (len, hr->rbuf_len - hr->rbuf_off);
+		memcpy (buf, hr->rbuf + hr->rbuf_off, n);
+		hr->rbuf_off += n;
+		buf += n;
+		len -= n;
 	}
+	return true;
+}
+
+static void http_request_fini(RSocketHTTPRequest *rs) {
+	free (rs->path);
+	free (rs->host);
+	free (rs->agent);
+	free (rs->method);
+	free (rs->referer);
+	free (rs->data);
+}
+
+// parse the next request of the connection, waiting up to msecs for it
+static bool http_parse(RSocketHTTPRequest *hr, RSocketHTTPOptions *so, int msecs) {
+	int content_length = 0;
+	char buf[1500], *p, *q;
+	bool first = true;
+	int conn = 0;
+
 	hr->auth = !so->httpauth;
+	if (!http_fill (hr, msecs)) {
+		return false;
+	}
 	for (;;) {
 #if __WINDOWS__
 		if (breaked && *breaked) {
-			r_socket_http_close (hr);
-			return NULL;
+			return false;
 		}
 #endif
-		memset (buf, 0, sizeof (buf));
-		xx = r_socket_gets (hr->s, buf, sizeof (buf));
-		yy = r_socket_ready (hr->s, 0, 20 * 1000); //this function uses usecs as argument
-//		eprintf ("READ %d (%s) READY %d\n", xx, buf, yy);
-		if (!yy || (!xx && !pxx)) {
+		int xx = http_gets (hr, buf, sizeof (buf));
+		if (xx < 0) {
+			if (first) {
+				return false;
+			}
+			// clients that never send the empty line are served as before,
+			// but their connection can not be reused
+			hr->keepalive = false;
 			break;
 		}
-		pxx = xx;
-
-		if (first==0) {
-			first = 1;
-			if (strlen (buf)<3) {
-				r_socket_http_close (hr);
-				return NULL;
+		if (first) {
+			if (!xx) {
+				// empty lines before the request line are allowed
+				continue;
+			}
+			first = false;
+			if (strlen (buf) < 3) {
+				return false;
 			}
 			p = strchr (buf, ' ');
 			if (p) {
@@ -58,58 +130,146 @@ R_API RSocketHTTPRequest *r_socket_http_accept (RSocket *s, RSocketHTTPOptions *
 			}
 			hr->method = strdup (buf);
 			if (p) {
-				q = strstr (p+1, " HTTP"); //strchr (p+1, ' ');
+				q = strstr (p + 1, " HTTP"); //strchr (p+1, ' ');
 				if (q) {
 					*q = 0;
+					// HTTP/1.1 connections are persistent by default
+					conn = !strncmp (q + 1, "HTTP/1.", 7) && q[8] >= '1'? 1: -1;
 				}
-				hr->path = strdup (p+1);
+				hr->path = strdup (p + 1);
+			}
+			continue;
+		}
+		if (!xx) {
+			break;
+		}
+		if (!hr->referer && !strncmp (buf, "Referer: ", 9)) {
+			hr->referer = strdup (buf + 9);
+		} else if (!hr->agent && !strncmp (buf, "User-Agent: ", 12)) {
+			hr->agent = strdup (buf + 12);
+		} else if (!hr->host && !strncmp (buf, "Host: ", 6)) {
+			hr->host = strdup (buf + 6);
+		} else if (!strncmp (buf, "Content-Length: ", 16)) {
+			content_length = atoi (buf + 16);
+		} else if (!r_str_ncasecmp (buf, "Connection: ", 12)) {
+			if (r_str_casestr (buf + 12, "close")) {
+				conn = -1;
+			} else if (r_str_casestr (buf + 12, "keep-alive")) {
+				conn = 1;
+			}
+		} else if (so->httpauth && !strncmp (buf, "Authorization: Basic ", 21)) {
+			char *authtoken = buf + 21;
+			size_t authlen = strlen (authtoken);
+			char *curauthtoken;
+			RListIter *iter;
+			char *decauthtoken = calloc (4, authlen + 1);
+			if (!decauthtoken) {
+				eprintf ("Could not allocate decoding buffer\n");
+				return true;
 			}
-		} else {
-			if (!hr->referer && !strncmp (buf, "Referer: ", 9)) {
-				hr->referer = strdup (buf + 9);
-			} else if (!hr->agent && !strncmp (buf, "User-Agent: ", 12)) {
-				hr->agent = strdup (buf + 12);
-			} else if (!hr->host && !strncmp (buf, "Host: ", 6)) {
-				hr->host = strdup (buf + 6);
-			} else if (!strncmp (buf, "Content-Length: ", 16)) {
-				content_length = atoi (buf + 16);
-			} else if (so->httpauth && !strncmp (buf, "Authorization: Basic ", 21)) {
-				char *authtoken = buf + 21;
-				size_t authlen = strlen (authtoken);
-				char *curauthtoken;
-				RListIter *iter;
-				char *decauthtoken = calloc (4, authlen + 1);
-				if (!decauthtoken) {
-					eprintf ("Could not allocate decoding buffer\n");
-					return hr;
-				}
 
-				if (r_base64_decode ((ut8 *)decauthtoken, authtoken, authlen) == -1) {
-					eprintf ("Could not decode authorization token\n");
-				} else {
-					r_list_foreach (so->authtokens, iter, curauthtoken) {
-						if (!strcmp (decauthtoken, curauthtoken)) {
-							hr->auth = true;
-							break;
-						}
+			if (r_base64_decode ((ut8 *)decauthtoken, authtoken, authlen) == -1) {
+				eprintf ("Could not decode authorization token\n");
+			} else {
+				r_list_foreach (so->authtokens, iter, curauthtoken) {
+					if (!strcmp (decauthtoken, curauthtoken)) {
+						hr->auth = true;
+						break;
 					}
 				}
+			}
 
-				free (decauthtoken);
+			free (decauthtoken);
 
-				if (!hr->auth) {
-					eprintf ("Failed attempt login from '%s'\n", hr->host);
-				}
+			if (!hr->auth) {
+				eprintf ("Failed attempt login from '%s'\n", hr->host);
 			}
 		}
 	}
-	if (content_length>0) {
-		r_socket_read_block (hr->s, (ut8*)buf, 1); // one missing byte wtf
-		hr->data = malloc (content_length+1);
+	if (conn <= 0) {
+		hr->keepalive = false;
+	}
+	if (content_length > 0) {
+		hr->data = malloc (content_length + 1);
+		if (!hr->data) {
+			hr->keepalive = false;
+			return true;
+		}
 		hr->data_length = content_length;
-		r_socket_read_block (hr->s, hr->data, hr->data_length);
+		if (!http_read (hr, hr->data, hr->data_length)) {
+			hr->keepalive = false;
+		}
 		hr->data[content_length] = 0;
 	}
+	return true;
+}
+
+R_API RSocketHTTPRequest *r_socket_http_accept (RSocket *s, RSocketHTTPOptions *so) {
+	RSocketHTTPRequest *hr = R_NEW0 (RSocketHTTPRequest);
+	if (!hr) {
+		return NULL;
+	}
+	if (so->accept_timeout) {
+		hr->s = r_socket_accept_timeout (s, 1);
+	} else {
+		hr->s = r_socket_accept (s);
+	}
+	if (!hr->s) {
+		free (hr);
+		return NULL;
+	}
+	// the listening socket may be non-blocking
+	r_socket_block_time (hr->s, 1, so->timeout);
+	if (so->keepalive) {
+		// responses are written in small pieces, do not hold them back
+		int flag = 1;
+		(void)setsockopt (hr->s->fd, IPPROTO_TCP, TCP_NODELAY, (char *)&flag, sizeof (flag));
+	}
+	hr->keepalive = so->keepalive;
+	if (!http_parse (hr, so, HTTP_READ_MSECS)) {
+		r_socket_http_close (hr);
+		return NULL;
+	}
+	return hr;
+}
+
+// Keep-alive: reuse the connection of rs (which is freed) for the next
+// request, waiting so->timeout seconds for it. The connection is closed
+// and NULL returned when it can not be reused.
+R_API RSocketHTTPRequest *r_socket_http_next(RSocketHTTPRequest *rs, RSocketHTTPOptions *so) {
+	r_return_val_if_fail (rs && so, NULL);
+	if (!rs->keepalive || (so->stop && *so->stop)) {
+		r_socket_http_close (rs);
+		return NULL;
+	}
+	RSocketHTTPRequest *hr = R_NEW0 (RSocketHTTPRequest);
+	if (!hr) {
+		r_socket_http_close (rs);
+		return NULL;
+	}
+	hr->s = rs->s;
+	hr->rbuf = rs->rbuf;
+	hr->rbuf_off = rs->rbuf_off;
+	hr->rbuf_len = rs->rbuf_len;
+	hr->count = rs->count + 1;
+	hr->keepalive = true;
+	http_request_fini (rs);
+	free (rs);
+	// idle clients are polled so a server stop is not delayed by them
+	int left = so->timeout > 0? so->timeout * 1000: -1;
+	for (;;) {
+		if (hr->rbuf_off < hr->rbuf_len || r_socket_ready (hr->s, 0, 100 * 1000) > 0) {
+			break;
+		}
+		if ((so->stop && *so->stop) || (left > 0 && (left -= 100) <= 0)) {
+			r_socket_http_close (hr);
+			return NULL;
+		}
+	}
+	if (!http_parse (hr, so, HTTP_READ_MSECS)) {
+		r_socket_http_close (hr);
+		return NULL;
+	}
 	return hr;
 }
 
@@ -128,12 +288,29 @@ R_API void r_socket_http_response (RSocketHTTPRequest *rs, int code, const char
 	if (!headers) {
 		headers = code == 401 ? "WWW-Authenticate: Basic realm=\"R2 Web UI Access\"\n" : "";
 	}
-	r_socket_printf (rs->s, "HTTP/1.0 %d %s\r\n%s"
-		"Connection: close\r\nContent-Length: %d\r\n\r\n",
-		code, strcode, headers, len);
+	char *res = r_str_newf ("HTTP/1.%d %d %s\r\n%s"
+		"Connection: %s\r\nContent-Length: %d\r\n\r\n",
+		rs->keepalive? 1: 0, code, strcode, headers,
+		rs->keepalive? "keep-alive": "close", len);
+	if (!res) {
+		return;
+	}
+	// header and body go in the same write, a small body sent on its own
+	// waits for the client to ack the header (nagle + delayed acks)
+	int hlen = strlen (res);
 	if (out && len > 0) {
-		r_socket_write (rs->s, (void *)out, len);
+		char *tmp = realloc (res, hlen + len);
+		if (!tmp) {
+			free (res);
+			return;
+		}
+		res = tmp;
+		memcpy (res + hlen, out, len);
+	} else {
+		len = 0;
 	}
+	r_socket_write (rs->s, res, hlen + len);
+	free (res);
 }
 
 R_API ut8 *r_socket_http_handle_upload(const ut8 *str, int len, int *retlen) {
@@ -185,11 +362,8 @@ R_API ut8 *r_socket_http_handle_upload(const ut8 *str, int len, int *retlen) {
 /* close client socket and free struct */
 R_API void r_socket_http_close (RSocketHTTPRequest *rs) {
 	r_socket_free (rs->s);
-	free (rs->path);
-	free (rs->host);
-	free (rs->agent);
-	free (rs->method);
-	free (rs->data);
+	http_request_fini (rs);
+	free (rs->rbuf);
 	free (rs);
 }
 
@@ -885,7 +885,7 @@ R_API RMmap *r_file_mmap (const char *file, bool rw, ut64 base) {
 		return m;
 	}
 
-	if (m->len == (off_t)-1) {
+	if (m->len == (ut64)-1) {
 		close (fd);
 		R_FREE (m);
 		return NULL;
@@ -57,6 +57,20 @@ R_API R_TH_TID r_th_self(void) {
 #endif
 }
 
+// number of online processors, used as the default amount of workers
+R_API int r_th_ncpus(void) {
+#if __WINDOWS__
+	SYSTEM_INFO si;
+	GetSystemInfo (&si);
+	return R_MAX ((int)si.dwNumberOfProcessors, 1);
+#elif __UNIX__ && defined(_SC_NPROCESSORS_ONLN)
+	long n = sysconf (_SC_NPROCESSORS_ONLN);
+	return n > 0? (int)n: 1;
+#else
+	return 1;
+#endif
+}
+
 R_API bool r_th_setname(RThread *th, const char *name) {
 #if defined(HAVE_PTHREAD_NP) && HAVE_PTHREAD_NP
 #if __linux__
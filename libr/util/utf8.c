@@ -587,6 +587,10 @@ R_API int r_utf8_strlen(const ut8 *str) {
 R_API int r_isprint(const RRune c) {
 	const int last = nonprintable_ranges_count;
 
+	if (c < 0x80) {
+		return c >= 0x20 && c != 0x7f;
+	}
+
 	int low = 0;
 	int hi = last - 1;
 
@@ -699,7 +703,7 @@ R_API int *r_utf_block_list(const ut8 *str, int len) {
 	if (len < 0) {
 		len = strlen ((const char *)str);
 	}
-	static bool has_block[r_utf_blocks_count] = {0};
+	bool has_block[r_utf_blocks_count] = {0};
 	int *list = R_NEWS (int, len + 1);
 	if (!list) {
 		return NULL;
@@ -725,8 +729,5 @@ R_API int *r_utf_block_list(const ut8 *str, int len) {
 		str_ptr += ch_bytes;
 	}
 	*list_ptr = -1;
-	for (list_ptr = list; *list_ptr != -1; list_ptr++) {
-		has_block[*list_ptr] = false;
-	}
 	return list;
 }